@@ -0,0 +1,111 @@
+#include "seqpacket.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <core/assert.hpp>
+
+using namespace core;
+
+static io::Error errno_error(const char *what) {
+    return io::Error{io::ErrorKind::Other, std::string(what) + ": " + std::strerror(errno)};
+}
+
+SeqpacketChannel::SeqpacketChannel(SeqpacketChannel &&other) : fd_(std::exchange(other.fd_, -1)) {}
+
+SeqpacketChannel &SeqpacketChannel::operator=(SeqpacketChannel &&other) {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = std::exchange(other.fd_, -1);
+    return *this;
+}
+
+SeqpacketChannel::~SeqpacketChannel() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+Result<SeqpacketChannel, io::Error> SeqpacketChannel::connect(const std::string &path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return Err(io::Error{io::ErrorKind::InvalidInput, "Socket path is too long: " + path});
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return Err(errno_error("socket"));
+    }
+    // Wrap descriptor immediately so it is closed on any error below.
+    SeqpacketChannel channel(fd);
+
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+        return Err(errno_error("connect"));
+    }
+    return Ok(std::move(channel));
+}
+
+Result<std::monostate, io::Error> SeqpacketChannel::wait(short events, std::optional<std::chrono::milliseconds> timeout) {
+    pollfd pfd = {fd_, events, 0};
+    int timeout_ms = timeout.has_value() ? int(timeout.value().count()) : -1;
+    for (;;) {
+        int ret = ::poll(&pfd, 1, timeout_ms);
+        if (ret > 0) {
+            return Ok(std::monostate{});
+        } else if (ret == 0) {
+            return Err(io::Error{io::ErrorKind::TimedOut});
+        } else if (errno != EINTR) {
+            return Err(errno_error("poll"));
+        }
+    }
+}
+
+Result<std::monostate, io::Error> SeqpacketChannel::send(
+    const uint8_t *bytes,
+    size_t length,
+    std::optional<std::chrono::milliseconds> timeout //
+) {
+    auto wait_result = wait(POLLOUT, timeout);
+    if (wait_result.is_err()) {
+        return Err(wait_result.unwrap_err());
+    }
+
+    // Whole message is sent atomically or not sent at all.
+    ssize_t ret = ::send(fd_, bytes, length, MSG_NOSIGNAL);
+    if (ret < 0) {
+        return Err(errno_error("send"));
+    }
+    core_assert_eq(size_t(ret), length);
+    return Ok(std::monostate{});
+}
+
+Result<size_t, io::Error> SeqpacketChannel::receive(
+    uint8_t *bytes,
+    size_t max_length,
+    std::optional<std::chrono::milliseconds> timeout //
+) {
+    auto wait_result = wait(POLLIN, timeout);
+    if (wait_result.is_err()) {
+        return Err(wait_result.unwrap_err());
+    }
+
+    // Use `MSG_TRUNC` to get real message length and detect truncation.
+    ssize_t ret = ::recv(fd_, bytes, max_length, MSG_TRUNC);
+    if (ret < 0) {
+        return Err(errno_error("recv"));
+    } else if (ret == 0) {
+        return Err(io::Error{io::ErrorKind::UnexpectedEof, "Connection closed by peer"});
+    } else if (size_t(ret) > max_length) {
+        return Err(io::Error{io::ErrorKind::InvalidData, "Message is too long: " + std::to_string(ret)});
+    }
+    return Ok(size_t(ret));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <chrono>
+
+#include <core/result.hpp>
+#include <core/io.hpp>
+
+#include <channel/base.hpp>
+
+/// Channel over a Unix-domain `SOCK_SEQPACKET` socket.
+/// Preserves message boundaries like ZMQ does, but without TCP stack and broker overhead.
+class SeqpacketChannel final : public Channel {
+private:
+    int fd_ = -1;
+
+    explicit SeqpacketChannel(int fd) : fd_(fd) {}
+
+public:
+    SeqpacketChannel(const SeqpacketChannel &) = delete;
+    SeqpacketChannel &operator=(const SeqpacketChannel &) = delete;
+
+    SeqpacketChannel(SeqpacketChannel &&other);
+    SeqpacketChannel &operator=(SeqpacketChannel &&other);
+
+    ~SeqpacketChannel() override;
+
+    /// Connect to socket bound to filesystem `path`.
+    static core::Result<SeqpacketChannel, core::io::Error> connect(const std::string &path);
+
+    core::Result<std::monostate, core::io::Error> send(
+        const uint8_t *bytes,
+        size_t length,
+        std::optional<std::chrono::milliseconds> timeout) override;
+
+    core::Result<size_t, core::io::Error> receive(
+        uint8_t *bytes,
+        size_t max_length,
+        std::optional<std::chrono::milliseconds> timeout) override;
+
+private:
+    /// Wait until socket is ready for `events`.
+    core::Result<std::monostate, core::io::Error> wait(short events, std::optional<std::chrono::milliseconds> timeout);
+};
@@ -1,11 +1,67 @@
 #include <external.hpp>
 
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include <core/log.hpp>
+#include <core/assert.hpp>
+
 #include <channel/zmq.hpp>
+#include <channel/seqpacket.hpp>
+
+// NOTE: Must be kept in sync with `tornado/ioc/fakedev/base.py`.
+#define FAKEDEV_TRANSPORT_ENV "TORNADO_FAKEDEV_TRANSPORT"
+#define FAKEDEV_SOCKET_PATH_ENV "TORNADO_FAKEDEV_SOCKET_PATH"
+#define FAKEDEV_SOCKET_PATH_DEFAULT "/tmp/tornado_fakedev.sock"
+
+#define ZMQ_MAX_MSG_LEN 1024
+#define SEQPACKET_MAX_MSG_LEN 32768
+
+enum class Transport {
+    Zmq,
+    Seqpacket,
+};
+
+/// Transport is selected at startup by environment variable set by fake device.
+static Transport transport() {
+    const char *value = std::getenv(FAKEDEV_TRANSPORT_ENV);
+    if (value == nullptr || std::string_view(value) == "zmq") {
+        return Transport::Zmq;
+    } else if (std::string_view(value) == "seqpacket") {
+        return Transport::Seqpacket;
+    } else {
+        core_panic("Unknown fakedev transport: {}", value);
+    }
+}
+
+static std::string socket_path() {
+    const char *value = std::getenv(FAKEDEV_SOCKET_PATH_ENV);
+    return value != nullptr ? value : FAKEDEV_SOCKET_PATH_DEFAULT;
+}
 
 size_t max_message_length() {
-    return 1024;
+    switch (transport()) {
+    case Transport::Zmq:
+        return ZMQ_MAX_MSG_LEN;
+    case Transport::Seqpacket:
+        return SEQPACKET_MAX_MSG_LEN;
+    default:
+        core_unreachable();
+    }
 }
 
 std::unique_ptr<Channel> make_device_channel() {
-    return std::make_unique<ZmqChannel>(std::move(ZmqChannel::create("127.0.0.1", 8321, 8322).unwrap()));
+    switch (transport()) {
+    case Transport::Zmq:
+        core_log_info("Fakedev transport: ZMQ");
+        return std::make_unique<ZmqChannel>(std::move(ZmqChannel::create("127.0.0.1", 8321, 8322).unwrap()));
+    case Transport::Seqpacket: {
+        auto path = socket_path();
+        core_log_info("Fakedev transport: SOCK_SEQPACKET at '{}'", path);
+        return std::make_unique<SeqpacketChannel>(std::move(SeqpacketChannel::connect(path).unwrap()));
+    }
+    default:
+        core_unreachable();
+    }
 }
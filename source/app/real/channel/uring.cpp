@@ -0,0 +1,507 @@
+#include "uring.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <core/assert.hpp>
+
+using namespace core;
+
+static io::Error errno_error(const char *what, int code = errno) {
+    return io::Error{io::ErrorKind::Other, std::string(what) + ": " + std::strerror(code)};
+}
+
+static int sys_io_uring_setup(unsigned entries, io_uring_params *params) {
+    return int(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return int(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+template <typename T>
+static T *ring_offset(void *base, uint32_t offset) {
+    return reinterpret_cast<T *>(static_cast<uint8_t *>(base) + offset);
+}
+
+static unsigned load_acquire(const unsigned *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(unsigned *ptr, unsigned value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+UringQueue::UringQueue(UringQueue &&other) {
+    *this = std::move(other);
+}
+
+UringQueue &UringQueue::operator=(UringQueue &&other) {
+    release();
+    fd_ = std::exchange(other.fd_, -1);
+    sq_ptr_ = std::exchange(other.sq_ptr_, nullptr);
+    sq_size_ = std::exchange(other.sq_size_, 0);
+    cq_ptr_ = std::exchange(other.cq_ptr_, nullptr);
+    cq_size_ = std::exchange(other.cq_size_, 0);
+    sqes_ = std::exchange(other.sqes_, nullptr);
+    sqes_size_ = std::exchange(other.sqes_size_, 0);
+    sq_head_ = other.sq_head_;
+    sq_tail_ = other.sq_tail_;
+    sq_mask_ = other.sq_mask_;
+    sq_array_ = other.sq_array_;
+    cq_head_ = other.cq_head_;
+    cq_tail_ = other.cq_tail_;
+    cq_mask_ = other.cq_mask_;
+    cqes_ = other.cqes_;
+    sq_pending_ = std::exchange(other.sq_pending_, 0);
+    sq_entries_ = other.sq_entries_;
+    enter_count_ = other.enter_count_;
+    return *this;
+}
+
+UringQueue::~UringQueue() {
+    release();
+}
+
+void UringQueue::release() {
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+        ::munmap(cq_ptr_, cq_size_);
+    }
+    cq_ptr_ = nullptr;
+    if (sq_ptr_ != nullptr) {
+        ::munmap(sq_ptr_, sq_size_);
+        sq_ptr_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+Result<UringQueue, io::Error> UringQueue::create(unsigned entries) {
+    UringQueue self;
+
+    io_uring_params params = {};
+    self.fd_ = sys_io_uring_setup(entries, &params);
+    if (self.fd_ < 0) {
+        return Err(errno_error("io_uring_setup"));
+    }
+
+    self.sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    self.cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        self.sq_size_ = std::max(self.sq_size_, self.cq_size_);
+        self.cq_size_ = self.sq_size_;
+    }
+
+    self.sq_ptr_ =
+        ::mmap(nullptr, self.sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self.fd_, IORING_OFF_SQ_RING);
+    if (self.sq_ptr_ == MAP_FAILED) {
+        self.sq_ptr_ = nullptr;
+        return Err(errno_error("mmap(sq)"));
+    }
+    if (single_mmap) {
+        self.cq_ptr_ = self.sq_ptr_;
+    } else {
+        self.cq_ptr_ =
+            ::mmap(nullptr, self.cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self.fd_, IORING_OFF_CQ_RING);
+        if (self.cq_ptr_ == MAP_FAILED) {
+            self.cq_ptr_ = nullptr;
+            return Err(errno_error("mmap(cq)"));
+        }
+    }
+    self.sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = ::mmap(nullptr, self.sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self.fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return Err(errno_error("mmap(sqes)"));
+    }
+    self.sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    self.sq_head_ = ring_offset<unsigned>(self.sq_ptr_, params.sq_off.head);
+    self.sq_tail_ = ring_offset<unsigned>(self.sq_ptr_, params.sq_off.tail);
+    self.sq_mask_ = *ring_offset<unsigned>(self.sq_ptr_, params.sq_off.ring_mask);
+    self.sq_array_ = ring_offset<unsigned>(self.sq_ptr_, params.sq_off.array);
+    self.sq_entries_ = params.sq_entries;
+
+    self.cq_head_ = ring_offset<unsigned>(self.cq_ptr_, params.cq_off.head);
+    self.cq_tail_ = ring_offset<unsigned>(self.cq_ptr_, params.cq_off.tail);
+    self.cq_mask_ = *ring_offset<unsigned>(self.cq_ptr_, params.cq_off.ring_mask);
+    self.cqes_ = ring_offset<io_uring_cqe>(self.cq_ptr_, params.cq_off.cqes);
+
+    return Ok(std::move(self));
+}
+
+io_uring_sqe *UringQueue::get_sqe() {
+    unsigned head = load_acquire(sq_head_);
+    unsigned tail = *sq_tail_ + sq_pending_;
+    if (tail - head >= sq_entries_) {
+        return nullptr;
+    }
+    unsigned index = tail & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    sq_pending_ += 1;
+    return sqe;
+}
+
+Result<unsigned, io::Error> UringQueue::submit(unsigned wait_nr) {
+    unsigned to_submit = sq_pending_;
+    // Publish pending SQEs to kernel.
+    store_release(sq_tail_, *sq_tail_ + to_submit);
+    sq_pending_ = 0;
+
+    if (to_submit == 0 && wait_nr == 0) {
+        return Ok(0u);
+    }
+    for (;;) {
+        enter_count_ += 1;
+        int ret = sys_io_uring_enter(fd_, to_submit, wait_nr, wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (ret >= 0) {
+            return Ok(unsigned(ret));
+        } else if (errno != EINTR) {
+            return Err(errno_error("io_uring_enter"));
+        }
+    }
+}
+
+io_uring_cqe *UringQueue::peek_cqe() {
+    unsigned head = *cq_head_;
+    if (head == load_acquire(cq_tail_)) {
+        return nullptr;
+    }
+    return &cqes_[head & cq_mask_];
+}
+
+void UringQueue::cqe_seen() {
+    store_release(cq_head_, *cq_head_ + 1);
+}
+
+Result<std::monostate, io::Error> UringQueue::wait_cqe(std::optional<std::chrono::milliseconds> timeout) {
+    // Ring fd becomes readable when completion queue is not empty.
+    pollfd pfd = {fd_, POLLIN, 0};
+    int timeout_ms = timeout.has_value() ? int(timeout.value().count()) : -1;
+    for (;;) {
+        if (peek_cqe() != nullptr) {
+            return Ok(std::monostate{});
+        }
+        enter_count_ += 1;
+        int ret = ::poll(&pfd, 1, timeout_ms);
+        if (ret == 0) {
+            return Err(io::Error{io::ErrorKind::TimedOut});
+        } else if (ret < 0 && errno != EINTR) {
+            return Err(errno_error("poll"));
+        }
+    }
+}
+
+UringChannel::UringChannel(int fd, size_t max_len, UringQueue &&read_ring, UringQueue &&write_ring) :
+    fd_(fd),
+    max_len_(max_len),
+    read_ring_(std::move(read_ring)),
+    write_ring_(std::move(write_ring)) //
+{
+    for (auto &slot : read_slots_) {
+        slot.buffer.resize(max_len_);
+    }
+    for (size_t i = 0; i < WRITE_BATCH_SIZE; ++i) {
+        write_slots_[i].reserve(max_len_);
+        write_free_.push_back(i);
+    }
+}
+
+/// User data of cancel requests, doesn't intersect with slot indices.
+static constexpr uint64_t CANCEL_USER_DATA = ~uint64_t(0);
+
+UringChannel::~UringChannel() {
+    shutdown();
+    ::close(fd_);
+}
+
+void UringChannel::shutdown() {
+    // Kernel may write into read buffers until the request is completed, so we must wait for all of them.
+    for (size_t i = 0; i < READS_IN_FLIGHT && read_in_flight_ > 0; ++i) {
+        io_uring_sqe *sqe = read_ring_.get_sqe();
+        if (sqe == nullptr) {
+            read_ring_.submit().unwrap();
+            sqe = read_ring_.get_sqe();
+            core_assert(sqe != nullptr);
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = i;
+        sqe->user_data = CANCEL_USER_DATA;
+    }
+    while (read_in_flight_ > 0) {
+        read_ring_.submit(1).unwrap();
+        while (io_uring_cqe *cqe = read_ring_.peek_cqe()) {
+            if (cqe->user_data != CANCEL_USER_DATA) {
+                read_in_flight_ -= 1;
+            }
+            read_ring_.cqe_seen();
+        }
+    }
+
+    flush().unwrap();
+    while (write_in_flight_ > 0) {
+        write_ring_.submit(1).unwrap();
+        while (write_ring_.peek_cqe() != nullptr) {
+            write_in_flight_ -= 1;
+            write_ring_.cqe_seen();
+        }
+    }
+}
+
+Result<std::unique_ptr<UringChannel>, io::Error> UringChannel::create(const std::string &path, size_t max_len) {
+    int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) {
+        return Err(errno_error("open"));
+    }
+
+    // Set raw mode to pass binary messages unchanged.
+    termios tty = {};
+    if (::tcgetattr(fd, &tty) != 0) {
+        int code = errno;
+        ::close(fd);
+        return Err(errno_error("tcgetattr", code));
+    }
+    ::cfmakeraw(&tty);
+    if (::tcsetattr(fd, TCSANOW, &tty) != 0) {
+        int code = errno;
+        ::close(fd);
+        return Err(errno_error("tcsetattr", code));
+    }
+
+    return from_fd(fd, max_len);
+}
+
+Result<std::unique_ptr<UringChannel>, io::Error> UringChannel::from_fd(int fd, size_t max_len) {
+    auto read_ring = UringQueue::create(READS_IN_FLIGHT);
+    if (read_ring.is_err()) {
+        ::close(fd);
+        return Err(read_ring.unwrap_err());
+    }
+    auto write_ring = UringQueue::create(WRITE_BATCH_SIZE);
+    if (write_ring.is_err()) {
+        ::close(fd);
+        return Err(write_ring.unwrap_err());
+    }
+
+    std::unique_ptr<UringChannel> self(
+        new UringChannel(fd, max_len, std::move(read_ring.unwrap()), std::move(write_ring.unwrap())));
+
+    // Put all reads in flight at once.
+    for (size_t i = 0; i < READS_IN_FLIGHT; ++i) {
+        self->submit_read(i);
+    }
+    auto submit_result = self->read_ring_.submit();
+    if (submit_result.is_err()) {
+        // Nothing has reached the kernel.
+        self->read_in_flight_ = 0;
+        return Err(submit_result.unwrap_err());
+    }
+    return Ok(std::move(self));
+}
+
+void UringChannel::submit_read(size_t index) {
+    auto &slot = read_slots_[index];
+    slot.len = 0;
+    slot.pos = 0;
+
+    io_uring_sqe *sqe = read_ring_.get_sqe();
+    // Read ring is sized exactly to the number of slots.
+    core_assert(sqe != nullptr);
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(slot.buffer.data());
+    sqe->len = uint32_t(slot.buffer.size());
+    // Tty is not seekable, use current position.
+    sqe->off = uint64_t(-1);
+    sqe->user_data = index;
+    read_in_flight_ += 1;
+}
+
+Result<std::monostate, io::Error> UringChannel::reap_reads() {
+    // NOTE: Completions for the same tty come in the order the data was read,
+    // so we hand slots out in CQ order and preserve byte stream ordering.
+    while (io_uring_cqe *cqe = read_ring_.peek_cqe()) {
+        size_t index = size_t(cqe->user_data);
+        int res = cqe->res;
+        read_ring_.cqe_seen();
+
+        core_assert(index < READS_IN_FLIGHT);
+        read_in_flight_ -= 1;
+        if (res == -EINTR || res == -EAGAIN) {
+            // Read was interrupted before getting any data, just put it back in flight.
+            submit_read(index);
+            continue;
+        } else if (res < 0) {
+            return Err(errno_error("read", -res));
+        } else if (res == 0) {
+            return Err(io::Error{io::ErrorKind::UnexpectedEof, "Tty closed"});
+        }
+        read_slots_[index].len = size_t(res);
+        read_ready_.push_back(index);
+    }
+    return Ok(std::monostate{});
+}
+
+Result<size_t, io::Error> UringChannel::receive(
+    uint8_t *bytes,
+    size_t max_length,
+    std::optional<std::chrono::milliseconds> timeout //
+) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout.value_or(std::chrono::milliseconds(0));
+    while (read_ready_.empty()) {
+        std::optional<std::chrono::milliseconds> remaining = std::nullopt;
+        if (timeout.has_value()) {
+            remaining = std::max(
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()),
+                std::chrono::milliseconds(0));
+        }
+        auto wait_result = read_ring_.wait_cqe(remaining);
+        if (wait_result.is_err()) {
+            return Err(wait_result.unwrap_err());
+        }
+        auto reap_result = reap_reads();
+        if (reap_result.is_err()) {
+            return Err(reap_result.unwrap_err());
+        }
+        // Resubmit interrupted reads if any.
+        auto submit_result = read_ring_.submit();
+        if (submit_result.is_err()) {
+            return Err(submit_result.unwrap_err());
+        }
+    }
+
+    // Copy as much as possible from completed reads and put drained slots back in flight.
+    size_t total = 0;
+    while (!read_ready_.empty() && total < max_length) {
+        size_t index = read_ready_.front();
+        auto &slot = read_slots_[index];
+        size_t len = std::min(slot.len - slot.pos, max_length - total);
+        std::memcpy(bytes + total, slot.buffer.data() + slot.pos, len);
+        slot.pos += len;
+        total += len;
+        if (slot.pos == slot.len) {
+            read_ready_.pop_front();
+            submit_read(index);
+        }
+    }
+    auto submit_result = read_ring_.submit();
+    if (submit_result.is_err()) {
+        return Err(submit_result.unwrap_err());
+    }
+    return Ok(total);
+}
+
+Result<std::monostate, io::Error> UringChannel::reap_writes() {
+    while (io_uring_cqe *cqe = write_ring_.peek_cqe()) {
+        size_t index = size_t(cqe->user_data);
+        int res = cqe->res;
+        write_ring_.cqe_seen();
+
+        core_assert(index < WRITE_BATCH_SIZE);
+        write_in_flight_ -= 1;
+        write_free_.push_back(index);
+        if (res < 0) {
+            return Err(errno_error("write", -res));
+        } else if (size_t(res) != write_slots_[index].size()) {
+            // RPMSG tty accepts whole message at once, so short write is not expected.
+            return Err(io::Error{io::ErrorKind::Other, "Short write: " + std::to_string(res)});
+        }
+    }
+    return Ok(std::monostate{});
+}
+
+Result<std::monostate, io::Error> UringChannel::send(
+    const uint8_t *bytes,
+    size_t length,
+    std::optional<std::chrono::milliseconds> timeout //
+) {
+    core_assert(length <= max_len_);
+
+    auto reap_result = reap_writes();
+    if (reap_result.is_err()) {
+        return Err(reap_result.unwrap_err());
+    }
+    while (write_free_.empty()) {
+        // All slots are busy, submit what we have and wait for some of them to complete.
+        auto flush_result = flush();
+        if (flush_result.is_err()) {
+            return Err(flush_result.unwrap_err());
+        }
+        auto wait_result = write_ring_.wait_cqe(timeout);
+        if (wait_result.is_err()) {
+            return Err(wait_result.unwrap_err());
+        }
+        reap_result = reap_writes();
+        if (reap_result.is_err()) {
+            return Err(reap_result.unwrap_err());
+        }
+    }
+
+    size_t index = write_free_.back();
+    write_free_.pop_back();
+    auto &slot = write_slots_[index];
+    slot.assign(bytes, bytes + length);
+
+    io_uring_sqe *sqe = write_ring_.get_sqe();
+    core_assert(sqe != nullptr);
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(slot.data());
+    sqe->len = uint32_t(slot.size());
+    sqe->off = uint64_t(-1);
+    sqe->user_data = index;
+    if (write_queued_ == 0) {
+        // Don't start the batch until previous batches are completed to keep message order.
+        sqe->flags |= IOSQE_IO_DRAIN;
+    } else {
+        // Writes inside the batch are executed strictly one after another.
+        write_last_->flags |= IOSQE_IO_LINK;
+    }
+    write_last_ = sqe;
+    write_queued_ += 1;
+
+    if (write_queued_ + write_in_flight_ >= WRITE_BATCH_SIZE) {
+        return flush();
+    }
+    return Ok(std::monostate{});
+}
+
+Result<std::monostate, io::Error> UringChannel::flush() {
+    if (write_queued_ == 0) {
+        return Ok(std::monostate{});
+    }
+    auto submit_result = write_ring_.submit();
+    if (submit_result.is_err()) {
+        return Err(submit_result.unwrap_err());
+    }
+    write_in_flight_ += write_queued_;
+    write_queued_ = 0;
+    write_last_ = nullptr;
+    write_batches_ += 1;
+    return Ok(std::monostate{});
+}
+
+UringChannel::Stats UringChannel::stats() const {
+    Stats stats;
+    stats.recv_syscalls = read_ring_.enter_count();
+    stats.send_syscalls = write_ring_.enter_count();
+    stats.write_batches = write_batches_;
+    return stats;
+}
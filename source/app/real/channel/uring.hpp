@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <deque>
+#include <vector>
+#include <string>
+#include <optional>
+#include <chrono>
+
+#include <linux/io_uring.h>
+
+#include <core/result.hpp>
+#include <core/io.hpp>
+
+#include <batch_channel.hpp>
+
+/// Minimal io_uring queue over raw syscalls.
+/// We don't depend on `liburing` because it is missing in the cross toolchain sysroot.
+/// NOTE: Not thread-safe, each thread must use its own queue.
+class UringQueue final {
+private:
+    int fd_ = -1;
+
+    void *sq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    void *cq_ptr_ = nullptr;
+    size_t cq_size_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *sq_array_ = nullptr;
+
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+
+    /// Number of SQEs prepared but not yet submitted to kernel.
+    unsigned sq_pending_ = 0;
+    unsigned sq_entries_ = 0;
+
+    /// Number of `io_uring_enter` calls, used for benchmarking.
+    size_t enter_count_ = 0;
+
+    UringQueue() = default;
+    void release();
+
+public:
+    UringQueue(const UringQueue &) = delete;
+    UringQueue &operator=(const UringQueue &) = delete;
+
+    UringQueue(UringQueue &&other);
+    UringQueue &operator=(UringQueue &&other);
+
+    ~UringQueue();
+
+    static core::Result<UringQueue, core::io::Error> create(unsigned entries);
+
+    [[nodiscard]] int fd() const {
+        return fd_;
+    }
+    [[nodiscard]] size_t enter_count() const {
+        return enter_count_;
+    }
+
+    /// Get next free SQE or `nullptr` if submission queue is full.
+    /// SQE is zeroed and becomes pending until `submit` is called.
+    io_uring_sqe *get_sqe();
+
+    /// Submit all pending SQEs and wait for at least `wait_nr` completions in a single syscall.
+    core::Result<unsigned, core::io::Error> submit(unsigned wait_nr = 0);
+
+    /// Get next completion or `nullptr` if there is none. Doesn't make syscalls.
+    io_uring_cqe *peek_cqe();
+    /// Mark completion returned by `peek_cqe` as consumed.
+    void cqe_seen();
+
+    /// Wait until completion queue is not empty.
+    core::Result<std::monostate, core::io::Error> wait_cqe(std::optional<std::chrono::milliseconds> timeout);
+};
+
+/// Channel for RPMSG tty that uses io_uring instead of blocking `read`/`write`.
+///
+/// + Several reads are kept in flight, so incoming data is already in userspace when `receive` is called.
+/// + `send` only queues messages, they are submitted in batches by `flush` (or when the batch is full)
+///   with a single syscall.
+///
+/// Receiving and sending use separate rings, so `receive` and `send`/`flush` may be called from different threads.
+class UringChannel final : public BatchChannel {
+public:
+    static constexpr size_t READS_IN_FLIGHT = 4;
+    static constexpr size_t WRITE_BATCH_SIZE = 16;
+
+    struct Stats {
+        /// Syscalls made by receiving side.
+        size_t recv_syscalls = 0;
+        /// Syscalls made by sending side.
+        size_t send_syscalls = 0;
+        /// Number of submitted write batches.
+        size_t write_batches = 0;
+    };
+
+private:
+    struct ReadSlot {
+        std::vector<uint8_t> buffer;
+        size_t len = 0;
+        size_t pos = 0;
+    };
+
+    int fd_ = -1;
+    size_t max_len_ = 0;
+
+    UringQueue read_ring_;
+    std::array<ReadSlot, READS_IN_FLIGHT> read_slots_;
+    /// Indices of completed read slots in completion order.
+    std::deque<size_t> read_ready_;
+    size_t read_in_flight_ = 0;
+
+    UringQueue write_ring_;
+    std::array<std::vector<uint8_t>, WRITE_BATCH_SIZE> write_slots_;
+    std::vector<size_t> write_free_;
+    size_t write_queued_ = 0;
+    size_t write_in_flight_ = 0;
+    size_t write_batches_ = 0;
+    /// Last queued write, next one will be linked to it.
+    io_uring_sqe *write_last_ = nullptr;
+
+    UringChannel(int fd, size_t max_len, UringQueue &&read_ring, UringQueue &&write_ring);
+
+    void submit_read(size_t slot);
+    core::Result<std::monostate, core::io::Error> reap_reads();
+    core::Result<std::monostate, core::io::Error> reap_writes();
+    /// Cancel reads in flight and wait for pending writes before buffers are freed.
+    void shutdown();
+
+public:
+    UringChannel(const UringChannel &) = delete;
+    UringChannel &operator=(const UringChannel &) = delete;
+    UringChannel(UringChannel &&) = delete;
+    UringChannel &operator=(UringChannel &&) = delete;
+
+    ~UringChannel() override;
+
+    /// Open tty at `path` in raw mode.
+    static core::Result<std::unique_ptr<UringChannel>, core::io::Error> create(const std::string &path, size_t max_len);
+    /// Take ownership of already opened and configured file descriptor.
+    static core::Result<std::unique_ptr<UringChannel>, core::io::Error> from_fd(int fd, size_t max_len);
+
+    /// Queue message for sending. Message is submitted to kernel on `flush` or when write batch is full.
+    core::Result<std::monostate, core::io::Error> send(
+        const uint8_t *bytes,
+        size_t length,
+        std::optional<std::chrono::milliseconds> timeout) override;
+
+    core::Result<size_t, core::io::Error> receive(
+        uint8_t *bytes,
+        size_t max_length,
+        std::optional<std::chrono::milliseconds> timeout) override;
+
+    /// Submit all queued messages with a single syscall.
+    core::Result<std::monostate, core::io::Error> flush() override;
+
+    [[nodiscard]] Stats stats() const;
+};
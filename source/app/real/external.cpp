@@ -1,12 +1,32 @@
 #include <external.hpp>
 
+#include <cstdlib>
+#include <string_view>
+
+#include <core/assert.hpp>
+#include <core/log.hpp>
+
 #include <common/config.h>
 #include <channel/rpmsg.hpp>
+#include <channel/uring.hpp>
+
+#define RPMSG_TTY_PATH "/dev/ttyRPMSG0"
+
+/// Environment variable to select RPMSG tty backend: `tty` (blocking I/O, default) or `uring`.
+#define RPMSG_BACKEND_ENV "TORNADO_RPMSG_BACKEND"
 
 size_t max_message_length() {
     return RPMSG_MAX_APP_MSG_LEN;
 }
 
 std::unique_ptr<Channel> make_device_channel() {
-    return std::make_unique<RpmsgChannel>(std::move(RpmsgChannel::create("/dev/ttyRPMSG0").unwrap()));
+    const char *backend = std::getenv(RPMSG_BACKEND_ENV);
+    if (backend == nullptr || std::string_view(backend) == "tty") {
+        return std::make_unique<RpmsgChannel>(std::move(RpmsgChannel::create(RPMSG_TTY_PATH).unwrap()));
+    } else if (std::string_view(backend) == "uring") {
+        core_log_info("RPMSG backend: io_uring");
+        return UringChannel::create(RPMSG_TTY_PATH, RPMSG_MAX_APP_MSG_LEN).unwrap();
+    } else {
+        core_panic("Unknown RPMSG backend: {}", backend);
+    }
 }
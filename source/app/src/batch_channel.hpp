@@ -0,0 +1,15 @@
+#pragma once
+
+#include <variant>
+
+#include <core/result.hpp>
+#include <core/io.hpp>
+
+#include <channel/base.hpp>
+
+/// Channel that may defer sending until `flush` is called.
+/// `Device` flushes it once per send loop iteration, so all messages produced in one iteration go out together.
+class BatchChannel : public Channel {
+public:
+    virtual core::Result<std::monostate, core::io::Error> flush() = 0;
+};
@@ -1,7 +1,9 @@
 #include "device.hpp"
 
+#include <cmath>
 #include <variant>
 #include <cstring>
+#include <limits>
 
 #include <core/assert.hpp>
 #include <core/log.hpp>
@@ -16,7 +18,13 @@ void Device::recv_loop() {
     core_log_info("Channel recv thread started");
     const auto timeout = std::chrono::milliseconds(100);
 
-    channel_.send(ipp::AppMsg{ipp::AppMsgConnect{}}, std::nullopt).unwrap(); // Wait forever
+    ipp::AppMsgConnect connect_msg;
+    connect_msg.version = IPP_PROTOCOL_VERSION;
+    connect_msg.max_msg_len = uint16_t(std::min(channel_.max_message_length(), size_t(std::numeric_limits<uint16_t>::max())));
+    connect_msg.features = IPP_FEATURES_SUPPORTED;
+    connect_msg.sample_freq_hz = requested_sample_freq_hz_;
+    channel_.send(ipp::AppMsg{std::move(connect_msg)}, std::nullopt).unwrap(); // Wait forever
+    flush_channel();
     core_log_info("Connect signal sent");
     send_worker_ = std::thread([this]() {
         this->send_loop();
@@ -35,6 +43,9 @@ void Device::recv_loop() {
         auto incoming = result.unwrap();
         std::visit(
             overloaded{
+                [&](ipp::McuMsgCapabilities &&caps_msg) {
+                    negotiate(caps_msg);
+                },
                 [&](ipp::McuMsgDinUpdate &&din_msg) {
                     din_.value.store(din_msg.value);
                     if (din_.notify) {
@@ -42,6 +53,9 @@ void Device::recv_loop() {
                     }
                 },
                 [&](ipp::McuMsgAdcData &&adc_msg) {
+                    if (!check_adc_link(adc_msg)) {
+                        return;
+                    }
                     const auto &points_arrays = adc_msg.points_arrays;
                     for (size_t i = 0; i < ADC_COUNT; ++i) {
                         auto &adc = adcs_[i];
@@ -84,6 +98,30 @@ void Device::recv_loop() {
                     }
                     send_ready_.notify_one();
                 },
+                [&](ipp::McuMsgTiming &&timing_msg) {
+                    update_timing(timing_msg);
+                },
+                [&](ipp::McuMsgStats &&stats_msg) {
+                    update_mcu_stats(stats_msg);
+                },
+                [&](ipp::McuMsgCalib &&calib_msg) {
+                    update_calib(calib_msg);
+                },
+                [&](ipp::McuMsgRegulator &&regulator_msg) {
+                    update_regulator_gains(regulator_msg);
+                },
+                [&](ipp::McuMsgTelemetry &&telemetry_msg) {
+                    update_telemetry(telemetry_msg);
+                },
+                [&](ipp::McuMsgFault &&fault_msg) {
+                    update_fault(fault_msg);
+                },
+                [&](ipp::McuMsgFaultLimits &&limits_msg) {
+                    update_fault_limits(limits_msg);
+                },
+                [&](ipp::McuMsgPostmortem &&postmortem_msg) {
+                    update_postmortem(postmortem_msg);
+                },
                 [&](ipp::McuMsgDebug &&debug) {
                     core_log_debug("[mcu:debug]: {}", debug.message);
                 },
@@ -102,6 +140,111 @@ void Device::recv_loop() {
     send_worker_.join();
 }
 
+void Device::negotiate(const ipp::McuMsgCapabilities &caps_msg) {
+    if (caps_msg.version != IPP_PROTOCOL_VERSION) {
+        core_panic(
+            "IPP protocol version mismatch: app {}, mcu {}",
+            uint32_t(IPP_PROTOCOL_VERSION),
+            uint32_t(caps_msg.version) //
+        );
+    }
+
+    Capabilities caps;
+    caps.version = caps_msg.version;
+    caps.max_msg_len = caps_msg.max_msg_len;
+    caps.dac_buffer_size = caps_msg.dac_buffer_size;
+    caps.adc_buffer_size = caps_msg.adc_buffer_size;
+    caps.dac_msg_max_points = caps_msg.dac_msg_max_points;
+    caps.adc_msg_max_points = caps_msg.adc_msg_max_points;
+    caps.sample_freq_hz = caps_msg.sample_freq_hz;
+    caps.features = caps_msg.features & IPP_FEATURES_SUPPORTED;
+
+    if (caps.sample_freq_hz != requested_sample_freq_hz_) {
+        core_log_warning(
+            "MCU sample frequency ({} Hz) differs from requested one ({} Hz)",
+            caps.sample_freq_hz,
+            requested_sample_freq_hz_ //
+        );
+    }
+    sample_freq_hz_.store(caps.sample_freq_hz);
+
+    // DAC message must fit both our channel and MCU receive buffer.
+    size_t max_len = std::min(channel_.max_message_length(), caps.max_msg_len);
+    size_t dac_points = std::min(_dac_msg_max_points_by_len(max_len), caps.dac_msg_max_points);
+    core_assert(dac_points > 0);
+
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        dac_msg_max_points_.store(dac_points);
+        features_.store(caps.features);
+        // MCU resets decimation on connection.
+        adc_decimation_update_.store(adc_decimation_.load() != 1);
+        dac_upsampling_update_.store(dac_upsampling_.load() != 1 || dac_interpolation_.load());
+        // Calibration is kept by MCU, so it is read instead.
+        calib_read_.store((caps.features & IPP_FEATURE_CALIB) != 0);
+        regulator_read_.store((caps.features & IPP_FEATURE_REGULATOR) != 0);
+        fault_limits_read_.store((caps.features & IPP_FEATURE_FAULT_LIMITS) != 0);
+        // MCU stops telemetry on connection.
+        telemetry_ratio_update_.store(telemetry_ratio_.load() != 0);
+    }
+    send_ready_.notify_all();
+    adc_link_ = AdcLink{};
+    telemetry_index_ = 0;
+
+    core_log_info(
+        "MCU capabilities: version {}, sample frequency {} Hz, DAC buffer {}, ADC buffer {}, DAC points per message {}, "
+        "ADC points per message {}, features {:#x}",
+        uint32_t(caps.version),
+        caps.sample_freq_hz,
+        caps.dac_buffer_size,
+        caps.adc_buffer_size,
+        dac_points,
+        caps.adc_msg_max_points,
+        caps.features //
+    );
+}
+
+bool Device::check_adc_link(const ipp::McuMsgAdcData &adc_msg) {
+    if ((features_.load() & IPP_FEATURE_SEQUENCE_NUMBERS) == 0) {
+        return true;
+    }
+    auto &link = adc_link_;
+    const uint64_t len = adc_msg.points_arrays.size();
+    if (!link.seq.has_value()) {
+        // First message after connection.
+        link.seq = adc_msg.seq + 1;
+        link.sample_index = adc_msg.sample_index + len;
+        return true;
+    }
+
+    // Wrapping difference, values above half range mean that message is from the past.
+    uint32_t seq_diff = adc_msg.seq - link.seq.value();
+    if (seq_diff >= 0x80000000u) {
+        link_stats_.adc_msg_dup += 1;
+        core_log_warning("Duplicated ADC message: seq {}, expected {}", adc_msg.seq, link.seq.value());
+        return false;
+    }
+
+    if (adc_msg.sample_index > link.sample_index) {
+        uint64_t points = adc_msg.sample_index - link.sample_index;
+        if (seq_diff != 0) {
+            link_stats_.adc_msg_lost += seq_diff;
+            link_stats_.adc_points_lost += points;
+            core_log_warning("Lost {} ADC messages ({} points)", seq_diff, points);
+        } else {
+            link_stats_.adc_points_overrun += points;
+        }
+    } else if (seq_diff != 0) {
+        link_stats_.adc_msg_lost += seq_diff;
+        core_log_warning("Lost {} ADC messages", seq_diff);
+    }
+
+    link.seq = adc_msg.seq + 1;
+    link.sample_index = adc_msg.sample_index + len;
+    return true;
+}
+
 void Device::send_loop() {
     core_log_info("Channel send thread started");
     const auto timeout = keep_alive_period_;
@@ -128,10 +271,7 @@ void Device::send_loop() {
                 ipp::AppMsgDacData dac_msg;
 
                 // Read next chunk from double buffer.
-                size_t max_count = std::min(
-                    _dac_msg_max_points_by_len(channel_.max_message_length()),
-                    dac_.mcu_requested_count.load() //
-                );
+                size_t max_count = std::min(dac_msg_max_points_.load(), dac_.mcu_requested_count.load());
 
                 size_t count = dac_.data.read_array_into(tmp, max_count);
                 dac_.mcu_requested_count -= count;
@@ -149,6 +289,7 @@ void Device::send_loop() {
                     tmp.clear();
 
                     // Send.
+                    dac_msg.seq = dac_.seq++;
                     core_assert(dac_msg.packed_size() <= channel_.max_message_length() - 1);
                     channel_.send(ipp::AppMsg{std::move(dac_msg)}, timeout).unwrap();
                     dac_.tmp_buf = std::move(tmp);
@@ -165,10 +306,99 @@ void Device::send_loop() {
         if (stats_reset_.exchange(false)) {
             channel_.send(ipp::AppMsg{ipp::AppMsgStatsReset{}}, timeout).unwrap();
         }
+        if (adc_decimation_update_.exchange(false)) {
+            uint32_t ratio = adc_decimation_.load();
+            if ((features_.load() & IPP_FEATURE_ADC_DECIMATION) != 0) {
+                core_log_debug("Send ADC decimation ratio: {}", ratio);
+                channel_.send(ipp::AppMsg{ipp::AppMsgAdcDecimation{uint16_t(ratio)}}, timeout).unwrap();
+            } else {
+                core_log_warning("ADC decimation is not supported by MCU, ratio {} is ignored", ratio);
+            }
+        }
+        if (dac_upsampling_update_.exchange(false)) {
+            uint32_t ratio = dac_upsampling_.load();
+            bool interpolate = dac_interpolation_.load();
+            if ((features_.load() & IPP_FEATURE_DAC_UPSAMPLING) != 0) {
+                core_log_debug("Send DAC upsampling ratio: {}, interpolation: {}", ratio, interpolate);
+                channel_.send(ipp::AppMsg{ipp::AppMsgDacUpsampling{uint16_t(ratio), uint8_t(interpolate)}}, timeout).unwrap();
+            } else {
+                core_log_warning("DAC upsampling is not supported by MCU, ratio {} is ignored", ratio);
+            }
+        }
+        if (calib_read_.exchange(false)) {
+            core_log_debug("Request calibration table");
+            channel_.send(ipp::AppMsg{ipp::AppMsgCalibRead{}}, timeout).unwrap();
+        }
+        if (calib_write_.exchange(false)) {
+            std::optional<Calib> calib = *calib_.lock();
+            if (calib.has_value()) {
+                ipp::AppMsgCalibWrite calib_msg;
+                for (size_t i = 0; i < ADC_COUNT; ++i) {
+                    calib_msg.gain[i] = calib->gain[i];
+                    calib_msg.offset[i] = calib->offset[i];
+                    calib_msg.filter[i] = uint16_t(calib->filter[i]);
+                }
+                core_log_debug("Send calibration table");
+                channel_.send(ipp::AppMsg{std::move(calib_msg)}, timeout).unwrap();
+            }
+        }
+        if (regulator_read_.exchange(false)) {
+            core_log_debug("Request regulator gains");
+            channel_.send(ipp::AppMsg{ipp::AppMsgRegulatorRead{}}, timeout).unwrap();
+        }
+        if (telemetry_ratio_update_.exchange(false)) {
+            uint32_t ratio = telemetry_ratio_.load();
+            if ((features_.load() & IPP_FEATURE_TELEMETRY) != 0) {
+                core_log_debug("Send telemetry ratio: {}", ratio);
+                channel_.send(ipp::AppMsg{ipp::AppMsgTelemetry{uint16_t(ratio)}}, timeout).unwrap();
+            } else {
+                core_log_warning("Telemetry is not supported by MCU, ratio {} is ignored", ratio);
+            }
+        }
+        if (regulator_write_.exchange(false)) {
+            std::optional<RegulatorGains> gains = *regulator_gains_.lock();
+            if ((features_.load() & IPP_FEATURE_REGULATOR) == 0) {
+                core_log_warning("Regulator gains are not supported by MCU, write is ignored");
+            } else if (gains.has_value()) {
+                core_log_debug("Send regulator gains");
+                channel_.send(
+                    ipp::AppMsg{ipp::AppMsgRegulatorWrite{
+                        gains->kp, gains->ki, gains->kd, gains->kp2, gains->ki2, gains->kd2, gains->ff_r, gains->ff_l}},
+                    timeout //
+                ).unwrap();
+            }
+        }
+        if (fault_limits_read_.exchange(false)) {
+            core_log_debug("Request fault limits");
+            channel_.send(ipp::AppMsg{ipp::AppMsgFaultLimitsRead{}}, timeout).unwrap();
+        }
+        if (fault_limits_write_.exchange(false)) {
+            std::optional<FaultLimits> limits = *fault_limits_.lock();
+            if (limits.has_value()) {
+                ipp::AppMsgFaultLimitsWrite limits_msg;
+                for (size_t i = 0; i < FAULT_CHECK_COUNT; ++i) {
+                    limits_msg.limit[i] = limits->limit[i];
+                    limits_msg.persistence[i] = uint32_t(limits->persistence[i]);
+                }
+                core_log_debug("Send fault limits");
+                channel_.send(ipp::AppMsg{std::move(limits_msg)}, timeout).unwrap();
+            }
+        }
+
+        flush_channel();
     }
 }
 
-Device::Device(std::unique_ptr<Channel> &&raw_channel, size_t max_msg_len) :
+void Device::flush_channel() {
+    if (batch_channel_ != nullptr) {
+        batch_channel_->flush().unwrap();
+    }
+}
+
+Device::Device(std::unique_ptr<Channel> &&raw_channel, size_t max_msg_len, uint32_t sample_freq_hz) :
+    dac_msg_max_points_(_dac_msg_max_points_by_len(max_msg_len)),
+    requested_sample_freq_hz_(sample_freq_hz),
+    batch_channel_(dynamic_cast<BatchChannel *>(raw_channel.get())),
     channel_(std::move(raw_channel), max_msg_len) //
 {
     done_.store(true);
@@ -301,6 +531,420 @@ void Device::reset_statistics() {
     send_ready_.notify_all();
 }
 
+const Device::LinkStats &Device::link_stats() const {
+    return link_stats_;
+}
+
+void Device::update_timing(const ipp::McuMsgTiming &timing_msg) {
+    if (timing_msg.stage >= TIMING_STAGE_COUNT || timing_msg.cycles_per_us == 0) {
+        core_log_warning(
+            "Wrong MCU timing message: stage {}, {} cycles per us",
+            uint32_t(timing_msg.stage),
+            timing_msg.cycles_per_us //
+        );
+        return;
+    }
+    const double us_per_cycle = 1.0 / double(timing_msg.cycles_per_us);
+
+    TimingStats stats;
+    stats.count = timing_msg.count;
+    stats.min_us = double(timing_msg.min) * us_per_cycle;
+    stats.max_us = double(timing_msg.max) * us_per_cycle;
+    if (timing_msg.count > 0) {
+        stats.mean_us = double(timing_msg.sum) / double(timing_msg.count) * us_per_cycle;
+    }
+    std::copy(timing_msg.hist.begin(), timing_msg.hist.end(), stats.hist.begin());
+
+    (*timing_stats_.lock())[timing_msg.stage] = stats;
+}
+
+std::array<Device::TimingStats, TIMING_STAGE_COUNT> Device::timing_stats() {
+    return *timing_stats_.lock();
+}
+
+void Device::update_mcu_stats(const ipp::McuMsgStats &stats_msg) {
+    McuStats stats;
+    stats.clock_count = stats_msg.clock_count;
+    stats.sample_count = stats_msg.sample_count;
+    stats.max_intrs_per_sample = stats_msg.max_intrs_per_sample;
+    stats.crc_error_count = stats_msg.crc_error_count;
+    stats.dac_lost_empty = stats_msg.dac_lost_empty;
+    stats.dac_lost_full = stats_msg.dac_lost_full;
+    stats.dac_req_exceed = stats_msg.dac_req_exceed;
+    stats.adc_lost_full = stats_msg.adc_lost_full;
+    stats.dac_msg_lost = stats_msg.dac_msg_lost;
+    stats.dac_msg_dup = stats_msg.dac_msg_dup;
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        const uint32_t count = stats_msg.adc_count[i];
+        if (count == 0) {
+            // Min and max hold initial bounds when there were no samples.
+            continue;
+        }
+        stats.adc_last[i] = adc_code_to_volt(stats_msg.adc_last[i]);
+        stats.adc_min[i] = adc_code_to_volt(stats_msg.adc_min[i]);
+        stats.adc_max[i] = adc_code_to_volt(stats_msg.adc_max[i]);
+        stats.adc_mean[i] = adc_code_to_volt(point_t(stats_msg.adc_sum[i] / int64_t(count)));
+    }
+
+    *mcu_stats_.lock() = stats;
+}
+
+Device::McuStats Device::mcu_stats() {
+    return *mcu_stats_.lock();
+}
+
+void Device::update_fault(const ipp::McuMsgFault &fault_msg) {
+    core_log_warning(
+        "MCU fault {} at tick {} (ADC sample {}) with value {} (latency {} ticks, {} since MCU start)",
+        uint32_t(fault_msg.code),
+        fault_msg.tick,
+        fault_msg.sample_index,
+        fault_msg.value,
+        fault_msg.latency,
+        fault_msg.count //
+    );
+    if (fault_msg.lost_count != 0) {
+        core_log_warning("Reports of {} MCU faults were lost", fault_msg.lost_count);
+    }
+    *fault_report_.lock() = FaultReport{
+        fault_msg.code,
+        int64_t(fault_msg.tick),
+        int64_t(fault_msg.sample_index),
+        fault_msg.value,
+        fault_msg.latency,
+        fault_msg.count,
+        fault_msg.lost_count,
+    };
+}
+
+Device::FaultReport Device::fault_report() {
+    return *fault_report_.lock();
+}
+
+void Device::update_postmortem(const ipp::McuMsgPostmortem &postmortem_msg) {
+    auto &upload = postmortem_upload_;
+    if (postmortem_msg.offset == 0) {
+        // Upload is started over on each connection.
+        upload.fault_count = postmortem_msg.fault_count;
+        for (auto &values : upload.values) {
+            values.clear();
+            values.reserve(postmortem_msg.size);
+        }
+    } else if (
+        postmortem_msg.fault_count != upload.fault_count ||
+        postmortem_msg.offset != upload.values[POSTMORTEM_REF].size() //
+    ) {
+        core_log_warning(
+            "Unexpected post-mortem chunk of fault {} at {}, expected fault {} at {}",
+            postmortem_msg.fault_count,
+            postmortem_msg.offset,
+            upload.fault_count,
+            upload.values[POSTMORTEM_REF].size() //
+        );
+        return;
+    }
+
+    for (const auto &point : postmortem_msg.points) {
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            upload.values[POSTMORTEM_AIN0 + i].push_back(adc_code_to_volt(point[POSTMORTEM_AIN0 + i]));
+        }
+        for (size_t i = POSTMORTEM_AIN0 + ADC_COUNT; i < POSTMORTEM_COUNT; ++i) {
+            upload.values[i].push_back(double(point[i]));
+        }
+    }
+    if (upload.values[POSTMORTEM_REF].size() < postmortem_msg.size) {
+        return;
+    }
+
+    core_log_info(
+        "Post-mortem buffer of MCU fault {} received ({} ticks)",
+        upload.fault_count,
+        upload.values[POSTMORTEM_REF].size() //
+    );
+    if (postmortem_msg.lost_count != 0) {
+        core_log_warning("Post-mortem buffer missed {} MCU faults", postmortem_msg.lost_count);
+    }
+    *postmortem_.lock() = upload;
+    for (const auto &notify : postmortem_notify_) {
+        if (notify) {
+            notify();
+        }
+    }
+}
+
+uint32_t Device::postmortem_fault_count() {
+    return postmortem_.lock()->fault_count;
+}
+
+void Device::set_postmortem_callback(size_t index, std::function<void()> &&callback) {
+    core_assert(index < POSTMORTEM_COUNT);
+    postmortem_notify_[index] = std::move(callback);
+}
+
+std::vector<double> Device::read_postmortem(size_t index) {
+    core_assert(index < POSTMORTEM_COUNT);
+    return postmortem_.lock()->values[index];
+}
+
+void Device::set_adc_decimation(uint32_t ratio) {
+    if (ratio < 1 || ratio > ADC_DECIMATION_MAX) {
+        core_log_warning("ADC decimation ratio {} is out of range [1, {}]", ratio, ADC_DECIMATION_MAX);
+        return;
+    }
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        adc_decimation_.store(ratio);
+        adc_decimation_update_.store(true);
+    }
+    send_ready_.notify_all();
+}
+
+void Device::set_dac_upsampling(uint32_t ratio) {
+    if (ratio < 1 || ratio > DAC_UPSAMPLING_MAX) {
+        core_log_warning("DAC upsampling ratio {} is out of range [1, {}]", ratio, DAC_UPSAMPLING_MAX);
+        return;
+    }
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        dac_upsampling_.store(ratio);
+        dac_upsampling_update_.store(true);
+    }
+    send_ready_.notify_all();
+}
+
+void Device::set_dac_interpolation(bool enable) {
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        dac_interpolation_.store(enable);
+        dac_upsampling_update_.store(true);
+    }
+    send_ready_.notify_all();
+}
+
+void Device::update_calib(const ipp::McuMsgCalib &calib_msg) {
+    Calib calib;
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        calib.gain[i] = calib_msg.gain[i];
+        calib.offset[i] = calib_msg.offset[i];
+        calib.filter[i] = calib_msg.filter[i];
+    }
+    *calib_.lock() = calib;
+}
+
+std::optional<Device::Calib> Device::calib() {
+    return *calib_.lock();
+}
+
+void Device::write_calib(CalibField field, std::span<const double> values) {
+    if (values.size() != ADC_COUNT) {
+        core_log_warning("Calibration field must have {} elements, got {}", ADC_COUNT, values.size());
+        return;
+    }
+    const bool is_filter = field == &Calib::filter;
+    const double min = is_filter ? 0.0 : double(std::numeric_limits<int32_t>::min());
+    const double max = is_filter ? double(std::numeric_limits<uint16_t>::max()) : double(std::numeric_limits<int32_t>::max());
+    for (double value : values) {
+        if (!(value >= min && value <= max)) {
+            core_log_warning("Calibration value {} is out of range [{}, {}]", value, min, max);
+            return;
+        }
+    }
+    {
+        auto calib = calib_.lock();
+        if (!calib->has_value()) {
+            core_log_warning("Calibration table is not read from MCU yet, write is ignored");
+            return;
+        }
+        // Table is modified in place, so that subsequent writes are not lost before MCU replies.
+        auto &array = (**calib).*field;
+        std::transform(values.begin(), values.end(), array.begin(), [](double value) {
+            return int32_t(std::llround(value));
+        });
+    }
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        calib_write_.store(true);
+    }
+    send_ready_.notify_all();
+}
+
+void Device::update_regulator_gains(const ipp::McuMsgRegulator &regulator_msg) {
+    *regulator_gains_.lock() = RegulatorGains{
+        regulator_msg.kp,
+        regulator_msg.ki,
+        regulator_msg.kd,
+        regulator_msg.kp2,
+        regulator_msg.ki2,
+        regulator_msg.kd2,
+        regulator_msg.ff_r,
+        regulator_msg.ff_l,
+    };
+}
+
+std::optional<Device::RegulatorGains> Device::regulator_gains() {
+    return *regulator_gains_.lock();
+}
+
+void Device::write_regulator_gains(std::span<const double> values) {
+    if (values.size() != REGULATOR_GAINS_ORDER.size()) {
+        core_log_warning("Regulator gains must have {} elements, got {}", REGULATOR_GAINS_ORDER.size(), values.size());
+        return;
+    }
+    RegulatorGains gains;
+    for (size_t i = 0; i < values.size(); ++i) {
+        const double value = values[i];
+        if (!(value >= double(std::numeric_limits<int32_t>::min()) && value <= double(std::numeric_limits<int32_t>::max()))) {
+            core_log_warning("Regulator gain {} is out of range", value);
+            return;
+        }
+        gains.*REGULATOR_GAINS_ORDER[i] = int32_t(std::llround(value));
+    }
+    // Stored before MCU replies, so that the records show what is going to be applied.
+    *regulator_gains_.lock() = gains;
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        regulator_write_.store(true);
+    }
+    send_ready_.notify_all();
+}
+
+void Device::update_fault_limits(const ipp::McuMsgFaultLimits &limits_msg) {
+    FaultLimits limits;
+    for (size_t i = 0; i < FAULT_CHECK_COUNT; ++i) {
+        limits.limit[i] = limits_msg.limit[i];
+        limits.persistence[i] = int32_t(limits_msg.persistence[i]);
+    }
+    *fault_limits_.lock() = limits;
+}
+
+std::optional<Device::FaultLimits> Device::fault_limits() {
+    return *fault_limits_.lock();
+}
+
+void Device::write_fault_limits(FaultLimitsField field, std::span<const double> values) {
+    if (values.size() != FAULT_CHECK_COUNT) {
+        core_log_warning("Fault limits field must have {} elements, got {}", FAULT_CHECK_COUNT, values.size());
+        return;
+    }
+    // MCU compares absolute values, and persistence is a number of ticks, so neither can be negative.
+    const double max = double(std::numeric_limits<int32_t>::max());
+    for (double value : values) {
+        if (!(value >= 0.0 && value <= max)) {
+            core_log_warning("Fault limit value {} is out of range [0, {}]", value, max);
+            return;
+        }
+    }
+    {
+        auto limits = fault_limits_.lock();
+        if (!limits->has_value()) {
+            core_log_warning("Fault limits are not read from MCU yet, write is ignored");
+            return;
+        }
+        // Limits are modified in place, so that subsequent writes are not lost before MCU replies.
+        auto &array = (**limits).*field;
+        std::transform(values.begin(), values.end(), array.begin(), [](double value) {
+            return int32_t(std::llround(value));
+        });
+    }
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        fault_limits_write_.store(true);
+    }
+    send_ready_.notify_all();
+}
+
+void Device::update_telemetry(const ipp::McuMsgTelemetry &telemetry_msg) {
+    if (telemetry_msg.point_index > telemetry_index_) {
+        uint64_t points = telemetry_msg.point_index - telemetry_index_;
+        link_stats_.telemetry_points_lost += points;
+        core_log_warning("Lost {} telemetry points", points);
+    }
+    const auto &points = telemetry_msg.points;
+    telemetry_index_ = telemetry_msg.point_index + points.size();
+
+    for (size_t i = 0; i < TELEMETRY_COUNT; ++i) {
+        auto &entry = telemetry_[i];
+        if (entry.max_size == 0) {
+            // There is no record for this value.
+            continue;
+        }
+
+        Vec<double> tmp = std::move(entry.tmp_buf);
+        std::transform(points.begin(), points.end(), std::back_inserter(tmp), [&](const auto &values) {
+            return double(values[i]);
+        });
+
+        auto data_guard = entry.data.lock();
+        core_assert(data_guard->write_array_exact(tmp));
+        tmp.clear();
+        entry.tmp_buf = std::move(tmp);
+
+        if (data_guard->size() >= entry.max_size && !entry.ioc_notified.load()) {
+            core_assert(entry.notify);
+            entry.ioc_notified.store(true);
+            entry.notify();
+        }
+    }
+}
+
+void Device::set_telemetry_ratio(uint32_t ratio) {
+    if (ratio > TELEMETRY_RATIO_MAX) {
+        core_log_warning("Telemetry ratio {} is out of range [0, {}]", ratio, TELEMETRY_RATIO_MAX);
+        return;
+    }
+    telemetry_ratio_.store(ratio);
+    {
+        // Note: `send_mutex_` must be locked even if atomic is used. See `std::condition_variable` reference.
+        std::lock_guard send_guard(send_mutex_);
+        telemetry_ratio_update_.store(true);
+    }
+    send_ready_.notify_all();
+}
+
+void Device::init_telemetry(size_t index, size_t max_size) {
+    core_assert(index < TELEMETRY_COUNT);
+    telemetry_[index].max_size = max_size;
+}
+
+void Device::set_telemetry_callback(size_t index, std::function<void()> &&callback) {
+    core_assert(index < TELEMETRY_COUNT);
+    telemetry_[index].notify = std::move(callback);
+}
+
+std::vector<double> Device::read_telemetry(size_t index) {
+    auto &entry = telemetry_[index];
+
+    Vec<double> data;
+    size_t skipped_count = 0;
+    {
+        auto data_guard = entry.data.lock();
+        while (data_guard->size() >= 2 * entry.max_size) {
+            data_guard->skip_front(entry.max_size);
+            skipped_count += 1;
+        }
+
+        data.reserve(entry.max_size);
+        core_assert_eq(data.write_array_from(*data_guard, entry.max_size), entry.max_size);
+    }
+    entry.ioc_notified.store(false);
+
+    if (skipped_count) {
+        core_log_warning("Skipped {} telemetry{} waveforms", skipped_count, index);
+    }
+
+    return data;
+}
+
+uint32_t Device::sample_freq_hz() const {
+    return sample_freq_hz_.load();
+}
+
 point_t Device::dac_volt_to_code(double volt) const {
     return DAC_CODE_SHIFT + point_t((volt * 1e6) / DAC_STEP_UV);
 }
@@ -7,6 +7,7 @@
 #include <condition_variable>
 #include <thread>
 #include <functional>
+#include <optional>
 
 #include <core/mutex.hpp>
 #include <core/collections/vec_deque.hpp>
@@ -16,6 +17,7 @@
 #include <channel/message.hpp>
 
 #include "double_buffer.hpp"
+#include "batch_channel.hpp"
 
 using DeviceChannel = MessageChannel<ipp::AppMsg, ipp::McuMsg>;
 
@@ -31,6 +33,122 @@ public:
         Cyclic,
     };
 
+    /// Link quality counters. Counted since IOC start.
+    struct LinkStats {
+        /// ADC messages lost in transport (gaps in sequence numbers).
+        std::atomic<uint64_t> adc_msg_lost{0};
+        /// Duplicated or reordered ADC messages, they are discarded.
+        std::atomic<uint64_t> adc_msg_dup{0};
+        /// ADC points lost along with lost messages.
+        std::atomic<uint64_t> adc_points_lost{0};
+        /// ADC points lost on MCU buffer overrun (gaps in sample index without lost messages).
+        std::atomic<uint64_t> adc_points_overrun{0};
+        /// Telemetry points lost on MCU buffer overrun (gaps in point index).
+        std::atomic<uint64_t> telemetry_points_lost{0};
+    };
+
+    /// MCU statistics since the last reset, updated every `STATS_MSG_PERIOD_MS`.
+    struct McuStats {
+        uint64_t clock_count = 0;
+        uint64_t sample_count = 0;
+        uint64_t max_intrs_per_sample = 0;
+        uint64_t crc_error_count = 0;
+        uint64_t dac_lost_empty = 0;
+        uint64_t dac_lost_full = 0;
+        uint64_t dac_req_exceed = 0;
+        uint64_t adc_lost_full = 0;
+        uint64_t dac_msg_lost = 0;
+        uint64_t dac_msg_dup = 0;
+        /// Per-channel ADC values in volts. Zero if there were no samples.
+        std::array<double, ADC_COUNT> adc_last = {};
+        std::array<double, ADC_COUNT> adc_min = {};
+        std::array<double, ADC_COUNT> adc_max = {};
+        std::array<double, ADC_COUNT> adc_mean = {};
+    };
+
+    /// Durations of MCU task stage over the last `TIMING_REPORT_PERIOD_MS`.
+    struct TimingStats {
+        uint32_t count = 0;
+        double min_us = 0.0;
+        double mean_us = 0.0;
+        double max_us = 0.0;
+        /// Logarithmic histogram, see `TIMING_HIST_BINS`.
+        std::array<uint32_t, TIMING_HIST_BINS> hist = {};
+    };
+
+    /// Calibration table of MCU measurement channels, one element per ADC channel. See `McuMsgCalib`.
+    struct Calib {
+        std::array<int32_t, ADC_COUNT> gain = {};
+        std::array<int32_t, ADC_COUNT> offset = {};
+        std::array<int32_t, ADC_COUNT> filter = {};
+    };
+    using CalibField = std::array<int32_t, ADC_COUNT> Calib::*;
+
+    /// Gains of MCU current regulator. See `McuMsgRegulator`.
+    struct RegulatorGains {
+        int32_t kp = 0;
+        int32_t ki = 0;
+        int32_t kd = 0;
+        int32_t kp2 = 0;
+        int32_t ki2 = 0;
+        int32_t kd2 = 0;
+        int32_t ff_r = 0;
+        int32_t ff_l = 0;
+    };
+    /// Order of gains in `regulator_gains` records.
+    static constexpr std::array<int32_t RegulatorGains::*, 8> REGULATOR_GAINS_ORDER = {
+        &RegulatorGains::kp,
+        &RegulatorGains::ki,
+        &RegulatorGains::kd,
+        &RegulatorGains::kp2,
+        &RegulatorGains::ki2,
+        &RegulatorGains::kd2,
+        &RegulatorGains::ff_r,
+        &RegulatorGains::ff_l,
+    };
+
+    /// Thresholds of MCU fault checks, one element per `FAULT_CHECK_*`. See `McuMsgFaultLimits`.
+    struct FaultLimits {
+        std::array<int32_t, FAULT_CHECK_COUNT> limit = {};
+        std::array<int32_t, FAULT_CHECK_COUNT> persistence = {};
+    };
+    using FaultLimitsField = std::array<int32_t, FAULT_CHECK_COUNT> FaultLimits::*;
+
+    /// The first fault of the last fault episode reported by MCU. See `McuMsgFault`.
+    struct FaultReport {
+        /// `FAULT_*` code, zero if no fault was reported since IOC start.
+        int64_t code = 0;
+        int64_t tick = 0;
+        /// Sample index of the ADC point that contains the trip.
+        int64_t sample_index = 0;
+        int64_t value = 0;
+        int64_t latency = 0;
+        int64_t count = 0;
+        int64_t lost_count = 0;
+    };
+
+    /// Post-mortem buffer uploaded by MCU after fault. See `McuMsgPostmortem`.
+    struct Postmortem {
+        /// Fault count of `FaultReport` the buffer was frozen at, zero if nothing was uploaded since IOC start.
+        uint32_t fault_count = 0;
+        /// Waveforms indexed by `POSTMORTEM_*`, one point per MCU sync tick. ADC channels are in volts.
+        std::array<std::vector<double>, POSTMORTEM_COUNT> values;
+    };
+
+    /// Parameters reported by MCU on connection.
+    struct Capabilities {
+        uint16_t version = 0;
+        /// Maximum length of message MCU is able to receive.
+        size_t max_msg_len = 0;
+        size_t dac_buffer_size = 0;
+        size_t adc_buffer_size = 0;
+        size_t dac_msg_max_points = 0;
+        size_t adc_msg_max_points = 0;
+        uint32_t sample_freq_hz = 0;
+        /// Features enabled for the connection, see `IPP_FEATURE_*`.
+        uint32_t features = 0;
+    };
+
 private:
     struct DinEntry {
         std::atomic<uint8_t> value;
@@ -42,6 +160,12 @@ private:
         std::atomic<bool> update{false};
     };
 
+    /// Expected values of next ADC message. Accessed only from receiving thread.
+    struct AdcLink {
+        std::optional<uint32_t> seq;
+        uint64_t sample_index = 0;
+    };
+
     struct AdcEntry {
         core::Mutex<core::VecDeque<double>> data;
         core::Vec<double> tmp_buf;
@@ -52,11 +176,23 @@ private:
         std::atomic<bool> ioc_notified{false};
     };
 
+    /// Waveform of one `TELEMETRY_*` value, filled in chunks of `max_size` like ADC waveforms.
+    struct TelemetryEntry {
+        core::Mutex<core::VecDeque<double>> data;
+        core::Vec<double> tmp_buf;
+
+        size_t max_size = 0;
+        std::function<void()> notify;
+        std::atomic<bool> ioc_notified{false};
+    };
+
     struct DacEntry {
         DoubleBuffer<double> data;
         core::Vec<double> tmp_buf;
 
         std::atomic<size_t> mcu_requested_count{0};
+        /// Sequence number of the next DAC message. Accessed only from sending thread.
+        uint32_t seq = 0;
 
         std::function<void()> sync_ioc_request_flag;
         std::atomic<bool> ioc_requested{false};
@@ -74,14 +210,75 @@ private:
     DinEntry din_;
     DoutEntry dout_;
     std::array<AdcEntry, ADC_COUNT> adcs_;
+    AdcLink adc_link_;
+    /// Features enabled for current connection.
+    std::atomic<uint32_t> features_{0};
+    /// Maximum number of points in DAC message negotiated with MCU.
+    std::atomic<size_t> dac_msg_max_points_;
+    /// Sample frequency requested on connection.
+    const uint32_t requested_sample_freq_hz_;
+    /// Actual sample frequency reported by MCU, zero until connected.
+    std::atomic<uint32_t> sample_freq_hz_{0};
     DacEntry dac_;
+    LinkStats link_stats_;
     std::atomic<bool> stats_reset_{false};
+    /// ADC decimation ratio set by IOC, sent on change and on each connection.
+    std::atomic<uint32_t> adc_decimation_{1};
+    std::atomic<bool> adc_decimation_update_{false};
+    /// DAC upsampling ratio and reference interpolation set by IOC, sent on change and on each connection.
+    std::atomic<uint32_t> dac_upsampling_{1};
+    std::atomic<bool> dac_interpolation_{false};
+    std::atomic<bool> dac_upsampling_update_{false};
+    /// Calibration table reported by MCU with pending changes applied, empty until read on connection.
+    core::Mutex<std::optional<Calib>> calib_;
+    std::atomic<bool> calib_read_{false};
+    std::atomic<bool> calib_write_{false};
+    /// Regulator gains reported by MCU or written by IOC, empty until read on connection.
+    core::Mutex<std::optional<RegulatorGains>> regulator_gains_;
+    std::atomic<bool> regulator_read_{false};
+    std::atomic<bool> regulator_write_{false};
+    /// Fault limits reported by MCU with pending changes applied, empty until read on connection.
+    core::Mutex<std::optional<FaultLimits>> fault_limits_;
+    std::atomic<bool> fault_limits_read_{false};
+    std::atomic<bool> fault_limits_write_{false};
+    std::array<TelemetryEntry, TELEMETRY_COUNT> telemetry_;
+    /// Expected index of the next telemetry point. Accessed only from receiving thread.
+    uint64_t telemetry_index_ = 0;
+    /// Telemetry ratio set by IOC, sent on change and on each connection.
+    std::atomic<uint32_t> telemetry_ratio_{0};
+    std::atomic<bool> telemetry_ratio_update_{false};
+    core::Mutex<McuStats> mcu_stats_;
+    core::Mutex<FaultReport> fault_report_;
+    /// Post-mortem buffer being uploaded. Accessed only from receiving thread.
+    Postmortem postmortem_upload_;
+    /// The last post-mortem buffer uploaded completely.
+    core::Mutex<Postmortem> postmortem_;
+    std::array<std::function<void()>, POSTMORTEM_COUNT> postmortem_notify_;
+    /// Indexed by `TIMING_*` stage.
+    core::Mutex<std::array<TimingStats, TIMING_STAGE_COUNT>> timing_stats_;
 
+    /// Set if underlying channel defers sending until flushed.
+    /// NOTE: Must be declared before `channel_` to be initialized before the channel is moved into it.
+    BatchChannel *batch_channel_ = nullptr;
     DeviceChannel channel_;
 
 private:
     void recv_loop();
     void send_loop();
+    /// Check MCU capabilities and derive connection parameters from them.
+    void negotiate(const ipp::McuMsgCapabilities &caps_msg);
+    /// Check ADC message sequence number and sample index, update link statistics.
+    /// @return `false` if message is duplicated and must be discarded.
+    bool check_adc_link(const ipp::McuMsgAdcData &adc_msg);
+    void update_timing(const ipp::McuMsgTiming &timing_msg);
+    void update_mcu_stats(const ipp::McuMsgStats &stats_msg);
+    void update_calib(const ipp::McuMsgCalib &calib_msg);
+    void update_regulator_gains(const ipp::McuMsgRegulator &regulator_msg);
+    void update_telemetry(const ipp::McuMsgTelemetry &telemetry_msg);
+    void update_fault(const ipp::McuMsgFault &fault_msg);
+    void update_fault_limits(const ipp::McuMsgFaultLimits &limits_msg);
+    void update_postmortem(const ipp::McuMsgPostmortem &postmortem_msg);
+    void flush_channel();
 
 public:
     Device(const Device &dev) = delete;
@@ -89,7 +286,7 @@ public:
     Device(Device &&dev) = delete;
     Device &operator=(Device &&dev) = delete;
 
-    explicit Device(std::unique_ptr<Channel> &&channel, size_t max_msg_len);
+    explicit Device(std::unique_ptr<Channel> &&channel, size_t max_msg_len, uint32_t sample_freq_hz);
     ~Device();
 
     void start();
@@ -117,6 +314,48 @@ public:
 
     void reset_statistics();
 
+    [[nodiscard]] const LinkStats &link_stats() const;
+    [[nodiscard]] std::array<TimingStats, TIMING_STAGE_COUNT> timing_stats();
+    [[nodiscard]] McuStats mcu_stats();
+    [[nodiscard]] FaultReport fault_report();
+    [[nodiscard]] uint32_t sample_freq_hz() const;
+
+    /// Average ADC points over `ratio` samples on MCU. ADC waveforms get `ratio` times less points.
+    void set_adc_decimation(uint32_t ratio);
+
+    /// Hold each DAC point for `ratio` samples on MCU, so DAC waveform is played `ratio` times slower.
+    void set_dac_upsampling(uint32_t ratio);
+    /// Interpolate MCU regulator reference between DAC points instead of holding it.
+    void set_dac_interpolation(bool enable);
+
+    /// Calibration table of MCU, empty if it is not known yet.
+    [[nodiscard]] std::optional<Calib> calib();
+    /// Replace one field of all calibration entries. The whole table is written to MCU at once.
+    void write_calib(CalibField field, std::span<const double> values);
+
+    /// Regulator gains of MCU, empty if they are not known yet.
+    [[nodiscard]] std::optional<RegulatorGains> regulator_gains();
+    /// Replace all regulator gains, `values` are in `REGULATOR_GAINS_ORDER`. MCU switches to them at once.
+    void write_regulator_gains(std::span<const double> values);
+
+    /// Fault limits of MCU, empty if they are not known yet.
+    [[nodiscard]] std::optional<FaultLimits> fault_limits();
+    /// Replace one field of all fault checks. All limits are written to MCU at once.
+    void write_fault_limits(FaultLimitsField field, std::span<const double> values);
+
+    /// Stream regulator values of every `ratio`-th MCU sync tick, zero stops the stream.
+    void set_telemetry_ratio(uint32_t ratio);
+    void init_telemetry(size_t index, size_t max_size);
+    void set_telemetry_callback(size_t index, std::function<void()> &&callback);
+    /// Read waveform of `TELEMETRY_*` value.
+    std::vector<double> read_telemetry(size_t index);
+
+    /// Fault count of the last uploaded post-mortem buffer.
+    [[nodiscard]] uint32_t postmortem_fault_count();
+    void set_postmortem_callback(size_t index, std::function<void()> &&callback);
+    /// Read waveform of `POSTMORTEM_*` value of the last uploaded post-mortem buffer.
+    std::vector<double> read_postmortem(size_t index);
+
 private:
     point_t dac_volt_to_code(double volt) const;
     double adc_code_to_volt(point_t code) const;
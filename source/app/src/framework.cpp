@@ -1,7 +1,10 @@
 #include <framework.hpp>
 
+#include <charconv>
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <memory>
 
@@ -15,15 +18,194 @@
 
 using namespace core;
 
+/// Environment variable with sample frequency requested from MCU.
+#define SAMPLE_FREQ_ENV "TORNADO_SAMPLE_FREQ_HZ"
+
+static uint32_t requested_sample_freq_hz() {
+    const char *value = std::getenv(SAMPLE_FREQ_ENV);
+    if (value == nullptr) {
+        return SAMPLE_FREQ_HZ;
+    }
+    std::string_view str(value);
+    uint32_t freq_hz = 0;
+    auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), freq_hz);
+    if (ec != std::errc() || end != str.data() + str.size()) {
+        core_panic("Invalid {} value: {}", SAMPLE_FREQ_ENV, value);
+    }
+    return freq_hz;
+}
+
 void init_device(MaybeUninit<Device> &mem) {
     core_log_info("LazyStatic: Device::init()");
-    mem.init_in_place(make_device_channel(), max_message_length());
+    mem.init_in_place(make_device_channel(), max_message_length(), requested_sample_freq_hz());
 }
 
 /// We use LazyStatic to initialize global Device without global constructor.
 /// NOTE: Must subject to [constant initialization](https://en.cppreference.com/w/cpp/language/constant_initialization).
 LazyStatic<Device, init_device> DEVICE = {};
 
+static const std::atomic<uint64_t> Device::LinkStats::*link_stats_counter(std::string_view name) {
+    if (name == "link_adc_msg_lost") {
+        return &Device::LinkStats::adc_msg_lost;
+    } else if (name == "link_adc_msg_dup") {
+        return &Device::LinkStats::adc_msg_dup;
+    } else if (name == "link_adc_points_lost") {
+        return &Device::LinkStats::adc_points_lost;
+    } else if (name == "link_adc_points_overrun") {
+        return &Device::LinkStats::adc_points_overrun;
+    } else if (name == "link_telemetry_points_lost") {
+        return &Device::LinkStats::telemetry_points_lost;
+    } else {
+        core_log_fatal("Unexpected link statistics record: {}", name);
+        core_unimplemented();
+    }
+}
+
+static uint64_t Device::McuStats::*mcu_stats_counter(std::string_view name) {
+    if (name == "mcu_clock_count") {
+        return &Device::McuStats::clock_count;
+    } else if (name == "mcu_sample_count") {
+        return &Device::McuStats::sample_count;
+    } else if (name == "mcu_max_intrs_per_sample") {
+        return &Device::McuStats::max_intrs_per_sample;
+    } else if (name == "mcu_crc_error_count") {
+        return &Device::McuStats::crc_error_count;
+    } else if (name == "mcu_dac_lost_empty") {
+        return &Device::McuStats::dac_lost_empty;
+    } else if (name == "mcu_dac_lost_full") {
+        return &Device::McuStats::dac_lost_full;
+    } else if (name == "mcu_dac_req_exceed") {
+        return &Device::McuStats::dac_req_exceed;
+    } else if (name == "mcu_adc_lost_full") {
+        return &Device::McuStats::adc_lost_full;
+    } else if (name == "mcu_dac_msg_lost") {
+        return &Device::McuStats::dac_msg_lost;
+    } else if (name == "mcu_dac_msg_dup") {
+        return &Device::McuStats::dac_msg_dup;
+    } else {
+        core_log_fatal("Unexpected MCU statistics record: {}", name);
+        core_unimplemented();
+    }
+}
+
+static int64_t Device::FaultReport::*fault_report_field(std::string_view name) {
+    if (name == "fault_code") {
+        return &Device::FaultReport::code;
+    } else if (name == "fault_tick") {
+        return &Device::FaultReport::tick;
+    } else if (name == "fault_sample_index") {
+        return &Device::FaultReport::sample_index;
+    } else if (name == "fault_value") {
+        return &Device::FaultReport::value;
+    } else if (name == "fault_latency") {
+        return &Device::FaultReport::latency;
+    } else if (name == "fault_count") {
+        return &Device::FaultReport::count;
+    } else if (name == "fault_lost_count") {
+        return &Device::FaultReport::lost_count;
+    } else {
+        core_log_fatal("Unexpected fault report record: {}", name);
+        core_unimplemented();
+    }
+}
+
+static std::array<double, ADC_COUNT> Device::McuStats::*mcu_adc_stats_values(std::string_view name) {
+    if (name == "mcu_adc_last") {
+        return &Device::McuStats::adc_last;
+    } else if (name == "mcu_adc_min") {
+        return &Device::McuStats::adc_min;
+    } else if (name == "mcu_adc_max") {
+        return &Device::McuStats::adc_max;
+    } else if (name == "mcu_adc_mean") {
+        return &Device::McuStats::adc_mean;
+    } else {
+        core_log_fatal("Unexpected MCU ADC statistics record: {}", name);
+        core_unimplemented();
+    }
+}
+
+static const double Device::TimingStats::*timing_stats_value(std::string_view name) {
+    if (name == "timing_min_us") {
+        return &Device::TimingStats::min_us;
+    } else if (name == "timing_mean_us") {
+        return &Device::TimingStats::mean_us;
+    } else if (name == "timing_max_us") {
+        return &Device::TimingStats::max_us;
+    } else {
+        core_log_fatal("Unexpected timing statistics record: {}", name);
+        core_unimplemented();
+    }
+}
+
+/// Field of fault limits record, `_set` suffix of output record is ignored.
+static Device::FaultLimitsField fault_limits_field(std::string_view name) {
+    if (name.rfind("fault_limit", 0) == 0) {
+        return &Device::FaultLimits::limit;
+    } else if (name.rfind("fault_persistence", 0) == 0) {
+        return &Device::FaultLimits::persistence;
+    } else {
+        core_log_fatal("Unexpected fault limits record: {}", name);
+        core_unimplemented();
+    }
+}
+
+/// Field of calibration record, `_set` suffix of output record is ignored.
+static Device::CalibField calib_field(std::string_view name) {
+    if (name.rfind("calib_gain", 0) == 0) {
+        return &Device::Calib::gain;
+    } else if (name.rfind("calib_offset", 0) == 0) {
+        return &Device::Calib::offset;
+    } else if (name.rfind("calib_filter", 0) == 0) {
+        return &Device::Calib::filter;
+    } else {
+        core_log_fatal("Unexpected calibration record: {}", name);
+        core_unimplemented();
+    }
+}
+
+/// Index of telemetry waveform record, see `TELEMETRY_*`.
+static size_t telemetry_index(std::string_view name) {
+    if (name == "telemetry_ref") {
+        return TELEMETRY_REF;
+    } else if (name == "telemetry_iout") {
+        return TELEMETRY_IOUT;
+    } else if (name == "telemetry_vout") {
+        return TELEMETRY_VOUT;
+    } else if (name == "telemetry_fb") {
+        return TELEMETRY_FB;
+    } else if (name == "telemetry_sum") {
+        return TELEMETRY_SUM;
+    } else {
+        core_log_fatal("Unexpected telemetry record: {}", name);
+        core_unimplemented();
+    }
+}
+
+/// Index of post-mortem waveform record, see `POSTMORTEM_*`.
+static size_t postmortem_index(std::string_view name) {
+    if (name == "postmortem_ain0") {
+        return POSTMORTEM_AIN0 + 0;
+    } else if (name == "postmortem_ain1") {
+        return POSTMORTEM_AIN0 + 1;
+    } else if (name == "postmortem_ain2") {
+        return POSTMORTEM_AIN0 + 2;
+    } else if (name == "postmortem_ain3") {
+        return POSTMORTEM_AIN0 + 3;
+    } else if (name == "postmortem_ain4") {
+        return POSTMORTEM_AIN0 + 4;
+    } else if (name == "postmortem_ain5") {
+        return POSTMORTEM_AIN0 + 5;
+    } else if (name == "postmortem_ref") {
+        return POSTMORTEM_REF;
+    } else if (name == "postmortem_fb") {
+        return POSTMORTEM_FB;
+    } else if (name == "postmortem_din") {
+        return POSTMORTEM_DIN;
+    } else {
+        core_log_fatal("Unexpected post-mortem record: {}", name);
+        core_unimplemented();
+    }
+}
 
 void framework_init() {
     // Explicitly initialize device.
@@ -78,6 +260,86 @@ void framework_record_init(Record &record) {
         core::downcast<OutputValueRecord<bool>>(record).unwrap().get().set_handler( //
             std::make_unique<StatsResetHandler>(*DEVICE));
 
+    } else if (name == "adc_decimation") {
+        core::downcast<OutputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<AdcDecimationHandler>(*DEVICE));
+
+    } else if (name == "dac_upsampling") {
+        core::downcast<OutputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<DacUpsamplingHandler>(*DEVICE));
+
+    } else if (name == "dac_interpolation") {
+        core::downcast<OutputValueRecord<bool>>(record).unwrap().get().set_handler( //
+            std::make_unique<DacInterpolationHandler>(*DEVICE));
+
+    } else if (name == "calib_gain_set" || name == "calib_offset_set" || name == "calib_filter_set") {
+        core::downcast<OutputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<CalibWriteHandler>(*DEVICE, calib_field(name)));
+
+    } else if (name == "calib_gain" || name == "calib_offset" || name == "calib_filter") {
+        core::downcast<InputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<CalibReadHandler>(*DEVICE, calib_field(name)));
+
+    } else if (name == "regulator_gains_set") {
+        core::downcast<OutputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<RegulatorGainsWriteHandler>(*DEVICE));
+
+    } else if (name == "regulator_gains") {
+        core::downcast<InputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<RegulatorGainsReadHandler>(*DEVICE));
+
+    } else if (name == "telemetry_ratio") {
+        core::downcast<OutputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<TelemetryRatioHandler>(*DEVICE));
+
+    } else if (name.rfind("telemetry_", 0) == 0) { // name.startswith("telemetry_")
+        auto &current_record = core::downcast<InputArrayRecord<double>>(record).unwrap().get();
+        current_record.set_handler(std::make_unique<TelemetryWfHandler>(*DEVICE, current_record, telemetry_index(name)));
+
+    } else if (name == "sample_freq_hz") {
+        core::downcast<InputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<SampleFreqHandler>(*DEVICE));
+
+    } else if (name.rfind("link_", 0) == 0) { // name.startswith("link_")
+        core::downcast<InputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<LinkStatsHandler>(*DEVICE, link_stats_counter(name)));
+
+    } else if (name == "mcu_adc_last" || name == "mcu_adc_min" || name == "mcu_adc_max" || name == "mcu_adc_mean") {
+        core::downcast<InputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<McuAdcStatsHandler>(*DEVICE, mcu_adc_stats_values(name)));
+
+    } else if (name.rfind("mcu_", 0) == 0) { // name.startswith("mcu_")
+        core::downcast<InputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<McuStatsHandler>(*DEVICE, mcu_stats_counter(name)));
+
+    } else if (name == "fault_limit_set" || name == "fault_persistence_set") {
+        core::downcast<OutputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<FaultLimitsWriteHandler>(*DEVICE, fault_limits_field(name)));
+
+    } else if (name == "fault_limit" || name == "fault_persistence") {
+        core::downcast<InputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<FaultLimitsReadHandler>(*DEVICE, fault_limits_field(name)));
+
+    } else if (name.rfind("fault_", 0) == 0) { // name.startswith("fault_")
+        core::downcast<InputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<FaultReportHandler>(*DEVICE, fault_report_field(name)));
+
+    } else if (name == "postmortem_fault_count") {
+        core::downcast<InputValueRecord<int32_t>>(record).unwrap().get().set_handler( //
+            std::make_unique<PostmortemFaultCountHandler>(*DEVICE));
+
+    } else if (name.rfind("postmortem_", 0) == 0) { // name.startswith("postmortem_")
+        core::downcast<InputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<PostmortemWfHandler>(*DEVICE, postmortem_index(name)));
+
+    } else if (name == "timing_hist") {
+        core::downcast<InputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<TimingHistHandler>(*DEVICE));
+
+    } else if (name.rfind("timing_", 0) == 0) { // name.startswith("timing_")
+        core::downcast<InputArrayRecord<double>>(record).unwrap().get().set_handler( //
+            std::make_unique<TimingHandler>(*DEVICE, timing_stats_value(name)));
+
     } else {
         core_log_fatal("Unexpected record: {}", name);
         core_unimplemented();
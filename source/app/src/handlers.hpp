@@ -144,3 +144,346 @@ public:
         device_.reset_statistics();
     }
 };
+
+class LinkStatsHandler final : public DeviceHandler, public InputValueHandler<int32_t> {
+private:
+    const std::atomic<uint64_t> Device::LinkStats::*counter_;
+
+public:
+    LinkStatsHandler(Device &device, const std::atomic<uint64_t> Device::LinkStats::*counter) :
+        Handler(false),
+        DeviceHandler(device),
+        counter_(counter) {}
+
+    virtual void read(InputValueRecord<int32_t> &record) override {
+        record.set_value(int32_t((device_.link_stats().*counter_).load()));
+    }
+
+    virtual void set_read_request(InputValueRecord<int32_t> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+class McuStatsHandler final : public DeviceHandler, public InputValueHandler<int32_t> {
+private:
+    uint64_t Device::McuStats::*counter_;
+
+public:
+    McuStatsHandler(Device &device, uint64_t Device::McuStats::*counter) :
+        Handler(false),
+        DeviceHandler(device),
+        counter_(counter) {}
+
+    virtual void read(InputValueRecord<int32_t> &record) override {
+        record.set_value(int32_t(device_.mcu_stats().*counter_));
+    }
+
+    virtual void set_read_request(InputValueRecord<int32_t> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+class FaultReportHandler final : public DeviceHandler, public InputValueHandler<int32_t> {
+private:
+    int64_t Device::FaultReport::*field_;
+
+public:
+    FaultReportHandler(Device &device, int64_t Device::FaultReport::*field) :
+        Handler(false),
+        DeviceHandler(device),
+        field_(field) {}
+
+    virtual void read(InputValueRecord<int32_t> &record) override {
+        record.set_value(int32_t(device_.fault_report().*field_));
+    }
+
+    virtual void set_read_request(InputValueRecord<int32_t> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+class AdcDecimationHandler final : public DeviceHandler, public OutputValueHandler<int32_t> {
+public:
+    AdcDecimationHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void write(OutputValueRecord<int32_t> &record) override {
+        device_.set_adc_decimation(uint32_t(record.value()));
+    }
+};
+
+class DacUpsamplingHandler final : public DeviceHandler, public OutputValueHandler<int32_t> {
+public:
+    DacUpsamplingHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void write(OutputValueRecord<int32_t> &record) override {
+        device_.set_dac_upsampling(uint32_t(record.value()));
+    }
+};
+
+class DacInterpolationHandler final : public DeviceHandler, public OutputValueHandler<bool> {
+public:
+    DacInterpolationHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void write(OutputValueRecord<bool> &record) override {
+        device_.set_dac_interpolation(record.value());
+    }
+};
+
+/// Writes one field of all calibration entries, see `Device::Calib`.
+class CalibWriteHandler final : public DeviceHandler, public OutputArrayHandler<double> {
+private:
+    Device::CalibField field_;
+
+public:
+    CalibWriteHandler(Device &device, Device::CalibField field) : Handler(false), DeviceHandler(device), field_(field) {}
+
+    virtual void write(OutputArrayRecord<double> &record) override {
+        device_.write_calib(field_, record.data());
+    }
+};
+
+/// Reads one field of all calibration entries, empty until the table is read from MCU.
+class CalibReadHandler final : public DeviceHandler, public InputArrayHandler<double> {
+private:
+    Device::CalibField field_;
+
+public:
+    CalibReadHandler(Device &device, Device::CalibField field) : Handler(false), DeviceHandler(device), field_(field) {}
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        const auto calib = device_.calib();
+        std::array<double, ADC_COUNT> data = {};
+        size_t size = 0;
+        if (calib.has_value()) {
+            const auto &values = (*calib).*field_;
+            std::copy(values.begin(), values.end(), data.begin());
+            size = ADC_COUNT;
+        }
+        core_assert(record.set_data(std::span<const double>(data.data(), size)));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+/// Writes one field of all fault checks, see `Device::FaultLimits`.
+class FaultLimitsWriteHandler final : public DeviceHandler, public OutputArrayHandler<double> {
+private:
+    Device::FaultLimitsField field_;
+
+public:
+    FaultLimitsWriteHandler(Device &device, Device::FaultLimitsField field) :
+        Handler(false),
+        DeviceHandler(device),
+        field_(field) {}
+
+    virtual void write(OutputArrayRecord<double> &record) override {
+        device_.write_fault_limits(field_, record.data());
+    }
+};
+
+/// Reads one field of all fault checks, empty until the limits are read from MCU.
+class FaultLimitsReadHandler final : public DeviceHandler, public InputArrayHandler<double> {
+private:
+    Device::FaultLimitsField field_;
+
+public:
+    FaultLimitsReadHandler(Device &device, Device::FaultLimitsField field) :
+        Handler(false),
+        DeviceHandler(device),
+        field_(field) {}
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        const auto limits = device_.fault_limits();
+        std::array<double, FAULT_CHECK_COUNT> data = {};
+        size_t size = 0;
+        if (limits.has_value()) {
+            const auto &values = (*limits).*field_;
+            std::copy(values.begin(), values.end(), data.begin());
+            size = FAULT_CHECK_COUNT;
+        }
+        core_assert(record.set_data(std::span<const double>(data.data(), size)));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+/// Writes all regulator gains at once in `Device::REGULATOR_GAINS_ORDER`.
+class RegulatorGainsWriteHandler final : public DeviceHandler, public OutputArrayHandler<double> {
+public:
+    RegulatorGainsWriteHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void write(OutputArrayRecord<double> &record) override {
+        device_.write_regulator_gains(record.data());
+    }
+};
+
+/// Reads all regulator gains in `Device::REGULATOR_GAINS_ORDER`, empty until they are read from MCU.
+class RegulatorGainsReadHandler final : public DeviceHandler, public InputArrayHandler<double> {
+public:
+    RegulatorGainsReadHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        const auto gains = device_.regulator_gains();
+        std::array<double, Device::REGULATOR_GAINS_ORDER.size()> data = {};
+        size_t size = 0;
+        if (gains.has_value()) {
+            for (size_t i = 0; i < data.size(); ++i) {
+                data[i] = double((*gains).*Device::REGULATOR_GAINS_ORDER[i]);
+            }
+            size = data.size();
+        }
+        core_assert(record.set_data(std::span<const double>(data.data(), size)));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+class TelemetryRatioHandler final : public DeviceHandler, public OutputValueHandler<int32_t> {
+public:
+    TelemetryRatioHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void write(OutputValueRecord<int32_t> &record) override {
+        device_.set_telemetry_ratio(uint32_t(record.value()));
+    }
+};
+
+/// Waveform of one regulator telemetry value, see `TELEMETRY_*`.
+class TelemetryWfHandler final : public DeviceHandler, public InputArrayHandler<double> {
+private:
+    size_t index_;
+
+public:
+    TelemetryWfHandler(Device &device, InputArrayRecord<double> &record, size_t index) :
+        Handler(true),
+        DeviceHandler(device),
+        index_(index) {
+        device_.init_telemetry(index_, record.max_length());
+    }
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        auto data = device_.read_telemetry(index_);
+        core_assert(record.set_data(data));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&callback) override {
+        device_.set_telemetry_callback(index_, std::move(callback));
+    }
+};
+
+/// Waveform of one post-mortem value, see `POSTMORTEM_*`.
+class PostmortemWfHandler final : public DeviceHandler, public InputArrayHandler<double> {
+private:
+    size_t index_;
+
+public:
+    PostmortemWfHandler(Device &device, size_t index) : Handler(true), DeviceHandler(device), index_(index) {}
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        auto data = device_.read_postmortem(index_);
+        if (data.size() > record.max_length()) {
+            // Keep the ticks just before the fault.
+            data.erase(data.begin(), data.end() - record.max_length());
+        }
+        core_assert(record.set_data(data));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&callback) override {
+        device_.set_postmortem_callback(index_, std::move(callback));
+    }
+};
+
+class PostmortemFaultCountHandler final : public DeviceHandler, public InputValueHandler<int32_t> {
+public:
+    PostmortemFaultCountHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void read(InputValueRecord<int32_t> &record) override {
+        record.set_value(int32_t(device_.postmortem_fault_count()));
+    }
+
+    virtual void set_read_request(InputValueRecord<int32_t> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+class SampleFreqHandler final : public DeviceHandler, public InputValueHandler<int32_t> {
+public:
+    SampleFreqHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void read(InputValueRecord<int32_t> &record) override {
+        record.set_value(int32_t(device_.sample_freq_hz()));
+    }
+
+    virtual void set_read_request(InputValueRecord<int32_t> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+/// Statistics of all ADC channels, one element per channel.
+class McuAdcStatsHandler final : public DeviceHandler, public InputArrayHandler<double> {
+private:
+    std::array<double, ADC_COUNT> Device::McuStats::*values_;
+
+public:
+    McuAdcStatsHandler(Device &device, std::array<double, ADC_COUNT> Device::McuStats::*values) :
+        Handler(false),
+        DeviceHandler(device),
+        values_(values) {}
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        const auto stats = device_.mcu_stats();
+        core_assert(record.set_data(stats.*values_));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+class TimingHandler final : public DeviceHandler, public InputArrayHandler<double> {
+private:
+    const double Device::TimingStats::*value_;
+
+public:
+    TimingHandler(Device &device, const double Device::TimingStats::*value) :
+        Handler(false),
+        DeviceHandler(device),
+        value_(value) {}
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        const auto stats = device_.timing_stats();
+        std::array<double, TIMING_STAGE_COUNT> data;
+        for (size_t i = 0; i < TIMING_STAGE_COUNT; ++i) {
+            data[i] = stats[i].*value_;
+        }
+        core_assert(record.set_data(data));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
+
+/// Histograms of all stages one after another.
+class TimingHistHandler final : public DeviceHandler, public InputArrayHandler<double> {
+public:
+    TimingHistHandler(Device &device) : Handler(false), DeviceHandler(device) {}
+
+    virtual void read(InputArrayRecord<double> &record) override {
+        const auto stats = device_.timing_stats();
+        std::array<double, TIMING_STAGE_COUNT * TIMING_HIST_BINS> data;
+        for (size_t i = 0; i < TIMING_STAGE_COUNT; ++i) {
+            std::copy(stats[i].hist.begin(), stats[i].hist.end(), data.begin() + i * TIMING_HIST_BINS);
+        }
+        core_assert(record.set_data(data));
+    }
+
+    virtual void set_read_request(InputArrayRecord<double> &, std::function<void()> &&) override {
+        core_unimplemented();
+    }
+};
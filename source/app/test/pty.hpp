@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <core/assert.hpp>
+
+/// Pseudo-terminal pair standing in for `/dev/ttyRPMSG*` on a host.
+/// Channel under test opens `slave_path()`, test code plays the MCU role through `master()`.
+class PtyPair final {
+private:
+    int master_ = -1;
+    std::string slave_path_;
+
+public:
+    PtyPair() {
+        master_ = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        core_assert(master_ >= 0);
+        core_assert(grantpt(master_) == 0);
+        core_assert(unlockpt(master_) == 0);
+        slave_path_ = ptsname(master_);
+
+        termios tty = {};
+        core_assert(tcgetattr(master_, &tty) == 0);
+        cfmakeraw(&tty);
+        core_assert(tcsetattr(master_, TCSANOW, &tty) == 0);
+    }
+    ~PtyPair() {
+        close(master_);
+    }
+
+    PtyPair(const PtyPair &) = delete;
+    PtyPair &operator=(const PtyPair &) = delete;
+
+    [[nodiscard]] int master() const {
+        return master_;
+    }
+    [[nodiscard]] const std::string &slave_path() const {
+        return slave_path_;
+    }
+
+    void write_all(const uint8_t *data, size_t len) {
+        while (len > 0) {
+            ssize_t ret = write(master_, data, len);
+            core_assert(ret > 0);
+            data += ret;
+            len -= size_t(ret);
+        }
+    }
+
+    void read_exact(uint8_t *data, size_t len) {
+        while (len > 0) {
+            ssize_t ret = read(master_, data, len);
+            core_assert(ret > 0);
+            data += ret;
+            len -= size_t(ret);
+        }
+    }
+};
@@ -0,0 +1,165 @@
+// Compares syscall count and round-trip latency of blocking tty I/O (as done by `RpmsgChannel`)
+// and `UringChannel` on a pty pair. Results are printed as JSON.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+#include <channel/uring.hpp>
+
+#include "pty.hpp"
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t MSG_LEN = 64;
+static constexpr size_t BATCH = 8;
+static constexpr size_t ROUNDS = 2000;
+
+/// Blocking tty I/O with the same syscall pattern as `RpmsgChannel`: `poll` + `read` per receive, `write` per send.
+class BlockingTty final {
+private:
+    int fd_;
+
+public:
+    size_t syscalls = 0;
+
+    explicit BlockingTty(const std::string &path) {
+        fd_ = open(path.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+        core_assert(fd_ >= 0);
+        termios tty = {};
+        core_assert(tcgetattr(fd_, &tty) == 0);
+        cfmakeraw(&tty);
+        core_assert(tcsetattr(fd_, TCSANOW, &tty) == 0);
+    }
+    ~BlockingTty() {
+        close(fd_);
+    }
+
+    void send(const uint8_t *data, size_t len) {
+        syscalls += 1;
+        core_assert(write(fd_, data, len) == ssize_t(len));
+    }
+    void flush() {}
+
+    size_t receive(uint8_t *data, size_t max_len) {
+        pollfd pfd = {fd_, POLLIN, 0};
+        syscalls += 1;
+        core_assert(poll(&pfd, 1, 1000) == 1);
+        syscalls += 1;
+        ssize_t ret = read(fd_, data, max_len);
+        core_assert(ret > 0);
+        return size_t(ret);
+    }
+};
+
+/// Adapter with the same interface as `BlockingTty`.
+class Uring final {
+private:
+    std::unique_ptr<UringChannel> channel_;
+
+public:
+    explicit Uring(const std::string &path) : channel_(UringChannel::create(path, MSG_LEN * BATCH).unwrap()) {}
+
+    void send(const uint8_t *data, size_t len) {
+        channel_->send(data, len, 1000ms).unwrap();
+    }
+    void flush() {
+        channel_->flush().unwrap();
+    }
+    size_t receive(uint8_t *data, size_t max_len) {
+        return channel_->receive(data, max_len, 1000ms).unwrap();
+    }
+    [[nodiscard]] size_t syscalls() const {
+        auto stats = channel_->stats();
+        return stats.recv_syscalls + stats.send_syscalls;
+    }
+};
+
+static size_t syscalls(const BlockingTty &tty) {
+    return tty.syscalls;
+}
+static size_t syscalls(const Uring &uring) {
+    return uring.syscalls();
+}
+
+/// Echo everything back, emulating MCU that answers each batch of DAC messages.
+static void echo(PtyPair &pty, const std::atomic<bool> &done) {
+    std::vector<uint8_t> buffer(MSG_LEN * BATCH);
+    while (!done.load()) {
+        pollfd pfd = {pty.master(), POLLIN, 0};
+        if (poll(&pfd, 1, 10) != 1) {
+            continue;
+        }
+        ssize_t len = read(pty.master(), buffer.data(), buffer.size());
+        if (len > 0) {
+            pty.write_all(buffer.data(), size_t(len));
+        }
+    }
+}
+
+template <typename Backend>
+static void run(const char *name, bool last) {
+    PtyPair pty;
+    std::atomic<bool> done{false};
+    std::thread echo_thread([&]() {
+        echo(pty, done);
+    });
+
+    Backend backend(pty.slave_path());
+    std::vector<uint8_t> msg(MSG_LEN, 0x5a);
+    std::vector<uint8_t> buffer(MSG_LEN * BATCH);
+    std::vector<double> latencies_us;
+    latencies_us.reserve(ROUNDS);
+
+    size_t syscalls_before = syscalls(backend);
+    auto total_start = Clock::now();
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < BATCH; ++i) {
+            backend.send(msg.data(), msg.size());
+        }
+        backend.flush();
+        size_t received = 0;
+        while (received < MSG_LEN * BATCH) {
+            received += backend.receive(buffer.data(), buffer.size() - received);
+        }
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    double total_s = std::chrono::duration<double>(Clock::now() - total_start).count();
+    size_t total_syscalls = syscalls(backend) - syscalls_before;
+
+    done.store(true);
+    echo_thread.join();
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+    auto percentile = [&](double p) {
+        return latencies_us[size_t(p * double(latencies_us.size() - 1))];
+    };
+    size_t messages = ROUNDS * BATCH;
+    std::printf(
+        "    \"%s\": {\"messages\": %zu, \"syscalls_per_message\": %.3f, \"messages_per_s\": %.0f, "
+        "\"batch_rtt_us\": {\"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}}%s\n",
+        name,
+        messages,
+        double(total_syscalls) / double(messages),
+        double(messages) / total_s,
+        percentile(0.5),
+        percentile(0.99),
+        latencies_us.back(),
+        last ? "" : ",");
+}
+
+int main() {
+    std::printf("{\n");
+    std::printf("  \"msg_len\": %zu,\n  \"batch\": %zu,\n  \"results\": {\n", MSG_LEN, BATCH);
+    run<BlockingTty>("blocking", false);
+    run<Uring>("io_uring", true);
+    std::printf("  }\n}\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <channel/uring.hpp>
+
+#include "pty.hpp"
+
+using namespace std::chrono_literals;
+
+static constexpr size_t MAX_LEN = 496;
+
+TEST(UringChannel, receive_in_order) {
+    PtyPair pty;
+    auto channel = UringChannel::create(pty.slave_path(), MAX_LEN).unwrap();
+
+    // More data than all reads in flight can hold at once.
+    std::vector<uint8_t> data(4 * UringChannel::READS_IN_FLIGHT * MAX_LEN);
+    std::iota(data.begin(), data.end(), uint8_t(0));
+    pty.write_all(data.data(), data.size());
+
+    std::vector<uint8_t> received;
+    std::vector<uint8_t> buffer(MAX_LEN);
+    while (received.size() < data.size()) {
+        size_t len = channel->receive(buffer.data(), buffer.size(), 1000ms).unwrap();
+        ASSERT_GT(len, 0u);
+        received.insert(received.end(), buffer.begin(), buffer.begin() + len);
+    }
+    ASSERT_EQ(received, data);
+}
+
+TEST(UringChannel, receive_timeout) {
+    PtyPair pty;
+    auto channel = UringChannel::create(pty.slave_path(), MAX_LEN).unwrap();
+
+    uint8_t buffer[MAX_LEN];
+    auto result = channel->receive(buffer, MAX_LEN, 10ms);
+    ASSERT_TRUE(result.is_err());
+    ASSERT_EQ(result.unwrap_err().kind, core::io::ErrorKind::TimedOut);
+}
+
+TEST(UringChannel, send_batch) {
+    PtyPair pty;
+    auto channel = UringChannel::create(pty.slave_path(), MAX_LEN).unwrap();
+
+    const size_t count = UringChannel::WRITE_BATCH_SIZE / 2;
+    std::vector<uint8_t> expected;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<uint8_t> msg(i + 1, uint8_t(i));
+        channel->send(msg.data(), msg.size(), 1000ms).unwrap();
+        expected.insert(expected.end(), msg.begin(), msg.end());
+    }
+    auto before = channel->stats();
+    channel->flush().unwrap();
+    auto after = channel->stats();
+
+    // Whole batch is submitted with a single syscall.
+    ASSERT_EQ(after.write_batches - before.write_batches, 1u);
+    ASSERT_EQ(after.send_syscalls - before.send_syscalls, 1u);
+
+    std::vector<uint8_t> received(expected.size());
+    pty.read_exact(received.data(), received.size());
+    ASSERT_EQ(received, expected);
+}
+
+TEST(UringChannel, send_overflow_batch) {
+    PtyPair pty;
+    auto channel = UringChannel::create(pty.slave_path(), MAX_LEN).unwrap();
+
+    // Sending more messages than slots flushes automatically and keeps order.
+    const size_t count = 4 * UringChannel::WRITE_BATCH_SIZE;
+    std::vector<uint8_t> expected;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<uint8_t> msg(16, uint8_t(i));
+        channel->send(msg.data(), msg.size(), 1000ms).unwrap();
+        expected.insert(expected.end(), msg.begin(), msg.end());
+    }
+    channel->flush().unwrap();
+
+    std::vector<uint8_t> received(expected.size());
+    pty.read_exact(received.data(), received.size());
+    ASSERT_EQ(received, expected);
+}
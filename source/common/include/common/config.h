@@ -5,6 +5,7 @@
 
 #define ADC_COUNT 6
 
+/// Default sample frequency. Actual one is requested by app on connection and reported by MCU.
 #define SAMPLE_FREQ_HZ 10000
 
 #define DAC_MAX_ABS_V 10.0
@@ -24,9 +25,139 @@ typedef int32_t point_t;
 #define _adc_msg_max_points_by_len(len) \
     (((len) - sizeof(((IppMcuMsg *)NULL)->type) - sizeof(IppMcuMsgAdcData)) / (ADC_COUNT * sizeof(point_t)))
 
+#define _telemetry_msg_max_points_by_len(len) \
+    (((len) - sizeof(((IppMcuMsg *)NULL)->type) - sizeof(IppMcuMsgTelemetry)) / (TELEMETRY_COUNT * sizeof(int32_t)))
+#define _postmortem_msg_max_points_by_len(len) \
+    (((len) - sizeof(((IppMcuMsg *)NULL)->type) - sizeof(IppMcuMsgPostmortem)) / (POSTMORTEM_COUNT * sizeof(int32_t)))
+
 #define DAC_MSG_MAX_POINTS _dac_msg_max_points_by_len(RPMSG_MAX_APP_MSG_LEN)
 #define ADC_MSG_MAX_POINTS _adc_msg_max_points_by_len(RPMSG_MAX_MCU_MSG_LEN)
+#define TELEMETRY_MSG_MAX_POINTS _telemetry_msg_max_points_by_len(RPMSG_MAX_MCU_MSG_LEN)
+#define POSTMORTEM_MSG_MAX_POINTS _postmortem_msg_max_points_by_len(RPMSG_MAX_MCU_MSG_LEN)
 
 
 #define KEEP_ALIVE_PERIOD_MS 100
 #define KEEP_ALIVE_MAX_DELAY_MS 200
+
+/// Version of inter-processor protocol exchanged on connection.
+/// Must be incremented on every incompatible change of messages.
+#define IPP_PROTOCOL_VERSION 5
+
+/// Optional protocol features negotiated on connection (bit flags).
+/// Feature is enabled only if both sides support it.
+#define IPP_FEATURE_SEQUENCE_NUMBERS 1
+/// MCU averages ADC points over ratio set by `AppMsgAdcDecimation`.
+#define IPP_FEATURE_ADC_DECIMATION 2
+/// MCU calibration table is read and written with `AppMsgCalibRead` and `AppMsgCalibWrite`.
+#define IPP_FEATURE_CALIB 4
+/// MCU regulator gains are read and written with `AppMsgRegulatorRead` and `AppMsgRegulatorWrite`.
+#define IPP_FEATURE_REGULATOR 8
+/// MCU streams regulator telemetry in `McuMsgTelemetry` at ratio set by `AppMsgTelemetry`.
+#define IPP_FEATURE_TELEMETRY 16
+/// MCU holds each DAC point for a number of samples set by `AppMsgDacUpsampling` and interpolates reference.
+#define IPP_FEATURE_DAC_UPSAMPLING 32
+/// MCU reports the first fault of each fault episode in `McuMsgFault`.
+#define IPP_FEATURE_FAULT 64
+/// MCU uploads post-mortem buffer frozen on fault in `McuMsgPostmortem` chunks.
+#define IPP_FEATURE_POSTMORTEM 128
+/// MCU fault thresholds are read and written with `AppMsgFaultLimitsRead` and `AppMsgFaultLimitsWrite`.
+#define IPP_FEATURE_FAULT_LIMITS 256
+
+/// Features supported by this build.
+#define IPP_FEATURES_SUPPORTED \
+    (IPP_FEATURE_SEQUENCE_NUMBERS | IPP_FEATURE_ADC_DECIMATION | IPP_FEATURE_CALIB | IPP_FEATURE_REGULATOR | \
+     IPP_FEATURE_TELEMETRY | IPP_FEATURE_DAC_UPSAMPLING | IPP_FEATURE_FAULT | IPP_FEATURE_POSTMORTEM | \
+     IPP_FEATURE_FAULT_LIMITS)
+
+/// Maximum ADC decimation ratio.
+#define ADC_DECIMATION_MAX 256
+/// Maximum DAC upsampling ratio.
+#define DAC_UPSAMPLING_MAX 100
+
+/// Values of regulator telemetry point, one point per sync generator tick.
+/// Reference and measured current are in 100 uA units, voltage is in 100 uV units,
+/// regulator output is in DAC units of sync generator, integral sum is saturated to `int32_t`.
+#define TELEMETRY_REF 0
+#define TELEMETRY_IOUT 1
+#define TELEMETRY_VOUT 2
+#define TELEMETRY_FB 3
+#define TELEMETRY_SUM 4
+
+#define TELEMETRY_COUNT 5
+
+/// Maximum telemetry decimation ratio.
+#define TELEMETRY_RATIO_MAX 65535
+/// Period of sending telemetry points that do not fill a whole message.
+#define TELEMETRY_FLUSH_PERIOD_MS 100
+
+/// Fault codes reported in `McuMsgFault`. The first four are tripped by thresholds of calibrated values,
+/// the rest by discrete inputs and sync generator timer.
+#define FAULT_NONE 0
+#define FAULT_OVERCURRENT 1
+#define FAULT_OVERVOLTAGE 2
+#define FAULT_OVERHEAT 3
+#define FAULT_FB_LOST 4
+#define FAULT_BOARD 5
+#define FAULT_DCCT 6
+#define FAULT_EXT_LOCK1 7
+#define FAULT_EXT_LOCK2 8
+#define FAULT_GND_MON 9
+#define FAULT_LINE 10
+
+/// Values checked against fault thresholds, index into `McuMsgFaultLimits` arrays.
+/// Output current, output voltage, the hottest heatsink temperature,
+/// and difference between reference and measured current while regulating.
+#define FAULT_CHECK_IOUT 0
+#define FAULT_CHECK_VOUT 1
+#define FAULT_CHECK_HEATSINK 2
+#define FAULT_CHECK_FB_ERROR 3
+
+#define FAULT_CHECK_COUNT 4
+
+/// Values of post-mortem point, one point per sync generator tick.
+/// ADC channels are raw codes seen by sync generator, reference and regulator output are as in telemetry,
+/// discrete inputs are SkifIO DIN bits.
+#define POSTMORTEM_AIN0 0
+#define POSTMORTEM_REF (POSTMORTEM_AIN0 + ADC_COUNT)
+#define POSTMORTEM_FB (POSTMORTEM_REF + 1)
+#define POSTMORTEM_DIN (POSTMORTEM_FB + 1)
+
+#define POSTMORTEM_COUNT (POSTMORTEM_DIN + 1)
+
+/// Number of the last sync generator ticks kept in post-mortem buffer.
+#define POSTMORTEM_DEPTH 256
+
+/// Stages of MCU tasks measured by timing probes, reported in `McuMsgTiming`.
+/// Control task stages are measured once per sample: waiting for SkifIO ready signal, wake-up latency from ready
+/// signal interrupt to the task, discrete input/output exchange, DAC ring buffer read, SPI transfer, ADC ring buffer
+/// write with statistics update, and the whole sample except waiting.
+#define TIMING_CONTROL_WAIT 0
+#define TIMING_CONTROL_WAKEUP 1
+#define TIMING_CONTROL_DIO 2
+#define TIMING_CONTROL_DAC 3
+#define TIMING_CONTROL_TRANSFER 4
+#define TIMING_CONTROL_ADC 5
+#define TIMING_CONTROL_SAMPLE 6
+/// Sync generator stages are measured on each timer tick: waiting for the tick, wake-up latency from timer interrupt
+/// to the task, measurement scaling, filtering and regulator math, discrete input checks with discrete output update,
+/// and the whole tick except waiting.
+#define TIMING_SYNC_WAIT 7
+#define TIMING_SYNC_WAKEUP 8
+#define TIMING_SYNC_REGULATOR 9
+#define TIMING_SYNC_DIO 10
+#define TIMING_SYNC_TICK 11
+/// RPMSG send task wake-up latency from control task or discrete input interrupt notification.
+#define TIMING_RPMSG_WAKEUP 12
+
+#define TIMING_STAGE_COUNT 13
+
+/// Timing histogram has logarithmic bins: bin 0 counts durations below `TIMING_HIST_BASE_CYCLES`,
+/// bin `i` counts durations in `[TIMING_HIST_BASE_CYCLES * 2^(i-1), TIMING_HIST_BASE_CYCLES * 2^i)`,
+/// and the last bin also counts all longer durations.
+#define TIMING_HIST_BINS 12
+#define TIMING_HIST_BASE_CYCLES 64
+
+#define TIMING_REPORT_PERIOD_MS 1000
+
+/// Period of `McuMsgStats` sending.
+#define STATS_MSG_PERIOD_MS 1000
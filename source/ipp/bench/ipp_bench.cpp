@@ -0,0 +1,294 @@
+// Measures encode/decode throughput and heap allocations of generated IPP codecs (C `ipp.c` and C++ `ipp.cpp`)
+// for each message type at realistic sizes. Results are printed as JSON.
+// C codec has no encode/decode of its own, so its encode and decode are `ipp_*_msg_size` as called by sender and
+// receiver. They do not touch the payload, so C results are marked `size_check_only` and have no throughput.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <vector>
+
+#include <core/assert.hpp>
+
+#include <common/config.h>
+#include <ipp.h>
+#include <ipp.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t ITERATIONS = 100000;
+static constexpr size_t WARMUP = 1000;
+
+// Allocation counting.
+// NOTE: Deallocation functions are not inlined, otherwise GCC complains about `free` of pointer from `new`.
+
+static std::atomic<size_t> g_alloc_count{0};
+
+void *operator new(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+__attribute__((noinline)) void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+__attribute__((noinline)) void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+__attribute__((noinline)) void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+__attribute__((noinline)) void operator delete[](void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+/// Prevent compiler from optimizing out computation of `value`.
+template <typename T>
+static void do_not_optimize(T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Measurement {
+    double ns_per_msg = 0.0;
+    double allocs_per_msg = 0.0;
+};
+
+static Measurement measure(const std::function<void(size_t)> &op) {
+    for (size_t i = 0; i < WARMUP; ++i) {
+        op(i);
+    }
+
+    size_t allocs_before = g_alloc_count.load();
+    auto start = Clock::now();
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        op(i);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    size_t allocs = g_alloc_count.load() - allocs_before;
+
+    return Measurement{elapsed / ITERATIONS, double(allocs) / ITERATIONS};
+}
+
+struct Case {
+    const char *codec;
+    const char *message;
+    size_t points;
+    /// Operations only compute message size, so bytes per time is meaningless.
+    bool size_check_only;
+    /// Encodes message into buffer and returns its size.
+    std::function<size_t(size_t)> encode;
+    /// Decodes message previously encoded into buffer.
+    std::function<void(size_t)> decode;
+};
+
+struct Result {
+    const char *codec;
+    const char *message;
+    size_t points;
+    bool size_check_only;
+    size_t size;
+    Measurement encode;
+    Measurement decode;
+};
+
+static Result run_case(const Case &c) {
+    Result result{c.codec, c.message, c.points, c.size_check_only, 0, {}, {}};
+    result.encode = measure([&](size_t i) {
+        result.size = c.encode(i);
+    });
+    // Buffer contains encoded message now.
+    result.decode = measure(c.decode);
+    return result;
+}
+
+static void print_measurement(const char *name, const Measurement &m, const Result &r, bool last) {
+    std::printf("      \"%s\": {\"ns_per_msg\": %.2f, ", name, m.ns_per_msg);
+    if (!r.size_check_only) {
+        double mb_per_s = m.ns_per_msg > 0.0 ? double(r.size) / m.ns_per_msg * 1e3 : 0.0;
+        std::printf("\"mb_per_s\": %.1f, ", mb_per_s);
+    }
+    std::printf("\"allocs_per_msg\": %.2f}%s\n", m.allocs_per_msg, last ? "" : ",");
+}
+
+int main() {
+    alignas(8) static uint8_t app_buffer[RPMSG_MAX_APP_MSG_LEN];
+    alignas(8) static uint8_t mcu_buffer[RPMSG_MAX_MCU_MSG_LEN];
+    auto *app_c = reinterpret_cast<IppAppMsg *>(app_buffer);
+    auto *mcu_c = reinterpret_cast<IppMcuMsg *>(mcu_buffer);
+
+    static constexpr size_t DAC_POINTS = DAC_MSG_MAX_POINTS;
+    static constexpr size_t ADC_POINTS = ADC_MSG_MAX_POINTS;
+    using AdcPoints = std::array<point_t, ADC_COUNT>;
+
+    // Source data, like the data is taken from ring buffers.
+    std::vector<point_t> dac_src(DAC_POINTS);
+    std::vector<AdcPoints> adc_src(ADC_POINTS);
+    for (size_t i = 0; i < DAC_POINTS; ++i) {
+        dac_src[i] = point_t(i * 997);
+    }
+    for (size_t i = 0; i < ADC_POINTS; ++i) {
+        for (size_t j = 0; j < ADC_COUNT; ++j) {
+            adc_src[i][j] = point_t(i * 131 + j);
+        }
+    }
+
+    // Pre-built C++ messages. Encoding of an existing message is what `MessageChannel::send` does.
+    ipp::AppMsg keep_alive_cpp{ipp::AppMsgKeepAlive{}};
+    ipp::AppMsgDacData dac_data;
+    dac_data.seq = 0;
+    dac_data.points.insert(dac_data.points.end(), dac_src.begin(), dac_src.end());
+    ipp::AppMsg dac_data_cpp{std::move(dac_data)};
+    ipp::McuMsg dac_request_cpp{ipp::McuMsgDacRequest{uint32_t(DAC_POINTS)}};
+    ipp::McuMsgAdcData adc_data;
+    adc_data.seq = 0;
+    adc_data.sample_index = 0;
+    adc_data.points_arrays.insert(adc_data.points_arrays.end(), adc_src.begin(), adc_src.end());
+    ipp::McuMsg adc_data_cpp{std::move(adc_data)};
+
+    // Generated C code is packed structs that are filled and read in place, the only generated function called
+    // per message is `ipp_*_msg_size`: by sender to get length of filled message and by receiver to check it against
+    // received length. C cases measure it on messages with real payloads stored by C++ codec into separate buffers.
+    alignas(8) static uint8_t c_buffers[4][std::max(RPMSG_MAX_APP_MSG_LEN, RPMSG_MAX_MCU_MSG_LEN)];
+    const auto c_app_case = [&](const char *message, size_t points, ipp::AppMsg &src, uint8_t *buffer) {
+        auto *msg = reinterpret_cast<IppAppMsg *>(buffer);
+        src.store(*msg);
+        const size_t len = src.packed_size();
+        return Case{
+            "c",
+            message,
+            points,
+            true,
+            [msg](size_t) {
+                size_t size = ipp_app_msg_size(msg);
+                do_not_optimize(size);
+                return size;
+            },
+            [msg, len](size_t) {
+                core_assert(ipp_app_msg_size(msg) == len);
+            },
+        };
+    };
+    const auto c_mcu_case = [&](const char *message, size_t points, ipp::McuMsg &src, uint8_t *buffer) {
+        auto *msg = reinterpret_cast<IppMcuMsg *>(buffer);
+        src.store(*msg);
+        const size_t len = src.packed_size();
+        return Case{
+            "c",
+            message,
+            points,
+            true,
+            [msg](size_t) {
+                size_t size = ipp_mcu_msg_size(msg);
+                do_not_optimize(size);
+                return size;
+            },
+            [msg, len](size_t) {
+                core_assert(ipp_mcu_msg_size(msg) == len);
+            },
+        };
+    };
+
+    const std::vector<Case> cases = {
+        c_app_case("app_msg_keep_alive", 0, keep_alive_cpp, c_buffers[0]),
+        c_app_case("app_msg_dac_data", DAC_POINTS, dac_data_cpp, c_buffers[1]),
+        c_mcu_case("mcu_msg_dac_request", 0, dac_request_cpp, c_buffers[2]),
+        c_mcu_case("mcu_msg_adc_data", ADC_POINTS, adc_data_cpp, c_buffers[3]),
+        Case{
+            "cpp",
+            "app_msg_keep_alive",
+            0,
+            false,
+            [&](size_t) {
+                size_t size = keep_alive_cpp.packed_size();
+                keep_alive_cpp.store(*app_c);
+                return size;
+            },
+            [&](size_t) {
+                auto msg = ipp::AppMsg::load(*app_c);
+                do_not_optimize(msg);
+            },
+        },
+        Case{
+            "cpp",
+            "app_msg_dac_data",
+            DAC_POINTS,
+            false,
+            [&](size_t) {
+                size_t size = dac_data_cpp.packed_size();
+                dac_data_cpp.store(*app_c);
+                return size;
+            },
+            [&](size_t) {
+                auto msg = ipp::AppMsg::load(*app_c);
+                do_not_optimize(msg);
+            },
+        },
+        Case{
+            "cpp",
+            "mcu_msg_dac_request",
+            0,
+            false,
+            [&](size_t) {
+                size_t size = dac_request_cpp.packed_size();
+                dac_request_cpp.store(*mcu_c);
+                return size;
+            },
+            [&](size_t) {
+                auto msg = ipp::McuMsg::load(*mcu_c);
+                do_not_optimize(msg);
+            },
+        },
+        Case{
+            "cpp",
+            "mcu_msg_adc_data",
+            ADC_POINTS,
+            false,
+            [&](size_t) {
+                size_t size = adc_data_cpp.packed_size();
+                adc_data_cpp.store(*mcu_c);
+                return size;
+            },
+            [&](size_t) {
+                auto msg = ipp::McuMsg::load(*mcu_c);
+                do_not_optimize(msg);
+            },
+        },
+    };
+
+    std::vector<Result> results;
+    for (const auto &c : cases) {
+        results.push_back(run_case(c));
+    }
+
+    std::printf("{\n");
+    std::printf("  \"iterations\": %zu,\n  \"results\": [\n", ITERATIONS);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto &r = results[i];
+        std::printf("    {\n");
+        std::printf(
+            "      \"codec\": \"%s\", \"message\": \"%s\", \"points\": %zu, \"size\": %zu, \"size_check_only\": %s,\n",
+            r.codec,
+            r.message,
+            r.points,
+            r.size,
+            r.size_check_only ? "true" : "false" //
+        );
+        print_measurement("encode", r.encode, r, false);
+        print_measurement("decode", r.decode, r, true);
+        std::printf("    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+
+    return 0;
+}
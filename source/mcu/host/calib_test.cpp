@@ -0,0 +1,133 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/calib.h>
+}
+
+/// Calibration of `main.c`.
+static const CalibTable DEFAULT_CALIB = {{
+    {-130653, 1070, t250ms},
+    {-39390, -2805, t250ms},
+    {12718, 0, 0},
+    {1250, 0, t250ms},
+    {1250, 0, t250ms},
+    {1250, 0, t250ms},
+}};
+
+/// Scaling as it was done by `SCALE` macro of sync generator. Filter is compared to `FILTER` macro in `filter_test.cpp`.
+static int64_t reference_scale(int32_t code, const CalibEntry &entry) {
+    return (int64_t(code - entry.offset) * int64_t(entry.gain)) / 1000000LL;
+}
+
+TEST(Calib, same_as_macros) {
+    static Calib calib;
+    calib_init(&calib, &DEFAULT_CALIB);
+
+    Filter reference[ADC_COUNT];
+    FilterCoef coefs[ADC_COUNT];
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        filter_reset(&reference[i], 0);
+        filter_coef_init(&coefs[i], DEFAULT_CALIB.entries[i].filter);
+    }
+    std::mt19937 rng(0);
+    int32_t ain[ADC_COUNT] = {};
+    for (size_t tick = 0; tick < 100000; ++tick) {
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            // Slow ramp with noise over the whole ADC range.
+            ain[i] = int32_t((tick * (i + 1) * 37) % 0x1000000) - 0x800000 + int32_t(rng() % 2001) - 1000;
+        }
+        calib_process(&calib, ain);
+
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            const CalibEntry &entry = DEFAULT_CALIB.entries[i];
+            int64_t value = reference_scale(ain[i], entry);
+            ASSERT_EQ(calib.values[i], int32_t(value)) << "tick: " << tick << ", channel: " << i;
+            int32_t filtered = filter_update(&reference[i], &coefs[i], int32_t(value));
+            ASSERT_EQ(calib.filtered[i], filtered) << "tick: " << tick << ", channel: " << i;
+            if (entry.filter == 0) {
+                ASSERT_EQ(calib.filtered[i], int32_t(value));
+            }
+        }
+    }
+}
+
+TEST(Calib, filter_settles) {
+    static Calib calib;
+    CalibTable table = {};
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        table.entries[i] = CalibEntry{int32_t(K_SCALE), 0, uint16_t(i * 10)};
+    }
+    calib_init(&calib, &table);
+
+    const int32_t ain[ADC_COUNT] = {1000, -1000, 12345, -12345, 1, 100000};
+    for (size_t tick = 0; tick < 2000; ++tick) {
+        calib_process(&calib, ain);
+    }
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        ASSERT_EQ(calib.values[i], ain[i]);
+        // Fractional bits of filter state keep it from sticking below the input.
+        ASSERT_LE(std::abs(calib.filtered[i] - ain[i]), 1) << "channel: " << i;
+    }
+}
+
+TEST(Calib, write_at_tick_boundary) {
+    static Calib calib;
+    CalibTable first = {}, second = {}, third = {};
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        first.entries[i] = CalibEntry{int32_t(K_SCALE), 0, 0};
+        second.entries[i] = CalibEntry{2 * int32_t(K_SCALE), 1, 0};
+        third.entries[i] = CalibEntry{3 * int32_t(K_SCALE), 0, 0};
+    }
+    calib_init(&calib, &first);
+    const int32_t ain[ADC_COUNT] = {10, 20, 30, 40, 50, 60};
+
+    ASSERT_TRUE(calib_write(&calib, &second));
+    ASSERT_EQ(calib_table(&calib)->entries[0].gain, second.entries[0].gain);
+    // Pending table is not used until taken.
+    calib_process(&calib, ain);
+    ASSERT_EQ(calib.values[0], 10);
+    // The next table is accepted only after the previous one is taken.
+    ASSERT_FALSE(calib_write(&calib, &third));
+    ASSERT_EQ(calib_table(&calib)->entries[0].gain, second.entries[0].gain);
+
+    calib_commit(&calib);
+    calib_process(&calib, ain);
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        ASSERT_EQ(calib.values[i], 2 * (ain[i] - 1));
+    }
+    // Nothing is pending anymore.
+    calib_commit(&calib);
+    ASSERT_EQ(calib.active[0].entry.gain, second.entries[0].gain);
+
+    ASSERT_TRUE(calib_write(&calib, &third));
+    calib_commit(&calib);
+    calib_process(&calib, ain);
+    ASSERT_EQ(calib.values[0], 30);
+}
+
+TEST(Calib, extreme_values) {
+    static Calib calib;
+    CalibTable table = {};
+    table.entries[0] = CalibEntry{int32_t(K_SCALE), INT32_MIN, 0};
+    table.entries[1] = CalibEntry{INT32_MAX, 0, 0};
+    table.entries[2] = CalibEntry{INT32_MIN, 0, 0};
+    table.entries[3] = CalibEntry{-int32_t(K_SCALE), INT32_MAX, 0};
+    calib_init(&calib, &table);
+
+    // Difference of code and offset does not wrap, and scaled values out of range saturate.
+    const int32_t ain[ADC_COUNT] = {INT32_MAX, 1 << 20, 1 << 20, INT32_MIN, 0, 0};
+    calib_process(&calib, ain);
+    ASSERT_EQ(calib.values[0], INT32_MAX);
+    ASSERT_EQ(calib.values[1], INT32_MAX);
+    ASSERT_EQ(calib.values[2], INT32_MIN);
+    ASSERT_EQ(calib.values[3], INT32_MAX);
+    ASSERT_EQ(calib.filtered[0], INT32_MAX);
+
+    // Value in range is exact even with offset at the limit.
+    const int32_t near[ADC_COUNT] = {INT32_MIN + 5, 0, 0, INT32_MAX - 7, 0, 0};
+    calib_process(&calib, near);
+    ASSERT_EQ(calib.values[0], 5);
+    ASSERT_EQ(calib.values[3], 7);
+}
@@ -0,0 +1,294 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/control.h>
+#include <fake_skifio.h>
+}
+
+class ControlSample : public testing::Test {
+protected:
+    static constexpr size_t DAC_CHUNK = 16;
+    static constexpr size_t ADC_CHUNK = 8;
+
+    void SetUp() override {
+        fake_skifio_reset();
+        std::memset(static_cast<void *>(&mps), 0, sizeof(mps));
+        stats_init(&stats);
+
+        control_sync_init(&sync, DAC_CHUNK, ADC_CHUNK);
+        // Test thread is notified instead of RPMSG send task.
+        control_sync_set_task(&sync, xTaskGetCurrentTaskHandle());
+        notified();
+
+        control_init(&control, &stats, &mps);
+        control_set_sync(&control, &sync);
+    }
+    void TearDown() override {
+        control_deinit(&control);
+    }
+
+    /// Take notification without waiting.
+    /// @return Notified `CONTROL_EVENT_*` bits, zero if not notified.
+    uint32_t notified() {
+        uint32_t events = 0;
+        return control_sync_wait(&sync, 0, &events) ? events : 0;
+    }
+
+    PS_Control mps;
+    Statistics stats;
+    ControlSync sync;
+    Control control;
+};
+
+TEST_F(ControlSample, adc_to_ring) {
+    const size_t count = 3 * ADC_CHUNK;
+    for (size_t i = 0; i < count; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_EQ(FAKE_SKIFIO.transfer_count, count);
+    ASSERT_EQ(stats.sample_count, count);
+    ASSERT_EQ(adc_rb_occupied(&control.adc.buffer), count);
+
+    std::vector<AdcArray> adcs(count);
+    ASSERT_EQ(adc_rb_read(&control.adc.buffer, adcs.data(), count), count);
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < ADC_COUNT; ++j) {
+            ASSERT_EQ(adcs[i].points[j], point_t(i * ADC_COUNT + j));
+        }
+    }
+    ASSERT_EQ(stats.adc.values[0].last, point_t((count - 1) * ADC_COUNT));
+}
+
+TEST_F(ControlSample, adc_notify) {
+    // Counter starts from zero, so the first sample notifies.
+    control_sample(&control);
+    ASSERT_EQ(notified(), CONTROL_EVENT_ADC_READY);
+    for (size_t i = 1; i < ADC_CHUNK; ++i) {
+        control_sample(&control);
+        ASSERT_EQ(notified(), 0u);
+    }
+    control_sample(&control);
+    ASSERT_EQ(notified(), CONTROL_EVENT_ADC_READY);
+}
+
+TEST_F(ControlSample, adc_overrun) {
+    // Only part of the buffer is used at default sample rate.
+    const size_t depth = control.adc.depth;
+    ASSERT_LT(depth, size_t(ADC_BUFFER_SIZE));
+    const size_t extra = 5;
+    for (size_t i = 0; i < depth + extra; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_EQ(adc_rb_occupied(&control.adc.buffer), depth);
+    ASSERT_EQ(control.adc.overrun.total, extra);
+    ASSERT_EQ(stats.adc.lost_full, extra);
+
+    // The oldest points are kept.
+    AdcArray first;
+    ASSERT_EQ(adc_rb_read(&control.adc.buffer, &first, 1), 1u);
+    ASSERT_EQ(first.points[0], 0);
+
+    // Lost points are recorded before the next written one, so the buffered points are read without a gap.
+    control_sample(&control);
+    const size_t position = adc_rb_read_position(&control.adc.buffer);
+    size_t len = depth;
+    ASSERT_EQ(overrun_log_read(&control.adc.overrun, position, &len), 0u);
+    ASSERT_EQ(len, depth - 1);
+    ASSERT_EQ(adc_rb_skip(&control.adc.buffer, len), len);
+    len = depth;
+    ASSERT_EQ(overrun_log_read(&control.adc.overrun, position + depth - 1, &len), extra);
+    ASSERT_EQ(len, depth);
+    AdcArray next;
+    ASSERT_EQ(adc_rb_read(&control.adc.buffer, &next, 1), 1u);
+    ASSERT_EQ(next.points[0], point_t((depth + extra) * ADC_COUNT));
+}
+
+TEST_F(ControlSample, adc_depth_change) {
+    SampleRate rate;
+    ASSERT_TRUE(sample_rate_init(&rate, 5000));
+    control_set_sample_rate(&control, &rate);
+    for (size_t i = 0; i < rate.adc_depth + 1; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_EQ(adc_rb_occupied(&control.adc.buffer), rate.adc_depth);
+    ASSERT_EQ(stats.adc.lost_full, 1u);
+
+    // Buffered points are kept when depth grows.
+    ASSERT_TRUE(sample_rate_init(&rate, SAMPLE_FREQ_MAX_HZ));
+    control_set_sample_rate(&control, &rate);
+    control_sample(&control);
+    ASSERT_EQ(adc_rb_occupied(&control.adc.buffer), 5000 * ADC_BUFFER_TIME_MS / 1000 + 1);
+    ASSERT_EQ(stats.adc.lost_full, 1u);
+}
+
+TEST_F(ControlSample, adc_decimation) {
+    const size_t ratio = 4;
+    control_set_adc_decimation(&control, ratio);
+    // Ratio is applied after the current output point, so the first point is not decimated.
+    control_sample(&control);
+    ASSERT_EQ(adc_rb_occupied(&control.adc.buffer), 1u);
+
+    const size_t count = 3;
+    for (size_t i = 0; i < count * ratio; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_EQ(adc_rb_occupied(&control.adc.buffer), 1 + count);
+    // Statistics are still collected for each sample.
+    ASSERT_EQ(stats.adc.values[0].count, 1 + count * ratio);
+
+    std::vector<AdcArray> adcs(1 + count);
+    ASSERT_EQ(adc_rb_read(&control.adc.buffer, adcs.data(), adcs.size()), adcs.size());
+    for (size_t i = 0; i < count; ++i) {
+        // Fake board returns linearly growing values, so the average is the value in the middle.
+        const double first = double(1 + i * ratio);
+        for (size_t j = 0; j < ADC_COUNT; ++j) {
+            const double mean = (first + double(ratio - 1) / 2) * ADC_COUNT + double(j);
+            ASSERT_EQ(adcs[1 + i].points[j], point_t(std::lround(mean)));
+        }
+    }
+}
+
+TEST_F(ControlSample, adc_decimation_notify) {
+    control_set_adc_decimation(&control, 2);
+    control_sample(&control);
+    ASSERT_EQ(notified(), CONTROL_EVENT_ADC_READY);
+    // Notification counter counts decimated points.
+    for (size_t i = 0; i < 2 * ADC_CHUNK - 1; ++i) {
+        control_sample(&control);
+        ASSERT_EQ(notified(), 0u);
+    }
+    control_sample(&control);
+    ASSERT_EQ(notified(), CONTROL_EVENT_ADC_READY);
+}
+
+TEST_F(ControlSample, dac_from_ring) {
+    std::vector<point_t> points = {10, 20, 30};
+    ASSERT_EQ(dac_rb_write(&control.dac.buffer, points.data(), points.size()), points.size());
+
+    // DAC points are not consumed until started.
+    control_sample(&control);
+    ASSERT_EQ(dac_rb_occupied(&control.dac.buffer), points.size());
+
+    control_dac_start(&control);
+    for (size_t i = 0; i < points.size(); ++i) {
+        control_sample(&control);
+        ASSERT_EQ(control.dac.last_point, points[i]);
+    }
+    ASSERT_EQ(dac_rb_occupied(&control.dac.buffer), 0u);
+    ASSERT_EQ(stats.dac.lost_empty, 0u);
+
+    // Last point is held when the buffer is empty.
+    control_sample(&control);
+    ASSERT_EQ(control.dac.last_point, points.back());
+    ASSERT_EQ(stats.dac.lost_empty, 1u);
+}
+
+TEST_F(ControlSample, dac_upsampling) {
+    control_set_dac_upsampling(&control, 3);
+    std::vector<point_t> points = {10, 20};
+    ASSERT_EQ(dac_rb_write(&control.dac.buffer, points.data(), points.size()), points.size());
+
+    control_dac_start(&control);
+    for (size_t i = 0; i < 3 * points.size(); ++i) {
+        control_sample(&control);
+        ASSERT_EQ(control.dac.last_point, points[i / 3]);
+        ASSERT_EQ(dac_rb_occupied(&control.dac.buffer), points.size() - 1 - i / 3);
+    }
+    // Held samples are not counted as lost.
+    ASSERT_EQ(stats.dac.lost_empty, 0u);
+
+    // New ratio is applied after the next point.
+    control_set_dac_upsampling(&control, 1);
+    point_t point = 30;
+    ASSERT_EQ(dac_rb_write(&control.dac.buffer, &point, 1), 1u);
+    control_sample(&control);
+    ASSERT_EQ(control.dac.last_point, point);
+    control_sample(&control);
+    ASSERT_EQ(stats.dac.lost_empty, 1u);
+}
+
+TEST_F(ControlSample, crc_error) {
+    FAKE_SKIFIO.transfer_ret = HAL_INVALID_DATA;
+    control_sample(&control);
+    control_sample(&control);
+    ASSERT_EQ(stats.crc_error_count, 1u);
+    ASSERT_EQ(adc_rb_occupied(&control.adc.buffer), 2u);
+}
+
+TEST_F(ControlSample, dio) {
+    FAKE_SKIFIO.din = 0x5;
+    control_sample(&control);
+    ASSERT_EQ(control.dio.in, 0x5);
+    ASSERT_EQ(notified(), CONTROL_EVENT_DIN_CHANGED | CONTROL_EVENT_ADC_READY);
+
+    // Posted discrete output change is taken by the next sample.
+    control.dio.out = 0x3;
+    control_sync_post(&sync, CONTROL_EVENT_DOUT_CHANGED);
+    ASSERT_EQ(sync.control_events, CONTROL_EVENT_DOUT_CHANGED);
+    control_sample(&control);
+    ASSERT_EQ(sync.control_events, 0u);
+}
+
+TEST_F(ControlSample, dac_notify) {
+    std::vector<point_t> points(2 * DAC_CHUNK, 0);
+    ASSERT_EQ(dac_rb_write(&control.dac.buffer, points.data(), points.size()), points.size());
+    control_dac_start(&control);
+    // Each event is notified separately, so the send task services only what is pending.
+    control_sample(&control);
+    ASSERT_EQ(notified(), CONTROL_EVENT_DAC_SPACE | CONTROL_EVENT_ADC_READY);
+    for (size_t i = 1; i < ADC_CHUNK; ++i) {
+        control_sample(&control);
+        ASSERT_EQ(notified(), 0u);
+    }
+    control_sample(&control);
+    ASSERT_EQ(notified(), CONTROL_EVENT_ADC_READY);
+    for (size_t i = ADC_CHUNK + 1; i < DAC_CHUNK; ++i) {
+        control_sample(&control);
+        notified();
+    }
+    control_sample(&control);
+    ASSERT_EQ(notified() & CONTROL_EVENT_DAC_SPACE, CONTROL_EVENT_DAC_SPACE);
+}
+
+TEST_F(ControlSample, notify_latency) {
+    // Later notification of one event does not hide how long the other one has been pending.
+    control_sync_notify(&sync, CONTROL_EVENT_ADC_READY);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    control_sync_notify(&sync, CONTROL_EVENT_DIN_CHANGED);
+    const uint32_t events = notified();
+    ASSERT_EQ(events, CONTROL_EVENT_ADC_READY | CONTROL_EVENT_DIN_CHANGED);
+    ASSERT_GE(control_sync_latency(&sync, events), 5u * 1000u * CYCLES_PER_US);
+    ASSERT_LT(control_sync_latency(&sync, CONTROL_EVENT_DIN_CHANGED), 5u * 1000u * CYCLES_PER_US);
+}
+
+TEST(SampleRate, derived) {
+    SampleRate rate;
+    ASSERT_TRUE(sample_rate_init(&rate, 10000));
+    ASSERT_EQ(rate.freq_hz, 10000u);
+    ASSERT_EQ(rate.period_us, 100u);
+    ASSERT_EQ(rate.dac_depth, size_t(10000 * DAC_BUFFER_TIME_MS / 1000));
+    ASSERT_EQ(rate.adc_depth, size_t(10000 * ADC_BUFFER_TIME_MS / 1000));
+    ASSERT_EQ(rate.adc_batch, size_t(10000 / ADC_MSG_RATE_HZ));
+
+    // Buffered time is the same at the highest rate.
+    ASSERT_TRUE(sample_rate_init(&rate, SAMPLE_FREQ_MAX_HZ));
+    ASSERT_EQ(rate.period_us, 50u);
+    ASSERT_EQ(rate.dac_depth, size_t(SAMPLE_FREQ_MAX_HZ * DAC_BUFFER_TIME_MS / 1000));
+    ASSERT_EQ(rate.adc_depth, size_t(SAMPLE_FREQ_MAX_HZ * ADC_BUFFER_TIME_MS / 1000));
+    ASSERT_FALSE(sample_rate_init(&rate, 50000));
+}
+
+TEST(SampleRate, unsupported) {
+    SampleRate rate;
+    ASSERT_TRUE(sample_rate_init(&rate, 5000));
+    ASSERT_FALSE(sample_rate_init(&rate, 0));
+    ASSERT_FALSE(sample_rate_init(&rate, 12345));
+    // Rate is left untouched.
+    ASSERT_EQ(rate.freq_hz, 5000u);
+}
@@ -0,0 +1,52 @@
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <utils/crc.h>
+}
+
+static uint16_t crc16(const std::vector<uint8_t> &data) {
+    return calculate_crc16(data.data(), data.size());
+}
+
+TEST(Crc16, check_value) {
+    const char *text = "123456789";
+    std::vector<uint8_t> data(text, text + std::strlen(text));
+    // Standard check value of CRC-16/CCITT-FALSE.
+    ASSERT_EQ(crc16(data), 0x29B1);
+    ASSERT_EQ(calculate_crc16_bytewise(data.data(), data.size()), 0x29B1);
+}
+
+TEST(Crc16, empty) {
+    ASSERT_EQ(calculate_crc16(nullptr, 0), 0xFFFF);
+}
+
+TEST(Crc16, same_as_bytewise) {
+    std::mt19937 rng(0);
+    // All lengths around slicing boundaries, including SkifIO frame parts.
+    for (size_t len = 0; len <= 64; ++len) {
+        for (size_t i = 0; i < 16; ++i) {
+            std::vector<uint8_t> data(len);
+            for (auto &byte : data) {
+                byte = uint8_t(rng());
+            }
+            ASSERT_EQ(crc16(data), calculate_crc16_bytewise(data.data(), data.size())) << "len: " << len;
+        }
+    }
+}
+
+TEST(Crc16, detects_single_bit_errors) {
+    std::vector<uint8_t> data(24);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t(i * 37);
+    }
+    const uint16_t crc = crc16(data);
+    for (size_t bit = 0; bit < data.size() * 8; ++bit) {
+        data[bit / 8] ^= uint8_t(1 << (bit % 8));
+        ASSERT_NE(crc16(data), crc) << "bit: " << bit;
+        data[bit / 8] ^= uint8_t(1 << (bit % 8));
+    }
+}
@@ -0,0 +1,40 @@
+// Fake SkifIO board for host tests. Implements `drivers/skifio.h` API and exposes its state.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include <drivers/skifio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Fill ADC values for next transfer.
+typedef void (*FakeSkifioAdcSource)(void *, uint64_t, SkifioInput *);
+
+typedef struct {
+    /// DAC value passed to the last transfer.
+    SkifioAout last_dac;
+    /// Number of transfers done.
+    uint64_t transfer_count;
+
+    /// If not set, ADC channel `i` of transfer `n` is equal to `n * ADC_COUNT + i`.
+    FakeSkifioAdcSource adc_source;
+    void *adc_source_data;
+
+    SkifioDin din;
+    SkifioDout dout;
+    bool dac_enabled;
+
+    /// Value returned by the next transfer, e.g. `HAL_INVALID_DATA` to emulate CRC error. Reset after transfer.
+    hal_retcode transfer_ret;
+} FakeSkifio;
+
+extern FakeSkifio FAKE_SKIFIO;
+
+void fake_skifio_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,131 @@
+#include "fake_skifio.h"
+
+#include <string.h>
+
+FakeSkifio FAKE_SKIFIO;
+_SkifioDebugInfo _SKIFIO_DEBUG_INFO;
+
+static SkifioDinCallback DIN_CALLBACK = NULL;
+static void *DIN_CALLBACK_DATA = NULL;
+
+#ifdef SKIFIO_DMA
+static SkifioOutput PREPARED;
+static SkifioOutput IN_FLIGHT;
+static bool STARTED = false;
+static SkifioInput RECEIVED;
+#endif
+
+void fake_skifio_reset(void) {
+    memset(&FAKE_SKIFIO, 0, sizeof(FAKE_SKIFIO));
+    FAKE_SKIFIO.transfer_ret = HAL_SUCCESS;
+    _SKIFIO_DEBUG_INFO.intr_count = 0;
+    DIN_CALLBACK = NULL;
+    DIN_CALLBACK_DATA = NULL;
+#ifdef SKIFIO_DMA
+    memset(&PREPARED, 0, sizeof(PREPARED));
+    STARTED = false;
+#endif
+}
+
+hal_retcode skifio_init() {
+    fake_skifio_reset();
+    return HAL_SUCCESS;
+}
+
+hal_retcode skifio_deinit() {
+    return HAL_SUCCESS;
+}
+
+size_t skifio_readFlag(size_t Flag) {
+    return 0;
+}
+
+hal_retcode skifio_dac_enable() {
+    FAKE_SKIFIO.dac_enabled = true;
+    return HAL_SUCCESS;
+}
+
+hal_retcode skifio_dac_disable() {
+    FAKE_SKIFIO.dac_enabled = false;
+    return HAL_SUCCESS;
+}
+
+hal_retcode skifio_transfer(const SkifioOutput *out, SkifioInput *in) {
+    FAKE_SKIFIO.last_dac = out->dac;
+    if (FAKE_SKIFIO.adc_source != NULL) {
+        FAKE_SKIFIO.adc_source(FAKE_SKIFIO.adc_source_data, FAKE_SKIFIO.transfer_count, in);
+    } else {
+        for (size_t i = 0; i < SKIFIO_ADC_CHANNEL_COUNT; ++i) {
+            in->adcs[i] = (SkifioAin)(FAKE_SKIFIO.transfer_count * SKIFIO_ADC_CHANNEL_COUNT + i);
+        }
+    }
+    FAKE_SKIFIO.transfer_count += 1;
+
+    hal_retcode ret = FAKE_SKIFIO.transfer_ret;
+    FAKE_SKIFIO.transfer_ret = HAL_SUCCESS;
+    return ret;
+}
+
+#ifdef SKIFIO_DMA
+hal_retcode skifio_transfer_prepare(const SkifioOutput *out) {
+    PREPARED = *out;
+    return HAL_SUCCESS;
+}
+
+hal_retcode skifio_transfer_start(void) {
+    if (STARTED) {
+        return HAL_FAILURE;
+    }
+    IN_FLIGHT = PREPARED;
+    STARTED = true;
+    return HAL_SUCCESS;
+}
+
+hal_retcode skifio_transfer_wait(const SkifioInput **in) {
+    *in = NULL;
+    if (!STARTED) {
+        return HAL_FAILURE;
+    }
+    STARTED = false;
+    hal_retcode ret = skifio_transfer(&IN_FLIGHT, &RECEIVED);
+    *in = &RECEIVED;
+    return ret;
+}
+#endif
+
+size_t skifio_force_data_ready(void) {
+    return 0;
+}
+
+void skifio_sync_tick(void) {}
+
+hal_retcode skifio_wait_ready(uint32_t delay_ms) {
+    // Sample period is emulated by the caller, so the board is always ready.
+    _SKIFIO_DEBUG_INFO.intr_count += 1;
+    return HAL_SUCCESS;
+}
+
+uint32_t skifio_ready_latency(void) {
+    return 0;
+}
+
+hal_retcode skifio_dout_write(SkifioDout value) {
+    FAKE_SKIFIO.dout = value;
+    return HAL_SUCCESS;
+}
+
+SkifioDin skifio_din_read() {
+    return FAKE_SKIFIO.din;
+}
+
+hal_retcode skifio_din_subscribe(SkifioDinCallback callback, void *data) {
+    DIN_CALLBACK = callback;
+    DIN_CALLBACK_DATA = data;
+    return HAL_SUCCESS;
+}
+
+hal_retcode skifio_din_unsubscribe() {
+    DIN_CALLBACK = NULL;
+    DIN_CALLBACK_DATA = NULL;
+    return HAL_SUCCESS;
+}
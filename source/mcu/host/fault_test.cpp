@@ -0,0 +1,155 @@
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/fault.h>
+}
+
+static const FaultLimits LIMITS = {{
+    {1000, 3},
+    {2000, 1},
+    {800, 0},
+    {100, 5},
+}};
+
+/// Values of a tick with only `check` set to `value`.
+struct Values {
+    int32_t data[FAULT_CHECK_COUNT] = {};
+
+    Values() = default;
+    Values(size_t check, int32_t value) {
+        data[check] = value;
+    }
+};
+
+TEST(Fault, persistence) {
+    static FaultMonitor fault;
+    fault_init(&fault, &LIMITS);
+
+    // Value at the limit does not fail, interrupted run of failed ticks starts over.
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 1000).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 1001).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, -1001).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values().data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 1001).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 1002).data), 0u);
+    // Trips at the third tick in a row and stays tripped while over the limit.
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, -1003).data), 1u << FAULT_CHECK_IOUT);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 1004).data), 1u << FAULT_CHECK_IOUT);
+    ASSERT_EQ(fault_check(&fault, Values().data), 0u);
+
+    // Disabled check never trips.
+    for (size_t i = 0; i < 10; ++i) {
+        ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_HEATSINK, INT32_MAX).data), 0u);
+    }
+    // Extreme value does not overflow.
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_VOUT, INT32_MIN).data), 1u << FAULT_CHECK_VOUT);
+}
+
+TEST(Fault, first_fault_latch) {
+    static FaultMonitor fault;
+    fault_init(&fault, &LIMITS);
+    FaultRecord record;
+    ASSERT_FALSE(fault_take(&fault, &record));
+
+    for (size_t i = 0; i < 10; ++i) {
+        fault_check(&fault, Values().data);
+    }
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_VOUT, 2500).data), 1u << FAULT_CHECK_VOUT);
+    // Faults after the first one are not latched until release.
+    fault_trip(&fault, FAULT_DCCT);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_VOUT, 3000).data), 1u << FAULT_CHECK_VOUT);
+
+    ASSERT_TRUE(fault_take(&fault, &record));
+    ASSERT_EQ(record.code, uint32_t(FAULT_OVERVOLTAGE));
+    ASSERT_EQ(record.tick, 11u);
+    ASSERT_EQ(record.value, 2500);
+    ASSERT_EQ(record.latency, 0u);
+    ASSERT_EQ(record.count, 1u);
+    ASSERT_FALSE(fault_take(&fault, &record));
+
+    // The next episode.
+    fault_release(&fault);
+    fault_check(&fault, Values().data);
+    fault_trip(&fault, FAULT_EXT_LOCK1);
+    ASSERT_TRUE(fault_take(&fault, &record));
+    ASSERT_EQ(record.code, uint32_t(FAULT_EXT_LOCK1));
+    ASSERT_EQ(record.tick, 13u);
+    ASSERT_EQ(record.value, 0);
+    ASSERT_EQ(record.count, 2u);
+}
+
+TEST(Fault, trip_latency) {
+    static FaultMonitor fault;
+    fault_init(&fault, &LIMITS);
+    // Reference is lost at tick 1, fault trips after persistence.
+    uint32_t tripped = 0;
+    uint64_t tick = 0;
+    while (tripped == 0) {
+        tick += 1;
+        tripped = fault_check(&fault, Values(FAULT_CHECK_FB_ERROR, -500).data);
+    }
+    ASSERT_EQ(tripped, 1u << FAULT_CHECK_FB_ERROR);
+    ASSERT_EQ(tick, 5u);
+
+    FaultRecord record;
+    ASSERT_TRUE(fault_take(&fault, &record));
+    ASSERT_EQ(record.code, uint32_t(FAULT_FB_LOST));
+    ASSERT_EQ(record.tick, tick);
+    ASSERT_EQ(record.latency, 4u);
+    ASSERT_EQ(record.value, -500);
+}
+
+TEST(Fault, report_not_taken) {
+    static FaultMonitor fault;
+    fault_init(&fault, &LIMITS);
+    fault_trip(&fault, FAULT_BOARD);
+    fault_release(&fault);
+    fault_trip(&fault, FAULT_DCCT);
+    // Report of the second episode is lost, the first one is kept.
+    ASSERT_EQ(fault.lost_count, 1u);
+    FaultRecord record;
+    ASSERT_TRUE(fault_take(&fault, &record));
+    ASSERT_EQ(record.code, uint32_t(FAULT_BOARD));
+    ASSERT_EQ(record.count, 1u);
+}
+
+TEST(Fault, staged_limits) {
+    static FaultMonitor fault;
+    fault_init(&fault, &LIMITS);
+
+    FaultLimits limits = LIMITS;
+    limits.thresholds[FAULT_CHECK_IOUT] = {500, 3};
+    ASSERT_TRUE(fault_write_limits(&fault, &limits));
+    // The next write waits until the previous one is committed.
+    ASSERT_FALSE(fault_write_limits(&fault, &limits));
+    ASSERT_EQ(fault_limits(&fault)->thresholds[FAULT_CHECK_IOUT].limit, 500);
+
+    // Limits in effect are not changed until commit.
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 600).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 1001).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 1001).data), 0u);
+
+    // Failed ticks counted with the old limits start over.
+    fault_commit(&fault);
+    ASSERT_TRUE(fault_write_limits(&fault, &limits));
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 600).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 600).data), 0u);
+    ASSERT_EQ(fault_check(&fault, Values(FAULT_CHECK_IOUT, 600).data), 1u << FAULT_CHECK_IOUT);
+}
+
+TEST(Fault, adc_index) {
+    static FaultMonitor fault;
+    fault_init(&fault, &LIMITS);
+    volatile uint32_t adc_index = 41;
+    fault_set_adc_index(&fault, &adc_index);
+
+    fault_check(&fault, Values().data);
+    adc_index = 42;
+    fault_trip(&fault, FAULT_DCCT);
+    adc_index = 43;
+    FaultRecord record;
+    ASSERT_TRUE(fault_take(&fault, &record));
+    ASSERT_EQ(record.adc_index, 42u);
+}
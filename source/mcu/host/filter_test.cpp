@@ -0,0 +1,139 @@
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <utils/filter.h>
+}
+
+/// Filter as it was done by `FILTER` macro of sync generator: 64-bit division with remainder accumulation.
+struct MacroFilter {
+    int32_t val = 0;
+    int32_t add = 0;
+
+    int32_t update(int64_t value, int64_t t) {
+        val = int32_t((int64_t(val) * t + value) / (t + 1));
+        add += int32_t((val * t + value) % (t + 1));
+        if (add > (t + 1)) {
+            val++;
+            add -= int32_t(t + 1);
+        }
+        if (add < -(t + 1)) {
+            val--;
+            add += int32_t(t + 1);
+        }
+        return val;
+    }
+};
+
+/// Step response from zero to `step` over `ticks` ticks.
+struct StepResponse {
+    std::vector<int32_t> filter;
+    std::vector<int32_t> macro;
+};
+
+static StepResponse step_response(uint32_t t, int32_t step, size_t ticks) {
+    FilterCoef coef;
+    filter_coef_init(&coef, t);
+    Filter filter;
+    filter_reset(&filter, 0);
+    MacroFilter macro;
+
+    StepResponse response;
+    for (size_t i = 0; i < ticks; ++i) {
+        response.filter.push_back(filter_update(&filter, &coef, step));
+        response.macro.push_back(macro.update(step, t));
+    }
+    return response;
+}
+
+/// Index of the first tick that reached 63.2% of step, that is one time constant.
+static size_t rise_time(const std::vector<int32_t> &values, int32_t step) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (std::abs(int64_t(values[i])) * 1000 >= std::abs(int64_t(step)) * 632) {
+            return i + 1;
+        }
+    }
+    return values.size();
+}
+
+TEST(Filter, step_response_as_macro) {
+    for (uint32_t t : {1, 3, 24, 249, 1023}) {
+        for (int32_t step : {10000, -10000}) {
+            const auto response = step_response(t, step, 10 * (t + 1));
+            for (size_t i = 0; i < response.filter.size(); ++i) {
+                ASSERT_LE(std::abs(response.filter[i] - response.macro[i]), 3) << "t: " << t << ", tick: " << i;
+            }
+            const size_t rise = rise_time(response.filter, step);
+            ASSERT_LE(std::abs(int64_t(rise) - int64_t(rise_time(response.macro, step))), 1) << "t: " << t;
+            ASSERT_LE(std::abs(int64_t(rise) - int64_t(t + 1)), 1) << "t: " << t;
+        }
+    }
+}
+
+TEST(Filter, small_step) {
+    // Macro lags on steps of a few units because of remainder accumulation, the filter does not.
+    for (uint32_t t : {24, 249, 1023}) {
+        const int32_t step = 7;
+        const auto response = step_response(t, step, 10 * (t + 1));
+        ASSERT_LE(rise_time(response.filter, step), rise_time(response.macro, step)) << "t: " << t;
+        ASSERT_LE(rise_time(response.filter, step), (t + 1) * 11 / 10) << "t: " << t;
+    }
+}
+
+TEST(Filter, settles) {
+    for (uint32_t t : {1, 24, 249, 1000, 8191, 65535}) {
+        FilterCoef coef;
+        filter_coef_init(&coef, t);
+        for (int32_t value : {7, -7, 10000, -1500000, 1 << 30}) {
+            Filter filter;
+            filter_reset(&filter, 0);
+            int32_t output = 0;
+            for (size_t i = 0; i < 30 * (t + 1); ++i) {
+                output = filter_update(&filter, &coef, value);
+            }
+            if (t <= 8191) {
+                ASSERT_EQ(output, value) << "t: " << t;
+            } else {
+                ASSERT_LE(std::abs(output - value), 2) << "t: " << t;
+            }
+        }
+    }
+}
+
+TEST(Filter, pass_through) {
+    FilterCoef coef;
+    filter_coef_init(&coef, 0);
+    Filter filter;
+    filter_reset(&filter, 0);
+    for (int32_t value : {1, -1, 12345, INT32_MAX, INT32_MIN, 0}) {
+        ASSERT_EQ(filter_update(&filter, &coef, value), value);
+    }
+}
+
+TEST(Filter, full_range) {
+    for (uint32_t t : {1, FILTER_TIME_CONSTANT_MAX}) {
+        FilterCoef coef;
+        filter_coef_init(&coef, t);
+        Filter filter;
+        filter_reset(&filter, INT32_MIN);
+        // Output rises monotonically without overflow.
+        int32_t prev = INT32_MIN;
+        for (size_t i = 0; i < 100; ++i) {
+            int32_t output = filter_update(&filter, &coef, INT32_MAX);
+            ASSERT_GE(output, prev) << "t: " << t;
+            prev = output;
+        }
+        ASSERT_GT(prev, t == 1 ? INT32_MAX - 2 : INT32_MIN);
+    }
+}
+
+TEST(Filter, power_of_two_exact) {
+    for (uint32_t shift = 0; shift <= FILTER_COEF_BITS; ++shift) {
+        FilterCoef coef;
+        filter_coef_init(&coef, (1u << shift) - 1);
+        ASSERT_EQ(coef.coef, 1 << (FILTER_COEF_BITS - shift));
+    }
+}
@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <utils/fixed.h>
+}
+
+static std::vector<uint64_t> divisors() {
+    // Divisors of sync generator and control tasks, powers of two and their neighbours, extremes.
+    std::vector<uint64_t> divs = {1, 3, 5, 7, 10, 100, 250, 80000, 1000000, 1000000007, INT64_MAX};
+    for (size_t i = 1; i < 63; ++i) {
+        uint64_t p = uint64_t(1) << i;
+        divs.insert(divs.end(), {p - 1, p, p + 1});
+    }
+    std::mt19937_64 rng(0);
+    for (size_t i = 0; i < 64; ++i) {
+        divs.push_back(rng() >> (1 + rng() % 63));
+    }
+    return divs;
+}
+
+static std::vector<int64_t> dividends(uint64_t div, std::mt19937_64 &rng) {
+    std::vector<int64_t> ns = {0, 1, -1, INT64_MAX, INT64_MIN, INT64_MAX - 1, INT64_MIN + 1};
+    // Around multiples of divisor, where rounding errors show up first.
+    for (uint64_t k : {uint64_t(1), uint64_t(2), uint64_t(3), uint64_t(INT64_MAX) / div}) {
+        if (k > uint64_t(INT64_MAX) / div) {
+            continue;
+        }
+        int64_t m = int64_t(k * div);
+        for (int64_t d : {-1, 0, 1}) {
+            if (d <= 0 || m < INT64_MAX) {
+                ns.insert(ns.end(), {m + d, -(m + d)});
+            }
+        }
+    }
+    for (size_t i = 0; i < 256; ++i) {
+        // Random magnitudes of all lengths.
+        ns.push_back(int64_t(rng()) >> (rng() % 64));
+    }
+    return ns;
+}
+
+TEST(Fixed, div_s64_exact) {
+    std::mt19937_64 rng(1);
+    for (uint64_t div : divisors()) {
+        if (div == 0) {
+            continue;
+        }
+        FixedDiv fd;
+        fixed_div_init(&fd, div);
+        const int64_t d = int64_t(div);
+        for (int64_t n : dividends(div, rng)) {
+            ASSERT_EQ(fixed_div_s64(&fd, n), n / d) << "n: " << n << ", d: " << d;
+            ASSERT_EQ(fixed_mod_s64(&fd, n), n % d) << "n: " << n << ", d: " << d;
+        }
+    }
+}
+
+TEST(Fixed, div_u64_exact) {
+    std::mt19937_64 rng(2);
+    for (uint64_t div : divisors()) {
+        if (div == 0) {
+            continue;
+        }
+        FixedDiv fd;
+        fixed_div_init(&fd, div);
+        for (uint64_t n : {uint64_t(0), div - 1, div, std::numeric_limits<uint64_t>::max()}) {
+            ASSERT_EQ(fixed_div_u64(&fd, n), n / div) << "n: " << n << ", d: " << div;
+        }
+        for (size_t i = 0; i < 256; ++i) {
+            uint64_t n = rng();
+            ASSERT_EQ(fixed_div_u64(&fd, n), n / div) << "n: " << n << ", d: " << div;
+        }
+    }
+}
+
+TEST(Fixed, regulator_ranges) {
+    // Exhaustive check of `FILTER` and `SCALE` dividends for small ADC codes with real coefficients.
+    FixedDiv filter, scale;
+    fixed_div_init(&filter, 250);
+    fixed_div_init(&scale, 1000000);
+    for (int64_t a = -(1 << 20); a <= (1 << 20); ++a) {
+        ASSERT_EQ(fixed_div_s64(&filter, a * 249), a * 249 / 250);
+        ASSERT_EQ(fixed_mod_s64(&filter, a * 249), a * 249 % 250);
+        ASSERT_EQ(fixed_div_s64(&scale, a * -130653), a * -130653 / 1000000);
+    }
+}
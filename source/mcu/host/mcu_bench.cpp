@@ -0,0 +1,438 @@
+// Measures hot paths of MCU tasks on host: ring buffer transfer in the same patterns as control and RPMSG tasks use,
+// and the whole control sample handling with its stages measured by timing probes. Results are printed as JSON.
+//
+// With `max-rate` argument runs RPMSG tasks against emulated app at each supported sample rate instead
+// and finds the maximum rate that is sustained without DAC or ADC points lost.
+//
+// NOTE: Absolute numbers are not representative for MCU, use them only to compare changes.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <tasks/control.h>
+#include <tasks/rpmsg.h>
+#include <utils/crc.h>
+#include <utils/filter.h>
+#include <utils/fixed.h>
+#include <fake_skifio.h>
+}
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t ITERATIONS = 1000;
+static constexpr size_t WARMUP = 10;
+
+/// Prevent compiler from optimizing out computation of `value`.
+template <typename T>
+static void do_not_optimize(T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// @return Nanoseconds per item.
+static double measure(size_t items_per_iter, const std::function<void()> &op) {
+    for (size_t i = 0; i < WARMUP; ++i) {
+        op();
+    }
+    auto start = Clock::now();
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        op();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return elapsed / double(ITERATIONS * items_per_iter);
+}
+
+static int bench_hot_paths() {
+    static DacRingBuffer dac_rb;
+    static AdcRingBuffer adc_rb;
+    dac_rb_init(&dac_rb);
+    adc_rb_init(&adc_rb);
+
+    // DAC: RPMSG task writes whole messages, control task reads points one by one.
+    const size_t dac_chunk = DAC_MSG_MAX_POINTS;
+    std::vector<point_t> dac_msg(dac_chunk, 0x1234);
+    double dac_ns = measure(dac_chunk, [&]() {
+        dac_rb_write(&dac_rb, dac_msg.data(), dac_chunk);
+        for (size_t i = 0; i < dac_chunk; ++i) {
+            const point_t *slot = nullptr;
+            if (dac_rb_read_peek_contiguous(&dac_rb, &slot) >= 1) {
+                point_t value = *slot;
+                do_not_optimize(value);
+                dac_rb_read_commit(&dac_rb, 1);
+            }
+        }
+    });
+
+    // ADC: control task writes points one by one in place, RPMSG task reads whole messages.
+    const size_t adc_chunk = ADC_MSG_MAX_POINTS;
+    std::vector<AdcArray> adc_msg(adc_chunk);
+    double adc_ns = measure(adc_chunk, [&]() {
+        for (size_t i = 0; i < adc_chunk; ++i) {
+            AdcArray *slot = nullptr;
+            if (adc_rb_write_peek_contiguous(&adc_rb, &slot) >= 1) {
+                for (size_t j = 0; j < ADC_COUNT; ++j) {
+                    slot->points[j] = point_t(i + j);
+                }
+                adc_rb_write_commit(&adc_rb, 1);
+            }
+        }
+        adc_rb_read(&adc_rb, adc_msg.data(), adc_chunk);
+        do_not_optimize(adc_msg);
+    });
+
+    // Control sample with running DAC. Rings are drained between iterations like RPMSG task does.
+    static PS_Control mps;
+    static Statistics stats;
+    static Control control;
+    static ControlSync sync;
+    std::memset(static_cast<void *>(&mps), 0, sizeof(mps));
+    fake_skifio_reset();
+    stats_init(&stats);
+    control_sync_init(&sync, DAC_MSG_MAX_POINTS, ADC_MSG_MAX_POINTS);
+    control_init(&control, &stats, &mps);
+    control_set_sync(&control, &sync);
+    control_dac_start(&control);
+    double sample_ns = measure(adc_chunk, [&]() {
+        dac_rb_write(&control.dac.buffer, dac_msg.data(), adc_chunk);
+        for (size_t i = 0; i < adc_chunk; ++i) {
+            control_sample(&control);
+        }
+        adc_rb_read(&control.adc.buffer, adc_msg.data(), adc_chunk);
+    });
+    control_deinit(&control);
+
+    // CRC16 of SkifIO frame parts: magic with DAC value on TX, ADC values on RX.
+    static constexpr size_t CRC_TX_LEN = 4;
+    static constexpr size_t CRC_RX_LEN = ADC_COUNT * sizeof(point_t);
+    static constexpr size_t CRC_REPEAT = 100;
+    uint8_t crc_data[CRC_RX_LEN];
+    for (size_t i = 0; i < CRC_RX_LEN; ++i) {
+        crc_data[i] = uint8_t(i * 37);
+    }
+    auto measure_crc = [&](uint16_t (*crc)(const uint8_t *, size_t), size_t len) {
+        return measure(CRC_REPEAT, [&]() {
+            for (size_t i = 0; i < CRC_REPEAT; ++i) {
+                do_not_optimize(crc_data);
+                uint16_t value = crc(crc_data, len);
+                do_not_optimize(value);
+            }
+        });
+    };
+    double crc_tx_bytewise_ns = measure_crc(calculate_crc16_bytewise, CRC_TX_LEN);
+    double crc_tx_ns = measure_crc(calculate_crc16, CRC_TX_LEN);
+    double crc_rx_bytewise_ns = measure_crc(calculate_crc16_bytewise, CRC_RX_LEN);
+    double crc_rx_ns = measure_crc(calculate_crc16, CRC_RX_LEN);
+
+    // Signed 64-bit division by regulator constant. Divisor is opaque to compiler, like on MCU where it is not
+    // known at compile time or division is a library call anyway. Host CPU has hardware division, so the gain is lower.
+    static constexpr size_t DIV_REPEAT = 100;
+    volatile int64_t div_divisor = K_SCALE;
+    FixedDiv fixed_divisor;
+    fixed_div_init(&fixed_divisor, uint64_t(div_divisor));
+    int64_t div_dividends[DIV_REPEAT];
+    for (size_t i = 0; i < DIV_REPEAT; ++i) {
+        div_dividends[i] = (int64_t(i) - int64_t(DIV_REPEAT / 2)) * -130653LL * 8191LL;
+    }
+    double div_native_ns = measure(DIV_REPEAT, [&]() {
+        int64_t divisor = div_divisor;
+        for (size_t i = 0; i < DIV_REPEAT; ++i) {
+            do_not_optimize(div_dividends[i]);
+            int64_t value = div_dividends[i] / divisor;
+            do_not_optimize(value);
+        }
+    });
+    double div_fixed_ns = measure(DIV_REPEAT, [&]() {
+        for (size_t i = 0; i < DIV_REPEAT; ++i) {
+            do_not_optimize(div_dividends[i]);
+            int64_t value = fixed_div_s64(&fixed_divisor, div_dividends[i]);
+            do_not_optimize(value);
+        }
+    });
+
+    // First-order filter of calibrated value with `t250ms` time constant: `FILTER` macro with division and remainder
+    // by opaque divisor against reciprocal coefficient. Input is a noisy step, so both take their usual path.
+    static constexpr size_t FILTER_REPEAT = 100;
+    volatile int64_t filter_t = 249;
+    int32_t filter_inputs[FILTER_REPEAT];
+    for (size_t i = 0; i < FILTER_REPEAT; ++i) {
+        filter_inputs[i] = 150000 + int32_t(i % 7) * 13 - 39;
+    }
+    int32_t macro_val = 0, macro_add = 0;
+    double filter_macro_ns = measure(FILTER_REPEAT, [&]() {
+        int64_t t = filter_t;
+        for (size_t i = 0; i < FILTER_REPEAT; ++i) {
+            do_not_optimize(filter_inputs[i]);
+            int64_t value = filter_inputs[i];
+            macro_val = int32_t((int64_t(macro_val) * t + value) / (t + 1));
+            macro_add += int32_t((macro_val * t + value) % (t + 1));
+            if (macro_add > (t + 1)) {
+                macro_val++;
+                macro_add -= int32_t(t + 1);
+            }
+            if (macro_add < -(t + 1)) {
+                macro_val--;
+                macro_add += int32_t(t + 1);
+            }
+            do_not_optimize(macro_val);
+        }
+    });
+    FilterCoef filter_coef;
+    filter_coef_init(&filter_coef, uint32_t(filter_t));
+    Filter filter;
+    filter_reset(&filter, 0);
+    double filter_ns = measure(FILTER_REPEAT, [&]() {
+        for (size_t i = 0; i < FILTER_REPEAT; ++i) {
+            do_not_optimize(filter_inputs[i]);
+            int32_t value = filter_update(&filter, &filter_coef, filter_inputs[i]);
+            do_not_optimize(value);
+        }
+    });
+
+    // Snapshot is never requested here, so active probes contain all samples. Host cycle counter ticks in nanoseconds.
+    static const char *const STAGE_NAMES[] = {"dio", "dac", "transfer", "adc"};
+    double stage_ns[4] = {0.0};
+    for (size_t i = 0; i < 4; ++i) {
+        const Probe &probe = *probe_group_get(&control.timing, uint8_t(TIMING_CONTROL_DIO + i));
+        stage_ns[i] = probe.count > 0 ? double(probe.sum) / double(probe.count) : 0.0;
+    }
+
+    std::printf("{\n");
+    std::printf("  \"iterations\": %zu,\n", ITERATIONS);
+    std::printf("  \"dac_ring_ns_per_point\": %.2f,\n", dac_ns);
+    std::printf("  \"adc_ring_ns_per_point\": %.2f,\n", adc_ns);
+    std::printf("  \"control_sample_ns\": %.2f,\n", sample_ns);
+    std::printf("  \"control_stage_ns\": {");
+    for (size_t i = 0; i < 4; ++i) {
+        std::printf("\"%s\": %.2f%s", STAGE_NAMES[i], stage_ns[i], i + 1 < 4 ? ", " : "");
+    }
+    std::printf("},\n");
+    std::printf(
+        "  \"crc16_ns_per_frame\": {\"slice\": %d, \"tx_bytewise\": %.2f, \"tx\": %.2f, \"rx_bytewise\": %.2f, "
+        "\"rx\": %.2f},\n",
+        CRC16_SLICE,
+        crc_tx_bytewise_ns,
+        crc_tx_ns,
+        crc_rx_bytewise_ns,
+        crc_rx_ns //
+    );
+    std::printf("  \"div_s64_ns\": {\"native\": %.2f, \"fixed\": %.2f},\n", div_native_ns, div_fixed_ns);
+    std::printf("  \"filter_ns\": {\"macro\": %.2f, \"reciprocal\": %.2f}\n", filter_macro_ns, filter_ns);
+    std::printf("}\n");
+
+    return 0;
+}
+
+// Maximum sustainable rate.
+
+static constexpr uint32_t RATES_HZ[] = {SAMPLE_FREQS_HZ};
+static constexpr auto RATE_WARMUP = std::chrono::milliseconds(200);
+static constexpr auto RATE_RUN = std::chrono::milliseconds(1000);
+
+/// Emulates app side of RPMSG connection: answers DAC requests, consumes ADC messages and keeps connection alive.
+class AppEmulator {
+public:
+    void connect(uint32_t sample_freq_hz) {
+        auto *msg = app_msg();
+        msg->type = IPP_APP_MSG_CONNECT;
+        msg->connect.version = IPP_PROTOCOL_VERSION;
+        msg->connect.max_msg_len = RPMSG_MAX_MCU_MSG_LEN;
+        msg->connect.features = IPP_FEATURES_SUPPORTED;
+        msg->connect.sample_freq_hz = sample_freq_hz;
+        send();
+        connected_ = false;
+    }
+
+    void reset_stats() {
+        app_msg()->type = IPP_APP_MSG_STATS_RESET;
+        send();
+    }
+
+    /// Handle MCU messages for given time.
+    /// @return Sample frequency from capabilities if received, zero otherwise.
+    uint32_t pump(std::chrono::steady_clock::duration duration) {
+        uint32_t caps_freq_hz = 0;
+        const auto deadline = Clock::now() + duration;
+        while (Clock::now() < deadline) {
+            if (Clock::now() - keep_alive_sent_ >= std::chrono::milliseconds(KEEP_ALIVE_PERIOD_MS)) {
+                app_msg()->type = IPP_APP_MSG_KEEP_ALIVE;
+                send();
+                keep_alive_sent_ = Clock::now();
+            }
+            if (hal_rpmsg_host_pop_tx(mcu_buffer_, sizeof(mcu_buffer_), 1) == 0) {
+                continue;
+            }
+            const auto *msg = reinterpret_cast<const IppMcuMsg *>(mcu_buffer_);
+            switch (msg->type) {
+            case IPP_MCU_MSG_CAPABILITIES:
+                caps_freq_hz = msg->capabilities.sample_freq_hz;
+                dac_seq_ = 0;
+                connected_ = true;
+                break;
+            case IPP_MCU_MSG_DAC_REQUEST:
+                if (connected_) {
+                    send_dac(msg->dac_request.count);
+                }
+                break;
+            default:
+                // ADC data and reports are dropped.
+                break;
+            }
+        }
+        return caps_freq_hz;
+    }
+
+private:
+    IppAppMsg *app_msg() {
+        return reinterpret_cast<IppAppMsg *>(app_buffer_);
+    }
+
+    void send() {
+        hal_rpmsg_host_push_rx(app_buffer_, ipp_app_msg_size(app_msg()));
+    }
+
+    void send_dac(size_t count) {
+        while (count > 0) {
+            size_t len = std::min(count, size_t(DAC_MSG_MAX_POINTS));
+            auto *msg = app_msg();
+            msg->type = IPP_APP_MSG_DAC_DATA;
+            msg->dac_data.seq = dac_seq_++;
+            msg->dac_data.points.len = uint16_t(len);
+            for (size_t i = 0; i < len; ++i) {
+                msg->dac_data.points.data[i] = point_t(i);
+            }
+            send();
+            count -= len;
+        }
+    }
+
+    alignas(8) uint8_t app_buffer_[RPMSG_MAX_APP_MSG_LEN] = {};
+    alignas(8) uint8_t mcu_buffer_[RPMSG_MAX_MCU_MSG_LEN] = {};
+    uint32_t dac_seq_ = 0;
+    bool connected_ = false;
+    Clock::time_point keep_alive_sent_ = {};
+};
+
+struct RateResult {
+    uint32_t freq_hz = 0;
+    uint64_t samples = 0;
+    uint32_t dac_lost_empty = 0;
+    uint32_t dac_lost_full = 0;
+    uint32_t adc_lost_full = 0;
+
+    bool sustained() const {
+        return samples > 0 && dac_lost_empty == 0 && dac_lost_full == 0 && adc_lost_full == 0;
+    }
+};
+
+/// Sample period in nanoseconds, set by RPMSG rate handler like sync generator period on MCU.
+static std::atomic<uint64_t> g_period_ns{0};
+
+static int bench_max_rate() {
+    static PS_Control mps;
+    static Statistics stats;
+    static Control control;
+    static Rpmsg rpmsg;
+    std::memset(static_cast<void *>(&mps), 0, sizeof(mps));
+    fake_skifio_reset();
+    stats_init(&stats);
+    control_init(&control, &stats, &mps);
+    rpmsg_init(&rpmsg, &control, &stats);
+    rpmsg_set_rate_handler(
+        &rpmsg,
+        [](void *, const SampleRate *rate) {
+            g_period_ns.store(uint64_t(rate->period_us) * 1000);
+            return true;
+        },
+        nullptr //
+    );
+    g_period_ns.store(uint64_t(rpmsg.rate.period_us) * 1000);
+    rpmsg_run(&rpmsg);
+
+    // Samples are paced by busy waiting because sleeping is too coarse for tens of microseconds.
+    std::atomic<bool> done{false};
+    std::thread sampler([&]() {
+        auto next = Clock::now();
+        while (!done.load()) {
+            next += std::chrono::nanoseconds(g_period_ns.load());
+            auto now = Clock::now();
+            while (now < next) {
+                now = Clock::now();
+            }
+            // Skip missed samples instead of catching up with a burst.
+            if (now - next > std::chrono::milliseconds(10)) {
+                next = now;
+            }
+            control_sample(&control);
+        }
+    });
+
+    AppEmulator app;
+    std::vector<RateResult> results;
+    for (uint32_t freq_hz : RATES_HZ) {
+        app.connect(freq_hz);
+        uint32_t caps_freq_hz = app.pump(RATE_WARMUP);
+        if (caps_freq_hz != freq_hz) {
+            std::fprintf(stderr, "Sample frequency %u Hz is not applied (reported %u Hz)\n", freq_hz, caps_freq_hz);
+            break;
+        }
+        app.reset_stats();
+        app.pump(RATE_RUN);
+
+        static Statistics snapshot;
+        stats_snapshot(&stats, &snapshot);
+        results.push_back(RateResult{
+            freq_hz,
+            snapshot.sample_count,
+            snapshot.dac.lost_empty,
+            snapshot.dac.lost_full,
+            snapshot.adc.lost_full,
+        });
+    }
+    // RPMSG tasks are never stopped, so only the sampler is joined.
+    done.store(true);
+    sampler.join();
+
+    uint32_t max_rate_hz = 0;
+    for (const auto &r : results) {
+        if (!r.sustained()) {
+            break;
+        }
+        max_rate_hz = r.freq_hz;
+    }
+
+    std::printf("{\n");
+    std::printf("  \"run_ms\": %lld,\n", (long long)std::chrono::milliseconds(RATE_RUN).count());
+    std::printf("  \"rates\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto &r = results[i];
+        std::printf(
+            "    {\"freq_hz\": %u, \"samples\": %llu, \"dac_lost_empty\": %u, \"dac_lost_full\": %u, "
+            "\"adc_lost_full\": %u}%s\n",
+            r.freq_hz,
+            (unsigned long long)r.samples,
+            r.dac_lost_empty,
+            r.dac_lost_full,
+            r.adc_lost_full,
+            i + 1 < results.size() ? "," : "" //
+        );
+    }
+    std::printf("  ],\n");
+    std::printf("  \"max_sustainable_rate_hz\": %u\n", max_rate_hz);
+    std::printf("}\n");
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string_view(argv[1]) == "max-rate") {
+        return bench_max_rate();
+    }
+    return bench_hot_paths();
+}
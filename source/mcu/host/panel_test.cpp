@@ -0,0 +1,192 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/panel.h>
+#include <utils/crc.h>
+}
+
+static std::vector<uint8_t> encode(uint8_t type, const std::vector<uint8_t> &payload) {
+    PanelFrame frame = {};
+    frame.type = type;
+    frame.len = uint8_t(payload.size());
+    std::memcpy(frame.payload, payload.data(), payload.size());
+    std::vector<uint8_t> buffer(PANEL_FRAME_MAX_LEN);
+    buffer.resize(panel_frame_encode(&frame, buffer.data()));
+    return buffer;
+}
+
+/// Push all bytes and collect completed frames.
+static std::vector<PanelFrame> parse(PanelParser &parser, const std::vector<uint8_t> &bytes) {
+    std::vector<PanelFrame> frames;
+    for (uint8_t byte : bytes) {
+        PanelFrame frame;
+        if (panel_parser_push(&parser, byte, &frame)) {
+            frames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+static void append(std::vector<uint8_t> &dst, const std::vector<uint8_t> &src) {
+    dst.insert(dst.end(), src.begin(), src.end());
+}
+
+TEST(Panel, encode) {
+    const auto bytes = encode(PANEL_CMD_MODE, {1});
+    ASSERT_EQ(bytes.size(), size_t(PANEL_FRAME_HEADER_LEN + 1 + PANEL_FRAME_CRC_LEN));
+    ASSERT_EQ(bytes[0], PANEL_FRAME_START);
+    ASSERT_EQ(bytes[1], PANEL_CMD_MODE);
+    ASSERT_EQ(bytes[2], 1);
+    ASSERT_EQ(bytes[3], 1);
+    const uint16_t crc = calculate_crc16(&bytes[1], 3);
+    ASSERT_EQ(bytes[4], crc >> 8);
+    ASSERT_EQ(bytes[5], crc & 0xff);
+}
+
+TEST(Panel, roundtrip) {
+    PanelParser parser;
+    panel_parser_init(&parser);
+    for (size_t len : {0, 1, 4, PANEL_PAYLOAD_MAX}) {
+        std::vector<uint8_t> payload(len);
+        for (size_t i = 0; i < len; ++i) {
+            // Start byte inside payload must not confuse the parser.
+            payload[i] = i % 2 == 0 ? PANEL_FRAME_START : uint8_t(i);
+        }
+        const auto frames = parse(parser, encode(0x42, payload));
+        ASSERT_EQ(frames.size(), 1u) << "len: " << len;
+        ASSERT_EQ(frames[0].type, 0x42);
+        ASSERT_EQ(frames[0].len, len);
+        ASSERT_EQ(std::vector<uint8_t>(frames[0].payload, frames[0].payload + len), payload);
+    }
+    ASSERT_EQ(parser.crc_error_count, 0u);
+    ASSERT_EQ(parser.length_error_count, 0u);
+}
+
+TEST(Panel, garbage_and_back_to_back) {
+    PanelParser parser;
+    panel_parser_init(&parser);
+    // Old text protocol line before frames.
+    std::vector<uint8_t> bytes = {'\n', 'I', 'O', 'U', 'T', '=', '1', '\r'};
+    append(bytes, encode(PANEL_CMD_MODE, {0}));
+    append(bytes, encode(PANEL_CMD_MAIN_POWER, {1}));
+    const auto frames = parse(parser, bytes);
+    ASSERT_EQ(frames.size(), 2u);
+    ASSERT_EQ(frames[0].type, PANEL_CMD_MODE);
+    ASSERT_EQ(frames[1].type, PANEL_CMD_MAIN_POWER);
+}
+
+TEST(Panel, split_delivery) {
+    PanelParser parser;
+    panel_parser_init(&parser);
+    const auto bytes = encode(PANEL_CMD_REF_SET, {1, 2, 3, 4});
+    // Bytes arrive over several wake-ups, the frame completes only on the last one.
+    for (size_t i = 0; i + 1 < bytes.size(); ++i) {
+        ASSERT_TRUE(parse(parser, {bytes[i]}).empty());
+    }
+    ASSERT_EQ(parse(parser, {bytes.back()}).size(), 1u);
+}
+
+TEST(Panel, crc_error_resync) {
+    PanelParser parser;
+    panel_parser_init(&parser);
+    auto bad = encode(PANEL_CMD_REF_SET, {1, 2, 3, 4});
+    bad[4] ^= 0x10;
+    std::vector<uint8_t> bytes = bad;
+    append(bytes, encode(PANEL_CMD_MODE, {1}));
+    const auto frames = parse(parser, bytes);
+    ASSERT_EQ(frames.size(), 1u);
+    ASSERT_EQ(frames[0].type, PANEL_CMD_MODE);
+    ASSERT_EQ(parser.crc_error_count, 1u);
+}
+
+TEST(Panel, length_error) {
+    PanelParser parser;
+    panel_parser_init(&parser);
+    std::vector<uint8_t> bytes = {PANEL_FRAME_START, PANEL_CMD_MODE, PANEL_PAYLOAD_MAX + 1};
+    append(bytes, encode(PANEL_CMD_MODE, {1}));
+    const auto frames = parse(parser, bytes);
+    ASSERT_EQ(frames.size(), 1u);
+    ASSERT_EQ(parser.length_error_count, 1u);
+}
+
+TEST(Panel, status) {
+    PanelStatus status = {-12345, 2400, -15, 100000, 150000, 240000, 0x170001};
+    PanelFrame frame;
+    panel_status_write(&status, &frame);
+    ASSERT_EQ(frame.len, PANEL_STATUS_LEN);
+
+    PanelParser parser;
+    panel_parser_init(&parser);
+    std::vector<uint8_t> bytes(PANEL_FRAME_MAX_LEN);
+    bytes.resize(panel_frame_encode(&frame, bytes.data()));
+    const auto frames = parse(parser, bytes);
+    ASSERT_EQ(frames.size(), 1u);
+
+    PanelStatus parsed;
+    ASSERT_TRUE(panel_status_parse(&frames[0], &parsed));
+    ASSERT_EQ(parsed.iout, status.iout);
+    ASSERT_EQ(parsed.vout, status.vout);
+    ASSERT_EQ(parsed.heatsink, status.heatsink);
+    ASSERT_EQ(parsed.vreg, status.vreg);
+    ASSERT_EQ(parsed.ref_set, status.ref_set);
+    ASSERT_EQ(parsed.vref_set, status.vref_set);
+    ASSERT_EQ(parsed.stat, status.stat);
+}
+
+/// Apply command with `int32_t` payload.
+static bool apply(PS_Control &mps, uint8_t type, int32_t value) {
+    PanelFrame frame = {};
+    frame.type = type;
+    frame.len = 4;
+    for (size_t i = 0; i < 4; ++i) {
+        frame.payload[i] = uint8_t(uint32_t(value) >> (8 * i));
+    }
+    return panel_command_apply(&frame, &mps);
+}
+
+TEST(Panel, commands) {
+    PS_Control mps = {};
+
+    ASSERT_TRUE(apply(mps, PANEL_CMD_REF_SET, 12345));
+    ASSERT_EQ(mps.Ref_Set, 12345);
+    ASSERT_EQ(unsigned(mps.Flag.fLocale), 1u);
+    ASSERT_TRUE(apply(mps, PANEL_CMD_REF_SET, ISETMAX + 1));
+    ASSERT_EQ(mps.Ref_Set, ISETMAX);
+    ASSERT_TRUE(apply(mps, PANEL_CMD_REF_SET, -1));
+    ASSERT_EQ(mps.Ref_Set, 0);
+    ASSERT_TRUE(apply(mps, PANEL_CMD_DAC_SET, 1 << 30));
+    ASSERT_EQ(mps.VRef_Set, VSETMAX * 10);
+
+    PanelFrame frame = {PANEL_CMD_MODE, 1, {1}};
+    ASSERT_TRUE(panel_command_apply(&frame, &mps));
+    ASSERT_EQ(unsigned(mps.Flag.fCCMode), 1u);
+
+    // Main power goes on in two steps and off in reverse order.
+    frame = {PANEL_CMD_MAIN_POWER, 1, {1}};
+    ASSERT_TRUE(panel_command_apply(&frame, &mps));
+    ASSERT_EQ(unsigned(mps.Flag.PS_ON), 1u);
+    ASSERT_EQ(mps.Operate, 0);
+    ASSERT_TRUE(panel_command_apply(&frame, &mps));
+    ASSERT_EQ(mps.Operate, 1);
+    frame = {PANEL_CMD_MAIN_POWER, 1, {0}};
+    ASSERT_TRUE(panel_command_apply(&frame, &mps));
+    ASSERT_EQ(mps.Operate, 0);
+    ASSERT_EQ(unsigned(mps.Flag.PS_ON), 1u);
+    ASSERT_TRUE(panel_command_apply(&frame, &mps));
+    ASSERT_EQ(unsigned(mps.Flag.PS_ON), 0u);
+}
+
+TEST(Panel, unknown_command) {
+    PS_Control mps = {};
+    PanelFrame frame = {PANEL_MSG_STATUS, 0, {}};
+    ASSERT_FALSE(panel_command_apply(&frame, &mps));
+    // Wrong length is rejected as well.
+    frame = {PANEL_CMD_REF_SET, 2, {1, 2}};
+    ASSERT_FALSE(panel_command_apply(&frame, &mps));
+    ASSERT_EQ(mps.Ref_Set, 0);
+    ASSERT_EQ(unsigned(mps.Flag.fLocale), 0u);
+}
@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/postmortem.h>
+}
+
+/// Push points with reference equal to tick number, the last one with new fault count.
+static void push(Postmortem &postmortem, int32_t first, int32_t count, uint32_t fault_count) {
+    for (int32_t i = first; i < first + count; ++i) {
+        PostmortemPoint point = {};
+        point.values[POSTMORTEM_REF] = i;
+        postmortem_push(&postmortem, &point, i + 1 == first + count ? fault_count : postmortem.seen_fault_count);
+    }
+}
+
+/// Read the whole frozen buffer with chunks of given length.
+static std::vector<int32_t> read(const Postmortem &postmortem, size_t chunk) {
+    std::vector<int32_t> refs;
+    std::vector<PostmortemPoint> points(chunk);
+    for (;;) {
+        size_t len = postmortem_read(&postmortem, refs.size(), points.data(), chunk);
+        if (len == 0) {
+            return refs;
+        }
+        for (size_t i = 0; i < len; ++i) {
+            refs.push_back(points[i].values[POSTMORTEM_REF]);
+        }
+    }
+}
+
+TEST(Postmortem, freeze_partial) {
+    static Postmortem postmortem;
+    postmortem_init(&postmortem);
+    push(postmortem, 0, 10, 0);
+    ASSERT_FALSE(postmortem_frozen(&postmortem));
+
+    // The tick fault latched at is the last point.
+    push(postmortem, 10, 5, 1);
+    ASSERT_TRUE(postmortem_frozen(&postmortem));
+    ASSERT_EQ(postmortem.fault_count, 1u);
+    auto refs = read(postmortem, 4);
+    ASSERT_EQ(refs.size(), 15u);
+    for (size_t i = 0; i < refs.size(); ++i) {
+        ASSERT_EQ(refs[i], int32_t(i));
+    }
+}
+
+TEST(Postmortem, freeze_wrapped) {
+    static Postmortem postmortem;
+    postmortem_init(&postmortem);
+    const int32_t count = 3 * POSTMORTEM_DEPTH + 7;
+    push(postmortem, 0, count, 1);
+    ASSERT_TRUE(postmortem_frozen(&postmortem));
+
+    // Only the last `POSTMORTEM_DEPTH` ticks are kept, oldest first.
+    auto refs = read(postmortem, 13);
+    ASSERT_EQ(refs.size(), size_t(POSTMORTEM_DEPTH));
+    for (size_t i = 0; i < refs.size(); ++i) {
+        ASSERT_EQ(refs[i], int32_t(count - POSTMORTEM_DEPTH + i));
+    }
+}
+
+TEST(Postmortem, frozen_until_rearm) {
+    static Postmortem postmortem;
+    postmortem_init(&postmortem);
+    push(postmortem, 0, 3, 1);
+    ASSERT_TRUE(postmortem_frozen(&postmortem));
+
+    // Ticks and faults after freeze do not touch the buffer, faults are counted as lost.
+    push(postmortem, 3, 10, 3);
+    ASSERT_EQ(postmortem.lost_count, 2u);
+    ASSERT_EQ(postmortem.fault_count, 1u);
+    ASSERT_EQ(read(postmortem, 2), (std::vector<int32_t>{0, 1, 2}));
+
+    // Recording resumes from empty buffer, fault that is still latched does not freeze it again.
+    postmortem_rearm(&postmortem);
+    ASSERT_FALSE(postmortem_frozen(&postmortem));
+    push(postmortem, 13, 4, 3);
+    ASSERT_FALSE(postmortem_frozen(&postmortem));
+    push(postmortem, 17, 1, 4);
+    ASSERT_TRUE(postmortem_frozen(&postmortem));
+    ASSERT_EQ(read(postmortem, 16), (std::vector<int32_t>{13, 14, 15, 16, 17}));
+}
@@ -0,0 +1,114 @@
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <utils/probe.h>
+}
+
+TEST(Probe, hist_bins) {
+    const uint32_t BASE = TIMING_HIST_BASE_CYCLES;
+    ASSERT_EQ(probe_hist_bin(0), 0u);
+    ASSERT_EQ(probe_hist_bin(BASE - 1), 0u);
+    ASSERT_EQ(probe_hist_bin(BASE), 1u);
+    ASSERT_EQ(probe_hist_bin(2 * BASE - 1), 1u);
+    ASSERT_EQ(probe_hist_bin(2 * BASE), 2u);
+    ASSERT_EQ(probe_hist_bin(4 * BASE - 1), 2u);
+    ASSERT_EQ(probe_hist_bin(4 * BASE), 3u);
+    ASSERT_EQ(probe_hist_bin(BASE << (TIMING_HIST_BINS - 2)), size_t(TIMING_HIST_BINS - 1));
+    ASSERT_EQ(probe_hist_bin(UINT32_MAX), size_t(TIMING_HIST_BINS - 1));
+}
+
+TEST(Probe, record) {
+    Probe probe;
+    probe_reset(&probe);
+    ASSERT_EQ(probe.count, 0u);
+
+    const uint32_t values[] = {100, 10, 1000, 70};
+    for (uint32_t value : values) {
+        probe_record(&probe, value);
+    }
+    ASSERT_EQ(probe.count, 4u);
+    ASSERT_EQ(probe.min, 10u);
+    ASSERT_EQ(probe.max, 1000u);
+    ASSERT_EQ(probe.sum, 1180u);
+
+    uint32_t total = 0;
+    for (size_t i = 0; i < TIMING_HIST_BINS; ++i) {
+        total += probe.hist[i];
+    }
+    ASSERT_EQ(total, 4u);
+    ASSERT_EQ(probe.hist[probe_hist_bin(10)], 1u);
+    ASSERT_EQ(probe.hist[probe_hist_bin(100)], 2u);
+    ASSERT_EQ(probe.hist[probe_hist_bin(1000)], 1u);
+}
+
+TEST(ProbeGroup, handshake) {
+    ProbeGroup group;
+    probe_group_init(&group, TIMING_CONTROL_DIO, 2);
+    ASSERT_EQ(probe_group_get(&group, TIMING_CONTROL_DAC), &group.active[1]);
+
+    Probe out[PROBE_GROUP_MAX_SIZE];
+
+    // Nothing is committed without request.
+    probe_record(probe_group_get(&group, TIMING_CONTROL_DIO), 5);
+    probe_group_commit(&group);
+    ASSERT_FALSE(probe_group_take(&group, out));
+    // Request is pending until commit.
+    ASSERT_FALSE(probe_group_take(&group, out));
+
+    probe_record(probe_group_get(&group, TIMING_CONTROL_DAC), 7);
+    probe_group_commit(&group);
+    ASSERT_EQ(group.active[0].count, 0u);
+    ASSERT_EQ(group.active[1].count, 0u);
+
+    // Committing again does not overwrite the snapshot that is not taken yet.
+    probe_record(probe_group_get(&group, TIMING_CONTROL_DIO), 9);
+    probe_group_commit(&group);
+
+    ASSERT_TRUE(probe_group_take(&group, out));
+    ASSERT_EQ(out[0].count, 1u);
+    ASSERT_EQ(out[0].sum, 5u);
+    ASSERT_EQ(out[1].count, 1u);
+    ASSERT_EQ(out[1].sum, 7u);
+
+    probe_group_commit(&group);
+    ASSERT_TRUE(probe_group_take(&group, out));
+    ASSERT_EQ(out[0].count, 1u);
+    ASSERT_EQ(out[0].sum, 9u);
+    ASSERT_EQ(out[1].count, 0u);
+}
+
+TEST(ProbeGroup, concurrent) {
+    static ProbeGroup group;
+    probe_group_init(&group, TIMING_SYNC_WAIT, 1);
+
+    static constexpr uint32_t COUNT = 1000000;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            probe_record(probe_group_get(&group, TIMING_SYNC_WAIT), 1);
+            probe_group_commit(&group);
+        }
+        done.store(true);
+    });
+
+    // Every recorded duration must be reported exactly once.
+    uint64_t count = 0, sum = 0;
+    Probe out[PROBE_GROUP_MAX_SIZE];
+    for (;;) {
+        bool finished = done.load();
+        if (probe_group_take(&group, out)) {
+            ASSERT_EQ(uint64_t(out[0].count), out[0].sum);
+            count += out[0].count;
+            sum += out[0].sum;
+        }
+        if (finished && count + group.active[0].count == COUNT) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    writer.join();
+    ASSERT_EQ(count + group.active[0].count, uint64_t(COUNT));
+}
@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/reference.h>
+}
+
+/// Feed each setpoint for `ticks_per_point` ticks and collect reference of every tick.
+static std::vector<int32_t> run(Reference &reference, const std::vector<int32_t> &setpoints, size_t ticks_per_point) {
+    std::vector<int32_t> values;
+    for (int32_t setpoint : setpoints) {
+        for (size_t i = 0; i < ticks_per_point; ++i) {
+            reference_commit(&reference);
+            values.push_back(reference_update(&reference, REFERENCE_CURRENT, setpoint));
+        }
+    }
+    return values;
+}
+
+TEST(Reference, hold_by_default) {
+    static Reference reference;
+    reference_init(&reference);
+    ASSERT_EQ(
+        run(reference, {100, 200, 50}, REFERENCE_TICKS_PER_SAMPLE),
+        (std::vector<int32_t>{100, 100, 200, 200, 50, 50}) //
+    );
+}
+
+TEST(Reference, linear) {
+    static Reference reference;
+    reference_init(&reference);
+    reference_set_mode(&reference, 1, true);
+    // Each point is reached at the end of its period.
+    ASSERT_EQ(
+        run(reference, {100, 200, 200, -100}, REFERENCE_TICKS_PER_SAMPLE),
+        (std::vector<int32_t>{50, 100, 150, 200, 200, 200, 50, -100}) //
+    );
+}
+
+TEST(Reference, upsampled_ramp) {
+    static Reference reference;
+    reference_init(&reference);
+    const uint32_t ratio = 10;
+    reference_set_mode(&reference, ratio, true);
+
+    const size_t ticks = REFERENCE_TICKS_PER_SAMPLE * ratio;
+    auto values = run(reference, {0, 2000, 4000, 6000}, ticks);
+    ASSERT_EQ(values.size(), 4 * ticks);
+    // Ramp of 100 per tick without steps, lagging one point behind.
+    for (size_t i = ticks; i < values.size(); ++i) {
+        ASSERT_EQ(values[i], int32_t(100 * (i - ticks + 1))) << i;
+    }
+}
+
+TEST(Reference, mode_change) {
+    static Reference reference;
+    reference_init(&reference);
+    reference_set_mode(&reference, 2, true);
+    ASSERT_EQ(run(reference, {400}, 2), (std::vector<int32_t>{100, 200}));
+
+    // Ramp in progress is finished at once when interpolation is turned off.
+    reference_set_mode(&reference, 2, false);
+    ASSERT_EQ(run(reference, {400}, 1), (std::vector<int32_t>{400}));
+}
+
+TEST(Reference, reset) {
+    static Reference reference;
+    reference_init(&reference);
+    reference_set_mode(&reference, 1, true);
+    run(reference, {1000}, REFERENCE_TICKS_PER_SAMPLE);
+
+    // Reference ramps up from zero after fault is cleared.
+    reference_reset(&reference, REFERENCE_CURRENT, 0);
+    ASSERT_EQ(run(reference, {1000}, REFERENCE_TICKS_PER_SAMPLE), (std::vector<int32_t>{500, 1000}));
+}
+
+TEST(Reference, full_range) {
+    static Reference reference;
+    reference_init(&reference);
+    reference_set_mode(&reference, 1, true);
+    reference_commit(&reference);
+    reference_reset(&reference, REFERENCE_VOLTAGE, INT32_MIN);
+    ASSERT_EQ(reference_update(&reference, REFERENCE_VOLTAGE, INT32_MAX), -1);
+    ASSERT_EQ(reference_update(&reference, REFERENCE_VOLTAGE, INT32_MAX), INT32_MAX);
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/regulator.h>
+}
+
+/// Gains of `main.c`.
+static const RegulatorGains DEFAULT_GAINS = {20000, 4000, 0, 0, 0, 0, 0, 0};
+
+/// PI step as it was done inline by sync generator.
+static int32_t reference_pi(const RegulatorGains &gains, int32_t delta, int64_t &sum) {
+    sum += delta;
+    int64_t smax = gains.ki ? (160000LL * 150000LL) / gains.ki : 0;
+    if (sum > smax) {
+        sum = smax;
+    }
+    if (sum < -smax) {
+        sum = -smax;
+    }
+    return int32_t((int64_t(delta) * int64_t(gains.kp)) / 100LL + (sum * int64_t(gains.ki)) / 80000LL);
+}
+
+TEST(Regulator, same_as_inline) {
+    static Regulator regulator;
+    std::mt19937 rng(0);
+    for (const RegulatorGains &gains :
+         {DEFAULT_GAINS, RegulatorGains{1, 1, 0, 0, 0, 0, 0, 0}, RegulatorGains{-300, 7, 0, 0, 0, 0, 0, 0}, RegulatorGains{50000, 0, 0, 0, 0, 0, 0, 0}}) {
+        regulator_init(&regulator, &gains);
+        int64_t sum = 0, reference_sum = 0;
+        for (size_t tick = 0; tick < 100000; ++tick) {
+            // Error swings over the whole current range to hit both integral limits.
+            int32_t delta = int32_t(rng() % 400001) - 200000;
+            ASSERT_EQ(regulator_pi(&regulator, delta, &sum), reference_pi(gains, delta, reference_sum)) << "tick: " << tick;
+            ASSERT_EQ(sum, reference_sum) << "tick: " << tick;
+        }
+    }
+}
+
+TEST(Regulator, write_at_tick_boundary) {
+    static Regulator regulator;
+    const RegulatorGains first = {100, 0, 0, 0, 0, 0, 0, 0}, second = {200, 8000, 1, 2, 3, 4, 5, 6},
+                         third = {300, 0, 0, 0, 0, 0, 0, 0};
+    regulator_init(&regulator, &first);
+    int64_t sum = 0;
+
+    ASSERT_TRUE(regulator_write(&regulator, &second));
+    ASSERT_EQ(regulator_gains(&regulator)->kd2, 4);
+    // Pending gains are not used until taken.
+    ASSERT_EQ(regulator_pi(&regulator, 10, &sum), 10);
+    ASSERT_EQ(sum, 0);
+    // The next gains are accepted only after the previous ones are taken.
+    ASSERT_FALSE(regulator_write(&regulator, &third));
+    ASSERT_EQ(regulator_gains(&regulator)->kp, second.kp);
+
+    regulator_commit(&regulator);
+    // All gains and derived sum limit are switched together.
+    ASSERT_EQ(regulator.active.gains.kp, second.kp);
+    ASSERT_EQ(regulator.active.gains.kd2, second.kd2);
+    ASSERT_EQ(regulator.active.sum_limit, (160000LL * 150000LL) / second.ki);
+    ASSERT_EQ(regulator_pi(&regulator, 10, &sum), 20 + 1);
+    ASSERT_EQ(sum, 10);
+
+    // Nothing is pending anymore.
+    regulator_commit(&regulator);
+    ASSERT_EQ(regulator.active.gains.kp, second.kp);
+
+    ASSERT_TRUE(regulator_write(&regulator, &third));
+    regulator_commit(&regulator);
+    // Integral sum is clamped by the new limit, which is zero without integral gain.
+    ASSERT_EQ(regulator_pi(&regulator, 10, &sum), 30);
+    ASSERT_EQ(sum, 0);
+}
+
+TEST(Regulator, feed_forward_and_derivative) {
+    static Regulator regulator;
+    const RegulatorGains gains = {.kp = 0, .ki = 0, .kd = 300, .kp2 = 0, .ki2 = 0, .kd2 = 0, .ff_r = 1500, .ff_l = 2000};
+    regulator_init(&regulator, &gains);
+
+    // Resistive term follows reference, inductive one its change since the previous tick.
+    ASSERT_EQ(regulator_feed_forward(&regulator, 1000), 1500 + 2000);
+    ASSERT_EQ(regulator_feed_forward(&regulator, 1000), 1500);
+    ASSERT_EQ(regulator_feed_forward(&regulator, 900), 1350 - 200);
+
+    // Derivative opposes change of measurement only.
+    ASSERT_EQ(regulator_derivative(&regulator, 100), -300);
+    ASSERT_EQ(regulator_derivative(&regulator, 100), 0);
+    ASSERT_EQ(regulator_derivative(&regulator, 90), 30);
+
+    // Output is saturated instead of wrapped.
+    const RegulatorGains large = {.kp = 0, .ki = 0, .kd = 0, .kp2 = 0, .ki2 = 0, .kd2 = 0, .ff_r = INT32_MAX, .ff_l = INT32_MAX};
+    regulator_init(&regulator, &large);
+    ASSERT_EQ(regulator_feed_forward(&regulator, INT32_MAX), INT32_MAX);
+    ASSERT_EQ(regulator_feed_forward(&regulator, INT32_MIN), INT32_MIN);
+}
+
+/// Current source loaded with magnet, first-order model `L * dI/dt = k * FB - R * I`.
+class MagnetLoad {
+public:
+    /// Time constant `L / R` in sync ticks, 10 ms at 20 kHz.
+    static constexpr double TAU_TICKS = 200.0;
+    /// Steady-state current per regulator output, full output gives 15 A.
+    static constexpr double GAIN = 150000.0 / 240000.0;
+    /// Feed-forward gains of the model in `1 / REGULATOR_FF_SCALE` units.
+    static constexpr int32_t FF_R = int32_t(REGULATOR_FF_SCALE / GAIN);
+    static constexpr int32_t FF_L = int32_t(REGULATOR_FF_SCALE * TAU_TICKS / GAIN);
+
+    double current = 0.0;
+
+    void step(int32_t output) {
+        current += (GAIN * double(output) - current) / TAU_TICKS;
+    }
+};
+
+struct RampTracking {
+    /// Maximum deviation of current from reference while ramping.
+    double max_lag;
+    /// Deviation at the end of flat top.
+    double final_error;
+};
+
+/// Run regulator as sync generator does in CC mode on a ramp to flat top.
+static RampTracking track_ramp(const RegulatorGains &gains) {
+    static Regulator regulator;
+    regulator_init(&regulator, &gains);
+    MagnetLoad load;
+    int64_t sum = 0;
+    const int32_t slope = 5, top = 100000;
+    RampTracking result = {0.0, 0.0};
+    for (int32_t tick = 0; tick < 2 * top / slope; ++tick) {
+        int32_t ref = std::min(slope * tick, top);
+        int32_t meas = int32_t(std::lround(load.current));
+        int64_t output = int64_t(regulator_pi(&regulator, ref - meas, &sum)) + regulator_feed_forward(&regulator, ref) +
+            regulator_derivative(&regulator, meas);
+        load.step(int32_t(std::clamp(output, int64_t(0), int64_t(240000))));
+        // Skip the start of ramp where PI integral builds up.
+        if (tick >= top / slope / 2 && ref < top) {
+            result.max_lag = std::max(result.max_lag, std::abs(double(ref) - load.current));
+        }
+        result.final_error = double(ref) - load.current;
+    }
+    return result;
+}
+
+TEST(Regulator, magnet_ramp_tracking) {
+    const RampTracking pi = track_ramp(DEFAULT_GAINS);
+    // PI alone lags behind ramp by more than 100 units (10 mA).
+    ASSERT_GT(pi.max_lag, 100.0);
+    ASSERT_LT(std::abs(pi.final_error), 10.0);
+
+    RegulatorGains ff = DEFAULT_GAINS;
+    ff.ff_r = MagnetLoad::FF_R;
+    ff.ff_l = MagnetLoad::FF_L;
+    const RampTracking with_ff = track_ramp(ff);
+    // With model feed-forward current is only one tick behind.
+    ASSERT_LT(with_ff.max_lag, pi.max_lag / 10.0);
+    ASSERT_LT(std::abs(with_ff.final_error), 1.0);
+
+    // Derivative on measurement keeps the loop stable and does not spoil tracking.
+    ff.kd = 5000;
+    const RampTracking with_d = track_ramp(ff);
+    ASSERT_LT(with_d.max_lag, pi.max_lag / 10.0);
+    ASSERT_LT(std::abs(with_d.final_error), 1.0);
+}
@@ -0,0 +1,159 @@
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/control.h>
+}
+
+// DAC ring buffer instance from control task is used for tests.
+
+class DacRing : public testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(dac_rb_init(&rb), HAL_SUCCESS);
+    }
+    void TearDown() override {
+        ASSERT_EQ(dac_rb_deinit(&rb), HAL_SUCCESS);
+    }
+
+    static std::vector<point_t> sequence(point_t first, size_t len) {
+        std::vector<point_t> data(len);
+        std::iota(data.begin(), data.end(), first);
+        return data;
+    }
+
+    DacRingBuffer rb;
+};
+
+TEST_F(DacRing, write_read) {
+    ASSERT_EQ(dac_rb_capacity(&rb), size_t(DAC_BUFFER_SIZE));
+    ASSERT_EQ(dac_rb_occupied(&rb), 0u);
+    ASSERT_EQ(dac_rb_vacant(&rb), size_t(DAC_BUFFER_SIZE));
+
+    auto data = sequence(0, 10);
+    ASSERT_EQ(dac_rb_write(&rb, data.data(), data.size()), data.size());
+    ASSERT_EQ(dac_rb_occupied(&rb), data.size());
+    ASSERT_EQ(dac_rb_vacant(&rb), DAC_BUFFER_SIZE - data.size());
+
+    std::vector<point_t> out(20);
+    ASSERT_EQ(dac_rb_read(&rb, out.data(), out.size()), data.size());
+    out.resize(data.size());
+    ASSERT_EQ(out, data);
+    ASSERT_EQ(dac_rb_occupied(&rb), 0u);
+}
+
+TEST_F(DacRing, write_full) {
+    auto data = sequence(0, DAC_BUFFER_SIZE + 10);
+    ASSERT_EQ(dac_rb_write(&rb, data.data(), data.size()), size_t(DAC_BUFFER_SIZE));
+    ASSERT_EQ(dac_rb_vacant(&rb), 0u);
+    ASSERT_EQ(dac_rb_write(&rb, data.data(), 1), 0u);
+}
+
+TEST_F(DacRing, wrap_around) {
+    const size_t step = DAC_BUFFER_SIZE / 3;
+    point_t next_write = 0, next_read = 0;
+    std::vector<point_t> out(step);
+    for (size_t i = 0; i < 10; ++i) {
+        auto data = sequence(next_write, step);
+        ASSERT_EQ(dac_rb_write(&rb, data.data(), step), step);
+        next_write += point_t(step);
+
+        ASSERT_EQ(dac_rb_read(&rb, out.data(), step), step);
+        ASSERT_EQ(out, sequence(next_read, step));
+        next_read += point_t(step);
+    }
+}
+
+TEST_F(DacRing, peek_commit) {
+    // Move positions close to the end of the buffer.
+    const size_t offset = DAC_BUFFER_SIZE - 4;
+    auto data = sequence(0, offset);
+    ASSERT_EQ(dac_rb_write(&rb, data.data(), offset), offset);
+    ASSERT_EQ(dac_rb_skip(&rb, offset), offset);
+
+    // Free space wraps, so only its part up to the end of the buffer is contiguous.
+    point_t *wslot = nullptr;
+    ASSERT_EQ(dac_rb_write_peek_contiguous(&rb, &wslot), 4u);
+    for (size_t i = 0; i < 4; ++i) {
+        wslot[i] = point_t(100 + i);
+    }
+    // Nothing is visible before commit.
+    ASSERT_EQ(dac_rb_occupied(&rb), 0u);
+    dac_rb_write_commit(&rb, 4);
+    auto tail = sequence(104, 4);
+    ASSERT_EQ(dac_rb_write(&rb, tail.data(), tail.size()), tail.size());
+    ASSERT_EQ(dac_rb_occupied(&rb), 8u);
+
+    const point_t *rslot = nullptr;
+    ASSERT_EQ(dac_rb_read_peek_contiguous(&rb, &rslot), 4u);
+    ASSERT_EQ(rslot[0], 100);
+    dac_rb_read_commit(&rb, 1);
+    ASSERT_EQ(dac_rb_read_peek_contiguous(&rb, &rslot), 3u);
+    ASSERT_EQ(rslot[0], 101);
+    dac_rb_read_commit(&rb, 3);
+    ASSERT_EQ(dac_rb_read_peek_contiguous(&rb, &rslot), 4u);
+    ASSERT_EQ(rslot[3], 107);
+}
+
+TEST_F(DacRing, skip) {
+    auto data = sequence(0, 100);
+    ASSERT_EQ(dac_rb_write(&rb, data.data(), data.size()), data.size());
+    ASSERT_EQ(dac_rb_skip(&rb, 30), 30u);
+    ASSERT_EQ(dac_rb_skip(&rb, 100), 70u);
+    ASSERT_EQ(dac_rb_occupied(&rb), 0u);
+}
+
+TEST_F(DacRing, overwrite) {
+    auto data = sequence(0, DAC_BUFFER_SIZE);
+    ASSERT_EQ(dac_rb_write(&rb, data.data(), data.size()), data.size());
+    auto extra = sequence(DAC_BUFFER_SIZE, 5);
+    ASSERT_EQ(dac_rb_overwrite(&rb, extra.data(), extra.size()), extra.size());
+    ASSERT_EQ(dac_rb_occupied(&rb), size_t(DAC_BUFFER_SIZE));
+
+    std::vector<point_t> out(DAC_BUFFER_SIZE);
+    ASSERT_EQ(dac_rb_read(&rb, out.data(), out.size()), out.size());
+    ASSERT_EQ(out, sequence(5, DAC_BUFFER_SIZE));
+}
+
+TEST_F(DacRing, spsc_threads) {
+    static constexpr size_t TOTAL = 1 << 20;
+    static constexpr size_t CHUNK = 37;
+
+    std::thread producer([&]() {
+        point_t next = 0;
+        std::vector<point_t> data(CHUNK);
+        while (size_t(next) < TOTAL) {
+            size_t len = std::min(CHUNK, TOTAL - size_t(next));
+            std::iota(data.begin(), data.begin() + len, next);
+            size_t written = dac_rb_write(&rb, data.data(), len);
+            if (written == 0) {
+                sched_yield();
+            }
+            next += point_t(written);
+        }
+    });
+
+    // Consumer reads points one by one like control task does.
+    point_t expected = 0;
+    while (size_t(expected) < TOTAL) {
+        const point_t *slot = nullptr;
+        size_t len = dac_rb_read_peek_contiguous(&rb, &slot);
+        if (len == 0) {
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < len; ++i) {
+            ASSERT_EQ(slot[i], expected);
+            expected += 1;
+        }
+        dac_rb_read_commit(&rb, len);
+    }
+
+    producer.join();
+    ASSERT_EQ(dac_rb_occupied(&rb), 0u);
+}
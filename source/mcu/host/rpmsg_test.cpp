@@ -0,0 +1,531 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/rpmsg.h>
+#include <fake_skifio.h>
+}
+
+static constexpr uint32_t TIMEOUT_MS = 1000;
+static constexpr uint32_t SAMPLE_FREQ = 20000;
+
+/// Receive message sent by MCU skipping messages of other types.
+static bool receive(std::vector<uint8_t> &buffer, uint8_t type) {
+    for (;;) {
+        buffer.resize(RPMSG_MAX_MCU_MSG_LEN);
+        size_t len = hal_rpmsg_host_pop_tx(buffer.data(), buffer.size(), TIMEOUT_MS);
+        if (len == 0) {
+            return false;
+        }
+        buffer.resize(len);
+        if (buffer[0] == type) {
+            return true;
+        }
+    }
+}
+
+// Tasks are never stopped, so the whole connection scenario is checked in a single test.
+TEST(Rpmsg, connect_and_stream) {
+    static PS_Control mps;
+    static Statistics stats;
+    static Control control;
+    static Rpmsg rpmsg;
+    static Calib calib;
+    static Regulator regulator;
+    static Telemetry telemetry;
+    static Reference reference;
+    static FaultMonitor fault;
+    static Postmortem postmortem;
+    static uint32_t rate_period_us = 0;
+
+    fake_skifio_reset();
+    stats_init(&stats);
+    control_init(&control, &stats, &mps);
+    rpmsg_init(&rpmsg, &control, &stats);
+    rpmsg_set_rate_handler(
+        &rpmsg,
+        [](void *, const SampleRate *rate) {
+            rate_period_us = rate->period_us;
+            return true;
+        },
+        nullptr //
+    );
+    const CalibTable initial_calib = {{{1000, 10, 0}, {2000, 20, 1}, {3000, 30, 2}, {4000, 40, 3}, {5000, 50, 4}, {6000, 60, 5}}};
+    calib_init(&calib, &initial_calib);
+    rpmsg_set_calib(&rpmsg, &calib);
+    const RegulatorGains initial_gains = {1, 2, 3, 4, 5, 6, 7, 8};
+    regulator_init(&regulator, &initial_gains);
+    rpmsg_set_regulator(&rpmsg, &regulator);
+    telemetry_init(&telemetry);
+    rpmsg_set_telemetry(&rpmsg, &telemetry);
+    reference_init(&reference);
+    rpmsg_set_reference(&rpmsg, &reference);
+    const FaultLimits fault_limits = {};
+    fault_init(&fault, &fault_limits);
+    fault_set_adc_index(&fault, &control.adc.point_count);
+    rpmsg_set_fault(&rpmsg, &fault);
+    postmortem_init(&postmortem);
+    rpmsg_set_postmortem(&rpmsg, &postmortem);
+    rpmsg_run(&rpmsg);
+
+    // Connect
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_CONNECT;
+        msg.connect.version = IPP_PROTOCOL_VERSION;
+        msg.connect.max_msg_len = RPMSG_MAX_MCU_MSG_LEN;
+        msg.connect.features = IPP_FEATURES_SUPPORTED;
+        msg.connect.sample_freq_hz = SAMPLE_FREQ;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+
+    std::vector<uint8_t> buffer;
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_CAPABILITIES));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        const IppMcuMsgCapabilities &caps = msg->capabilities;
+        ASSERT_EQ(caps.version, IPP_PROTOCOL_VERSION);
+        ASSERT_EQ(caps.adc_msg_max_points, ADC_MSG_MAX_POINTS);
+        ASSERT_EQ(caps.features, uint32_t(IPP_FEATURES_SUPPORTED));
+        ASSERT_EQ(caps.sample_freq_hz, SAMPLE_FREQ);
+        ASSERT_EQ(caps.dac_buffer_size, control.dac.depth);
+        ASSERT_EQ(caps.adc_buffer_size, control.adc.depth);
+    }
+    ASSERT_EQ(rate_period_us, 1000000 / SAMPLE_FREQ);
+    ASSERT_EQ(control.dac.depth, size_t(SAMPLE_FREQ * DAC_BUFFER_TIME_MS / 1000));
+
+    // DAC request is sent only when connection is established, and never exceeds buffer depth.
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_DAC_REQUEST));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_GT(msg->dac_request.count, 0u);
+        ASSERT_LE(msg->dac_request.count, control.dac.depth);
+    }
+
+    // Produce samples until the first ADC message is sent.
+    for (size_t i = 0; i < ADC_MSG_MAX_POINTS + 1; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_ADC_DATA));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        const IppMcuMsgAdcData &adc = msg->adc_data;
+        ASSERT_EQ(adc.seq, 0u);
+        ASSERT_EQ(adc.points_arrays.len, ADC_MSG_MAX_POINTS);
+        for (size_t i = 0; i < ADC_MSG_MAX_POINTS; ++i) {
+            ASSERT_EQ(adc.points_arrays.data[i].data[0], point_t(i * ADC_COUNT));
+        }
+    }
+
+    // Decimation is applied by control task after the message is handled by receive task.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_ADC_DECIMATION;
+        msg.adc_decimation.ratio = 2;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    for (size_t i = 0; i < TIMEOUT_MS && control.adc.decimation.requested_ratio != 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(control.adc.decimation.requested_ratio, 2u);
+    // The next message contains a point left in the buffer from the previous samples, the rest of it is decimated.
+    for (size_t i = 0; i < 2 * ADC_MSG_MAX_POINTS; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_ADC_DATA));
+    for (size_t i = 0; i < 2 * ADC_MSG_MAX_POINTS; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_ADC_DATA));
+    // Two samples are averaged into each point. Ratio is switched after the first sample following
+    // the message, so `ADC_MSG_MAX_POINTS + 2` samples are not decimated.
+    const auto adc_value = [](uint64_t sample_index) {
+        const uint64_t first = (ADC_MSG_MAX_POINTS + 2) + 2 * (ADC_MSG_MAX_POINTS - 2);
+        return point_t((first + 2 * (sample_index - 2 * ADC_MSG_MAX_POINTS)) * ADC_COUNT + ADC_COUNT / 2);
+    };
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        const IppMcuMsgAdcData &adc = msg->adc_data;
+        ASSERT_EQ(adc.seq, 2u);
+        ASSERT_EQ(adc.sample_index, 2 * ADC_MSG_MAX_POINTS);
+        ASSERT_EQ(adc.points_arrays.len, ADC_MSG_MAX_POINTS);
+        for (size_t i = 0; i < ADC_MSG_MAX_POINTS; ++i) {
+            ASSERT_EQ(adc.points_arrays.data[i].data[0], adc_value(adc.sample_index + i));
+        }
+    }
+    // Send task is held off until ADC buffer overruns. Buffered points are sent without a gap,
+    // and the points lost are accounted in sample index of the first message after them.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_KEEP_ALIVE;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_EQ(xSemaphoreTake(rpmsg.service_mutex, portMAX_DELAY), pdTRUE);
+    const size_t overrun_extra = 5;
+    for (size_t i = 0; i < 2 * (control.adc.depth + overrun_extra); ++i) {
+        control_sample(&control);
+    }
+    const uint32_t overruns = control.adc.overrun.total;
+    ASSERT_GE(overruns, overrun_extra);
+    xSemaphoreGive(rpmsg.service_mutex);
+    // New points are produced after the buffered ones are sent, so that nothing more is lost.
+    for (size_t i = 0; i < TIMEOUT_MS && adc_rb_occupied(&control.adc.buffer) >= ADC_MSG_MAX_POINTS; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (size_t i = 0; i < 2 * ADC_MSG_MAX_POINTS; ++i) {
+        control_sample(&control);
+    }
+    // Message before the gap may be short, so the rest is sent on the next wake-up.
+    control_sync_notify(&rpmsg.control_sync, CONTROL_EVENT_ADC_READY);
+    {
+        uint32_t seq = 3;
+        uint64_t sample_index = 3 * ADC_MSG_MAX_POINTS;
+        uint64_t lost = 0;
+        while (lost == 0) {
+            ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_ADC_DATA));
+            const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+            const IppMcuMsgAdcData &adc = msg->adc_data;
+            ASSERT_EQ(adc.seq, seq);
+            ASSERT_GE(adc.sample_index, sample_index);
+            lost = adc.sample_index - sample_index;
+            for (size_t i = 0; i < adc.points_arrays.len; ++i) {
+                ASSERT_EQ(adc.points_arrays.data[i].data[0], adc_value(adc.sample_index + i));
+            }
+            seq += 1;
+            sample_index = adc.sample_index + adc.points_arrays.len;
+        }
+        ASSERT_EQ(lost, overruns);
+    }
+    // Calibration table is read and written as a whole, sync generator takes written one at its next tick.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_CALIB_READ;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_CALIB));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            ASSERT_EQ(msg->calib.gain.data[i], initial_calib.entries[i].gain);
+            ASSERT_EQ(msg->calib.offset.data[i], initial_calib.entries[i].offset);
+            ASSERT_EQ(msg->calib.filter.data[i], initial_calib.entries[i].filter);
+        }
+    }
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_CALIB_WRITE;
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            msg.calib_write.gain.data[i] = -int32_t(i);
+            msg.calib_write.offset.data[i] = int32_t(i * 100);
+            msg.calib_write.filter.data[i] = uint16_t(i * 1000);
+        }
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_CALIB));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            ASSERT_EQ(msg->calib.gain.data[i], -int32_t(i));
+            ASSERT_EQ(msg->calib.offset.data[i], int32_t(i * 100));
+            ASSERT_EQ(msg->calib.filter.data[i], uint16_t(i * 1000));
+        }
+    }
+    ASSERT_EQ(calib.active[1].entry.gain, initial_calib.entries[1].gain);
+    calib_commit(&calib);
+    ASSERT_EQ(calib.active[1].entry.gain, -1);
+    ASSERT_EQ(calib.active[1].entry.filter, 1000);
+    // Regulator gains are read and written in the same way.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_REGULATOR_READ;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_REGULATOR));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        ASSERT_EQ(msg->regulator.kp, 1);
+        ASSERT_EQ(msg->regulator.kd2, 6);
+    }
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_REGULATOR_WRITE;
+        msg.regulator_write = IppAppMsgRegulatorWrite{10, 20, 30, 40, 50, 60, 70, 80};
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_REGULATOR));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(msg->regulator.kp, 10);
+        ASSERT_EQ(msg->regulator.ki, 20);
+        ASSERT_EQ(msg->regulator.kd2, 60);
+        ASSERT_EQ(msg->regulator.ff_l, 80);
+    }
+    ASSERT_EQ(regulator.active.gains.ki, 2);
+    regulator_commit(&regulator);
+    ASSERT_EQ(regulator.active.gains.ki, 20);
+    ASSERT_EQ(regulator.active.gains.kd2, 60);
+    ASSERT_EQ(regulator.active.gains.ff_r, 70);
+    // Negative integral gain is rejected, reply has the gains in effect.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_REGULATOR_WRITE;
+        msg.regulator_write = IppAppMsgRegulatorWrite{1, -1, 0, 0, 0, 0, 0, 0};
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_REGULATOR));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(msg->regulator.kp, 10);
+        ASSERT_EQ(msg->regulator.ki, 20);
+    }
+    // Fault limits use the same staged write.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_FAULT_LIMITS_WRITE;
+        msg.fault_limits_write.limit = IppArray4Int32{{100, 200, 300, 400}};
+        msg.fault_limits_write.persistence = IppArray4Uint32{{1, 2, 0, 4}};
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_FAULT_LIMITS));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        ASSERT_EQ(msg->fault_limits.limit.data[FAULT_CHECK_VOUT], 200);
+        ASSERT_EQ(msg->fault_limits.persistence.data[FAULT_CHECK_FB_ERROR], 4u);
+    }
+    ASSERT_EQ(fault.limits.thresholds[FAULT_CHECK_IOUT].persistence, 0u);
+    fault_commit(&fault);
+    ASSERT_EQ(fault.limits.thresholds[FAULT_CHECK_IOUT].limit, 100);
+    ASSERT_EQ(fault.limits.thresholds[FAULT_CHECK_IOUT].persistence, 1u);
+    // Negative limit is rejected, reply has the limits in effect.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_FAULT_LIMITS_WRITE;
+        msg.fault_limits_write.limit = IppArray4Int32{{-1, 0, 0, 0}};
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_FAULT_LIMITS));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(msg->fault_limits.limit.data[FAULT_CHECK_IOUT], 100);
+    }
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_FAULT_LIMITS_READ;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_FAULT_LIMITS));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(msg->fault_limits.limit.data[FAULT_CHECK_HEATSINK], 300);
+    }
+    // Checks in the test below must not trip.
+    {
+        const FaultLimits disabled = {};
+        ASSERT_TRUE(fault_write_limits(&fault, &disabled));
+        fault_commit(&fault);
+    }
+    // DAC upsampling switches reference interpolation together with DAC hold.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_DAC_UPSAMPLING;
+        msg.dac_upsampling.ratio = 10;
+        msg.dac_upsampling.interpolate = 1;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    for (size_t i = 0; i < TIMEOUT_MS && reference.requested_ticks == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(reference.requested_ticks, 10u * REFERENCE_TICKS_PER_SAMPLE);
+    ASSERT_EQ(control.dac.upsampling, 10u);
+    // Telemetry is stopped until app sets the ratio.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_TELEMETRY;
+        msg.telemetry.ratio = 2;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    for (size_t i = 0; i < TIMEOUT_MS && telemetry.requested_ratio != 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(telemetry.requested_ratio, 2u);
+    const auto push_ticks = [&](int32_t first, int32_t count) {
+        for (int32_t i = first; i < first + count; ++i) {
+            TelemetryPoint point = {};
+            point.values[TELEMETRY_REF] = i;
+            point.values[TELEMETRY_SUM] = -i;
+            telemetry_push(&telemetry, &point);
+        }
+    };
+    // Whole messages are sent as soon as the send task is woken up.
+    push_ticks(0, 2 * TELEMETRY_MSG_MAX_POINTS);
+    control_sync_notify(&rpmsg.control_sync, 0);
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_TELEMETRY));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        const IppMcuMsgTelemetry &tm = msg->telemetry;
+        ASSERT_EQ(tm.point_index, 0u);
+        ASSERT_EQ(tm.points.len, TELEMETRY_MSG_MAX_POINTS);
+        for (size_t i = 0; i < TELEMETRY_MSG_MAX_POINTS; ++i) {
+            ASSERT_EQ(tm.points.data[i].data[TELEMETRY_REF], int32_t(2 * i));
+            ASSERT_EQ(tm.points.data[i].data[TELEMETRY_SUM], -int32_t(2 * i));
+        }
+    }
+    // The rest is flushed after `TELEMETRY_FLUSH_PERIOD_MS`.
+    push_ticks(2 * TELEMETRY_MSG_MAX_POINTS, 3);
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_KEEP_ALIVE;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_FLUSH_PERIOD_MS + 20));
+    control_sync_notify(&rpmsg.control_sync, 0);
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_TELEMETRY));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        const IppMcuMsgTelemetry &tm = msg->telemetry;
+        ASSERT_EQ(tm.point_index, TELEMETRY_MSG_MAX_POINTS);
+        ASSERT_EQ(tm.points.len, 2u);
+        ASSERT_EQ(tm.points.data[1].data[TELEMETRY_REF], int32_t(2 * TELEMETRY_MSG_MAX_POINTS + 2));
+    }
+    // Points lost on overrun are accounted at their place in the same way as ADC ones.
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_KEEP_ALIVE;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    ASSERT_EQ(xSemaphoreTake(rpmsg.service_mutex, portMAX_DELAY), pdTRUE);
+    const int32_t overrun_tick = 2 * TELEMETRY_MSG_MAX_POINTS + 3;
+    push_ticks(overrun_tick, 2 * (TELEMETRY_BUFFER_SIZE + 5));
+    ASSERT_EQ(telemetry.overrun.total, 5u);
+    xSemaphoreGive(rpmsg.service_mutex);
+    control_sync_notify(&rpmsg.control_sync, 0);
+    for (size_t i = 0; i < TIMEOUT_MS && telemetry_rb_occupied(&telemetry.buffer) >= TELEMETRY_MSG_MAX_POINTS; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    push_ticks(overrun_tick + 2 * (TELEMETRY_BUFFER_SIZE + 5), 2 * TELEMETRY_MSG_MAX_POINTS);
+    control_sync_notify(&rpmsg.control_sync, 0);
+    {
+        // Each stored point is taken every second tick.
+        uint64_t point_index = TELEMETRY_MSG_MAX_POINTS + 2;
+        uint64_t lost = 0;
+        while (lost == 0) {
+            ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_TELEMETRY));
+            const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+            const IppMcuMsgTelemetry &tm = msg->telemetry;
+            ASSERT_GE(tm.point_index, point_index);
+            lost = tm.point_index - point_index;
+            for (size_t i = 0; i < tm.points.len; ++i) {
+                ASSERT_EQ(tm.points.data[i].data[TELEMETRY_REF], int32_t(2 * (tm.point_index + i)));
+            }
+            point_index = tm.point_index + tm.points.len;
+        }
+        ASSERT_EQ(lost, 5u);
+    }
+    // The first fault is reported once, with sample index of the ADC point being accumulated.
+    const int32_t values[FAULT_CHECK_COUNT] = {};
+    fault_check(&fault, values);
+    const uint32_t fault_sample_index = control.adc.point_count;
+    fault_trip(&fault, FAULT_DCCT);
+    fault_trip(&fault, FAULT_EXT_LOCK2);
+    control_sync_notify(&rpmsg.control_sync, 0);
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_FAULT));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        ASSERT_EQ(msg->fault.code, FAULT_DCCT);
+        ASSERT_EQ(msg->fault.tick, 1u);
+        ASSERT_EQ(msg->fault.sample_index, fault_sample_index);
+        ASSERT_EQ(msg->fault.count, 1u);
+        ASSERT_EQ(msg->fault.lost_count, 0u);
+    }
+    // Post-mortem buffer frozen on the fault is uploaded in chunks and then re-armed.
+    const uint16_t pm_size = 2 * POSTMORTEM_MSG_MAX_POINTS + 1;
+    for (uint16_t i = 0; i < pm_size; ++i) {
+        PostmortemPoint point = {};
+        point.values[POSTMORTEM_REF] = i;
+        postmortem_push(&postmortem, &point, i + 1 == pm_size ? fault.count : 0);
+    }
+    ASSERT_TRUE(postmortem_frozen(&postmortem));
+    control_sync_notify(&rpmsg.control_sync, 0);
+    for (uint16_t offset = 0; offset < pm_size;) {
+        ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_POSTMORTEM));
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(buffer.size(), ipp_mcu_msg_size(msg));
+        const IppMcuMsgPostmortem &pm = msg->postmortem;
+        ASSERT_EQ(pm.fault_count, 1u);
+        ASSERT_EQ(pm.size, pm_size);
+        ASSERT_EQ(pm.offset, offset);
+        ASSERT_GT(pm.points.len, 0u);
+        for (size_t i = 0; i < pm.points.len; ++i) {
+            ASSERT_EQ(pm.points.data[i].data[POSTMORTEM_REF], int32_t(offset + i));
+        }
+        offset += pm.points.len;
+    }
+    for (size_t i = 0; i < TIMEOUT_MS && postmortem_frozen(&postmortem); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_FALSE(postmortem_frozen(&postmortem));
+    // Reconnect at lower rate before keep-alive timeout while samples are produced.
+    constexpr uint32_t LOW_FREQ = 5000;
+    const size_t low_points = std::min(size_t(ADC_MSG_MAX_POINTS), size_t(LOW_FREQ / ADC_MSG_RATE_HZ));
+    for (size_t i = 0; i < ADC_MSG_MAX_POINTS / 2; ++i) {
+        control_sample(&control);
+    }
+    {
+        IppAppMsg msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.type = IPP_APP_MSG_CONNECT;
+        msg.connect.version = IPP_PROTOCOL_VERSION;
+        msg.connect.max_msg_len = RPMSG_MAX_MCU_MSG_LEN;
+        msg.connect.features = IPP_FEATURES_SUPPORTED;
+        msg.connect.sample_freq_hz = LOW_FREQ;
+        hal_rpmsg_host_push_rx(reinterpret_cast<const uint8_t *>(&msg), ipp_app_msg_size(&msg));
+    }
+    for (size_t i = 0; i < 4 * ADC_MSG_MAX_POINTS; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_CAPABILITIES));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(msg->capabilities.sample_freq_hz, LOW_FREQ);
+        ASSERT_EQ(msg->capabilities.adc_msg_max_points, low_points);
+    }
+    // Send task is woken up by control task once per shortened message.
+    ASSERT_EQ(rpmsg.control_sync.adc_notify_every, low_points);
+    for (size_t i = 0; i < low_points; ++i) {
+        control_sample(&control);
+    }
+    ASSERT_TRUE(receive(buffer, IPP_MCU_MSG_ADC_DATA));
+    {
+        const auto *msg = reinterpret_cast<const IppMcuMsg *>(buffer.data());
+        ASSERT_EQ(msg->adc_data.seq, 0u);
+        ASSERT_EQ(msg->adc_data.points_arrays.len, low_points);
+    }
+}
@@ -0,0 +1,93 @@
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/stats.h>
+}
+
+TEST(Stats, request_reset) {
+    static Statistics stats;
+    stats_init(&stats);
+
+    stats_write_begin(&stats);
+    stats.sample_count += 1;
+    value_stats_update(&stats.adc.values[0], 10);
+    stats_write_end(&stats);
+    // Updated by RPMSG receive task outside of seqlock.
+    stats.dac.lost_full += 1;
+    stats.link.dac_msg_lost += 1;
+
+    // Counters of receive task are reset at once, control task ones are deferred until the next update.
+    stats_request_reset(&stats);
+    ASSERT_EQ(stats.dac.lost_full, 0u);
+    ASSERT_EQ(stats.link.dac_msg_lost, 0u);
+    ASSERT_EQ(stats.sample_count, 1u);
+    stats.link.dac_msg_lost += 1;
+
+    stats_write_begin(&stats);
+    stats.sample_count += 1;
+    stats_write_end(&stats);
+    ASSERT_EQ(stats.sample_count, 1u);
+    ASSERT_EQ(stats.adc.values[0].count, 0u);
+    ASSERT_FALSE(stats.reset_requested);
+    // Control task does not touch counters of receive task.
+    ASSERT_EQ(stats.link.dac_msg_lost, 1u);
+}
+
+TEST(Stats, clock_reset) {
+    static Statistics stats;
+    stats_init(&stats);
+
+    stats_clock_tick(&stats);
+    stats_clock_tick(&stats);
+    // Clock count is reset by sync generator on its next tick, not by control task.
+    stats_request_reset(&stats);
+    ASSERT_EQ(stats.clock_count, 2u);
+    stats_write_begin(&stats);
+    stats_write_end(&stats);
+    ASSERT_EQ(stats.clock_count, 2u);
+    stats_clock_tick(&stats);
+    ASSERT_EQ(stats.clock_count, 1u);
+    ASSERT_FALSE(stats.clock_reset_requested);
+    stats_clock_tick(&stats);
+    ASSERT_EQ(stats.clock_count, 2u);
+}
+
+TEST(Stats, consistent_snapshot) {
+    static Statistics stats;
+    stats_init(&stats);
+
+    static constexpr uint32_t COUNT = 200000;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            stats_write_begin(&stats);
+            for (size_t j = 0; j < ADC_COUNT; ++j) {
+                value_stats_update(&stats.adc.values[j], point_t(i));
+            }
+            stats.sample_count += 1;
+            stats_write_end(&stats);
+        }
+        done.store(true);
+    });
+
+    // All fields updated in a single write section must be seen together.
+    static Statistics snapshot;
+    size_t snapshots = 0;
+    while (!done.load()) {
+        stats_snapshot(&stats, &snapshot);
+        for (size_t j = 0; j < ADC_COUNT; ++j) {
+            ASSERT_EQ(uint64_t(snapshot.adc.values[j].count), snapshot.sample_count);
+            ASSERT_EQ(snapshot.adc.values[j].sum, snapshot.adc.values[0].sum);
+        }
+        snapshots += 1;
+    }
+    writer.join();
+    ASSERT_GT(snapshots, 0u);
+
+    stats_snapshot(&stats, &snapshot);
+    ASSERT_EQ(snapshot.sample_count, uint64_t(COUNT));
+    ASSERT_EQ(snapshot.adc.values[ADC_COUNT - 1].max, point_t(COUNT - 1));
+}
@@ -0,0 +1,30 @@
+// Minimal subset of FreeRTOS API used by MCU tasks, implemented on top of POSIX threads for host builds.
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0)
+
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+#ifdef __cplusplus
+}
+#endif
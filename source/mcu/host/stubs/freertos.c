@@ -0,0 +1,215 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "deadline.h"
+
+struct HostSemaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool given;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    SemaphoreHandle_t sem = (SemaphoreHandle_t)malloc(sizeof(struct HostSemaphore));
+    if (sem == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->mutex, NULL);
+    host_cond_init(&sem->cond);
+    sem->given = false;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    if (sem != NULL) {
+        sem->given = true;
+    }
+    return sem;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    free(sem);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->mutex);
+    bool was_given = sem->given;
+    sem->given = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+    return was_given ? pdFALSE : pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *higher_priority_task_woken) {
+    if (higher_priority_task_woken != NULL) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout) {
+    struct timespec deadline = host_deadline_ms(timeout);
+    pthread_mutex_lock(&sem->mutex);
+    while (!sem->given) {
+        if (timeout == portMAX_DELAY) {
+            pthread_cond_wait(&sem->cond, &sem->mutex);
+        } else if (pthread_cond_timedwait(&sem->cond, &sem->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    bool taken = sem->given;
+    sem->given = false;
+    pthread_mutex_unlock(&sem->mutex);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+/// Notification state of a task, it is never freed because tasks are never deleted.
+struct HostTask {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t value;
+    bool pending;
+};
+
+static __thread TaskHandle_t CURRENT_TASK = NULL;
+
+static TaskHandle_t task_new(void) {
+    TaskHandle_t task = (TaskHandle_t)malloc(sizeof(struct HostTask));
+    if (task == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&task->mutex, NULL);
+    host_cond_init(&task->cond);
+    task->value = 0;
+    task->pending = false;
+    return task;
+}
+
+typedef struct {
+    TaskFunction_t function;
+    void *param;
+    TaskHandle_t task;
+} TaskStart;
+
+static void *task_entry(void *arg) {
+    TaskStart start = *(TaskStart *)arg;
+    free(arg);
+    CURRENT_TASK = start.task;
+    start.function(start.param);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(
+    TaskFunction_t function,
+    const char *name,
+    uint32_t stack_depth,
+    void *param,
+    UBaseType_t priority,
+    TaskHandle_t *handle //
+) {
+    TaskStart *start = (TaskStart *)malloc(sizeof(TaskStart));
+    if (start == NULL) {
+        return pdFAIL;
+    }
+    start->function = function;
+    start->param = param;
+    start->task = task_new();
+    if (start->task == NULL) {
+        free(start);
+        return pdFAIL;
+    }
+    // Handle is set before the task starts like in FreeRTOS.
+    if (handle != NULL) {
+        *handle = start->task;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_entry, start) != 0) {
+        free(start);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec delay = {(time_t)(ticks / 1000), (long)(ticks % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (TickType_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (CURRENT_TASK == NULL) {
+        CURRENT_TASK = task_new();
+    }
+    return CURRENT_TASK;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    pthread_mutex_lock(&task->mutex);
+    switch (action) {
+    case eSetBits:
+        task->value |= value;
+        break;
+    case eIncrement:
+        task->value += 1;
+        break;
+    case eSetValueWithOverwrite:
+        task->value = value;
+        break;
+    default:
+        break;
+    }
+    task->pending = true;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->mutex);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *higher_priority_task_woken) {
+    if (higher_priority_task_woken != NULL) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t timeout) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = host_deadline_ms(timeout);
+    pthread_mutex_lock(&task->mutex);
+    if (!task->pending) {
+        task->value &= ~clear_on_entry;
+    }
+    while (!task->pending) {
+        if (timeout == portMAX_DELAY) {
+            pthread_cond_wait(&task->cond, &task->mutex);
+        } else if (pthread_cond_timedwait(&task->cond, &task->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (value != NULL) {
+        *value = task->value;
+    }
+    bool received = task->pending;
+    if (received) {
+        task->value &= ~clear_on_exit;
+        task->pending = false;
+    }
+    pthread_mutex_unlock(&task->mutex);
+    return received ? pdTRUE : pdFALSE;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "defs.h"
+#include "log.h"
+
+#define hal_panic() \
+    do { \
+        hal_log_error("Panic at %s:%d", __FILE__, __LINE__); \
+        abort(); \
+    } while (0)
+
+#define hal_assert(expr) \
+    do { \
+        if (!(expr)) { \
+            hal_log_error("Assertion failed: %s", #expr); \
+            hal_panic(); \
+        } \
+    } while (0)
+
+#define hal_assert_retcode(expr) \
+    do { \
+        hal_retcode __ret = (expr); \
+        if (__ret != HAL_SUCCESS) { \
+            hal_log_error("Assertion failed: %s returned %d", #expr, (int)__ret); \
+            hal_panic(); \
+        } \
+    } while (0)
+
+#define hal_unreachable() hal_panic()
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    size_t value;
+} hal_atomic_size_t;
+
+static inline size_t hal_atomic_size_load(hal_atomic_size_t *self) {
+    return __atomic_load_n(&self->value, __ATOMIC_SEQ_CST);
+}
+
+static inline void hal_atomic_size_store(hal_atomic_size_t *self, size_t value) {
+    __atomic_store_n(&self->value, value, __ATOMIC_SEQ_CST);
+}
+
+static inline size_t hal_atomic_size_add(hal_atomic_size_t *self, size_t value) {
+    return __atomic_fetch_add(&self->value, value, __ATOMIC_SEQ_CST);
+}
+
+/// Subtract `value` saturating at zero.
+/// @return Amount by which `value` exceeded the stored one.
+static inline size_t hal_atomic_size_sub_checked(hal_atomic_size_t *self, size_t value) {
+    size_t current = __atomic_load_n(&self->value, __ATOMIC_SEQ_CST);
+    for (;;) {
+        size_t next = current >= value ? current - value : 0;
+        if (__atomic_compare_exchange_n(&self->value, &current, next, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            return current >= value ? 0 : value - current;
+        }
+    }
+}
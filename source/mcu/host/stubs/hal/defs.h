@@ -0,0 +1,19 @@
+// Host replacement of HAL definitions.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    HAL_SUCCESS = 0,
+    HAL_FAILURE,
+    HAL_BAD_ALLOC,
+    HAL_OUT_OF_BOUNDS,
+    HAL_UNIMPLEMENTED,
+    HAL_INVALID_INPUT,
+    HAL_INVALID_DATA,
+    HAL_TIMED_OUT,
+} hal_retcode;
+
+#define HAL_WAIT_FOREVER 0xffffffffUL
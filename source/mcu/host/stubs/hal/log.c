@@ -0,0 +1,19 @@
+#include "log.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+int HAL_HOST_LOG_LEVEL = HAL_HOST_LOG_WARN;
+
+void hal_host_log(int level, const char *format, ...) {
+    static const char *const PREFIXES[] = {"[error] ", "[warn] ", "[info] "};
+    if (level > HAL_HOST_LOG_LEVEL) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fputs(PREFIXES[level], stderr);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
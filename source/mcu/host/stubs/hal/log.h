@@ -0,0 +1,23 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Log levels above this one are suppressed. Warnings and errors are printed by default.
+extern int HAL_HOST_LOG_LEVEL;
+
+#define HAL_HOST_LOG_ERROR 0
+#define HAL_HOST_LOG_WARN 1
+#define HAL_HOST_LOG_INFO 2
+
+/// NOTE: Format arguments follow 32-bit MCU conventions (e.g. `%ld` for `uint32_t`), so they are not type-checked.
+void hal_host_log(int level, const char *format, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define hal_log_error(...) hal_host_log(HAL_HOST_LOG_ERROR, __VA_ARGS__)
+#define hal_log_warn(...) hal_host_log(HAL_HOST_LOG_WARN, __VA_ARGS__)
+#define hal_log_info(...) hal_host_log(HAL_HOST_LOG_INFO, __VA_ARGS__)
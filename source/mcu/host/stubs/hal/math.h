@@ -0,0 +1,4 @@
+#pragma once
+
+#define hal_min(a, b) ((a) < (b) ? (a) : (b))
+#define hal_max(a, b) ((a) > (b) ? (a) : (b))
@@ -0,0 +1,146 @@
+#include "rpmsg.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include <common/config.h>
+
+#include "../deadline.h"
+
+#define QUEUE_CAPACITY 256
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} Message;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    Message items[QUEUE_CAPACITY];
+    size_t head;
+    size_t tail;
+    bool init;
+} Queue;
+
+static Queue RX_QUEUE = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+static Queue TX_QUEUE = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+static void queue_init(Queue *self) {
+    pthread_mutex_lock(&self->mutex);
+    if (!self->init) {
+        host_cond_init(&self->cond);
+        self->head = 0;
+        self->tail = 0;
+        self->init = true;
+    }
+    pthread_mutex_unlock(&self->mutex);
+}
+
+/// Takes ownership of `data`.
+static bool queue_push(Queue *self, uint8_t *data, size_t len) {
+    queue_init(self);
+    pthread_mutex_lock(&self->mutex);
+    bool ok = self->head - self->tail < QUEUE_CAPACITY;
+    if (ok) {
+        self->items[self->head % QUEUE_CAPACITY] = (Message){data, len};
+        self->head += 1;
+        pthread_cond_signal(&self->cond);
+    }
+    pthread_mutex_unlock(&self->mutex);
+    return ok;
+}
+
+static bool queue_pop(Queue *self, Message *message, uint32_t timeout_ms) {
+    queue_init(self);
+    struct timespec deadline = host_deadline_ms(timeout_ms);
+    pthread_mutex_lock(&self->mutex);
+    while (self->head == self->tail) {
+        if (timeout_ms == HAL_WAIT_FOREVER) {
+            pthread_cond_wait(&self->cond, &self->mutex);
+        } else if (pthread_cond_timedwait(&self->cond, &self->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    bool ok = self->head != self->tail;
+    if (ok) {
+        *message = self->items[self->tail % QUEUE_CAPACITY];
+        self->tail += 1;
+    }
+    pthread_mutex_unlock(&self->mutex);
+    return ok;
+}
+
+void hal_rpmsg_init(void) {
+    queue_init(&RX_QUEUE);
+    queue_init(&TX_QUEUE);
+}
+
+void hal_rpmsg_deinit(void) {}
+
+hal_retcode hal_rpmsg_create_channel(hal_rpmsg_channel *channel, uint32_t remote_addr) {
+    channel->remote_addr = remote_addr;
+    return HAL_SUCCESS;
+}
+
+hal_retcode hal_rpmsg_destroy_channel(hal_rpmsg_channel *channel) {
+    return HAL_SUCCESS;
+}
+
+hal_retcode hal_rpmsg_alloc_tx_buffer(hal_rpmsg_channel *channel, uint8_t **buffer, size_t *size, uint32_t timeout) {
+    *buffer = (uint8_t *)calloc(1, RPMSG_MAX_MCU_MSG_LEN);
+    if (*buffer == NULL) {
+        return HAL_BAD_ALLOC;
+    }
+    *size = RPMSG_MAX_MCU_MSG_LEN;
+    return HAL_SUCCESS;
+}
+
+hal_retcode hal_rpmsg_free_rx_buffer(hal_rpmsg_channel *channel, uint8_t *buffer) {
+    free(buffer);
+    return HAL_SUCCESS;
+}
+
+hal_retcode hal_rpmsg_send_nocopy(hal_rpmsg_channel *channel, uint8_t *buffer, size_t len) {
+    if (!queue_push(&TX_QUEUE, buffer, len)) {
+        free(buffer);
+        return HAL_OUT_OF_BOUNDS;
+    }
+    return HAL_SUCCESS;
+}
+
+hal_retcode hal_rpmsg_recv_nocopy(hal_rpmsg_channel *channel, uint8_t **buffer, size_t *len, uint32_t timeout) {
+    Message message;
+    if (!queue_pop(&RX_QUEUE, &message, timeout)) {
+        return HAL_TIMED_OUT;
+    }
+    *buffer = message.data;
+    *len = message.len;
+    return HAL_SUCCESS;
+}
+
+void hal_rpmsg_host_push_rx(const uint8_t *data, size_t len) {
+    // Receive buffers have fixed size like in shared memory.
+    uint8_t *buffer = (uint8_t *)calloc(1, RPMSG_MAX_APP_MSG_LEN);
+    if (buffer == NULL || len > RPMSG_MAX_APP_MSG_LEN) {
+        abort();
+    }
+    memcpy(buffer, data, len);
+    if (!queue_push(&RX_QUEUE, buffer, len)) {
+        abort();
+    }
+}
+
+size_t hal_rpmsg_host_pop_tx(uint8_t *data, size_t max_len, uint32_t timeout_ms) {
+    Message message;
+    if (!queue_pop(&TX_QUEUE, &message, timeout_ms)) {
+        return 0;
+    }
+    size_t len = message.len < max_len ? message.len : max_len;
+    memcpy(data, message.data, len);
+    free(message.data);
+    return len;
+}
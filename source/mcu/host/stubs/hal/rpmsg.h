@@ -0,0 +1,40 @@
+// Host replacement of RPMSG channel. Messages are passed through in-memory queues,
+// the other side (app) is emulated by tests using `hal_rpmsg_host_*` functions.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t remote_addr;
+} hal_rpmsg_channel;
+
+void hal_rpmsg_init(void);
+void hal_rpmsg_deinit(void);
+
+hal_retcode hal_rpmsg_create_channel(hal_rpmsg_channel *channel, uint32_t remote_addr);
+hal_retcode hal_rpmsg_destroy_channel(hal_rpmsg_channel *channel);
+
+hal_retcode hal_rpmsg_alloc_tx_buffer(hal_rpmsg_channel *channel, uint8_t **buffer, size_t *size, uint32_t timeout);
+hal_retcode hal_rpmsg_free_rx_buffer(hal_rpmsg_channel *channel, uint8_t *buffer);
+
+hal_retcode hal_rpmsg_send_nocopy(hal_rpmsg_channel *channel, uint8_t *buffer, size_t len);
+hal_retcode hal_rpmsg_recv_nocopy(hal_rpmsg_channel *channel, uint8_t **buffer, size_t *len, uint32_t timeout);
+
+/// Host only: put message to be received by MCU.
+void hal_rpmsg_host_push_rx(const uint8_t *data, size_t len);
+
+/// Host only: take message sent by MCU.
+/// @return Length of the message or zero if timed out.
+size_t hal_rpmsg_host_pop_tx(uint8_t *data, size_t max_len, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
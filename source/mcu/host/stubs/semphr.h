@@ -0,0 +1,22 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct HostSemaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+/// Binary semaphore that is initially given, no priority inheritance on host.
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *higher_priority_task_woken);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct HostTask *TaskHandle_t;
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+} eNotifyAction;
+
+/// Task is run in detached thread, priority and stack depth are ignored.
+BaseType_t xTaskCreate(
+    TaskFunction_t function,
+    const char *name,
+    uint32_t stack_depth,
+    void *param,
+    UBaseType_t priority,
+    TaskHandle_t *handle //
+);
+
+void vTaskDelay(TickType_t ticks);
+
+TickType_t xTaskGetTickCount(void);
+
+/// Handle of calling thread, threads not created by `xTaskCreate` get one on the first call.
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *higher_priority_task_woken);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
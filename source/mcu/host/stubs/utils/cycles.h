@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+// Host backend of CPU cycle counter: one cycle is one nanosecond of monotonic clock.
+
+#define CYCLES_PER_US 1000u
+
+static inline void cycles_init(void) {}
+
+static inline uint32_t cycles_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec);
+}
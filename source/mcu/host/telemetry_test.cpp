@@ -0,0 +1,92 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <tasks/telemetry.h>
+}
+
+static TelemetryPoint make_point(int32_t value) {
+    TelemetryPoint point;
+    for (size_t i = 0; i < TELEMETRY_COUNT; ++i) {
+        point.values[i] = value + int32_t(i);
+    }
+    return point;
+}
+
+static std::vector<int32_t> read_all(Telemetry &telemetry) {
+    std::vector<int32_t> values;
+    TelemetryPoint point;
+    while (telemetry_rb_read(&telemetry.buffer, &point, 1) == 1) {
+        EXPECT_EQ(point.values[TELEMETRY_SUM], point.values[TELEMETRY_REF] + TELEMETRY_SUM);
+        values.push_back(point.values[TELEMETRY_REF]);
+    }
+    return values;
+}
+
+TEST(Telemetry, stopped_by_default) {
+    static Telemetry telemetry;
+    telemetry_init(&telemetry);
+    for (int32_t i = 0; i < 100; ++i) {
+        auto point = make_point(i);
+        telemetry_push(&telemetry, &point);
+    }
+    ASSERT_EQ(telemetry_rb_occupied(&telemetry.buffer), 0u);
+}
+
+TEST(Telemetry, ratio) {
+    static Telemetry telemetry;
+    telemetry_init(&telemetry);
+
+    telemetry_set_ratio(&telemetry, 3);
+    for (int32_t i = 0; i < 10; ++i) {
+        auto point = make_point(i);
+        telemetry_push(&telemetry, &point);
+    }
+    // The first point after switch is taken at once.
+    ASSERT_EQ(read_all(telemetry), (std::vector<int32_t>{0, 3, 6, 9}));
+
+    telemetry_set_ratio(&telemetry, 1);
+    for (int32_t i = 10; i < 13; ++i) {
+        auto point = make_point(i);
+        telemetry_push(&telemetry, &point);
+    }
+    ASSERT_EQ(read_all(telemetry), (std::vector<int32_t>{10, 11, 12}));
+
+    telemetry_set_ratio(&telemetry, 0);
+    auto point = make_point(13);
+    telemetry_push(&telemetry, &point);
+    ASSERT_EQ(read_all(telemetry), std::vector<int32_t>{});
+}
+
+TEST(Telemetry, overrun) {
+    static Telemetry telemetry;
+    telemetry_init(&telemetry);
+    telemetry_set_ratio(&telemetry, 1);
+    for (int32_t i = 0; i < int32_t(TELEMETRY_BUFFER_SIZE) + 5; ++i) {
+        auto point = make_point(i);
+        telemetry_push(&telemetry, &point);
+    }
+    // New points are dropped, stored ones are kept.
+    ASSERT_EQ(telemetry.overrun.total, 5u);
+    auto values = read_all(telemetry);
+    ASSERT_EQ(values.size(), size_t(TELEMETRY_BUFFER_SIZE));
+    ASSERT_EQ(values.front(), 0);
+    ASSERT_EQ(values.back(), int32_t(TELEMETRY_BUFFER_SIZE) - 1);
+
+    // Lost points are recorded before the next stored one.
+    auto point = make_point(int32_t(TELEMETRY_BUFFER_SIZE) + 5);
+    telemetry_push(&telemetry, &point);
+    size_t len = TELEMETRY_BUFFER_SIZE;
+    ASSERT_EQ(overrun_log_read(&telemetry.overrun, telemetry_rb_read_position(&telemetry.buffer), &len), 5u);
+    ASSERT_EQ(len, size_t(TELEMETRY_BUFFER_SIZE));
+    ASSERT_EQ(read_all(telemetry), std::vector<int32_t>{int32_t(TELEMETRY_BUFFER_SIZE) + 5});
+}
+
+TEST(Telemetry, saturate) {
+    ASSERT_EQ(telemetry_saturate(0), 0);
+    ASSERT_EQ(telemetry_saturate(-123456789), -123456789);
+    ASSERT_EQ(telemetry_saturate(int64_t(INT32_MAX) + 1), INT32_MAX);
+    ASSERT_EQ(telemetry_saturate(INT64_MIN), INT32_MIN);
+}
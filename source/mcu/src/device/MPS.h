@@ -17,25 +17,12 @@
 #define t250ms 249L
 #define t20ms 24L
 #define t2ms 3L
-#define SCALE(X,I) ((int64_t)(self->MPS->I-self->MPS->Offset.X) *(int64_t)self->MPS->K.X)/1000000LL
-#define FILTER(X,I,T) self-> MPS->X.val = ((int64_t)self->MPS->X.val*T+I)/(T+1) ; \
-self-> MPS->X.add += (self->MPS->X.val*T+I)%(T+1);\
-if(self-> MPS->X.add  > (T+1)) {self->MPS->X.val++; self-> MPS->X.add-=(T+1);}\
-if(self-> MPS->X.add  < -(T+1)) {self->MPS->X.val--; self-> MPS->X.add+=(T+1);}
+// Denominator of `K` and calibration gains.
+#define K_SCALE 1000000LL
 
+// Measurement channels are calibrated by table, see `tasks/calib.h`.
 typedef struct 
 {
-    int32_t val;
-    int32_t add;
-} Filter_Mes;
-typedef struct 
-{
-    int32_t Iout;
-    int32_t Vout;
-    int32_t Vreg;
-    int32_t tHS1;
-    int32_t tHS2;
-    int32_t tHS3;
     int32_t Iset;
     int32_t Vset;
 }Channels;
@@ -54,12 +41,7 @@ typedef struct
         int64_t Sum;
         int64_t Sum_Add;
         int64_t dVal;
-        int32_t KP;
-        int32_t KI;
-        int32_t KD;
-        int32_t KP2;
-        int32_t KI2;
-        int32_t KD2;
+        // Gains are kept by regulator, see tasks/regulator.h
     }Feedback;
     volatile struct 
     {
@@ -72,18 +54,17 @@ typedef struct
     
     int32_t Ain[8];
     Channels K;
-    Channels Offset;
     int32_t Iout;    //Measured value with 100uA discrette 10000 = 1,0000 A
-    Filter_Mes mIout;
+    int32_t mIout;   //Filtered value, see utils/filter.h
     int32_t Iout_Add;//filter cacl division reminder 
     int32_t Vout;    //Measured value with 100uV discrette 10000 = 1,0000 V
-    Filter_Mes mVout;//filter cacl division reminder 
+    int32_t mVout;   //Filtered value
     int32_t tHS1;    //Measured value of t HeatSink#1 with 0,1C discrette 300 = 30,0 C
-    Filter_Mes mtHS1;//filter cacl division reminder 
+    int32_t mtHS1;   //Filtered value
     int32_t tHS2;    //Measured value of t HeatSink#2 with 0,1C discrette 300 = 30,0 C
-    Filter_Mes mtHS2;//filter cacl division reminder 
+    int32_t mtHS2;   //Filtered value
     int32_t tHS3;    //Measured value of t HeatSink#3 with 0,1C discrette 300 = 30,0 C
-    Filter_Mes mtHS3;//filter cacl division reminder 
+    int32_t mtHS3;   //Filtered value
     int32_t tHeatsink;//Max value of Heatsink temperatures with 0,1C discrette 300 = 30,0 C
     int32_t Vreg;     //Measured value of VDAC readback with 100uV discrette
     int32_t Ready;   //Power Source Ready state 0 - not Ready , 1 - Ready
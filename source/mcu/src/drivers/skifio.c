@@ -1,10 +1,16 @@
 #include "skifio.h"
 
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 
 #include <fsl_common.h>
 #include <fsl_iomuxc.h>
+#ifdef SKIFIO_DMA
+#include <fsl_ecspi.h>
+#include <fsl_ecspi_sdma.h>
+#include <fsl_sdma.h>
+#endif
 
 #include <FreeRTOS.h>
 #include <task.h>
@@ -16,6 +22,7 @@
 #include <hal/time.h>
 
 #include <utils/crc.h>
+#include <utils/cycles.h>
 
 
 #define SPI_BAUD_RATE 25000000
@@ -26,6 +33,28 @@
 #define SPI_DEV_ID 0
 #define XFER_LEN 26
 
+#ifdef SKIFIO_DMA
+#define SPI_BASE ECSPI1
+#define SPI_CLOCK_FREQ \
+    (CLOCK_GetPllFreq(kCLOCK_SystemPll1Ctrl) / CLOCK_GetRootPreDivider(kCLOCK_RootEcspi1) \
+     / CLOCK_GetRootPostDivider(kCLOCK_RootEcspi1))
+
+// NOTE: SDMA1 is also used by Linux, so these channels and ECSPI1 DMA must not be claimed in device tree.
+#define DMA_BASE SDMAARM1
+#define DMA_IRQN SDMA1_IRQn
+#define DMA_TX_CHANNEL 1
+#define DMA_RX_CHANNEL 2
+// SDMA1 event sources of ECSPI1.
+#define DMA_RX_EVENT 0
+#define DMA_TX_EVENT 1
+#define DMA_CHANNEL_PRIORITY 4
+// Must not be higher (numerically lower) than FreeRTOS max syscall priority to give semaphore from ISR.
+#define DMA_IRQ_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1)
+
+// Whole transfer takes about 10 us, so the timeout is only reached on DMA failure.
+#define DMA_XFER_TIMEOUT_MS 2
+#endif
+
 #define SMP_RDY_MUX IOMUXC_UART1_TXD_GPIO5_IO23
 #define SMP_RDY_PIN 5, 23
 
@@ -88,6 +117,26 @@ static const PinInfo DOUT_PINS[SKIFIO_DOUT_SIZE] = {
     {{DOUT_3_MUX}, DOUT_3_PIN, false},
 };
 
+/// Frame sent to the board.
+typedef struct {
+    uint8_t magic[2];
+    SkifioAout dac;
+    /// CRC of `magic` and `dac`.
+    uint16_t crc;
+    uint8_t padding[XFER_LEN - 6];
+} SkifioTxFrame;
+
+/// Frame received from the board.
+/// ADC values go first and are aligned, so they can be used in place as `SkifioInput` (the same layout as `AdcArray`).
+typedef struct {
+    SkifioInput input;
+    /// CRC of `input`.
+    uint16_t crc;
+} SkifioRxFrame;
+
+_Static_assert(sizeof(SkifioTxFrame) == XFER_LEN, "Wrong TX frame layout");
+_Static_assert(offsetof(SkifioRxFrame, crc) + sizeof(uint16_t) == XFER_LEN, "Wrong RX frame layout");
+
 typedef struct {
     HalGpioGroup group;
     HalGpioPin read_rdy;
@@ -104,7 +153,16 @@ typedef struct {
 typedef struct {
     SkifioControlPins ctrl_pins;
     SkifioDioPins dio_pins;
-    SemaphoreHandle_t smp_rdy_sem;
+    /// Task waiting for ready signal, notified directly by interrupt.
+    TaskHandle_t ready_task;
+#ifdef CONTROL_SYNC_SEMAPHORE
+    /// Former wake-up path kept to compare latency, see `ControlSync`.
+    SemaphoreHandle_t ready_sem;
+#endif
+    /// Cycle counter at the last ready signal interrupt.
+    volatile uint32_t ready_cycles;
+    /// Cycles from the last ready signal interrupt until the waiting task woke up.
+    uint32_t ready_latency;
     volatile SkifioDinCallback din_callback;
     void *volatile din_user_data;
     volatile size_t sample_skip_counter;
@@ -114,10 +172,31 @@ typedef struct {
         unsigned ExtStart:1;
         unsigned ControlConnected:1;
     }flags;
+#ifdef SKIFIO_DMA
+    struct {
+        ecspi_sdma_handle_t spi_handle;
+        sdma_handle_t tx_handle;
+        sdma_handle_t rx_handle;
+        SemaphoreHandle_t done_sem;
+        volatile status_t status;
+        /// Index of frames of the last started transfer. Frames with the other index are free.
+        size_t frame;
+        bool in_flight;
+    } dma;
+#endif
 } SkifioGlobalState;
 
 static SkifioGlobalState GS;
 
+#ifdef SKIFIO_DMA
+// DMA buffers must not be cached. Frames are double-buffered: one pair is in flight, the other one is being
+// prepared (TX) or processed (RX).
+AT_NONCACHEABLE_SECTION_ALIGN(static SkifioTxFrame TX_FRAMES[2], 4);
+AT_NONCACHEABLE_SECTION_ALIGN(static SkifioRxFrame RX_FRAMES[2], 4);
+AT_NONCACHEABLE_SECTION_ALIGN(static sdma_context_data_t DMA_TX_CONTEXT, 4);
+AT_NONCACHEABLE_SECTION_ALIGN(static sdma_context_data_t DMA_RX_CONTEXT, 4);
+#endif
+
 #ifdef _SKIFIO_DEBUG
 _SkifioDebugInfo _SKIFIO_DEBUG_INFO = {0};
 #endif
@@ -131,7 +210,12 @@ static void smp_rdy_handler(void *user_data, HalGpioBlockIndex block, HalGpioPin
         _SKIFIO_DEBUG_INFO.intr_count += 1;
 #endif
         // Notify target task
-        xSemaphoreGiveFromISR(GS.smp_rdy_sem, &hptw);
+        GS.ready_cycles = cycles_now();
+#ifdef CONTROL_SYNC_SEMAPHORE
+        xSemaphoreGiveFromISR(GS.ready_sem, &hptw);
+#else
+        vTaskNotifyGiveFromISR(GS.ready_task, &hptw);
+#endif
     } else {
         GS.sample_skip_counter -= 1;
     }
@@ -223,6 +307,83 @@ void switch_dac_keys(bool state) {
     hal_gpio_pin_write(&GS.ctrl_pins.dac_keys[1], state);
 }
 
+static void write_tx_frame(SkifioTxFrame *frame, const SkifioOutput *out) {
+    frame->magic[0] = 0x55;
+    frame->magic[1] = 0xAA;
+    frame->dac = out->dac;
+    frame->crc = calculate_crc16((const uint8_t *)frame, offsetof(SkifioTxFrame, crc));
+}
+
+static hal_retcode check_rx_frame(const SkifioRxFrame *frame) {
+    if (calculate_crc16((const uint8_t *)&frame->input, sizeof(frame->input)) != frame->crc) {
+        // CRC mismatch
+        return HAL_INVALID_DATA;
+    }
+    return HAL_SUCCESS;
+}
+
+#ifdef SKIFIO_DMA
+static void dma_xfer_callback(ECSPI_Type *base, ecspi_sdma_handle_t *handle, status_t status, void *user_data) {
+    BaseType_t hptw = pdFALSE;
+    GS.dma.status = status;
+    xSemaphoreGiveFromISR(GS.dma.done_sem, &hptw);
+    portYIELD_FROM_ISR(hptw);
+}
+
+static hal_retcode init_spi_dma() {
+    // Set ECSPI1 source to SYSTEM PLL1 800 MHz and divide it by 10.
+    CLOCK_SetRootMux(kCLOCK_RootEcspi1, kCLOCK_EcspiRootmuxSysPll1);
+    CLOCK_SetRootDivider(kCLOCK_RootEcspi1, 2U, 5U);
+
+    // Chip select is not used by the board, so each byte is sent as a separate burst.
+    ecspi_master_config_t spi_config;
+    ECSPI_MasterGetDefaultConfig(&spi_config);
+    spi_config.baudRate_Bps = SPI_BAUD_RATE;
+    spi_config.burstLength = 8;
+    spi_config.channel = kECSPI_Channel0;
+    spi_config.channelConfig.phase = kECSPI_ClockPhaseSecondEdge;
+    spi_config.channelConfig.polarity = kECSPI_PolarityActiveHigh;
+    ECSPI_MasterInit(SPI_BASE, &spi_config, SPI_CLOCK_FREQ);
+
+    sdma_config_t dma_config;
+    SDMA_GetDefaultConfig(&dma_config);
+    dma_config.ratio = kSDMA_ARMClockFreq;
+    SDMA_Init(DMA_BASE, &dma_config);
+    SDMA_CreateHandle(&GS.dma.tx_handle, DMA_BASE, DMA_TX_CHANNEL, &DMA_TX_CONTEXT);
+    SDMA_CreateHandle(&GS.dma.rx_handle, DMA_BASE, DMA_RX_CHANNEL, &DMA_RX_CONTEXT);
+    SDMA_SetChannelPriority(DMA_BASE, DMA_TX_CHANNEL, DMA_CHANNEL_PRIORITY);
+    SDMA_SetChannelPriority(DMA_BASE, DMA_RX_CHANNEL, DMA_CHANNEL_PRIORITY);
+    NVIC_SetPriority(DMA_IRQN, DMA_IRQ_PRIORITY);
+
+    ECSPI_MasterTransferCreateHandleSDMA(
+        SPI_BASE,
+        &GS.dma.spi_handle,
+        dma_xfer_callback,
+        NULL,
+        &GS.dma.tx_handle,
+        &GS.dma.rx_handle,
+        DMA_TX_EVENT,
+        DMA_RX_EVENT,
+        DMA_TX_CHANNEL,
+        DMA_RX_CHANNEL //
+    );
+
+    GS.dma.done_sem = xSemaphoreCreateBinary();
+    hal_assert(GS.dma.done_sem != NULL);
+    GS.dma.status = kStatus_Success;
+    GS.dma.in_flight = false;
+
+    // DAC keys are open until enabled, so the value of the first frame doesn't matter.
+    memset(TX_FRAMES, 0, sizeof(TX_FRAMES));
+    memset(RX_FRAMES, 0, sizeof(RX_FRAMES));
+    GS.dma.frame = 1;
+    SkifioOutput out = {0};
+    write_tx_frame(&TX_FRAMES[0], &out);
+
+    return HAL_SUCCESS;
+}
+#endif
+
 hal_retcode init_spi() {
     IOMUXC_SetPinMux(IOMUXC_ECSPI1_MISO_ECSPI1_MISO, 0U);
     IOMUXC_SetPinConfig(
@@ -240,6 +401,9 @@ hal_retcode init_spi() {
         IOMUXC_SW_PAD_CTL_PAD_DSE(6U) | IOMUXC_SW_PAD_CTL_PAD_HYS_MASK | IOMUXC_SW_PAD_CTL_PAD_PE_MASK //
     );
 
+#ifdef SKIFIO_DMA
+    return init_spi_dma();
+#else
     hal_spi_init();
 
     hal_retcode st = hal_spi_enable(
@@ -254,6 +418,7 @@ hal_retcode init_spi() {
     }
 
     return HAL_SUCCESS;
+#endif
 }
 
 hal_retcode skifio_init() {
@@ -271,8 +436,14 @@ hal_retcode skifio_init() {
     GS.flags.ExtSync = 0;
     GS.flags.ControlConnected = 0;
 
-    GS.smp_rdy_sem = xSemaphoreCreateBinary();
-    hal_assert(GS.smp_rdy_sem != NULL);
+    // Ready signal is waited by the task that initializes the driver.
+    GS.ready_task = xTaskGetCurrentTaskHandle();
+#ifdef CONTROL_SYNC_SEMAPHORE
+    GS.ready_sem = xSemaphoreCreateBinary();
+    hal_assert(GS.ready_sem != NULL);
+#endif
+    GS.ready_cycles = 0;
+    GS.ready_latency = 0;
 
     ret = init_spi();
     if (ret != HAL_SUCCESS) {
@@ -293,13 +464,27 @@ hal_retcode skifio_init() {
 hal_retcode skifio_deinit() {
     hal_gpio_group_set_intr(&GS.ctrl_pins.group, NULL, NULL);
     switch_dac_keys(false);
+#ifdef CONTROL_SYNC_SEMAPHORE
+    vSemaphoreDelete(GS.ready_sem);
+#endif
 
+#ifdef SKIFIO_DMA
+    if (GS.dma.in_flight) {
+        ECSPI_MasterTransferAbortSDMA(SPI_BASE, &GS.dma.spi_handle);
+        GS.dma.in_flight = false;
+    }
+    ECSPI_Deinit(SPI_BASE);
+    SDMA_Deinit(DMA_BASE);
+    vSemaphoreDelete(GS.dma.done_sem);
+    return HAL_SUCCESS;
+#else
     hal_retcode st = hal_spi_disable(SPI_DEV_ID);
     if (st != HAL_SUCCESS) {
         return st;
     }
     hal_spi_deinit();
     return HAL_SUCCESS;
+#endif
 }
 
 size_t skifio_readFlag(size_t Flag){
@@ -323,52 +508,97 @@ hal_retcode skifio_dac_disable() {
 }
 
 hal_retcode skifio_transfer(const SkifioOutput *out, SkifioInput *in) {
+#ifdef SKIFIO_DMA
+    hal_retcode st = skifio_transfer_prepare(out);
+    if (st != HAL_SUCCESS) {
+        return st;
+    }
+    st = skifio_transfer_start();
+    if (st != HAL_SUCCESS) {
+        return st;
+    }
+    const SkifioInput *frame_in = NULL;
+    st = skifio_transfer_wait(&frame_in);
+    if (frame_in != NULL) {
+        memcpy(in, frame_in, sizeof(SkifioInput));
+    }
+    return st;
+#else
     hal_retcode st = HAL_SUCCESS;
-    uint8_t tx[XFER_LEN] = {0};
-    uint8_t rx[XFER_LEN] = {0};
-    uint16_t calc_crc = 0;
-
-    // Store magic number
-    tx[0] = 0x55;
-    tx[1] = 0xAA;
-
-    // Store DAC value
-    memcpy(tx + 2, &out->dac, 2);
+    SkifioTxFrame tx = {{0}};
+    SkifioRxFrame rx = {{{0}}};
 
-    // Store CRC
-    calc_crc = calculate_crc16(tx, 4);
-    memcpy(tx + 4, &calc_crc, 2);
+    write_tx_frame(&tx, out);
 
     // Transfer data
     hal_spi_byte tx4[XFER_LEN] = {0};
     hal_spi_byte rx4[XFER_LEN] = {0};
     for (size_t i = 0; i < XFER_LEN; ++i) {
-        tx4[i] = (hal_spi_byte)tx[i];
+        tx4[i] = (hal_spi_byte)((const uint8_t *)&tx)[i];
     }
     st = hal_spi_xfer(SPI_DEV_ID, tx4, rx4, XFER_LEN, HAL_WAIT_FOREVER);
     if (st != HAL_SUCCESS) {
         return st;
     }
     for (size_t i = 0; i < XFER_LEN; ++i) {
-        rx[i] = (uint8_t)rx4[i];
+        ((uint8_t *)&rx)[i] = (uint8_t)rx4[i];
     }
 
     // Load ADC values
-    const size_t in_data_len = SKIFIO_ADC_CHANNEL_COUNT * 4;
-    memcpy(in->adcs, rx, in_data_len);
-
-    // Load and check CRC
-    calc_crc = calculate_crc16(rx, in_data_len);
-    uint16_t in_crc = 0;
-    memcpy(&in_crc, rx + in_data_len, 2);
-    if (calc_crc != in_crc) {
-        // CRC mismatch
-        return HAL_INVALID_DATA;
+    memcpy(in, &rx.input, sizeof(SkifioInput));
+
+    return check_rx_frame(&rx);
+#endif
+}
+
+#ifdef SKIFIO_DMA
+hal_retcode skifio_transfer_prepare(const SkifioOutput *out) {
+    // Frame that is not in flight.
+    write_tx_frame(&TX_FRAMES[GS.dma.frame ^ 1], out);
+    return HAL_SUCCESS;
+}
+
+hal_retcode skifio_transfer_start(void) {
+    if (GS.dma.in_flight) {
+        return HAL_FAILURE;
+    }
+    size_t frame = GS.dma.frame ^ 1;
+
+    ecspi_transfer_t xfer = {0};
+    xfer.txData = (void *)&TX_FRAMES[frame];
+    xfer.rxData = (void *)&RX_FRAMES[frame];
+    xfer.dataSize = XFER_LEN;
+    xfer.channel = kECSPI_Channel0;
+    if (ECSPI_MasterTransferSDMA(SPI_BASE, &GS.dma.spi_handle, &xfer) != kStatus_Success) {
+        return HAL_FAILURE;
     }
 
+    GS.dma.frame = frame;
+    GS.dma.in_flight = true;
     return HAL_SUCCESS;
 }
 
+hal_retcode skifio_transfer_wait(const SkifioInput **in) {
+    *in = NULL;
+    if (!GS.dma.in_flight) {
+        return HAL_FAILURE;
+    }
+    if (xSemaphoreTake(GS.dma.done_sem, DMA_XFER_TIMEOUT_MS) != pdTRUE) {
+        ECSPI_MasterTransferAbortSDMA(SPI_BASE, &GS.dma.spi_handle);
+        GS.dma.in_flight = false;
+        return HAL_TIMED_OUT;
+    }
+    GS.dma.in_flight = false;
+    if (GS.dma.status != kStatus_Success) {
+        return HAL_FAILURE;
+    }
+
+    const SkifioRxFrame *rx = &RX_FRAMES[GS.dma.frame];
+    *in = &rx->input;
+    return check_rx_frame(rx);
+}
+#endif
+
 // force data_ready software pulse
 size_t skifio_force_data_ready(void) {
 
@@ -402,16 +632,27 @@ void skifio_sync_tick(void) {
 }
 // wait for stm_data_ready pulse
 hal_retcode skifio_wait_ready(uint32_t timeout_ms) {
-    // Wait for sample ready semaphore
-    if (xSemaphoreTake(GS.smp_rdy_sem, timeout_ms) != pdTRUE) {
+#ifdef CONTROL_SYNC_SEMAPHORE
+    if (xSemaphoreTake(GS.ready_sem, timeout_ms) != pdTRUE) {
         return HAL_TIMED_OUT;
     }
+#else
+    // Wait for sample ready notification, repeated signals are merged like with binary semaphore.
+    if (ulTaskNotifyTake(pdTRUE, timeout_ms) == 0) {
+        return HAL_TIMED_OUT;
+    }
+#endif
+    GS.ready_latency = cycles_now() - GS.ready_cycles;
 
     // Wait before data request to reduce ADC noise.
     hal_busy_wait_ns(READY_DELAY_NS);
     return HAL_SUCCESS;
 }
 
+uint32_t skifio_ready_latency(void) {
+    return GS.ready_latency;
+}
+
 hal_retcode skifio_dout_write(SkifioDout value) {
     if ((value & ~((1 << SKIFIO_DOUT_SIZE) - 1)) != 0) {
         return HAL_INVALID_INPUT;
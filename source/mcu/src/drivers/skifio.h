@@ -42,9 +42,32 @@ hal_retcode skifio_dac_enable();
 hal_retcode skifio_dac_disable();
 
 hal_retcode skifio_transfer(const SkifioOutput *out, SkifioInput *in);
+
+#ifdef SKIFIO_DMA
+// DMA transfer mode.
+//
+// Frames are exchanged with the board by SDMA, so CPU is free while transfer is in progress.
+// Output frame is prepared one sample ahead: `skifio_transfer_start` sends the frame prepared by the previous
+// `skifio_transfer_prepare` call, and the next one can be prepared while the transfer is in flight.
+// Received frame is not copied, `skifio_transfer_wait` returns pointer to it.
+
+/// Prepare output frame to be sent by the next `skifio_transfer_start`.
+hal_retcode skifio_transfer_prepare(const SkifioOutput *out);
+
+/// Start transfer of previously prepared frame.
+hal_retcode skifio_transfer_start(void);
+
+/// Wait for transfer completion and check received frame.
+/// @param in Set to received input. It stays valid until the next transfer is finished.
+/// @return `HAL_INVALID_DATA` on CRC mismatch, `in` is set anyway.
+hal_retcode skifio_transfer_wait(const SkifioInput **in);
+#endif
 size_t skifio_force_data_ready(void);
 void skifio_sync_tick(void);
+/// Wait for ready signal. Must be called from the task that called `skifio_init`, it is notified directly.
 hal_retcode skifio_wait_ready(uint32_t delay_ms);
+/// Cycles from the last ready signal interrupt until `skifio_wait_ready` woke up.
+uint32_t skifio_ready_latency(void);
 
 hal_retcode skifio_dout_write(SkifioDout value);
 
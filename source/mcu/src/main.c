@@ -9,6 +9,8 @@
 #include "device/rsc_table.h"
 #include "device/MPS.h"
 
+#include <utils/cycles.h>
+
 #include <tasks/stats.h>
 #include <tasks/control.h>
 #include <tasks/rpmsg.h>
@@ -18,8 +20,6 @@
 
 // The stack of `main` is tiny, so we store our state as globals.
 //#ifdef GENERATE_SYNC
-#define SYNC_PERIOD_US 100
-#define MS_TICK 1000/SYNC_PERIOD_US
 SyncGenerator sync;
 //#endif
 Statistics stats;
@@ -27,6 +27,52 @@ Control control;
 Rpmsg rpmsg;
 PS_Control MPS={0};
 
+/// Calibration used until app writes its own, see `tasks/calib.h`.
+static const CalibTable DEFAULT_CALIB = {{
+    [CALIB_IOUT] = {-130653L, 1070L, t250ms},
+    [CALIB_VOUT] = {-39390L, -2805L, t250ms},
+    [CALIB_VREG] = {12718L, 0, 0},
+    [CALIB_THS1] = {1250L, 0, t250ms},
+    [CALIB_THS2] = {1250L, 0, t250ms},
+    [CALIB_THS3] = {1250L, 0, t250ms},
+}};
+
+/// Regulator gains used until app writes its own, see `tasks/regulator.h`.
+static const RegulatorGains DEFAULT_GAINS = {
+    .kp = 20000L,
+    .ki = 4000L,
+    .kd = 0L,
+    .kp2 = 0L,
+    .ki2 = 0L,
+    .kd2 = 0L,
+    .ff_r = 0L,
+    .ff_l = 0L,
+};
+
+/// Fault thresholds of calibrated values, see `tasks/fault.h`. Persistence is in sync ticks, 20 per ms at default rate.
+/// All checks are disabled (zero persistence) until limits are validated on the unit, because a trip shuts the output
+/// down. Limits below are the intended ones, checks are enabled at runtime by app through fault limit records.
+static const FaultLimits DEFAULT_FAULT_LIMITS = {{
+    // 5% over setpoint range.
+    [FAULT_CHECK_IOUT] = {ISETMAX + ISETMAX / 20, 0},
+    [FAULT_CHECK_VOUT] = {10L * (VSETMAX + VSETMAX / 20), 0},
+    // 80.0 C of the hottest heatsink, temperatures are already filtered.
+    [FAULT_CHECK_HEATSINK] = {800L, 0},
+    // Current is 1 A off reference while regulating.
+    [FAULT_CHECK_FB_ERROR] = {10000L, 0},
+}};
+
+static bool apply_sample_rate(void *user_data, const SampleRate *rate) {
+#ifdef MPS_CTRL_VAR
+    // Regulator runs at sync generator tick, and its gains, calibration filters and fault persistence are counted
+    // in ticks tuned for the default rate. Other rates would silently change their time constants.
+    if (rate->freq_hz != SAMPLE_FREQ_HZ) {
+        return false;
+    }
+#endif
+    sync_generator_set_period((SyncGenerator *)user_data, rate->period_us);
+    return true;
+}
 
 int main(void) {
     // M7 has its local cache and enabled by default, need to set smart subsystems (0x28000000 ~ 0x3FFFFFFF) non-cacheable
@@ -52,35 +98,31 @@ int main(void) {
     hal_print("\n\r\n\r");
     hal_log_info("** Board started **");
 
-    stats_reset(&stats);
-    MPS.ms_tick = MS_TICK;
+    cycles_init();
+
+    stats_init(&stats);
+    SampleRate rate;
+    hal_assert(sample_rate_init(&rate, SAMPLE_FREQ_HZ));
+    MPS.ms_tick = 1000 / rate.period_us;
     MPS.Fault_Clear_Count = 100L*MPS.ms_tick;
-    MPS.K.Iout = -130653L;
-    MPS.Offset.Iout = 1070L;
-    MPS.K.Vout = -39390L;
-    MPS.Offset.Vout = -2805L;
-    MPS.K.Vreg = 12718L;
-    MPS.Offset.Vreg = 0;
-    MPS.K.tHS1 = 1250L;
-    MPS.Offset.tHS1 = 0L;
-    MPS.K.tHS2 = 1250L;
-    MPS.Offset.tHS2 = 0L;
-    MPS.K.tHS3 = 1250L;
-    MPS.Offset.tHS3 = 0L;
     MPS.K.Iset = 1000000L;
     MPS.K.Vset = 100000L;
-    MPS.Feedback.KP = 20000L;
-    MPS.Feedback.KI = 4000L;
-    MPS.Feedback.KD = 0L;
-    MPS.Feedback.KP2 = 0L;
-    MPS.Feedback.KI2 = 0L;
 
     
 //#ifdef GENERATE_SYNC
-    sync_generator_init(&sync, SYNC_PERIOD_US, &stats, &MPS);
+    sync_generator_init(&sync, rate.period_us, &stats, &MPS, &DEFAULT_CALIB, &DEFAULT_GAINS, &DEFAULT_FAULT_LIMITS);
 //#endif
     control_init(&control, &stats, &MPS);
     rpmsg_init(&rpmsg, &control, &stats);
+    rpmsg_add_timing(&rpmsg, &sync.timing);
+    rpmsg_set_rate_handler(&rpmsg, apply_sample_rate, (void *)&sync);
+    rpmsg_set_calib(&rpmsg, &sync.calib);
+    rpmsg_set_regulator(&rpmsg, &sync.regulator);
+    rpmsg_set_telemetry(&rpmsg, &sync.telemetry);
+    rpmsg_set_reference(&rpmsg, &sync.reference);
+    fault_set_adc_index(&sync.fault, &control.adc.point_count);
+    rpmsg_set_fault(&rpmsg, &sync.fault);
+    rpmsg_set_postmortem(&rpmsg, &sync.postmortem);
 
     hal_log_info("Enable statistics report");
     stats_report_run(&stats);
@@ -1,135 +1,142 @@
 //LCD indication task
-//Communication UART1 19200 8bit 1stop npar
-//Format: \n\r terminated string "\n[OPT1]=%ld\t[OPT2]=%ld\t...\n\r"
-//OPT
-//IOUT=%ld   Iout mA
-//VOUT=%ld   Vout mV
-//REFSET=%ld Iset mA
-//DACSET=%ld Dacset x100uV
-//STAT=%ld   ||__|__|__|__|SoftStart|PS_ON|Operate|Ready||Board|Line|OverVolt|GndMon|OverHeat|Water|EXT2|EXT1||DCCT|__|__|Punit3|PUnit2|PUnit1|FBLost|OverCurr||
-//THS=%d
-//TSYS=%d
-//VDC=%d x100mV
-//IDC=%d x100mA
-//IP=%s ddd.ddd.ddd.ddd
-//MAC=%s xxxxxxxxxxxx
+//Communication UART3 115200 8bit 1stop npar
+//Framed binary protocol, see tasks/panel.h
+//Status frame is sent on each 5 Hz flag of sync generator, commands are taken whenever they arrive.
+//Received bytes are put into ring buffer by UART interrupt, so the task never blocks when panel is absent or silent.
 #include <stdint.h>
-#include <stdio.h>
 #include <hal/assert.h>
 #include <hal/io.h>
 #include "fsl_common.h"
-//#include "fsl_debug_console.h"
 #include "fsl_iomuxc.h"
-#include "fsl_adapter_uart.h"
+#include "fsl_uart.h"
 #include "device/board.h"
 #include "Indicate.h"
+#include "panel.h"
 #include <MIMX8MN6_cm7.h>
 
-#define WAIT_FLAG  while(MPS->Flag.f5Hz==0); MPS->Flag.f5Hz=0
-char text_buffer[128];
-char recv_buffer[128];
-uint8_t RSim;
-uint8_t txbuff[]   = "Uart polling example\r\nBoard will send back received characters\r\n";
+#define PANEL_UART UART3
+#define PANEL_UART_IRQN UART3_IRQn
+#define PANEL_UART_IRQ_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 2)
+#define PANEL_BAUD_RATE 115200U
+#define PANEL_RX_BUFFER_SIZE 256
+// Status flag is polled on wake-up, so status frames lag the flag at most by this timeout.
+#define PANEL_RX_TIMEOUT_MS 10
 
-status_t status;
-hal_uart_config_t config_UART;
-hal_uart_handle_t hUART;
+#define RB_STRUCT PanelRxRingBuffer
+#define RB_PREFIX panel_rx_rb
+#define RB_ITEM uint8_t
+#define RB_CAPACITY PANEL_RX_BUFFER_SIZE
+#include <utils/ringbuf.h>
+#include <utils/ringbuf.inl>
+#undef RB_STRUCT
+#undef RB_PREFIX
+#undef RB_ITEM
+#undef RB_CAPACITY
 
-static void DataTransfer(PS_Control* MPS, uint32_t len){
-    uint32_t idx=0;
-    char* substr=NULL;
-    int32_t data;
-    HAL_UartSendBlocking(hUART, (uint8_t*)text_buffer, len);
-    idx=0; 
-    do {HAL_UartReceiveBlocking(hUART,(uint8_t*)&RSim,1);recv_buffer[idx++]=RSim;}while(RSim!='\r');
-    recv_buffer[idx]=0;
-    if(strstr(recv_buffer,"FBMODE=CC")){
-        MPS->Flag.fCCMode=1;
-        MPS->Flag.fLocale = 1;
+typedef struct {
+    PanelRxRingBuffer rx_buffer;
+    SemaphoreHandle_t rx_sem;
+    /// Bytes lost because ring buffer or UART FIFO was full.
+    volatile uint32_t rx_overrun_count;
+    PanelParser parser;
+} Panel;
+
+static Panel PANEL;
+
+void UART3_IRQHandler(void) {
+    BaseType_t hptw = pdFALSE;
+    bool received = false;
+    while (UART_GetStatusFlag(PANEL_UART, kUART_RxDataReadyFlag)) {
+        uint8_t byte = UART_ReadByte(PANEL_UART);
+        received = true;
+        // Only this interrupt writes into the buffer.
+        if (panel_rx_rb_write(&PANEL.rx_buffer, &byte, 1) == 0) {
+            PANEL.rx_overrun_count += 1;
+        }
     }
-    if(strstr(recv_buffer,"FBMODE=CV")){
-        MPS->Flag.fCCMode=0;
-        MPS->Flag.fLocale = 1;
+    if (UART_GetStatusFlag(PANEL_UART, kUART_RxOverrunFlag)) {
+        UART_ClearStatusFlag(PANEL_UART, kUART_RxOverrunFlag);
+        PANEL.rx_overrun_count += 1;
     }
-    substr = strstr(recv_buffer,"REF_SET=");
-    if(substr){
-        //hal_log_info("%s",recv_buffer);
-        //hal_log_info("%s",substr);
-        data = atol(substr+8);
-        if(data>ISETMAX)
-            data = ISETMAX;
-        if(data<0) 
-            data = 0;
-        MPS->Ref_Set = data;
-        MPS->Flag.fLocale = 1;
-        //hal_log_info("%ld",MPS->Ref_Set );
-        }
-    substr = strstr(recv_buffer,"DAC_SET=");
-    if(substr){
-        data = atol(substr+8);
-        if(data>VSETMAX*10L)
-            data = VSETMAX*10L;
-        if(data<0) 
-            data = 0;
-        MPS->VRef_Set = data;
-        MPS->Flag.fLocale = 1;
-        //hal_log_info("%s",recv_buffer);
-        //hal_log_info("%ld",MPS->VRef_Set );
+    if (received) {
+        xSemaphoreGiveFromISR(PANEL.rx_sem, &hptw);
+    }
+    portYIELD_FROM_ISR(hptw);
+}
+
+static hal_retcode panel_uart_init(void) {
+    clock_root_control_t clock_root = kCLOCK_RootUart3;
+    uint32_t clock_hz = CLOCK_GetPllFreq(kCLOCK_SystemPll1Ctrl) / CLOCK_GetRootPreDivider(clock_root)
+        / CLOCK_GetRootPostDivider(clock_root) / 10;
+    CLOCK_EnableClock(kCLOCK_Uart3);
+
+    uart_config_t config;
+    UART_GetDefaultConfig(&config);
+    config.baudRate_Bps = PANEL_BAUD_RATE;
+    config.parityMode = kUART_ParityDisabled;
+    config.stopBitCount = kUART_OneStopBit;
+    // Interrupt on every received byte.
+    config.rxFifoWatermark = 1;
+    config.enableTx = true;
+    config.enableRx = true;
+    if (UART_Init(PANEL_UART, &config, clock_hz) != kStatus_Success) {
+        return HAL_FAILURE;
+    }
+
+    NVIC_SetPriority(PANEL_UART_IRQN, PANEL_UART_IRQ_PRIORITY);
+    UART_EnableInterrupts(PANEL_UART, kUART_RxReadyEnable | kUART_RxOverrunEnable);
+    EnableIRQ(PANEL_UART_IRQN);
+    return HAL_SUCCESS;
+}
+
+static void send_frame(const PanelFrame *frame) {
+    uint8_t buffer[PANEL_FRAME_MAX_LEN];
+    size_t len = panel_frame_encode(frame, buffer);
+    // Frame takes about 3 ms at 115200, so blocking write is cheap for this task.
+    UART_WriteBlocking(PANEL_UART, buffer, len);
+}
+
+static void receive_commands(PS_Control *MPS) {
+    const uint8_t *data = NULL;
+    size_t len;
+    while ((len = panel_rx_rb_read_peek_contiguous(&PANEL.rx_buffer, &data)) > 0) {
+        for (size_t i = 0; i < len; ++i) {
+            PanelFrame frame;
+            if (panel_parser_push(&PANEL.parser, data[i], &frame) && !panel_command_apply(&frame, MPS)) {
+                hal_log_warn("Unknown panel command: type 0x%02x, len %d", (int)frame.type, (int)frame.len);
+            }
         }
-    if(strstr(recv_buffer,"MAINPOWER=1")){
-        if(MPS->Flag.PS_ON) MPS->Operate = 1;
-        else MPS->Flag.PS_ON = 1;
-        MPS->Flag.fLocale = 1;
-  
+        panel_rx_rb_read_commit(&PANEL.rx_buffer, len);
     }
-    if(strstr(recv_buffer,"MAINPOWER=0")){
-        if(MPS->Operate) MPS->Operate = 0;
-        else MPS->Flag.PS_ON = 0;  
-        MPS->Flag.fLocale = 1;
-    }  
 }
 
 static void indication_task(void *param) {
     PS_Control *MPS = (PS_Control*)param;
-    clock_root_control_t clock_root = kCLOCK_RootUart3;
-    clock_ip_name_t clock = kCLOCK_Uart3;
-    uint32_t uartClkSrcFreqHz = CLOCK_GetPllFreq(kCLOCK_SystemPll1Ctrl) / CLOCK_GetRootPreDivider(clock_root)
-        / CLOCK_GetRootPostDivider(clock_root) / 10;
-    CLOCK_EnableClock(clock);
-    config_UART.srcClock_Hz  = uartClkSrcFreqHz;
-    config_UART.baudRate_Bps = 115200U;
-    config_UART.parityMode   = kHAL_UartParityDisabled;
-    config_UART.stopBitCount = kHAL_UartOneStopBit;
-    config_UART.enableRx     = 1U;
-    config_UART.enableTx     = 1U;
-    config_UART.enableRxRTS  = 0U;
-    config_UART.enableTxCTS  = 0U;
-    config_UART.instance     = 3U;
-    hal_log_info("UART1 Init...");
-    if (kStatus_Success != HAL_UartInit(hUART, &config_UART)) {
-        hal_log_warn("!UART1 Init FAIL... Task suspend!");
+    hal_assert_retcode(panel_rx_rb_init(&PANEL.rx_buffer));
+    PANEL.rx_sem = xSemaphoreCreateBinary();
+    hal_assert(PANEL.rx_sem != NULL);
+    PANEL.rx_overrun_count = 0;
+    panel_parser_init(&PANEL.parser);
+
+    hal_log_info("UART3 Init...");
+    if (panel_uart_init() != HAL_SUCCESS) {
+        hal_log_warn("!UART3 Init FAIL... Task suspend!");
         vTaskSuspend(NULL);
     }
-    HAL_UartSendBlocking(hUART, txbuff, sizeof(txbuff) - 1);
-    hal_log_info("UART1 Init Successfuly");
+    hal_log_info("UART3 Init Successfuly");
+
     for(;;){
-        uint32_t text_len;
-        WAIT_FLAG;
-        DataTransfer(MPS,snprintf(text_buffer,128,"\nIOUT=%ld\tVOUT=%ld\tTHS=%d\n\r",MPS->mIout.val,MPS->mVout.val/10,(int16_t)MPS->tHeatsink));
-        WAIT_FLAG;
-        DataTransfer(MPS,snprintf(text_buffer,128,"\nIOUT=%ld\tVOUT=%ld\tVSET=%ld\n\r",MPS->mIout.val,MPS->mVout.val/10,MPS->Vreg));
-        WAIT_FLAG;
-        if(MPS->Flag.fCCMode)
-        DataTransfer(MPS,snprintf(text_buffer,128,"\nIOUT=%ld\tVOUT=%ld\tREFSET=%d\n\r",MPS->mIout.val,MPS->mVout.val/10,MPS->Ref_Set));
-        else
-        DataTransfer(MPS,snprintf(text_buffer,128,"\nIOUT=%ld\tVOUT=%ld\tDACSET=%d\n\r",MPS->mIout.val,MPS->mVout.val/10,MPS->VRef_Set));
-        WAIT_FLAG;
-        uint32_t STAT = (((uint32_t)MPS->Flag.fLocale)<<20)+(((uint32_t)MPS->Flag.PS_ON)<<18)+(MPS->Operate<<17)+(MPS->Ready<<16)+\
-        (((uint32_t)MPS->Faults.Board)<<15)+(((uint32_t)MPS->Faults.Line)<<14)+(((uint32_t)MPS->Faults.Overvoltage)<<13)+(((uint32_t)MPS->Faults.GndMon)<<12)+\
-        (((uint32_t)MPS->Faults.Overheat)<<11)+(((uint32_t)MPS->Faults.ExtLock2)<<9)+(((uint32_t)MPS->Faults.ExtLock1)<<8)+\
-        (((uint32_t)MPS->Faults.DCCT)<<7)+(((uint32_t)MPS->Faults.Unit2)<<3)+(((uint32_t)MPS->Faults.Unit1)<<2)+\
-        (((uint32_t)MPS->Faults.FBLost)<<1)+(((uint32_t)MPS->Faults.Overcurrent)<<0); 
-        DataTransfer(MPS,snprintf(text_buffer,128,"\nIOUT=%ld\tVOUT=%ld\tSTAT=%ld\n\r",MPS->mIout.val,MPS->mVout.val/10,STAT));
+        xSemaphoreTake(PANEL.rx_sem, pdMS_TO_TICKS(PANEL_RX_TIMEOUT_MS));
+        receive_commands(MPS);
+
+        if (MPS->Flag.f5Hz) {
+            MPS->Flag.f5Hz = 0;
+            PanelStatus status;
+            PanelFrame frame;
+            panel_status_read(&status, MPS);
+            panel_status_write(&status, &frame);
+            send_frame(&frame);
+        }
     }
 
     // This task must never end.
@@ -138,4 +145,3 @@ static void indication_task(void *param) {
 void indication_run(PS_Control *MPS) {
     hal_assert(xTaskCreate(indication_task, "Indication_task", TASK_STACK_SIZE, (void *)MPS, INDICATION_TASK_PRIORITY, NULL) == pdPASS);
 }
-
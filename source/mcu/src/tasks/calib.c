@@ -0,0 +1,71 @@
+#include "calib.h"
+
+#include <string.h>
+
+#include <hal/assert.h>
+#include <hal/math.h>
+
+// Handshake states. Writer only moves state from `IDLE` to `PENDING` after filling `pending`,
+// and sync generator only moves it back after copying `pending` to `active`.
+#define CALIB_STATE_IDLE 0
+#define CALIB_STATE_PENDING 1
+
+static void prepare_channels(CalibChannel *channels, const CalibTable *table) {
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        channels[i].entry = table->entries[i];
+        filter_coef_init(&channels[i].filter_coef, table->entries[i].filter);
+    }
+}
+
+void calib_init(Calib *self, const CalibTable *table) {
+    fixed_div_init(&self->scale, K_SCALE);
+    self->table = *table;
+    prepare_channels(self->active, table);
+    memset(self->values, 0, sizeof(self->values));
+    memset(self->filtered, 0, sizeof(self->filtered));
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        filter_reset(&self->filters[i], 0);
+    }
+    __atomic_store_n(&self->state, CALIB_STATE_IDLE, __ATOMIC_RELAXED);
+}
+
+bool calib_write(Calib *self, const CalibTable *table) {
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != CALIB_STATE_IDLE) {
+        return false;
+    }
+    self->table = *table;
+    prepare_channels(self->pending, table);
+    __atomic_store_n(&self->state, CALIB_STATE_PENDING, __ATOMIC_RELEASE);
+    return true;
+}
+
+const CalibTable *calib_table(const Calib *self) {
+    return &self->table;
+}
+
+void calib_commit(Calib *self) {
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != CALIB_STATE_PENDING) {
+        return;
+    }
+    // Filter states are kept, so filtered values settle to the new calibration smoothly.
+    memcpy(self->active, self->pending, sizeof(self->active));
+    __atomic_store_n(&self->state, CALIB_STATE_IDLE, __ATOMIC_RELEASE);
+}
+
+static int32_t saturate(int64_t value) {
+    return (int32_t)hal_max((int64_t)INT32_MIN, hal_min((int64_t)INT32_MAX, value));
+}
+
+void calib_process(Calib *self, const int32_t *ain) {
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        const CalibChannel *channel = &self->active[i];
+        const CalibEntry *entry = &channel->entry;
+        // Difference of two 32-bit values takes 33 bits, and its product with 32-bit gain still fits 64 bits.
+        int64_t code = (int64_t)ain[i] - (int64_t)entry->offset;
+        // Table is written by app, so a large gain is clamped here rather than wrapped into a value of opposite sign.
+        int32_t value = saturate(fixed_div_s64(&self->scale, code * (int64_t)entry->gain));
+        self->values[i] = value;
+        // Zero time constant passes value through, so there is no branch.
+        self->filtered[i] = filter_update(&self->filters[i], &channel->filter_coef, value);
+    }
+}
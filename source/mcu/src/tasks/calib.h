@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <common/config.h>
+#include <utils/filter.h>
+#include <utils/fixed.h>
+#include <device/MPS.h>
+
+// Calibration of measurement channels, one entry per ADC channel.
+//
+// Sync generator converts ADC codes to physical units by the active table each tick. Table is replaced by RPMSG task
+// with `calib_write` and is taken by sync generator with `calib_commit` at the tick boundary, so a tick always uses
+// entries of a single table. Like `ProbeGroup`, each side moves the handshake state in one direction only.
+
+/// Measurement channels, index is ADC channel.
+#define CALIB_IOUT 0
+#define CALIB_VOUT 1
+#define CALIB_VREG 2
+#define CALIB_THS1 3
+#define CALIB_THS2 4
+#define CALIB_THS3 5
+
+typedef struct {
+    /// Multiplier in `1 / K_SCALE` units.
+    int32_t gain;
+    /// ADC code subtracted before multiplication.
+    int32_t offset;
+    /// Time constant of first-order filter in ticks, zero disables filtering.
+    uint16_t filter;
+} CalibEntry;
+
+typedef struct {
+    CalibEntry entries[ADC_COUNT];
+} CalibTable;
+
+/// Entry with filter coefficient precomputed by writer, so that nothing is divided by variable in the tick.
+typedef struct {
+    CalibEntry entry;
+    FilterCoef filter_coef;
+} CalibChannel;
+
+typedef struct {
+    /// Channels used by sync generator, accessed only by it.
+    CalibChannel active[ADC_COUNT];
+    /// Scaled values of the last tick, accessed only by sync generator.
+    int32_t values[ADC_COUNT];
+    /// Filtered values, unfiltered channels hold scaled values.
+    int32_t filtered[ADC_COUNT];
+    Filter filters[ADC_COUNT];
+
+    /// Channels prepared by writer and not yet taken by sync generator.
+    CalibChannel pending[ADC_COUNT];
+    /// Handshake state, see `calib.c`.
+    uint32_t state;
+    /// Last written table, accessed only by writer.
+    CalibTable table;
+
+    FixedDiv scale;
+} Calib;
+
+/// Set initial table, must be called before sync generator is started.
+void calib_init(Calib *self, const CalibTable *table);
+
+/// Replace table, called by writer only. Table is applied by sync generator at the next tick.
+/// @return `false` if the previous table is not taken yet, the new one is discarded then.
+bool calib_write(Calib *self, const CalibTable *table);
+
+/// Last written table, called by writer only.
+const CalibTable *calib_table(const Calib *self);
+
+/// Take pending table if any, called by sync generator at tick boundary.
+void calib_commit(Calib *self);
+
+/// Convert ADC codes of all channels and update filters. Values out of `int32_t` range are saturated.
+void calib_process(Calib *self, const int32_t *ain);
@@ -24,6 +24,31 @@
 #undef RB_ITEM
 #undef RB_CAPACITY
 
+static void adc_decimation_reset(AdcDecimation *self, uint32_t ratio) {
+    self->ratio = ratio;
+    self->count = 0;
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        self->sums[i] = 0;
+    }
+}
+
+/// Write averages rounded to nearest to `points` and start the next output point.
+static void adc_decimation_take(AdcDecimation *self, point_t *points) {
+    // Sum is not divided without decimation to keep the default path cheap.
+    if (self->ratio == 1) {
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            points[i] = (point_t)self->sums[i];
+        }
+    } else {
+        const int64_t ratio = (int64_t)self->ratio;
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            int64_t sum = self->sums[i];
+            points[i] = (point_t)((sum >= 0 ? sum + ratio / 2 : sum - ratio / 2) / ratio);
+        }
+    }
+    adc_decimation_reset(self, self->requested_ratio);
+}
+
 void control_init(Control *self, Statistics *stats, PS_Control* MPS) {
     self->dio.in = 0;
     self->dio.out = 0;
@@ -32,15 +57,28 @@ void control_init(Control *self, Statistics *stats, PS_Control* MPS) {
     hal_assert_retcode(dac_rb_init(&self->dac.buffer));
     self->dac.last_point = 0x7fff;
     self->dac.counter = 0;
+    self->dac.upsampling = 1;
+    self->dac.hold_count = 0;
 
     hal_assert_retcode(adc_rb_init(&self->adc.buffer));
+    adc_decimation_reset(&self->adc.decimation, 1);
+    self->adc.decimation.requested_ratio = 1;
     self->adc.counter = 0;
+    overrun_log_init(&self->adc.overrun);
+    self->adc.point_count = 0;
+
+    SampleRate rate;
+    hal_assert(sample_rate_init(&rate, SAMPLE_FREQ_HZ));
+    control_set_sample_rate(self, &rate);
 
     self->sync = NULL;
+    self->prev_intr_count = 0;
+    probe_group_init(&self->timing, TIMING_CONTROL_WAIT, TIMING_CONTROL_SAMPLE - TIMING_CONTROL_WAIT + 1);
 
     hal_assert(stats != NULL);
     self->stats = stats;
     self->MPS = MPS;
+    fixed_div_init(&self->k_scale, K_SCALE);
 }
 
 void control_deinit(Control *self) {
@@ -50,14 +88,29 @@ void control_deinit(Control *self) {
 
 void control_set_sync(Control *self, ControlSync *sync) {
     hal_assert(sync != NULL);
-    hal_assert(sync->ready_sem != NULL);
     self->sync = sync;
 }
 
+void control_set_adc_decimation(Control *self, uint32_t ratio) {
+    hal_assert(ratio >= 1 && ratio <= ADC_DECIMATION_MAX);
+    self->adc.decimation.requested_ratio = ratio;
+}
+
+void control_set_dac_upsampling(Control *self, uint32_t ratio) {
+    hal_assert(ratio >= 1 && ratio <= DAC_UPSAMPLING_MAX);
+    self->dac.upsampling = ratio;
+}
+
+void control_set_sample_rate(Control *self, const SampleRate *rate) {
+    self->dac.depth = rate->dac_depth;
+    self->adc.depth = rate->adc_depth;
+}
+
 void control_dac_start(Control *self) {
     #ifndef MPS_CTRL_VAR
     skifio_dac_enable();
     #endif
+    self->dac.hold_count = 0;
     self->dac.running = true;
 }
 
@@ -68,21 +121,95 @@ void control_dac_stop(Control *self) {
     #endif
 }
 
-void control_sync_init(ControlSync *self, SemaphoreHandle_t *ready_sem, size_t dac_chunk_size, size_t adc_chunk_size) {
-    self->ready_sem = ready_sem;
+void control_sync_init(ControlSync *self, size_t dac_chunk_size, size_t adc_chunk_size) {
+    self->task = NULL;
+#ifdef CONTROL_SYNC_SEMAPHORE
+    self->sem = xSemaphoreCreateBinary();
+    hal_assert(self->sem != NULL);
+    self->sem_events = 0;
+#endif
+    for (size_t i = 0; i < CONTROL_EVENT_COUNT; ++i) {
+        self->notify_cycles[i] = 0;
+    }
 
     self->dac_notify_every = dac_chunk_size;
     self->adc_notify_every = adc_chunk_size;
 
-    self->din_changed = false;
-    self->dout_changed = false;
+    self->control_events = 0;
+}
+
+void control_sync_set_task(ControlSync *self, TaskHandle_t task) {
+    self->task = task;
+}
+
+void control_sync_post(ControlSync *self, uint32_t events) {
+    __atomic_fetch_or(&self->control_events, events, __ATOMIC_RELEASE);
+}
+
+static void store_notify_cycles(ControlSync *self, uint32_t events) {
+    uint32_t now = cycles_now();
+    for (size_t i = 0; i < CONTROL_EVENT_COUNT; ++i) {
+        if ((events & (1u << i)) != 0) {
+            self->notify_cycles[i] = now;
+        }
+    }
+}
+
+uint32_t control_sync_latency(const ControlSync *self, uint32_t events) {
+    uint32_t now = cycles_now();
+    uint32_t latency = 0;
+    for (size_t i = 0; i < CONTROL_EVENT_COUNT; ++i) {
+        if ((events & (1u << i)) != 0) {
+            latency = hal_max(latency, now - self->notify_cycles[i]);
+        }
+    }
+    return latency;
+}
+
+void control_sync_notify(ControlSync *self, uint32_t events) {
+    TaskHandle_t task = self->task;
+    if (task == NULL) {
+        return;
+    }
+    store_notify_cycles(self, events);
+#ifdef CONTROL_SYNC_SEMAPHORE
+    __atomic_fetch_or(&self->sem_events, events, __ATOMIC_RELEASE);
+    xSemaphoreGive(self->sem);
+#else
+    xTaskNotify(task, events, eSetBits);
+#endif
+}
+
+bool control_sync_wait(ControlSync *self, TickType_t timeout, uint32_t *events) {
+#ifdef CONTROL_SYNC_SEMAPHORE
+    if (xSemaphoreTake(self->sem, timeout) != pdTRUE) {
+        return false;
+    }
+    *events = __atomic_exchange_n(&self->sem_events, 0, __ATOMIC_ACQUIRE);
+    return true;
+#else
+    return xTaskNotifyWait(0, UINT32_MAX, events, timeout) == pdTRUE;
+#endif
+}
+
+static void control_sync_notify_from_isr(ControlSync *self, uint32_t events, BaseType_t *hptw) {
+    TaskHandle_t task = self->task;
+    if (task == NULL) {
+        return;
+    }
+    store_notify_cycles(self, events);
+#ifdef CONTROL_SYNC_SEMAPHORE
+    __atomic_fetch_or(&self->sem_events, events, __ATOMIC_RELEASE);
+    xSemaphoreGiveFromISR(self->sem, hptw);
+#else
+    xTaskNotifyFromISR(task, events, eSetBits, hptw);
+#endif
 }
 
 static bool update_din(Control *self) {
     SkifioDin din = skifio_din_read();
     if (din != self->dio.in) {
         self->dio.in = din;
-        self->sync->din_changed = true;
         self->stats->din = din;
         return true;
     } else {
@@ -91,133 +218,189 @@ static bool update_din(Control *self) {
 }
 
 static void intr_din_handler(void *data, SkifioDin value) {
-    Control *self = (Control *)self;
-    update_din(self);
+    Control *self = (Control *)data;
     BaseType_t hptw = pdFALSE;
-    if (self->sync->din_changed) {
-        xSemaphoreGiveFromISR(*self->sync->ready_sem, &hptw);
+    if (update_din(self)) {
+        control_sync_notify_from_isr(self->sync, CONTROL_EVENT_DIN_CHANGED, &hptw);
     }
     portYIELD_FROM_ISR(hptw);
 }
 
-static void control_task(void *param) {
-    Control *self = (Control *)param;
-
-    // Check that sync is set.
-    hal_assert(self->sync != NULL);
+void control_sample(Control *self) {
+    uint32_t events = 0;
+    uint32_t sample_start = cycles_now();
 
-    hal_log_info("SkifIO driver init");
-    hal_assert_retcode(skifio_init());
-    hal_assert_retcode(skifio_din_subscribe(intr_din_handler, NULL));
+    #ifdef SKIFIO_DMA
+    // Send frame prepared at the previous sample right away, the rest of the work is done while it is in flight.
+    hal_assert_retcode(skifio_transfer_start());
+    #endif
+    uint32_t stage_start = cycles_now();
+
+    // Write discrete output
+    uint32_t control_events = __atomic_exchange_n(&self->sync->control_events, 0, __ATOMIC_ACQUIRE);
+    if ((control_events & CONTROL_EVENT_DOUT_CHANGED) != 0) {
+        #ifndef MPS_CTRL_VAR
+        hal_assert_retcode(skifio_dout_write(self->dio.out));
+        #endif
+    }
 
-    hal_log_info("Enter SkifIO loop");
-    uint64_t prev_intr_count = _SKIFIO_DEBUG_INFO.intr_count;
-    for (size_t k = 0;; ++k) {
-        bool ready = false;
+    // Read discrete input
+    if (update_din(self)) {
+        events |= CONTROL_EVENT_DIN_CHANGED;
+    }
 
-        // Wait for 10 kHz sync signal
-        {
-            hal_retcode ret = skifio_wait_ready(1000);
-            if (ret == HAL_TIMED_OUT) {
-                hal_log_warn("SkifIO timeout %d", k);
-                continue;
+    // Statistics: detect 10 kHz sync signal loss
+    self->stats->max_intrs_per_sample = hal_max(
+        self->stats->max_intrs_per_sample,
+        (uint32_t)(_SKIFIO_DEBUG_INFO.intr_count - self->prev_intr_count) //
+    );
+    self->prev_intr_count = _SKIFIO_DEBUG_INFO.intr_count;
+    stage_start = probe_lap(probe_group_get(&self->timing, TIMING_CONTROL_DIO), stage_start);
+
+    // Fetch next DAC value from buffer
+    int32_t dac_value = self->dac.last_point;
+    if (self->dac.running && self->dac.hold_count > 0) {
+        // Point is held for a number of samples when upsampled.
+        self->dac.hold_count -= 1;
+    } else if (self->dac.running) {
+        const point_t *dac_slot = NULL;
+        if (dac_rb_read_peek_contiguous(&self->dac.buffer, &dac_slot) >= 1) {
+            dac_value = *dac_slot;
+            dac_rb_read_commit(&self->dac.buffer, 1);
+            self->dac.last_point = dac_value;
+            self->dac.hold_count = self->dac.upsampling - 1;
+            #ifdef MPS_CTRL_VAR
+            if(self->MPS->Flag.fCCMode){
+                int64_t Val = fixed_div_s64(&self->k_scale, (int64_t)dac_value * (int64_t)self->MPS->K.Iset);
+                if((Val>=0)&&(Val<=ISETMAX)) self->MPS->Ref_Set = Val;
+            }
+            else {
+                int64_t Val = fixed_div_s64(&self->k_scale, (int64_t)dac_value * (int64_t)self->MPS->K.Vset);
+                if((Val>=0)&&(Val<=VSETMAX)) self->MPS->VRef_Set = Val;
             }
-            hal_assert_retcode(ret);
-        }
-
-        // Write discrete output
-        if (self->sync->dout_changed) {
-            #ifndef MPS_CTRL_VAR
-            hal_assert_retcode(skifio_dout_write(self->dio.out));
             #endif
-            self->sync->dout_changed = false;
-        }
-
-        // Read discrete input
-        ready |= update_din(self);
-
-        // Statistics: detect 10 kHz sync signal loss
-        self->stats->max_intrs_per_sample = hal_max(
-            self->stats->max_intrs_per_sample,
-            (uint32_t)(_SKIFIO_DEBUG_INFO.intr_count - prev_intr_count) //
-        );
-        prev_intr_count = _SKIFIO_DEBUG_INFO.intr_count;
-
-        // Fetch next DAC value from buffer
-        int32_t dac_value = self->dac.last_point;
-        if (self->dac.running) {
-            if (dac_rb_read(&self->dac.buffer, &dac_value, 1) == 1) {
-                self->dac.last_point = dac_value;
-                #ifdef MPS_CTRL_VAR
-                if(self->MPS->Flag.fCCMode){
-                    int64_t Val = ((int64_t)dac_value * (int64_t)self->MPS->K.Iset)/1000000LL;
-                    if((Val>=0)&&(Val<=ISETMAX)) self->MPS->Ref_Set = Val;
-                }
-                else {
-                    int64_t Val = ((int64_t)dac_value * (int64_t)self->MPS->K.Vset)/1000000LL;
-                    if((Val>=0)&&(Val<=VSETMAX)) self->MPS->VRef_Set = Val;
-                }
-                #endif
-                // Decrement DAC notification counter.
-                if (self->dac.counter > 0) {
-                    self->dac.counter -= 1;
-                } else {
-                    self->dac.counter = self->sync->dac_notify_every - 1;
-                    ready = true;
-                }
+            // Decrement DAC notification counter.
+            if (self->dac.counter > 0) {
+                self->dac.counter -= 1;
             } else {
-                self->stats->dac.lost_empty += 1;
+                self->dac.counter = self->sync->dac_notify_every - 1;
+                events |= CONTROL_EVENT_DAC_SPACE;
             }
+        } else {
+            self->stats->dac.lost_empty += 1;
         }
-
-        // Transfer DAC/ADC values to/from SkifIO board.
-        {
-            SkifioInput input = {{0}};
-            SkifioOutput output = {0};
-            #ifdef MPS_CTRL_VAR
-            skifio_dac_enable();
-            output.dac = 0x8000U+(uint16_t)(((int64_t)self->MPS->Feedback.FB_Val*16384LL)/240000LL);
-            #else
-            output.dac = (int16_t)dac_value;
-            #endif
-            hal_retcode ret = skifio_transfer(&output, &input);
-            if (ret == HAL_INVALID_DATA) {
-                // CRC check error
-                self->stats->crc_error_count += 1;
-                ret = HAL_SUCCESS;
-            }
-            hal_assert_retcode(ret);
-
-            // Handle ADCs
-            AdcArray adcs = {{0}};
-            for (size_t i = 0; i < ADC_COUNT; ++i) {
-                point_t value = input.adcs[i];
-                adcs.points[i] = value;
-                self->MPS->Ain[i]=value;
-
-                // Update ADC value statistics
-                value_stats_update(&self->stats->adc.values[i], value);
-            }
-            // Push ADC point to buffer.
-            if (adc_rb_write(&self->adc.buffer, &adcs, 1) != 1) {
+    }
+    stage_start = probe_lap(probe_group_get(&self->timing, TIMING_CONTROL_DAC), stage_start);
+
+    // Transfer DAC/ADC values to/from SkifIO board.
+    {
+        SkifioOutput output = {0};
+        #ifdef MPS_CTRL_VAR
+        skifio_dac_enable();
+        output.dac = 0x8000U+(uint16_t)(((int64_t)self->MPS->Feedback.FB_Val*16384LL)/240000LL);
+        #else
+        output.dac = (int16_t)dac_value;
+        #endif
+        #ifdef SKIFIO_DMA
+        // DAC value is sent on the next sample.
+        hal_assert_retcode(skifio_transfer_prepare(&output));
+        const SkifioInput *input = NULL;
+        hal_retcode ret = skifio_transfer_wait(&input);
+        #else
+        SkifioInput input_data = {{0}};
+        const SkifioInput *input = &input_data;
+        hal_retcode ret = skifio_transfer(&output, &input_data);
+        #endif
+
+        // Statistics of the sample are updated at once, so that snapshot contains all of them or none.
+        stats_write_begin(self->stats);
+        if (ret == HAL_INVALID_DATA) {
+            // CRC check error
+            self->stats->crc_error_count += 1;
+            ret = HAL_SUCCESS;
+        }
+        hal_assert_retcode(ret);
+        stage_start = probe_lap(probe_group_get(&self->timing, TIMING_CONTROL_TRANSFER), stage_start);
+
+        // Handle ADCs
+        AdcDecimation *decimation = &self->adc.decimation;
+        for (size_t i = 0; i < ADC_COUNT; ++i) {
+            point_t value = input->adcs[i];
+            decimation->sums[i] += value;
+            self->MPS->Ain[i]=value;
+
+            // Update ADC value statistics
+            value_stats_update(&self->stats->adc.values[i], value);
+        }
+        decimation->count += 1;
+
+        // Push averaged ADC point to buffer when enough samples are accumulated.
+        if (decimation->count >= decimation->ratio) {
+            // Points are written directly into ring buffer slot if there is a free one within current depth.
+            AdcArray *adcs = NULL;
+            bool adc_slot = adc_rb_occupied(&self->adc.buffer) < self->adc.depth &&
+                adc_rb_write_peek_contiguous(&self->adc.buffer, &adcs) >= 1 &&
+                overrun_log_write(&self->adc.overrun, adc_rb_write_position(&self->adc.buffer));
+            if (adc_slot) {
+                adc_decimation_take(decimation, adcs->points);
+                adc_rb_write_commit(&self->adc.buffer, 1);
+            } else {
+                adc_decimation_reset(decimation, decimation->requested_ratio);
                 self->stats->adc.lost_full += 1;
+                overrun_log_drop(&self->adc.overrun);
             }
+            self->adc.point_count += 1;
 
             // Decrement ADC notification counter.
             if (self->adc.counter > 0) {
                 self->adc.counter -= 1;
             } else {
                 self->adc.counter = self->sync->adc_notify_every - 1;
-                ready = true;
+                events |= CONTROL_EVENT_ADC_READY;
             }
         }
+    }
+
+    self->stats->sample_count += 1;
+    // Must be ended before notification, because notified task may preempt this one and take a snapshot.
+    stats_write_end(self->stats);
+
+    if (events != 0) {
+        control_sync_notify(self->sync, events);
+    }
 
-        if (ready) {
-            // Notify
-            xSemaphoreGive(*self->sync->ready_sem);
+    probe_lap(probe_group_get(&self->timing, TIMING_CONTROL_ADC), stage_start);
+    probe_lap(probe_group_get(&self->timing, TIMING_CONTROL_SAMPLE), sample_start);
+    probe_group_commit(&self->timing);
+}
+
+static void control_task(void *param) {
+    Control *self = (Control *)param;
+
+    // Check that sync is set.
+    hal_assert(self->sync != NULL);
+
+    hal_log_info("SkifIO driver init");
+    hal_assert_retcode(skifio_init());
+    hal_assert_retcode(skifio_din_subscribe(intr_din_handler, (void *)self));
+
+    hal_log_info("Enter SkifIO loop");
+    self->prev_intr_count = _SKIFIO_DEBUG_INFO.intr_count;
+    for (size_t k = 0;; ++k) {
+        // Wait for 10 kHz sync signal
+        {
+            uint32_t wait_start = cycles_now();
+            hal_retcode ret = skifio_wait_ready(1000);
+            if (ret == HAL_TIMED_OUT) {
+                hal_log_warn("SkifIO timeout %d", k);
+                continue;
+            }
+            hal_assert_retcode(ret);
+            probe_lap(probe_group_get(&self->timing, TIMING_CONTROL_WAIT), wait_start);
+            probe_record(probe_group_get(&self->timing, TIMING_CONTROL_WAKEUP), skifio_ready_latency());
         }
 
-        self->stats->sample_count += 1;
+        control_sample(self);
     }
 
     // This task must never end.
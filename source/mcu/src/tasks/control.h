@@ -8,17 +8,30 @@
 
 #include <common/config.h>
 #include <drivers/skifio.h>
+#include <utils/fixed.h>
+#include <utils/overrun.h>
+#include <utils/probe.h>
 #include <tasks/stats.h>
 #include <device/MPS.h>
 
 #include "config.h"
+#include "rate.h"
 
 typedef struct {
     point_t points[ADC_COUNT];
 } AdcArray;
 
-#define DAC_BUFFER_SIZE 1024
-#define ADC_BUFFER_SIZE 384
+// Sizes of ring buffers, must be powers of two.
+// Buffers are allocated for the highest sample rate, only `depth` points of them are used at the current one.
+#define DAC_BUFFER_SIZE 2048
+#define ADC_BUFFER_SIZE 1024
+
+#if SAMPLE_FREQ_MAX_HZ * DAC_BUFFER_TIME_MS / 1000 > DAC_BUFFER_SIZE
+#error "DAC buffer does not cover DAC_BUFFER_TIME_MS at the highest sample rate"
+#endif
+#if SAMPLE_FREQ_MAX_HZ * ADC_BUFFER_TIME_MS / 1000 > ADC_BUFFER_SIZE
+#error "ADC buffer does not cover ADC_BUFFER_TIME_MS at the highest sample rate"
+#endif
 
 #define RB_STRUCT DacRingBuffer
 #define RB_PREFIX dac_rb
@@ -43,13 +56,36 @@ typedef struct {
 typedef struct {
     bool running;
     DacRingBuffer buffer;
+    /// Number of buffer points used at current sample rate.
+    volatile size_t depth;
     point_t last_point;
     size_t counter;
+    /// Number of samples each point is held for, set by other task.
+    volatile uint32_t upsampling;
+    /// Number of samples left until the next point is taken from buffer.
+    uint32_t hold_count;
 } ControlDac;
 
+/// Boxcar average of ADC points over `ratio` samples.
+typedef struct {
+    uint32_t ratio;
+    /// Ratio to switch to at the next output point, set by other task.
+    volatile uint32_t requested_ratio;
+    /// Number of samples accumulated.
+    uint32_t count;
+    int64_t sums[ADC_COUNT];
+} AdcDecimation;
+
 typedef struct {
     AdcRingBuffer buffer;
+    AdcDecimation decimation;
+    /// Number of buffer points used at current sample rate, points above it are lost.
+    volatile size_t depth;
     size_t counter;
+    /// Points lost because the buffer was full, accounted by reader at their place in the stream.
+    OverrunLog overrun;
+    /// Number of output points produced, both stored and lost, i.e. sample index of the point being accumulated.
+    volatile uint32_t point_count;
 } ControlAdc;
 
 typedef struct {
@@ -57,19 +93,37 @@ typedef struct {
     volatile SkifioDout out;
 } ControlDio;
 
+/// Events of control task, combined into a bit set.
+/// ADC buffer has got `adc_notify_every` points since the previous event.
+#define CONTROL_EVENT_ADC_READY (1u << 0)
+/// DAC buffer has freed `dac_notify_every` points since the previous event.
+#define CONTROL_EVENT_DAC_SPACE (1u << 1)
+/// Discrete input has changed.
+#define CONTROL_EVENT_DIN_CHANGED (1u << 2)
+/// Discrete output has been changed by other task and must be written to the board.
+#define CONTROL_EVENT_DOUT_CHANGED (1u << 3)
+/// Number of event bits.
+#define CONTROL_EVENT_COUNT 4
+
 typedef struct {
-    /// Semaphore to notify that something is ready.
-    SemaphoreHandle_t *ready_sem;
+    /// Task notified with ADC, DAC and DIN events as notification value bits, `NULL` until it is started.
+    TaskHandle_t volatile task;
+#ifdef CONTROL_SYNC_SEMAPHORE
+    /// Former wake-up path kept to compare latency: events are accumulated here and the task waits on semaphore.
+    SemaphoreHandle_t sem;
+    uint32_t sem_events;
+#endif
+    /// Cycle counter at the last notification of each event bit, to measure wake-up latency of the notified task.
+    /// Control task and DIN interrupt notify independently, so one timestamp would be overwritten by the later notifier.
+    volatile uint32_t notify_cycles[CONTROL_EVENT_COUNT];
 
     /// Number of DAC points to write until notified.
     volatile size_t dac_notify_every;
     /// Number of ADC points to read until notified.
     volatile size_t adc_notify_every;
 
-    /// Discrete input has changed.
-    volatile bool din_changed;
-    /// Discrete output has changed.
-    volatile bool dout_changed;
+    /// DOUT events posted to control task. It waits for SkifIO ready signal only, so they are taken once per sample.
+    uint32_t control_events;
 } ControlSync;
 
 typedef struct {
@@ -79,17 +133,54 @@ typedef struct {
     ControlSync *sync;
     Statistics *stats;
     PS_Control *MPS;
+    /// Reciprocal of `K_SCALE` for DAC setpoint scaling.
+    FixedDiv k_scale;
+    /// SkifIO interrupt count at previous sample.
+    uint64_t prev_intr_count;
+    /// Durations of `TIMING_CONTROL_*` stages.
+    ProbeGroup timing;
 } Control;
 
-void control_sync_init(ControlSync *self, SemaphoreHandle_t *ready_sem, size_t dac_chunk_size, size_t adc_chunk_size);
+void control_sync_init(ControlSync *self, size_t dac_chunk_size, size_t adc_chunk_size);
+
+/// Set task to notify, events that happen before are dropped.
+void control_sync_set_task(ControlSync *self, TaskHandle_t task);
+
+/// Notify task of sync about `CONTROL_EVENT_*` bits from task context. Zero `events` just wakes it up.
+void control_sync_notify(ControlSync *self, uint32_t events);
+
+/// Wait for notification in the task of sync.
+/// @return `false` on timeout, otherwise `events` are the bits notified since the previous wait.
+bool control_sync_wait(ControlSync *self, TickType_t timeout, uint32_t *events);
+
+/// Wake-up latency of notified task that got `events`, measured from the earliest of their last notifications.
+uint32_t control_sync_latency(const ControlSync *self, uint32_t events);
+
+/// Post `CONTROL_EVENT_*` bits to control task, they are handled on the next sample.
+void control_sync_post(ControlSync *self, uint32_t events);
 
 void control_init(Control *self, Statistics *stats, PS_Control *MPS);
 void control_deinit(Control *self);
 
 void control_set_sync(Control *self, ControlSync *sync);
 
+/// Set ADC decimation ratio, in range from 1 (no decimation) to `ADC_DECIMATION_MAX`.
+/// Ratio is applied after the current output point, so that it is not averaged over mixed number of samples.
+void control_set_adc_decimation(Control *self, uint32_t ratio);
+
+/// Set DAC upsampling ratio, in range from 1 (new point each sample) to `DAC_UPSAMPLING_MAX`.
+/// Ratio is applied after the current point is held for the previous one.
+void control_set_dac_upsampling(Control *self, uint32_t ratio);
+
+/// Limit buffer usage according to sample rate. Points already buffered above new depth are not dropped.
+void control_set_sample_rate(Control *self, const SampleRate *rate);
+
 void control_dac_start(Control *self);
 void control_dac_stop(Control *self);
 
+/// Handle single sample: exchange DIO, DAC and ADC values with SkifIO board and notify if data is ready.
+/// Called by control task on each SkifIO ready signal, also used directly by host tests and benchmarks.
+void control_sample(Control *self);
+
 /// Start control tasks.
 void control_run(Control *self);
@@ -0,0 +1,120 @@
+#include "fault.h"
+
+// Handshake states. Sync generator only moves state from `IDLE` to `PENDING` after filling `pending`,
+// RPMSG task only moves it back after copying it. Limits use the same states in the opposite direction, see `calib.c`.
+#define FAULT_STATE_IDLE 0
+#define FAULT_STATE_PENDING 1
+
+/// Fault codes of threshold checks.
+static const uint32_t CHECK_CODES[FAULT_CHECK_COUNT] = {
+    [FAULT_CHECK_IOUT] = FAULT_OVERCURRENT,
+    [FAULT_CHECK_VOUT] = FAULT_OVERVOLTAGE,
+    [FAULT_CHECK_HEATSINK] = FAULT_OVERHEAT,
+    [FAULT_CHECK_FB_ERROR] = FAULT_FB_LOST,
+};
+
+static void reset_failed(FaultMonitor *self) {
+    for (size_t i = 0; i < FAULT_CHECK_COUNT; ++i) {
+        self->failed[i] = 0;
+    }
+}
+
+void fault_init(FaultMonitor *self, const FaultLimits *limits) {
+    self->limits = *limits;
+    self->written_limits = *limits;
+    __atomic_store_n(&self->limits_state, FAULT_STATE_IDLE, __ATOMIC_RELAXED);
+    reset_failed(self);
+    self->tick = 0;
+    self->latched = false;
+    self->count = 0;
+    self->adc_index = NULL;
+    self->lost_count = 0;
+    __atomic_store_n(&self->state, FAULT_STATE_IDLE, __ATOMIC_RELAXED);
+}
+
+void fault_set_adc_index(FaultMonitor *self, const volatile uint32_t *adc_index) {
+    self->adc_index = adc_index;
+}
+
+bool fault_write_limits(FaultMonitor *self, const FaultLimits *limits) {
+    if (__atomic_load_n(&self->limits_state, __ATOMIC_ACQUIRE) != FAULT_STATE_IDLE) {
+        return false;
+    }
+    self->written_limits = *limits;
+    self->pending_limits = *limits;
+    __atomic_store_n(&self->limits_state, FAULT_STATE_PENDING, __ATOMIC_RELEASE);
+    return true;
+}
+
+const FaultLimits *fault_limits(const FaultMonitor *self) {
+    return &self->written_limits;
+}
+
+void fault_commit(FaultMonitor *self) {
+    if (__atomic_load_n(&self->limits_state, __ATOMIC_ACQUIRE) != FAULT_STATE_PENDING) {
+        return;
+    }
+    self->limits = self->pending_limits;
+    // Persistence may be shorter than already counted ticks, so counting restarts with the new limits.
+    reset_failed(self);
+    __atomic_store_n(&self->limits_state, FAULT_STATE_IDLE, __ATOMIC_RELEASE);
+}
+
+static void latch(FaultMonitor *self, uint32_t code, int32_t value, uint32_t latency) {
+    if (self->latched) {
+        return;
+    }
+    self->latched = true;
+    self->count += 1;
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != FAULT_STATE_IDLE) {
+        self->lost_count += 1;
+        return;
+    }
+    self->pending.code = code;
+    self->pending.tick = self->tick;
+    self->pending.adc_index = self->adc_index != NULL ? *self->adc_index : 0;
+    self->pending.value = value;
+    self->pending.latency = latency;
+    self->pending.count = self->count;
+    __atomic_store_n(&self->state, FAULT_STATE_PENDING, __ATOMIC_RELEASE);
+}
+
+uint32_t fault_check(FaultMonitor *self, const int32_t values[FAULT_CHECK_COUNT]) {
+    self->tick += 1;
+    uint32_t tripped = 0;
+    for (size_t i = 0; i < FAULT_CHECK_COUNT; ++i) {
+        const FaultThreshold *threshold = &self->limits.thresholds[i];
+        int32_t value = values[i];
+        int64_t magnitude = value < 0 ? -(int64_t)value : (int64_t)value;
+        if (threshold->persistence == 0 || magnitude <= (int64_t)threshold->limit) {
+            self->failed[i] = 0;
+            continue;
+        }
+        if (self->failed[i] < threshold->persistence) {
+            self->failed[i] += 1;
+        }
+        if (self->failed[i] >= threshold->persistence) {
+            // Latency counts ticks after the first failed one, so it is zero for persistence of one tick.
+            latch(self, CHECK_CODES[i], value, threshold->persistence - 1);
+            tripped |= 1u << i;
+        }
+    }
+    return tripped;
+}
+
+void fault_trip(FaultMonitor *self, uint32_t code) {
+    latch(self, code, 0, 0);
+}
+
+void fault_release(FaultMonitor *self) {
+    self->latched = false;
+}
+
+bool fault_take(FaultMonitor *self, FaultRecord *record) {
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != FAULT_STATE_PENDING) {
+        return false;
+    }
+    *record = self->pending;
+    __atomic_store_n(&self->state, FAULT_STATE_IDLE, __ATOMIC_RELEASE);
+    return true;
+}
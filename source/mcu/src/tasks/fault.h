@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <common/config.h>
+
+// Threshold fault detection with first-fault latch.
+//
+// Sync generator checks calibrated values against limits each tick. Threshold fault trips when a value stays over its
+// limit for `persistence` consecutive ticks, so a single noisy sample does not stop the source. The first fault of an
+// episode is latched together with the tick it tripped at and reported to app by RPMSG task. Latch is released when
+// sync generator clears faults. Report is passed to RPMSG task by the same one-way handshake as of `Calib`.
+// Limits are replaced by RPMSG task and taken by sync generator at the tick boundary in the same way as `Regulator`
+// gains. Values checked are indexed by `FAULT_CHECK_*`, see `common/config.h`.
+
+typedef struct {
+    /// Check fails when absolute value is greater than limit.
+    int32_t limit;
+    /// Number of consecutive failed ticks to trip, zero disables the check.
+    uint32_t persistence;
+} FaultThreshold;
+
+/// Limits are in units of checked values:
+/// - `FAULT_CHECK_IOUT` - unfiltered output current, 100 uA units (as `ISETMAX`),
+/// - `FAULT_CHECK_VOUT` - unfiltered output voltage, 100 uV units (`10 * VSETMAX`, as `VSETMAX` is in mV),
+/// - `FAULT_CHECK_HEATSINK` - filtered heatsink temperature, 0.1 C units,
+/// - `FAULT_CHECK_FB_ERROR` - current reference minus measured current, 100 uA units.
+typedef struct {
+    FaultThreshold thresholds[FAULT_CHECK_COUNT];
+} FaultLimits;
+
+typedef struct {
+    /// `FAULT_*` code.
+    uint32_t code;
+    /// Sync generator tick the fault tripped at, counted from MCU start. Tick rate is not tied to ADC points
+    /// (decimation, sample rate changes), use `adc_index` to line the fault up with ADC data.
+    uint64_t tick;
+    /// Lower 32 bits of sample index of the ADC point that contains the trip, see `fault_set_adc_index`.
+    uint32_t adc_index;
+    /// Value that exceeded the threshold, zero for discrete faults.
+    int32_t value;
+    /// Ticks from the value first exceeding the limit to trip, zero for discrete faults.
+    uint32_t latency;
+    /// Number of faults latched since MCU start including this one.
+    uint32_t count;
+} FaultRecord;
+
+typedef struct {
+    /// Limits used by sync generator, accessed only by it.
+    FaultLimits limits;
+    /// Limits written by RPMSG task and not yet taken by sync generator.
+    FaultLimits pending_limits;
+    /// Limits handshake state, see `fault.c`.
+    uint32_t limits_state;
+    /// Last written limits, accessed only by writer.
+    FaultLimits written_limits;
+
+    /// Consecutive failed ticks of each check.
+    uint32_t failed[FAULT_CHECK_COUNT];
+    uint64_t tick;
+    bool latched;
+    uint32_t count;
+    /// Number of ADC points produced by control task, `NULL` if not set.
+    const volatile uint32_t *adc_index;
+
+    /// The first fault not yet taken by RPMSG task.
+    FaultRecord pending;
+    /// Handshake state, see `fault.c`.
+    uint32_t state;
+    /// Number of latched faults not reported because the previous one was not taken yet. It is never reset.
+    volatile uint32_t lost_count;
+} FaultMonitor;
+
+/// Set initial limits, must be called before sync generator is started.
+void fault_init(FaultMonitor *self, const FaultLimits *limits);
+
+/// Take ADC sample index of fault records from counter of points produced by control task.
+/// Must be called before sync generator is started.
+void fault_set_adc_index(FaultMonitor *self, const volatile uint32_t *adc_index);
+
+/// Replace limits, called by writer only. Limits are applied by sync generator at the next tick.
+/// @return `false` if the previous limits are not taken yet, the new ones are discarded then.
+bool fault_write_limits(FaultMonitor *self, const FaultLimits *limits);
+
+/// Last written limits, called by writer only.
+const FaultLimits *fault_limits(const FaultMonitor *self);
+
+/// Take pending limits if any, called by sync generator at tick boundary. Failed tick counts restart from zero.
+void fault_commit(FaultMonitor *self);
+
+/// Check values of the current tick, indexed by `FAULT_CHECK_*`. Called by sync generator once per tick.
+/// @return Bit mask of tripped checks, `1 << FAULT_CHECK_*`. Check stays tripped while its value is over the limit.
+uint32_t fault_check(FaultMonitor *self, const int32_t values[FAULT_CHECK_COUNT]);
+
+/// Trip discrete fault with `FAULT_*` code. Called by sync generator, it is latched only if nothing is latched yet.
+void fault_trip(FaultMonitor *self, uint32_t code);
+
+/// Release latch after faults are cleared, so the next fault is latched as the first one of a new episode.
+void fault_release(FaultMonitor *self);
+
+/// Take the first fault of the last episode if it is not taken yet, called by RPMSG task.
+bool fault_take(FaultMonitor *self, FaultRecord *record);
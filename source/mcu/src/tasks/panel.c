@@ -0,0 +1,193 @@
+#include "panel.h"
+
+#include <string.h>
+
+#include <utils/crc.h>
+
+// Parser states, each one waits for the byte it is named after.
+#define PANEL_STATE_START 0
+#define PANEL_STATE_TYPE 1
+#define PANEL_STATE_LEN 2
+#define PANEL_STATE_PAYLOAD 3
+#define PANEL_STATE_CRC_HIGH 4
+#define PANEL_STATE_CRC_LOW 5
+
+void panel_parser_init(PanelParser *self) {
+    self->state = PANEL_STATE_START;
+    self->pos = 0;
+    self->crc = 0;
+    self->crc_error_count = 0;
+    self->length_error_count = 0;
+}
+
+static bool parser_finish(PanelParser *self, PanelFrame *frame) {
+    self->state = PANEL_STATE_START;
+    size_t len = 2 + (size_t)self->data[1];
+    if (calculate_crc16(self->data, len) != self->crc) {
+        self->crc_error_count += 1;
+        return false;
+    }
+    frame->type = self->data[0];
+    frame->len = self->data[1];
+    memcpy(frame->payload, &self->data[2], frame->len);
+    return true;
+}
+
+bool panel_parser_push(PanelParser *self, uint8_t byte, PanelFrame *frame) {
+    switch (self->state) {
+    case PANEL_STATE_START:
+        if (byte == PANEL_FRAME_START) {
+            self->state = PANEL_STATE_TYPE;
+        }
+        return false;
+    case PANEL_STATE_TYPE:
+        self->data[0] = byte;
+        self->state = PANEL_STATE_LEN;
+        return false;
+    case PANEL_STATE_LEN:
+        if (byte > PANEL_PAYLOAD_MAX) {
+            self->length_error_count += 1;
+            self->state = PANEL_STATE_START;
+            return false;
+        }
+        self->data[1] = byte;
+        self->pos = 0;
+        self->state = byte > 0 ? PANEL_STATE_PAYLOAD : PANEL_STATE_CRC_HIGH;
+        return false;
+    case PANEL_STATE_PAYLOAD:
+        self->data[2 + self->pos] = byte;
+        self->pos += 1;
+        if (self->pos == self->data[1]) {
+            self->state = PANEL_STATE_CRC_HIGH;
+        }
+        return false;
+    case PANEL_STATE_CRC_HIGH:
+        self->crc = (uint16_t)byte << 8;
+        self->state = PANEL_STATE_CRC_LOW;
+        return false;
+    case PANEL_STATE_CRC_LOW:
+        self->crc |= byte;
+        return parser_finish(self, frame);
+    default:
+        self->state = PANEL_STATE_START;
+        return false;
+    }
+}
+
+size_t panel_frame_encode(const PanelFrame *frame, uint8_t *buffer) {
+    buffer[0] = PANEL_FRAME_START;
+    buffer[1] = frame->type;
+    buffer[2] = frame->len;
+    memcpy(&buffer[PANEL_FRAME_HEADER_LEN], frame->payload, frame->len);
+    size_t len = PANEL_FRAME_HEADER_LEN + frame->len;
+    uint16_t crc = calculate_crc16(&buffer[1], len - 1);
+    buffer[len] = (uint8_t)(crc >> 8);
+    buffer[len + 1] = (uint8_t)crc;
+    return len + PANEL_FRAME_CRC_LEN;
+}
+
+static void put_u32(uint8_t *data, uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+        data[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t *data) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= (uint32_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+void panel_status_read(PanelStatus *status, const PS_Control *MPS) {
+    status->iout = MPS->mIout;
+    status->vout = MPS->mVout / 10;
+    status->heatsink = (int16_t)MPS->tHeatsink;
+    status->vreg = MPS->Vreg;
+    status->ref_set = MPS->Ref_Set;
+    status->vref_set = MPS->VRef_Set;
+    status->stat = (((uint32_t)MPS->Flag.fLocale)<<20)+(((uint32_t)MPS->Flag.PS_ON)<<18)+(MPS->Operate<<17)+(MPS->Ready<<16)+\
+        (((uint32_t)MPS->Faults.Board)<<15)+(((uint32_t)MPS->Faults.Line)<<14)+(((uint32_t)MPS->Faults.Overvoltage)<<13)+(((uint32_t)MPS->Faults.GndMon)<<12)+\
+        (((uint32_t)MPS->Faults.Overheat)<<11)+(((uint32_t)MPS->Faults.ExtLock2)<<9)+(((uint32_t)MPS->Faults.ExtLock1)<<8)+\
+        (((uint32_t)MPS->Faults.DCCT)<<7)+(((uint32_t)MPS->Faults.Unit2)<<3)+(((uint32_t)MPS->Faults.Unit1)<<2)+\
+        (((uint32_t)MPS->Faults.FBLost)<<1)+(((uint32_t)MPS->Faults.Overcurrent)<<0);
+}
+
+void panel_status_write(const PanelStatus *status, PanelFrame *frame) {
+    frame->type = PANEL_MSG_STATUS;
+    frame->len = PANEL_STATUS_LEN;
+    uint8_t *data = frame->payload;
+    put_u32(&data[0], (uint32_t)status->iout);
+    put_u32(&data[4], (uint32_t)status->vout);
+    data[8] = (uint8_t)status->heatsink;
+    data[9] = (uint8_t)((uint16_t)status->heatsink >> 8);
+    put_u32(&data[10], (uint32_t)status->vreg);
+    put_u32(&data[14], (uint32_t)status->ref_set);
+    put_u32(&data[18], (uint32_t)status->vref_set);
+    put_u32(&data[22], status->stat);
+}
+
+bool panel_status_parse(const PanelFrame *frame, PanelStatus *status) {
+    if (frame->type != PANEL_MSG_STATUS || frame->len != PANEL_STATUS_LEN) {
+        return false;
+    }
+    const uint8_t *data = frame->payload;
+    status->iout = (int32_t)get_u32(&data[0]);
+    status->vout = (int32_t)get_u32(&data[4]);
+    status->heatsink = (int16_t)((uint16_t)data[8] | ((uint16_t)data[9] << 8));
+    status->vreg = (int32_t)get_u32(&data[10]);
+    status->ref_set = (int32_t)get_u32(&data[14]);
+    status->vref_set = (int32_t)get_u32(&data[18]);
+    status->stat = get_u32(&data[22]);
+    return true;
+}
+
+static int32_t clamp(int32_t value, int32_t max) {
+    if (value > max) {
+        return max;
+    }
+    if (value < 0) {
+        return 0;
+    }
+    return value;
+}
+
+bool panel_command_apply(const PanelFrame *frame, PS_Control *MPS) {
+    switch (frame->type) {
+    case PANEL_CMD_MODE:
+        if (frame->len != 1) {
+            return false;
+        }
+        MPS->Flag.fCCMode = frame->payload[0] != 0;
+        break;
+    case PANEL_CMD_REF_SET:
+        if (frame->len != 4) {
+            return false;
+        }
+        MPS->Ref_Set = clamp((int32_t)get_u32(frame->payload), ISETMAX);
+        break;
+    case PANEL_CMD_DAC_SET:
+        if (frame->len != 4) {
+            return false;
+        }
+        MPS->VRef_Set = clamp((int32_t)get_u32(frame->payload), VSETMAX * 10L);
+        break;
+    case PANEL_CMD_MAIN_POWER:
+        if (frame->len != 1) {
+            return false;
+        }
+        if (frame->payload[0] != 0) {
+            if (MPS->Flag.PS_ON) MPS->Operate = 1;
+            else MPS->Flag.PS_ON = 1;
+        } else {
+            if (MPS->Operate) MPS->Operate = 0;
+            else MPS->Flag.PS_ON = 0;
+        }
+        break;
+    default:
+        return false;
+    }
+    MPS->Flag.fLocale = 1;
+    return true;
+}
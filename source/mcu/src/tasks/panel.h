@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <device/MPS.h>
+
+// Binary protocol of local panel link.
+//
+// Frame is start byte `PANEL_FRAME_START`, message type, payload length, payload and CRC16 of type, length and
+// payload. CRC is CCITT-FALSE of `utils/crc.h` sent in big-endian like in SkifIO frames, multi-byte payload fields
+// are little-endian. Received bytes are fed to parser one by one, so it never waits for a frame to complete.
+// Corrupted frame is dropped as a whole and parser hunts for the next start byte.
+
+#define PANEL_FRAME_START 0xA5
+/// Start, type and length.
+#define PANEL_FRAME_HEADER_LEN 3
+#define PANEL_FRAME_CRC_LEN 2
+#define PANEL_PAYLOAD_MAX 32
+#define PANEL_FRAME_MAX_LEN (PANEL_FRAME_HEADER_LEN + PANEL_PAYLOAD_MAX + PANEL_FRAME_CRC_LEN)
+
+/// Status sent by MCU, see `PanelStatus` for payload.
+#define PANEL_MSG_STATUS 0x01
+
+/// Commands sent by panel.
+/// Feedback mode, `uint8_t`: 1 - current, 0 - voltage.
+#define PANEL_CMD_MODE 0x81
+/// Current reference, `int32_t` in 100 uA units, clamped to `[0, ISETMAX]`.
+#define PANEL_CMD_REF_SET 0x82
+/// Voltage reference, `int32_t` in 100 uV units, clamped to `[0, 10 * VSETMAX]`.
+#define PANEL_CMD_DAC_SET 0x83
+/// Main power, `uint8_t`: 1 switches power on and then operation, 0 switches them off in reverse order.
+#define PANEL_CMD_MAIN_POWER 0x84
+
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint8_t payload[PANEL_PAYLOAD_MAX];
+} PanelFrame;
+
+typedef struct {
+    /// Filtered output current, 100 uA units.
+    int32_t iout;
+    /// Filtered output voltage, mV.
+    int32_t vout;
+    /// Heatsink temperature, 0.1 C units.
+    int16_t heatsink;
+    /// DAC readback, 100 uV units.
+    int32_t vreg;
+    int32_t ref_set;
+    int32_t vref_set;
+    /// Status bits: `||__|__|__|__|SoftStart|PS_ON|Operate|Ready||Board|Line|OverVolt|GndMon|OverHeat|Water|EXT2|EXT1||
+    /// DCCT|__|__|Punit3|PUnit2|PUnit1|FBLost|OverCurr||`, bit 20 is local control.
+    uint32_t stat;
+} PanelStatus;
+
+/// Length of `PanelStatus` payload.
+#define PANEL_STATUS_LEN 26
+
+typedef struct {
+    /// Type, length and payload received so far, CRC is computed over them.
+    uint8_t data[2 + PANEL_PAYLOAD_MAX];
+    uint8_t state;
+    uint8_t pos;
+    uint16_t crc;
+
+    /// Frames dropped because of CRC mismatch or length over `PANEL_PAYLOAD_MAX`. They are never reset.
+    uint32_t crc_error_count;
+    uint32_t length_error_count;
+} PanelParser;
+
+void panel_parser_init(PanelParser *self);
+
+/// Take the next received byte.
+/// @return `true` if a valid frame is completed by this byte, it is copied to `frame` then.
+bool panel_parser_push(PanelParser *self, uint8_t byte, PanelFrame *frame);
+
+/// Encode frame into `buffer` of at least `PANEL_FRAME_MAX_LEN` bytes.
+/// @return Length of encoded frame.
+size_t panel_frame_encode(const PanelFrame *frame, uint8_t *buffer);
+
+/// Collect status from control variables.
+void panel_status_read(PanelStatus *status, const PS_Control *MPS);
+
+void panel_status_write(const PanelStatus *status, PanelFrame *frame);
+
+bool panel_status_parse(const PanelFrame *frame, PanelStatus *status);
+
+/// Apply command received from panel to control variables.
+/// @return `false` if command type or length is unknown, nothing is changed then.
+bool panel_command_apply(const PanelFrame *frame, PS_Control *MPS);
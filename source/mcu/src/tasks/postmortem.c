@@ -0,0 +1,62 @@
+#include "postmortem.h"
+
+#include <hal/assert.h>
+
+// Handshake states. Sync generator only moves state from `RECORDING` to `FROZEN` and does not touch points after
+// that, RPMSG task only moves it back after upload.
+#define POSTMORTEM_STATE_RECORDING 0
+#define POSTMORTEM_STATE_FROZEN 1
+
+void postmortem_init(Postmortem *self) {
+    self->head = 0;
+    self->size = 0;
+    self->seen_fault_count = 0;
+    self->fault_count = 0;
+    self->lost_count = 0;
+    __atomic_store_n(&self->state, POSTMORTEM_STATE_RECORDING, __ATOMIC_RELAXED);
+}
+
+void postmortem_push(Postmortem *self, const PostmortemPoint *point, uint32_t fault_count) {
+    uint32_t latched = fault_count - self->seen_fault_count;
+    self->seen_fault_count = fault_count;
+
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != POSTMORTEM_STATE_RECORDING) {
+        self->lost_count += latched;
+        return;
+    }
+    self->points[self->head] = *point;
+    self->head = (self->head + 1) % POSTMORTEM_DEPTH;
+    if (self->size < POSTMORTEM_DEPTH) {
+        self->size += 1;
+    }
+    if (latched != 0) {
+        self->fault_count = fault_count;
+        __atomic_store_n(&self->state, POSTMORTEM_STATE_FROZEN, __ATOMIC_RELEASE);
+    }
+}
+
+bool postmortem_frozen(Postmortem *self) {
+    return __atomic_load_n(&self->state, __ATOMIC_ACQUIRE) == POSTMORTEM_STATE_FROZEN;
+}
+
+size_t postmortem_read(const Postmortem *self, size_t offset, PostmortemPoint *points, size_t len) {
+    if (offset >= self->size) {
+        return 0;
+    }
+    if (len > self->size - offset) {
+        len = self->size - offset;
+    }
+    // The oldest point is at `head` once the buffer has wrapped around, and at zero before that.
+    size_t start = (self->head + POSTMORTEM_DEPTH - self->size) % POSTMORTEM_DEPTH;
+    for (size_t i = 0; i < len; ++i) {
+        points[i] = self->points[(start + offset + i) % POSTMORTEM_DEPTH];
+    }
+    return len;
+}
+
+void postmortem_rearm(Postmortem *self) {
+    hal_assert(postmortem_frozen(self));
+    self->head = 0;
+    self->size = 0;
+    __atomic_store_n(&self->state, POSTMORTEM_STATE_RECORDING, __ATOMIC_RELEASE);
+}
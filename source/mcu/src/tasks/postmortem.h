@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <common/config.h>
+
+// Post-mortem buffer of regulator values.
+//
+// Sync generator pushes a point each tick into a circular buffer holding the last `POSTMORTEM_DEPTH` ticks. When a
+// fault latches the buffer is frozen after the point of that tick, so it keeps the ticks before the trip even if app
+// is not connected or not responsive at that moment. RPMSG task uploads the frozen buffer in chunks and then re-arms
+// it. Buffer is passed between tasks by the same one-way handshake as of `FaultMonitor`.
+
+typedef struct {
+    int32_t values[POSTMORTEM_COUNT];
+} PostmortemPoint;
+
+typedef struct {
+    PostmortemPoint points[POSTMORTEM_DEPTH];
+    /// Position of the next point to write.
+    size_t head;
+    /// Number of points written since re-arm, up to `POSTMORTEM_DEPTH`.
+    size_t size;
+    /// Fault count seen by sync generator at the previous tick.
+    uint32_t seen_fault_count;
+    /// Fault count the buffer was frozen at.
+    uint32_t fault_count;
+
+    /// Handshake state, see `postmortem.c`.
+    uint32_t state;
+    /// Number of faults latched while the buffer was frozen. It is never reset.
+    volatile uint32_t lost_count;
+} Postmortem;
+
+void postmortem_init(Postmortem *self);
+
+/// Store point of the current tick, called by sync generator after all faults of the tick are checked.
+/// `fault_count` is the number of faults latched so far, the buffer is frozen when it changes.
+void postmortem_push(Postmortem *self, const PostmortemPoint *point, uint32_t fault_count);
+
+/// Check if the buffer is frozen, called by RPMSG task. Points can be read until the buffer is re-armed.
+bool postmortem_frozen(Postmortem *self);
+
+/// Copy up to `len` points of the frozen buffer starting from `offset`, counted from the oldest point.
+/// @return Number of copied points.
+size_t postmortem_read(const Postmortem *self, size_t offset, PostmortemPoint *points, size_t len);
+
+/// Drop the frozen buffer and resume recording, called by RPMSG task after upload.
+void postmortem_rearm(Postmortem *self);
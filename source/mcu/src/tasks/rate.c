@@ -0,0 +1,23 @@
+#include "rate.h"
+
+#include <hal/math.h>
+
+static const uint32_t SUPPORTED_FREQS_HZ[] = {SAMPLE_FREQS_HZ};
+
+bool sample_rate_init(SampleRate *self, uint32_t freq_hz) {
+    bool supported = false;
+    for (size_t i = 0; i < sizeof(SUPPORTED_FREQS_HZ) / sizeof(SUPPORTED_FREQS_HZ[0]); ++i) {
+        supported |= SUPPORTED_FREQS_HZ[i] == freq_hz;
+    }
+    if (!supported) {
+        return false;
+    }
+
+    self->freq_hz = freq_hz;
+    self->period_us = 1000000 / freq_hz;
+    // Buffers cover the whole time at any supported rate, see `control.h`.
+    self->dac_depth = (size_t)(freq_hz * DAC_BUFFER_TIME_MS / 1000);
+    self->adc_depth = (size_t)(freq_hz * ADC_BUFFER_TIME_MS / 1000);
+    self->adc_batch = hal_max((size_t)(freq_hz / ADC_MSG_RATE_HZ), (size_t)1);
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <common/config.h>
+
+// Sample rate and parameters derived from it.
+//
+// Ring buffers are allocated for the highest rate, and only part of them is used at lower rates,
+// so the buffered time (and therefore latency) does not depend on the rate.
+
+/// Highest sample frequency, ring buffers are sized for it.
+#define SAMPLE_FREQ_MAX_HZ 20000
+/// Sample frequencies supported by sync generator, in ascending order.
+#define SAMPLE_FREQS_HZ 5000, 10000, SAMPLE_FREQ_MAX_HZ
+
+/// Time of DAC points buffered on MCU.
+#define DAC_BUFFER_TIME_MS 100
+/// Time of ADC points buffered on MCU until they are lost.
+#define ADC_BUFFER_TIME_MS 50
+/// Target rate of ADC messages, ADC points are batched to not exceed it.
+#define ADC_MSG_RATE_HZ 500
+
+typedef struct {
+    uint32_t freq_hz;
+    /// Sync generator period.
+    uint32_t period_us;
+    /// Number of DAC ring buffer points used.
+    size_t dac_depth;
+    /// Number of ADC ring buffer points used.
+    size_t adc_depth;
+    /// Number of ADC points in single message, may be further limited by message length.
+    size_t adc_batch;
+} SampleRate;
+
+/// Derive parameters for given sample frequency.
+/// @return `false` if frequency is not supported.
+bool sample_rate_init(SampleRate *self, uint32_t freq_hz);
@@ -0,0 +1,58 @@
+#include "reference.h"
+
+#include <hal/assert.h>
+
+#include <common/config.h>
+
+void reference_init(Reference *self) {
+    for (size_t i = 0; i < REFERENCE_COUNT; ++i) {
+        reference_reset(self, i, 0);
+    }
+    self->ticks = 0;
+    self->requested_ticks = 0;
+    fixed_div_init(&self->ticks_div, 1);
+}
+
+void reference_set_mode(Reference *self, uint32_t upsampling, bool interpolate) {
+    hal_assert(upsampling >= 1 && upsampling <= DAC_UPSAMPLING_MAX);
+    self->requested_ticks = interpolate ? REFERENCE_TICKS_PER_SAMPLE * upsampling : 0;
+}
+
+void reference_commit(Reference *self) {
+    uint32_t requested_ticks = self->requested_ticks;
+    if (requested_ticks == self->ticks) {
+        return;
+    }
+    self->ticks = requested_ticks;
+    if (requested_ticks != 0) {
+        // Done once per mode change, so the slow reciprocal computation does not matter.
+        fixed_div_init(&self->ticks_div, requested_ticks);
+    }
+}
+
+int32_t reference_update(Reference *self, size_t channel, int32_t setpoint) {
+    ReferenceChannel *ch = &self->channels[channel];
+    if (setpoint != ch->target) {
+        // Repeated setpoint is not a new point, previous ramp has already reached it or will do so in time.
+        ch->start = ch->value;
+        ch->target = setpoint;
+        ch->tick = 0;
+    }
+    if (self->ticks == 0 || ch->tick >= self->ticks - 1) {
+        ch->tick = self->ticks;
+        ch->value = ch->target;
+    } else {
+        ch->tick += 1;
+        int64_t step = (int64_t)ch->target - (int64_t)ch->start;
+        ch->value = ch->start + (int32_t)fixed_div_s64(&self->ticks_div, step * (int64_t)ch->tick);
+    }
+    return ch->value;
+}
+
+void reference_reset(Reference *self, size_t channel, int32_t value) {
+    ReferenceChannel *ch = &self->channels[channel];
+    ch->value = value;
+    ch->start = value;
+    ch->target = value;
+    ch->tick = 0;
+}
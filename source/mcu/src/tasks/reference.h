@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <utils/fixed.h>
+
+// Regulator reference interpolation.
+//
+// Control task sets reference once per DAC point, while sync generator runs regulator at two ticks per sample.
+// Without interpolation reference is held between DAC points. With interpolation sync generator ramps linearly from
+// the value at the moment of change to the new DAC point over the DAC point period, so the reference reaches each
+// point one period after it is set. That is half a period later than sample-and-hold on average,
+// but there are no steps for the regulator to overshoot on.
+
+/// Sync generator timer ticks twice per sample.
+#define REFERENCE_TICKS_PER_SAMPLE 2
+
+/// Interpolated setpoints: current in CC mode and voltage otherwise.
+#define REFERENCE_CURRENT 0
+#define REFERENCE_VOLTAGE 1
+
+#define REFERENCE_COUNT 2
+
+typedef struct {
+    int32_t value;
+    /// Value at the moment of the last setpoint change.
+    int32_t start;
+    int32_t target;
+    /// Number of ticks since the last setpoint change.
+    uint32_t tick;
+} ReferenceChannel;
+
+typedef struct {
+    ReferenceChannel channels[REFERENCE_COUNT];
+    /// Number of ticks between DAC points, zero if interpolation is off.
+    uint32_t ticks;
+    /// Ticks to switch to at the next tick, set by other task.
+    volatile uint32_t requested_ticks;
+    /// Reciprocal of `ticks`.
+    FixedDiv ticks_div;
+} Reference;
+
+/// Interpolation is off by default.
+void reference_init(Reference *self);
+
+/// Set number of samples between DAC points (DAC upsampling ratio) and whether to interpolate between them,
+/// called by RPMSG task.
+void reference_set_mode(Reference *self, uint32_t upsampling, bool interpolate);
+
+/// Take requested mode, called by sync generator at the tick boundary. Ramps in progress are kept.
+void reference_commit(Reference *self);
+
+/// Get reference of `channel` for the current tick given the last setpoint from control task.
+int32_t reference_update(Reference *self, size_t channel, int32_t setpoint);
+
+/// Set reference of `channel` to `value` at once, e.g. when regulator is stopped by fault.
+void reference_reset(Reference *self, size_t channel, int32_t value);
@@ -0,0 +1,81 @@
+#include "regulator.h"
+
+#include <hal/assert.h>
+#include <hal/math.h>
+
+// Handshake states, see `calib.c`.
+#define REGULATOR_STATE_IDLE 0
+#define REGULATOR_STATE_PENDING 1
+
+static void prepare_params(RegulatorParams *params, const RegulatorGains *gains) {
+    hal_assert(gains->ki >= 0);
+    params->gains = *gains;
+    params->sum_limit = gains->ki != 0 ? REGULATOR_SUM_TERM_MAX / gains->ki : 0;
+}
+
+void regulator_init(Regulator *self, const RegulatorGains *gains) {
+    fixed_div_init(&self->kp_div, REGULATOR_KP_SCALE);
+    fixed_div_init(&self->ki_div, REGULATOR_KI_SCALE);
+    fixed_div_init(&self->kd_div, REGULATOR_KD_SCALE);
+    fixed_div_init(&self->ff_div, REGULATOR_FF_SCALE);
+    self->prev_ref = 0;
+    self->prev_meas = 0;
+    self->gains = *gains;
+    prepare_params(&self->active, gains);
+    __atomic_store_n(&self->state, REGULATOR_STATE_IDLE, __ATOMIC_RELAXED);
+}
+
+bool regulator_write(Regulator *self, const RegulatorGains *gains) {
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != REGULATOR_STATE_IDLE) {
+        return false;
+    }
+    self->gains = *gains;
+    prepare_params(&self->pending, gains);
+    __atomic_store_n(&self->state, REGULATOR_STATE_PENDING, __ATOMIC_RELEASE);
+    return true;
+}
+
+const RegulatorGains *regulator_gains(const Regulator *self) {
+    return &self->gains;
+}
+
+void regulator_commit(Regulator *self) {
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != REGULATOR_STATE_PENDING) {
+        return;
+    }
+    // Integral sum is kept, it is clamped to the new limit by the next `regulator_pi`.
+    self->active = self->pending;
+    __atomic_store_n(&self->state, REGULATOR_STATE_IDLE, __ATOMIC_RELEASE);
+}
+
+int32_t regulator_pi(const Regulator *self, int32_t delta, int64_t *sum) {
+    const RegulatorParams *params = &self->active;
+    *sum += delta;
+    if (*sum > params->sum_limit) {
+        *sum = params->sum_limit;
+    }
+    if (*sum < -params->sum_limit) {
+        *sum = -params->sum_limit;
+    }
+    return (int32_t)(fixed_div_s64(&self->kp_div, (int64_t)delta * (int64_t)params->gains.kp) +
+                     fixed_div_s64(&self->ki_div, *sum * (int64_t)params->gains.ki));
+}
+
+static int32_t saturate(int64_t value) {
+    return (int32_t)hal_max((int64_t)INT32_MIN, hal_min((int64_t)INT32_MAX, value));
+}
+
+int32_t regulator_feed_forward(Regulator *self, int32_t ref) {
+    const RegulatorGains *gains = &self->active.gains;
+    int64_t change = (int64_t)ref - (int64_t)self->prev_ref;
+    self->prev_ref = ref;
+    // Both products fit 64 bits for any 32-bit values.
+    return saturate(fixed_div_s64(&self->ff_div, (int64_t)ref * (int64_t)gains->ff_r) +
+                    fixed_div_s64(&self->ff_div, change * (int64_t)gains->ff_l));
+}
+
+int32_t regulator_derivative(Regulator *self, int32_t meas) {
+    int64_t change = (int64_t)meas - (int64_t)self->prev_meas;
+    self->prev_meas = meas;
+    return saturate(-fixed_div_s64(&self->kd_div, change * (int64_t)self->active.gains.kd));
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <utils/fixed.h>
+
+// Gains of current regulator.
+//
+// Sync generator runs the regulator with the active gains each tick. New gains are staged by RPMSG task with
+// `regulator_write` and are taken by sync generator with `regulator_commit` at the tick boundary, so a tick never
+// sees a half-updated set. Handshake is the same as of `Calib`.
+
+/// Proportional gain is in `1 / REGULATOR_KP_SCALE` units.
+#define REGULATOR_KP_SCALE 100LL
+/// Integral gain is in `1 / REGULATOR_KI_SCALE` units per tick.
+#define REGULATOR_KI_SCALE 80000LL
+/// Integral term is limited to this value, sum limit is derived from it.
+#define REGULATOR_SUM_TERM_MAX (160000LL * 150000LL)
+/// Derivative gain is in `1 / REGULATOR_KD_SCALE` units per measurement change per tick.
+#define REGULATOR_KD_SCALE 100LL
+/// Feed-forward gains are in `1 / REGULATOR_FF_SCALE` units of output per reference (resistive)
+/// and per reference change per tick (inductive).
+#define REGULATOR_FF_SCALE 1000LL
+
+typedef struct {
+    int32_t kp;
+    /// Must not be negative, integral sum limit is derived from it.
+    int32_t ki;
+    int32_t kd;
+    int32_t kp2;
+    int32_t ki2;
+    int32_t kd2;
+    /// Feed-forward of load model `V = R * I + L * dI/dt`, output is proportional to `R` and `L` respectively.
+    int32_t ff_r;
+    int32_t ff_l;
+} RegulatorGains;
+
+/// Gains with values derived by writer, so that nothing is divided by variable in the tick.
+typedef struct {
+    RegulatorGains gains;
+    /// Integral sum limit, zero if integral gain is zero.
+    int64_t sum_limit;
+} RegulatorParams;
+
+typedef struct {
+    /// Parameters used by sync generator, accessed only by it.
+    RegulatorParams active;
+
+    /// Parameters prepared by writer and not yet taken by sync generator.
+    RegulatorParams pending;
+    /// Handshake state, see `regulator.c`.
+    uint32_t state;
+    /// Last written gains, accessed only by writer.
+    RegulatorGains gains;
+
+    /// Reference and measurement of previous tick, accessed only by sync generator.
+    int32_t prev_ref;
+    int32_t prev_meas;
+
+    FixedDiv kp_div;
+    FixedDiv ki_div;
+    FixedDiv kd_div;
+    FixedDiv ff_div;
+} Regulator;
+
+/// Set initial gains, must be called before sync generator is started.
+void regulator_init(Regulator *self, const RegulatorGains *gains);
+
+/// Replace gains, called by writer only. Gains are applied by sync generator at the next tick.
+/// @return `false` if the previous gains are not taken yet, the new ones are discarded then.
+bool regulator_write(Regulator *self, const RegulatorGains *gains);
+
+/// Last written gains, called by writer only.
+const RegulatorGains *regulator_gains(const Regulator *self);
+
+/// Take pending gains if any, called by sync generator at tick boundary.
+void regulator_commit(Regulator *self);
+
+/// Accumulate `delta` to integral `sum` with anti-windup limit and return PI output.
+int32_t regulator_pi(const Regulator *self, int32_t delta, int64_t *sum);
+
+/// Feed-forward output for reference `ref` of the current tick, so that the loop does not have to build up error to
+/// drive the load. Zero if `ff_r` and `ff_l` are zero.
+int32_t regulator_feed_forward(Regulator *self, int32_t ref);
+
+/// Derivative output on measurement `meas` of the current tick. Unlike derivative of error it does not kick on
+/// reference steps. Zero if `kd` is zero.
+int32_t regulator_derivative(Regulator *self, int32_t meas);
@@ -1,27 +1,94 @@
 #include "rpmsg.h"
 
 #include <hal/assert.h>
+#include <hal/math.h>
 
 
 void rpmsg_init(Rpmsg *self, Control *control, Statistics *stats) {
     // The layouts of `AdcArray` and `IppArray6Int32` must be the same.
     hal_assert(sizeof(*(AdcArray *)NULL) == sizeof(*(IppArray6Int32 *)NULL));
+    // The same for `TelemetryPoint` and `IppArray5Int32`.
+    hal_assert(sizeof(*(TelemetryPoint *)NULL) == sizeof(*(IppArray5Int32 *)NULL));
 
     self->alive = false;
 
-    self->send_sem = xSemaphoreCreateBinary();
-    hal_assert(self->send_sem != NULL);
+    self->features = 0;
+    hal_assert(sample_rate_init(&self->rate, SAMPLE_FREQ_HZ));
+    self->rate_handler = NULL;
+    self->rate_handler_data = NULL;
+    self->calib = NULL;
+    self->regulator = NULL;
+    self->telemetry = NULL;
+    self->reference = NULL;
+    self->fault = NULL;
+    self->postmortem = NULL;
+    self->adc_msg_points = hal_min((size_t)ADC_MSG_MAX_POINTS, self->rate.adc_batch);
+
+    self->send_task = NULL;
+    self->service_mutex = xSemaphoreCreateMutex();
+    hal_assert(self->service_mutex != NULL);
     hal_atomic_size_store(&self->dac_requested, 0);
 
-    control_sync_init(&self->control_sync, &self->send_sem, DAC_MSG_MAX_POINTS, ADC_MSG_MAX_POINTS);
+    self->adc_seq = 0;
+    self->adc_sample_index = 0;
+    self->dac_seq = 0;
+    self->telemetry_index = 0;
+    self->telemetry_sent = 0;
+    self->postmortem_offset = 0;
+
+    control_sync_init(&self->control_sync, DAC_MSG_MAX_POINTS, self->adc_msg_points);
     control_set_sync(control, &self->control_sync);
+    control_set_sample_rate(control, &self->rate);
     self->control = control;
 
     self->stats = stats;
+
+    self->timing_count = 0;
+    self->timing_reported = 0;
+    self->stats_reported = 0;
+    rpmsg_add_timing(self, &control->timing);
+    probe_group_init(&self->send_timing, TIMING_RPMSG_WAKEUP, 1);
+    rpmsg_add_timing(self, &self->send_timing);
+}
+
+void rpmsg_add_timing(Rpmsg *self, ProbeGroup *group) {
+    hal_assert(self->timing_count < RPMSG_MAX_TIMING_GROUPS);
+    self->timing[self->timing_count] = group;
+    self->timing_count += 1;
+}
+
+void rpmsg_set_rate_handler(Rpmsg *self, RpmsgRateHandler handler, void *user_data) {
+    self->rate_handler = handler;
+    self->rate_handler_data = user_data;
+}
+
+void rpmsg_set_calib(Rpmsg *self, Calib *calib) {
+    self->calib = calib;
+}
+
+void rpmsg_set_regulator(Rpmsg *self, Regulator *regulator) {
+    self->regulator = regulator;
+}
+
+void rpmsg_set_telemetry(Rpmsg *self, Telemetry *telemetry) {
+    self->telemetry = telemetry;
+}
+
+void rpmsg_set_reference(Rpmsg *self, Reference *reference) {
+    self->reference = reference;
+}
+
+void rpmsg_set_fault(Rpmsg *self, FaultMonitor *fault) {
+    self->fault = fault;
+}
+
+void rpmsg_set_postmortem(Rpmsg *self, Postmortem *postmortem) {
+    self->postmortem = postmortem;
 }
 
 void rpmsg_deinit(Rpmsg *self) {
-    vSemaphoreDelete(self->send_sem);
+    // Tasks and their notifications are never deleted.
+    vSemaphoreDelete(self->service_mutex);
 }
 
 static hal_retcode rpmsg_recv_message(
@@ -76,28 +143,42 @@ static void rpmsg_send_message(Rpmsg *self, void (*write_message)(Rpmsg *, void
 }
 
 static void write_adc_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
-    static const size_t SIZE = ADC_MSG_MAX_POINTS;
+    AdcRingBuffer *rb = &self->control->adc.buffer;
+    size_t size = self->adc_msg_points;
+
+    // Points lost on buffer overrun are accounted in sample index when reader reaches their place,
+    // so the app can tell them apart from messages lost in transport. Message is ended before the next gap.
+    size_t position = adc_rb_read_position(rb);
+    self->adc_sample_index += overrun_log_read(&self->control->adc.overrun, position, &size);
 
     basic_message->type = IPP_MCU_MSG_ADC_DATA;
     IppMcuMsgAdcData *message = &basic_message->adc_data;
-    message->points_arrays.len = (uint16_t)SIZE;
-    // It must be guaranteed that ADC buffer contains at least `ADC_MSG_MAX_POINTS` points.
-    hal_assert(adc_rb_read(&self->control->adc.buffer, (AdcArray *)message->points_arrays.data, SIZE) == SIZE);
+    message->seq = self->adc_seq;
+    message->sample_index = self->adc_sample_index;
+    message->points_arrays.len = (uint16_t)size;
+    // It must be guaranteed that ADC buffer contains at least `adc_msg_points` points.
+    hal_assert(adc_rb_read(rb, (AdcArray *)message->points_arrays.data, size) == size);
+
+    self->adc_seq += 1;
+    self->adc_sample_index += size;
 }
 
 static void rpmsg_send_adcs(Rpmsg *self) {
     AdcRingBuffer *rb = &self->control->adc.buffer;
-    while (adc_rb_occupied(rb) >= ADC_MSG_MAX_POINTS) {
+    while (adc_rb_occupied(rb) >= self->adc_msg_points) {
         rpmsg_send_message(self, write_adc_message, NULL);
     }
 }
 
 static void rpmsg_discard_adcs(Rpmsg *self) {
-    static const size_t SIZE = ADC_MSG_MAX_POINTS;
+    const size_t SIZE = self->adc_msg_points;
     AdcRingBuffer *rb = &self->control->adc.buffer;
-    while (adc_rb_occupied(rb) >= SIZE) {
-        hal_assert(adc_rb_skip(rb, SIZE) == SIZE);
-    }
+    // Skipping is O(1), so all whole messages are discarded at once.
+    size_t occupied = adc_rb_occupied(rb);
+    size_t len = occupied - occupied % SIZE;
+    self->adc_sample_index += overrun_log_skip(&self->control->adc.overrun, adc_rb_read_position(rb), len);
+    hal_assert(adc_rb_skip(rb, len) == len);
+    self->adc_sample_index += len;
 }
 
 static void write_dac_req_message(Rpmsg *self, void *user_data, IppMcuMsg *message) {
@@ -109,7 +190,10 @@ static void write_dac_req_message(Rpmsg *self, void *user_data, IppMcuMsg *messa
 static void rpmsg_send_dac_request(Rpmsg *self) {
     static const size_t SIZE = DAC_MSG_MAX_POINTS;
 
-    size_t vacant = dac_rb_vacant(&self->control->dac.buffer);
+    // Only `depth` points of the buffer are used at current sample rate.
+    size_t depth = self->control->dac.depth;
+    size_t occupied = dac_rb_occupied(&self->control->dac.buffer);
+    size_t vacant = depth > occupied ? depth - occupied : 0;
     size_t requested = hal_atomic_size_load(&self->dac_requested);
     size_t req_count_raw = 0;
     if (requested <= vacant) {
@@ -133,31 +217,331 @@ static void rpmsg_send_din(Rpmsg *self) {
     rpmsg_send_message(self, write_din_message, (void *)&self->control->dio.in);
 }
 
+/// Check whether `period_ms` has passed since `last` tick count and update it if so.
+static bool period_elapsed(TickType_t *last, uint32_t period_ms) {
+    TickType_t now = xTaskGetTickCount();
+    if ((TickType_t)(now - *last) < pdMS_TO_TICKS(period_ms)) {
+        return false;
+    }
+    *last = now;
+    return true;
+}
+
+typedef struct {
+    uint8_t stage;
+    const Probe *probe;
+} TimingReport;
+
+static void write_timing_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    const TimingReport *report = (const TimingReport *)user_data;
+    const Probe *probe = report->probe;
+    basic_message->type = IPP_MCU_MSG_TIMING;
+    IppMcuMsgTiming *message = &basic_message->timing;
+    message->stage = report->stage;
+    message->cycles_per_us = CYCLES_PER_US;
+    message->count = probe->count;
+    message->min = probe->count > 0 ? probe->min : 0;
+    message->max = probe->max;
+    message->sum = probe->sum;
+    for (size_t i = 0; i < TIMING_HIST_BINS; ++i) {
+        message->hist.data[i] = probe->hist[i];
+    }
+}
+
+static void rpmsg_send_timing(Rpmsg *self) {
+    if (!period_elapsed(&self->timing_reported, TIMING_REPORT_PERIOD_MS)) {
+        return;
+    }
+
+    // Snapshot is too large for the task stack.
+    static Probe probes[PROBE_GROUP_MAX_SIZE];
+    for (size_t i = 0; i < self->timing_count; ++i) {
+        ProbeGroup *group = self->timing[i];
+        if (!probe_group_take(group, probes)) {
+            continue;
+        }
+        for (size_t j = 0; j < group->size; ++j) {
+            TimingReport report = {(uint8_t)(group->first + j), &probes[j]};
+            rpmsg_send_message(self, write_timing_message, (void *)&report);
+        }
+    }
+}
+
+static void write_stats_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    const Statistics *stats = (const Statistics *)user_data;
+    basic_message->type = IPP_MCU_MSG_STATS;
+    IppMcuMsgStats *message = &basic_message->stats;
+    message->clock_count = stats->clock_count;
+    message->sample_count = stats->sample_count;
+    message->max_intrs_per_sample = stats->max_intrs_per_sample;
+    message->crc_error_count = stats->crc_error_count;
+    message->dac_lost_empty = stats->dac.lost_empty;
+    message->dac_lost_full = stats->dac.lost_full;
+    message->dac_req_exceed = stats->dac.req_exceed;
+    message->adc_lost_full = stats->adc.lost_full;
+    message->dac_msg_lost = stats->link.dac_msg_lost;
+    message->dac_msg_dup = stats->link.dac_msg_dup;
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        const ValueStats *values = &stats->adc.values[i];
+        message->adc_count.data[i] = values->count;
+        message->adc_sum.data[i] = values->sum;
+        message->adc_last.data[i] = values->last;
+        message->adc_min.data[i] = values->min;
+        message->adc_max.data[i] = values->max;
+    }
+}
+
+static void rpmsg_send_stats(Rpmsg *self) {
+    if (!period_elapsed(&self->stats_reported, STATS_MSG_PERIOD_MS)) {
+        return;
+    }
+
+    // Snapshot is too large for the task stack.
+    static Statistics snapshot;
+    stats_snapshot(self->stats, &snapshot);
+    rpmsg_send_message(self, write_stats_message, (void *)&snapshot);
+}
+
+static void write_telemetry_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    size_t size = *(const size_t *)user_data;
+    Telemetry *telemetry = self->telemetry;
+
+    // Points lost on buffer overrun are accounted in the same way as ADC ones.
+    size_t position = telemetry_rb_read_position(&telemetry->buffer);
+    self->telemetry_index += overrun_log_read(&telemetry->overrun, position, &size);
+
+    basic_message->type = IPP_MCU_MSG_TELEMETRY;
+    IppMcuMsgTelemetry *message = &basic_message->telemetry;
+    message->point_index = self->telemetry_index;
+    message->points.len = (uint16_t)size;
+    hal_assert(telemetry_rb_read(&telemetry->buffer, (TelemetryPoint *)message->points.data, size) == size);
+
+    self->telemetry_index += size;
+}
+
+static void rpmsg_send_telemetry(Rpmsg *self) {
+    if (self->telemetry == NULL) {
+        return;
+    }
+    TelemetryRingBuffer *rb = &self->telemetry->buffer;
+    size_t size = TELEMETRY_MSG_MAX_POINTS;
+    while (telemetry_rb_occupied(rb) >= size) {
+        rpmsg_send_message(self, write_telemetry_message, (void *)&size);
+        self->telemetry_sent = xTaskGetTickCount();
+    }
+    // At low ratio message is filled slowly, so the rest is sent periodically.
+    size = telemetry_rb_occupied(rb);
+    if (size > 0 && period_elapsed(&self->telemetry_sent, TELEMETRY_FLUSH_PERIOD_MS)) {
+        rpmsg_send_message(self, write_telemetry_message, (void *)&size);
+    }
+}
+
+static void rpmsg_discard_telemetry(Rpmsg *self) {
+    if (self->telemetry == NULL) {
+        return;
+    }
+    TelemetryRingBuffer *rb = &self->telemetry->buffer;
+    size_t len = telemetry_rb_occupied(rb);
+    self->telemetry_index += overrun_log_skip(&self->telemetry->overrun, telemetry_rb_read_position(rb), len);
+    hal_assert(telemetry_rb_skip(rb, len) == len);
+    self->telemetry_index += len;
+}
+
+static void write_fault_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    const FaultRecord *record = (const FaultRecord *)user_data;
+    basic_message->type = IPP_MCU_MSG_FAULT;
+    IppMcuMsgFault *message = &basic_message->fault;
+    message->code = (uint8_t)record->code;
+    message->tick = record->tick;
+    // Fault is close to the points being sent, so the index is extended from 32 bits by the nearest ADC one.
+    message->sample_index = self->adc_sample_index + (uint64_t)(int64_t)(int32_t)(record->adc_index - (uint32_t)self->adc_sample_index);
+    message->value = record->value;
+    message->latency = record->latency;
+    message->count = record->count;
+    message->lost_count = self->fault->lost_count;
+}
+
+/// Fault latched while app is not connected is kept until it connects.
+static void rpmsg_send_fault(Rpmsg *self) {
+    if ((self->features & IPP_FEATURE_FAULT) == 0) {
+        return;
+    }
+    FaultRecord record;
+    if (fault_take(self->fault, &record)) {
+        hal_log_warn("Fault %ld latched with value %ld", record.code, record.value);
+        rpmsg_send_message(self, write_fault_message, (void *)&record);
+    }
+}
+
+static void write_postmortem_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    (void)user_data;
+    const Postmortem *postmortem = self->postmortem;
+    basic_message->type = IPP_MCU_MSG_POSTMORTEM;
+    IppMcuMsgPostmortem *message = &basic_message->postmortem;
+    message->fault_count = postmortem->fault_count;
+    message->lost_count = postmortem->lost_count;
+    message->size = (uint16_t)postmortem->size;
+    message->offset = (uint16_t)self->postmortem_offset;
+    size_t len = postmortem_read(
+        postmortem,
+        self->postmortem_offset,
+        (PostmortemPoint *)message->points.data,
+        POSTMORTEM_MSG_MAX_POINTS //
+    );
+    message->points.len = (uint16_t)len;
+    self->postmortem_offset += len;
+}
+
+/// Frozen buffer is sent one chunk per call to keep latency of other messages, and is kept until app connects.
+static void rpmsg_send_postmortem(Rpmsg *self) {
+    if ((self->features & IPP_FEATURE_POSTMORTEM) == 0 || !postmortem_frozen(self->postmortem)) {
+        return;
+    }
+    if (self->postmortem_offset == 0) {
+        hal_log_info("Upload post-mortem buffer of fault %ld", self->postmortem->fault_count);
+    }
+    rpmsg_send_message(self, write_postmortem_message, NULL);
+    if (self->postmortem_offset >= self->postmortem->size) {
+        self->postmortem_offset = 0;
+        postmortem_rearm(self->postmortem);
+    } else {
+        // Wake up again to send the next chunk.
+        control_sync_notify(&self->control_sync, 0);
+    }
+}
+
 static void rpmsg_send_task(void *param) {
     Rpmsg *self = (Rpmsg *)param;
 
     for (;;) {
-        if (xSemaphoreTake(self->send_sem, 10000) != pdTRUE) {
+        uint32_t events = 0;
+        if (!control_sync_wait(&self->control_sync, 10000, &events)) {
             hal_log_warn("RPMSG send task timed out");
             continue;
         }
+        if (events != 0) {
+            // Wake-ups without events are made by this task itself.
+            uint32_t latency = control_sync_latency(&self->control_sync, events);
+            probe_record(probe_group_get(&self->send_timing, TIMING_RPMSG_WAKEUP), latency);
+        }
 
+        // Only pending events are serviced, the rest is checked on each wake-up.
+        hal_assert(xSemaphoreTake(self->service_mutex, portMAX_DELAY) == pdTRUE);
         if (self->alive) {
-            rpmsg_send_din(self);
-            rpmsg_send_adcs(self);
-            rpmsg_send_dac_request(self);
+            if ((events & CONTROL_EVENT_DIN_CHANGED) != 0) {
+                rpmsg_send_din(self);
+            }
+            if ((events & CONTROL_EVENT_ADC_READY) != 0) {
+                rpmsg_send_adcs(self);
+            }
+            if ((events & CONTROL_EVENT_DAC_SPACE) != 0) {
+                rpmsg_send_dac_request(self);
+            }
+            rpmsg_send_timing(self);
+            rpmsg_send_stats(self);
+            rpmsg_send_telemetry(self);
+            rpmsg_send_fault(self);
+            rpmsg_send_postmortem(self);
         } else {
             rpmsg_discard_adcs(self);
+            rpmsg_discard_telemetry(self);
         }
+        xSemaphoreGive(self->service_mutex);
+        probe_group_commit(&self->send_timing);
     }
 }
 
-static void connect(Rpmsg *self) {
-    hal_atomic_size_store(&self->dac_requested, 0);
-    control_dac_start(self->control);
-    self->alive = true;
-    xSemaphoreGive(self->send_sem);
-    hal_log_info("IOC connected");
+/// Number of ADC points that fit into message of given length.
+static size_t adc_msg_points_by_len(size_t len) {
+    static const size_t HEADER_SIZE = sizeof(((IppMcuMsg *)NULL)->type) + sizeof(IppMcuMsgAdcData);
+    if (len >= RPMSG_MAX_MCU_MSG_LEN) {
+        return ADC_MSG_MAX_POINTS;
+    }
+    if (len < HEADER_SIZE) {
+        return 0;
+    }
+    return _adc_msg_max_points_by_len(len);
+}
+
+static void write_capabilities_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    basic_message->type = IPP_MCU_MSG_CAPABILITIES;
+    IppMcuMsgCapabilities *message = &basic_message->capabilities;
+    message->version = IPP_PROTOCOL_VERSION;
+    message->max_msg_len = RPMSG_MAX_APP_MSG_LEN;
+    message->dac_buffer_size = (uint32_t)self->rate.dac_depth;
+    message->adc_buffer_size = (uint32_t)self->rate.adc_depth;
+    message->dac_msg_max_points = DAC_MSG_MAX_POINTS;
+    message->adc_msg_max_points = (uint16_t)self->adc_msg_points;
+    message->sample_freq_hz = self->rate.freq_hz;
+    message->features = self->features;
+}
+
+/// Apply sample rate requested by app, zero or unsupported frequency keeps the current one.
+/// Called with `service_mutex` taken, so send task does not use the rate meanwhile.
+static void set_sample_rate(Rpmsg *self, uint32_t freq_hz) {
+    if (freq_hz == 0 || freq_hz == self->rate.freq_hz) {
+        return;
+    }
+    SampleRate rate;
+    if (!sample_rate_init(&rate, freq_hz)) {
+        hal_log_warn("Unsupported sample frequency %ld Hz, keep %ld Hz", freq_hz, self->rate.freq_hz);
+        return;
+    }
+    if (self->rate_handler != NULL && !self->rate_handler(self->rate_handler_data, &rate)) {
+        hal_log_warn("Sample frequency %ld Hz is refused, keep %ld Hz", freq_hz, self->rate.freq_hz);
+        return;
+    }
+    self->rate = rate;
+    control_set_sample_rate(self->control, &rate);
+    hal_log_info("Sample frequency set to %ld Hz", freq_hz);
+}
+
+/// Negotiate connection parameters and reply with MCU capabilities.
+/// @return `false` if app is incompatible and connection must not be established.
+static bool negotiate(Rpmsg *self, const IppAppMsgConnect *request) {
+    bool compatible = true;
+
+    if (request->version != IPP_PROTOCOL_VERSION) {
+        hal_log_error("IPP protocol version mismatch: app %d, mcu %d", (int)request->version, (int)IPP_PROTOCOL_VERSION);
+        compatible = false;
+    }
+
+    size_t adc_msg_points = adc_msg_points_by_len((size_t)request->max_msg_len);
+    if (adc_msg_points == 0) {
+        hal_log_error("App max message length (%d) is too small", (int)request->max_msg_len);
+        compatible = false;
+    }
+
+    if (compatible) {
+        set_sample_rate(self, request->sample_freq_hz);
+        self->features = request->features & IPP_FEATURES_SUPPORTED;
+        if (self->calib == NULL) {
+            self->features &= ~IPP_FEATURE_CALIB;
+        }
+        if (self->regulator == NULL) {
+            self->features &= ~IPP_FEATURE_REGULATOR;
+        }
+        if (self->telemetry == NULL) {
+            self->features &= ~IPP_FEATURE_TELEMETRY;
+        }
+        if (self->reference == NULL) {
+            self->features &= ~IPP_FEATURE_DAC_UPSAMPLING;
+        }
+        if (self->fault == NULL) {
+            self->features &= ~(IPP_FEATURE_FAULT | IPP_FEATURE_FAULT_LIMITS);
+        }
+        if (self->postmortem == NULL) {
+            self->features &= ~IPP_FEATURE_POSTMORTEM;
+        }
+        // Message may be shorter than allowed to keep ADC latency independent of sample rate.
+        self->adc_msg_points = hal_min(adc_msg_points, self->rate.adc_batch);
+        self->control_sync.adc_notify_every = self->adc_msg_points;
+    } else {
+        self->features = 0;
+    }
+
+    rpmsg_send_message(self, write_capabilities_message, NULL);
+    return compatible;
 }
 
 static void disconnect(Rpmsg *self) {
@@ -166,13 +550,49 @@ static void disconnect(Rpmsg *self) {
     hal_log_info("IOC disconnected");
 }
 
+static void connect(Rpmsg *self, const IppAppMsgConnect *request) {
+    // App may reconnect before keep-alive timeout, DAC is stopped until the new connection is set up.
+    if (self->alive) {
+        disconnect(self);
+    }
+    // Sample rate and ADC message size must not change while send task services the previous connection.
+    hal_assert(xSemaphoreTake(self->service_mutex, portMAX_DELAY) == pdTRUE);
+    if (!negotiate(self, request)) {
+        xSemaphoreGive(self->service_mutex);
+        return;
+    }
+
+    hal_atomic_size_store(&self->dac_requested, 0);
+    self->adc_seq = 0;
+    self->dac_seq = 0;
+    // Decimation, upsampling and telemetry are set by app for each connection.
+    control_set_adc_decimation(self->control, 1);
+    control_set_dac_upsampling(self->control, 1);
+    if (self->reference != NULL) {
+        reference_set_mode(self->reference, 1, false);
+    }
+    if (self->telemetry != NULL) {
+        telemetry_set_ratio(self->telemetry, 0);
+    }
+    self->telemetry_index = 0;
+    // Upload interrupted by disconnection is restarted.
+    self->postmortem_offset = 0;
+    control_dac_start(self->control);
+    self->alive = true;
+    xSemaphoreGive(self->service_mutex);
+
+    // Current discrete input, DAC request and buffered ADC points are sent at once.
+    control_sync_notify(&self->control_sync, CONTROL_EVENT_ADC_READY | CONTROL_EVENT_DAC_SPACE | CONTROL_EVENT_DIN_CHANGED);
+    hal_log_info("IOC connected (features: %lx, ADC points per message: %d)", self->features, (int)self->adc_msg_points);
+}
+
 static void set_dout(Rpmsg *self, SkifioDout value) {
     SkifioDout mask = (SkifioDout)((1 << SKIFIO_DOUT_SIZE) - 1);
     if ((~mask & value) != 0) {
         hal_log_warn("Dout is out of bounds: %lx", (uint32_t)value);
     }
     self->control->dio.out = value & mask;
-    self->control_sync.dout_changed = true;
+    control_sync_post(&self->control_sync, CONTROL_EVENT_DOUT_CHANGED);
 }
 
 static void write_dac(Rpmsg *self, const point_t *data, size_t len) {
@@ -183,6 +603,227 @@ static void write_dac(Rpmsg *self, const point_t *data, size_t len) {
     self->stats->dac.req_exceed += hal_atomic_size_sub_checked(&self->dac_requested, len);
 }
 
+/// Check DAC message sequence number.
+/// @return `false` if message is duplicated or reordered and must be discarded.
+static bool check_dac_seq(Rpmsg *self, uint32_t seq) {
+    // Wrapping difference, values above half range mean that message is from the past.
+    uint32_t diff = seq - self->dac_seq;
+    if (diff >= 0x80000000) {
+        self->stats->link.dac_msg_dup += 1;
+        return false;
+    }
+    self->stats->link.dac_msg_lost += diff;
+    self->dac_seq = seq + 1;
+    return true;
+}
+
+static void set_adc_decimation(Rpmsg *self, uint32_t ratio) {
+    if ((self->features & IPP_FEATURE_ADC_DECIMATION) == 0) {
+        hal_log_warn("ADC decimation is not negotiated");
+        return;
+    }
+    if (ratio < 1 || ratio > ADC_DECIMATION_MAX) {
+        hal_log_warn("ADC decimation ratio is out of bounds: %ld", ratio);
+        return;
+    }
+    control_set_adc_decimation(self->control, ratio);
+    hal_log_info("ADC decimation ratio set to %ld", ratio);
+}
+
+static void write_calib_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    const CalibTable *table = (const CalibTable *)user_data;
+    basic_message->type = IPP_MCU_MSG_CALIB;
+    IppMcuMsgCalib *message = &basic_message->calib;
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        const CalibEntry *entry = &table->entries[i];
+        message->gain.data[i] = entry->gain;
+        message->offset.data[i] = entry->offset;
+        message->filter.data[i] = entry->filter;
+    }
+}
+
+static bool check_calib(Rpmsg *self) {
+    if ((self->features & IPP_FEATURE_CALIB) == 0) {
+        hal_log_warn("Calibration is not negotiated");
+        return false;
+    }
+    return true;
+}
+
+static void read_calib(Rpmsg *self) {
+    if (!check_calib(self)) {
+        return;
+    }
+    rpmsg_send_message(self, write_calib_message, (void *)calib_table(self->calib));
+}
+
+static void write_calib(Rpmsg *self, const IppAppMsgCalibWrite *request) {
+    if (!check_calib(self)) {
+        return;
+    }
+    CalibTable table;
+    for (size_t i = 0; i < ADC_COUNT; ++i) {
+        CalibEntry *entry = &table.entries[i];
+        entry->gain = request->gain.data[i];
+        entry->offset = request->offset.data[i];
+        entry->filter = request->filter.data[i];
+    }
+    // Previous table is taken by sync generator at its next tick, so the wait is short.
+    bool written = calib_write(self->calib, &table);
+    for (size_t i = 0; !written && i < RPMSG_WRITE_ATTEMPTS; ++i) {
+        vTaskDelay(1);
+        written = calib_write(self->calib, &table);
+    }
+    if (written) {
+        hal_log_info("Calibration table updated");
+    } else {
+        hal_log_error("Previous calibration table is not taken by sync generator");
+    }
+    // Reply with the table in effect, it is the previous one if writing failed.
+    rpmsg_send_message(self, write_calib_message, (void *)calib_table(self->calib));
+}
+
+static void write_regulator_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    const RegulatorGains *gains = (const RegulatorGains *)user_data;
+    basic_message->type = IPP_MCU_MSG_REGULATOR;
+    IppMcuMsgRegulator *message = &basic_message->regulator;
+    message->kp = gains->kp;
+    message->ki = gains->ki;
+    message->kd = gains->kd;
+    message->kp2 = gains->kp2;
+    message->ki2 = gains->ki2;
+    message->kd2 = gains->kd2;
+    message->ff_r = gains->ff_r;
+    message->ff_l = gains->ff_l;
+}
+
+static bool check_regulator(Rpmsg *self) {
+    if ((self->features & IPP_FEATURE_REGULATOR) == 0) {
+        hal_log_warn("Regulator gains are not negotiated");
+        return false;
+    }
+    return true;
+}
+
+static void read_regulator(Rpmsg *self) {
+    if (!check_regulator(self)) {
+        return;
+    }
+    rpmsg_send_message(self, write_regulator_message, (void *)regulator_gains(self->regulator));
+}
+
+static void write_regulator(Rpmsg *self, const IppAppMsgRegulatorWrite *request) {
+    if (!check_regulator(self)) {
+        return;
+    }
+    const RegulatorGains gains = {
+        .kp = request->kp,
+        .ki = request->ki,
+        .kd = request->kd,
+        .kp2 = request->kp2,
+        .ki2 = request->ki2,
+        .kd2 = request->kd2,
+        .ff_r = request->ff_r,
+        .ff_l = request->ff_l,
+    };
+    if (gains.ki < 0) {
+        // Integral limit is derived from KI and must not be negative.
+        hal_log_warn("Regulator KI is negative: %ld", gains.ki);
+        rpmsg_send_message(self, write_regulator_message, (void *)regulator_gains(self->regulator));
+        return;
+    }
+    bool written = regulator_write(self->regulator, &gains);
+    for (size_t i = 0; !written && i < RPMSG_WRITE_ATTEMPTS; ++i) {
+        vTaskDelay(1);
+        written = regulator_write(self->regulator, &gains);
+    }
+    if (written) {
+        hal_log_info("Regulator gains updated: KP=%ld, KI=%ld, KD=%ld", gains.kp, gains.ki, gains.kd);
+    } else {
+        hal_log_error("Previous regulator gains are not taken by sync generator");
+    }
+    // Reply with the gains in effect, they are the previous ones if writing failed.
+    rpmsg_send_message(self, write_regulator_message, (void *)regulator_gains(self->regulator));
+}
+
+static void write_fault_limits_message(Rpmsg *self, void *user_data, IppMcuMsg *basic_message) {
+    const FaultLimits *limits = (const FaultLimits *)user_data;
+    basic_message->type = IPP_MCU_MSG_FAULT_LIMITS;
+    IppMcuMsgFaultLimits *message = &basic_message->fault_limits;
+    for (size_t i = 0; i < FAULT_CHECK_COUNT; ++i) {
+        message->limit.data[i] = limits->thresholds[i].limit;
+        message->persistence.data[i] = limits->thresholds[i].persistence;
+    }
+}
+
+static bool check_fault_limits(Rpmsg *self) {
+    if ((self->features & IPP_FEATURE_FAULT_LIMITS) == 0) {
+        hal_log_warn("Fault limits are not negotiated");
+        return false;
+    }
+    return true;
+}
+
+static void read_fault_limits(Rpmsg *self) {
+    if (!check_fault_limits(self)) {
+        return;
+    }
+    rpmsg_send_message(self, write_fault_limits_message, (void *)fault_limits(self->fault));
+}
+
+static void write_fault_limits(Rpmsg *self, const IppAppMsgFaultLimitsWrite *request) {
+    if (!check_fault_limits(self)) {
+        return;
+    }
+    FaultLimits limits;
+    for (size_t i = 0; i < FAULT_CHECK_COUNT; ++i) {
+        FaultThreshold *threshold = &limits.thresholds[i];
+        threshold->limit = request->limit.data[i];
+        threshold->persistence = request->persistence.data[i];
+        if (threshold->limit < 0) {
+            // Absolute value is checked, so negative limit would trip on any value.
+            hal_log_warn("Fault limit %d is negative: %ld", (int)i, threshold->limit);
+            rpmsg_send_message(self, write_fault_limits_message, (void *)fault_limits(self->fault));
+            return;
+        }
+    }
+    bool written = fault_write_limits(self->fault, &limits);
+    for (size_t i = 0; !written && i < RPMSG_WRITE_ATTEMPTS; ++i) {
+        vTaskDelay(1);
+        written = fault_write_limits(self->fault, &limits);
+    }
+    if (written) {
+        hal_log_info("Fault limits updated");
+    } else {
+        hal_log_error("Previous fault limits are not taken by sync generator");
+    }
+    // Reply with the limits in effect, they are the previous ones if writing failed.
+    rpmsg_send_message(self, write_fault_limits_message, (void *)fault_limits(self->fault));
+}
+
+static void set_telemetry_ratio(Rpmsg *self, uint32_t ratio) {
+    if ((self->features & IPP_FEATURE_TELEMETRY) == 0) {
+        hal_log_warn("Telemetry is not negotiated");
+        return;
+    }
+    telemetry_set_ratio(self->telemetry, ratio);
+    hal_log_info("Telemetry ratio set to %ld", ratio);
+}
+
+static void set_dac_upsampling(Rpmsg *self, uint32_t ratio, bool interpolate) {
+    if ((self->features & IPP_FEATURE_DAC_UPSAMPLING) == 0) {
+        hal_log_warn("DAC upsampling is not negotiated");
+        return;
+    }
+    if (ratio < 1 || ratio > DAC_UPSAMPLING_MAX) {
+        hal_log_warn("DAC upsampling ratio is out of bounds: %ld", ratio);
+        return;
+    }
+    control_set_dac_upsampling(self->control, ratio);
+    reference_set_mode(self->reference, ratio, interpolate);
+    hal_log_info("DAC upsampling ratio set to %ld, interpolation %s", ratio, interpolate ? "on" : "off");
+}
+
 static void check_alive(Rpmsg *self) {
     if (!self->alive) {
         hal_log_warn("RPMSG connection is not alive");
@@ -192,7 +833,7 @@ static void check_alive(Rpmsg *self) {
 static void read_any_message(Rpmsg *self, void *user_data, const IppAppMsg *message) {
     switch (message->type) {
     case IPP_APP_MSG_CONNECT: {
-        connect(self);
+        connect(self, &message->connect);
         break;
     }
     case IPP_APP_MSG_KEEP_ALIVE: {
@@ -207,12 +848,60 @@ static void read_any_message(Rpmsg *self, void *user_data, const IppAppMsg *mess
     case IPP_APP_MSG_DAC_DATA: {
         check_alive(self);
         const IppAppMsgDacData *dac_msg = &message->dac_data;
-        write_dac(self, dac_msg->points.data, (size_t)dac_msg->points.len);
+        if ((self->features & IPP_FEATURE_SEQUENCE_NUMBERS) == 0 || check_dac_seq(self, dac_msg->seq)) {
+            write_dac(self, dac_msg->points.data, (size_t)dac_msg->points.len);
+        }
         break;
     }
     case IPP_APP_MSG_STATS_RESET: {
         check_alive(self);
-        stats_reset(self->stats);
+        stats_request_reset(self->stats);
+        break;
+    }
+    case IPP_APP_MSG_ADC_DECIMATION: {
+        check_alive(self);
+        set_adc_decimation(self, (uint32_t)message->adc_decimation.ratio);
+        break;
+    }
+    case IPP_APP_MSG_CALIB_READ: {
+        check_alive(self);
+        read_calib(self);
+        break;
+    }
+    case IPP_APP_MSG_CALIB_WRITE: {
+        check_alive(self);
+        write_calib(self, &message->calib_write);
+        break;
+    }
+    case IPP_APP_MSG_REGULATOR_READ: {
+        check_alive(self);
+        read_regulator(self);
+        break;
+    }
+    case IPP_APP_MSG_REGULATOR_WRITE: {
+        check_alive(self);
+        write_regulator(self, &message->regulator_write);
+        break;
+    }
+    case IPP_APP_MSG_TELEMETRY: {
+        check_alive(self);
+        set_telemetry_ratio(self, (uint32_t)message->telemetry.ratio);
+        break;
+    }
+    case IPP_APP_MSG_DAC_UPSAMPLING: {
+        check_alive(self);
+        const IppAppMsgDacUpsampling *request = &message->dac_upsampling;
+        set_dac_upsampling(self, (uint32_t)request->ratio, request->interpolate != 0);
+        break;
+    }
+    case IPP_APP_MSG_FAULT_LIMITS_READ: {
+        check_alive(self);
+        read_fault_limits(self);
+        break;
+    }
+    case IPP_APP_MSG_FAULT_LIMITS_WRITE: {
+        check_alive(self);
+        write_fault_limits(self, &message->fault_limits_write);
         break;
     }
     default:
@@ -254,7 +943,9 @@ static void rpmsg_recv_task(void *param) {
 
 void rpmsg_run(Rpmsg *self) {
     hal_assert(
-        xTaskCreate(rpmsg_send_task, "rpmsg_send", TASK_STACK_SIZE, (void *)self, RPMSG_SEND_TASK_PRIORITY, NULL) == pdPASS);
+        xTaskCreate(rpmsg_send_task, "rpmsg_send", TASK_STACK_SIZE, (void *)self, RPMSG_SEND_TASK_PRIORITY, &self->send_task)
+        == pdPASS);
+    control_sync_set_task(&self->control_sync, self->send_task);
 
     hal_assert(
         xTaskCreate(rpmsg_recv_task, "rpmsg_recv", TASK_STACK_SIZE, (void *)self, RPMSG_RECV_TASK_PRIORITY, NULL) == pdPASS);
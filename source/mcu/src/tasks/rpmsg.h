@@ -12,20 +12,84 @@
 #include <ipp.h>
 
 #include <common/config.h>
+#include <utils/probe.h>
+#include <tasks/calib.h>
 #include <tasks/control.h>
+#include <tasks/fault.h>
+#include <tasks/postmortem.h>
+#include <tasks/rate.h>
+#include <tasks/reference.h>
+#include <tasks/regulator.h>
 #include <tasks/stats.h>
+#include <tasks/telemetry.h>
 
+#define RPMSG_MAX_TIMING_GROUPS 4
+/// Number of 1 ms waits for sync generator to take previously written calibration table or regulator gains.
+#define RPMSG_WRITE_ATTEMPTS 10
+
+/// Handler of sample rate change, called from RPMSG receive task.
+/// @return `false` if the rate is refused, nothing is changed then.
+typedef bool (*RpmsgRateHandler)(void *user_data, const SampleRate *rate);
 
 typedef struct {
     hal_rpmsg_channel channel;
     /// Whether IOC is alive.
     bool alive;
 
-    /// Semaphore used to wait for data sending.
-    SemaphoreHandle_t send_sem;
+    /// Protocol features enabled for current connection, see `IPP_FEATURE_*`.
+    uint32_t features;
+    /// Number of points in ADC message negotiated for current connection.
+    size_t adc_msg_points;
+    /// Sample rate requested by app, kept between connections.
+    SampleRate rate;
+    RpmsgRateHandler rate_handler;
+    void *rate_handler_data;
+    /// Calibration table read and written by app, `NULL` if not supported.
+    Calib *calib;
+    /// Regulator gains read and written by app, `NULL` if not supported.
+    Regulator *regulator;
+    /// Regulator telemetry streamed to app, `NULL` if not supported.
+    Telemetry *telemetry;
+    /// Reference interpolation switched together with DAC upsampling, `NULL` if not supported.
+    Reference *reference;
+    /// Fault monitor whose first faults are reported to app and whose limits it sets, `NULL` if not supported.
+    FaultMonitor *fault;
+    /// Post-mortem buffer uploaded to app when frozen, `NULL` if not supported.
+    Postmortem *postmortem;
+
+    /// Send task, notified with `CONTROL_EVENT_*` bits of what is to be sent.
+    TaskHandle_t send_task;
+    /// Held by send task while it services connection and by receive task while it negotiates a new one,
+    /// so that sample rate and message size never change under the send task.
+    SemaphoreHandle_t service_mutex;
+    /// Durations of `TIMING_RPMSG_*` stages.
+    ProbeGroup send_timing;
     /// Number of DAC points requested from IOC.
     hal_atomic_size_t dac_requested;
 
+    /// Sequence number of the next ADC message.
+    uint32_t adc_seq;
+    /// Sample index of the next point read from ADC buffer.
+    uint64_t adc_sample_index;
+
+    /// Expected sequence number of the next DAC message.
+    uint32_t dac_seq;
+
+    /// Index of the next telemetry point sent to app.
+    uint64_t telemetry_index;
+    /// Tick count of the last telemetry message.
+    TickType_t telemetry_sent;
+    /// Index of the next post-mortem point to upload.
+    size_t postmortem_offset;
+
+    /// Probe groups reported to IOC.
+    ProbeGroup *timing[RPMSG_MAX_TIMING_GROUPS];
+    size_t timing_count;
+    /// Tick count of the last timing report.
+    TickType_t timing_reported;
+    /// Tick count of the last statistics report.
+    TickType_t stats_reported;
+
     ControlSync control_sync;
     Control *control;
     Statistics *stats;
@@ -35,5 +99,29 @@ typedef struct {
 void rpmsg_init(Rpmsg *rpmsg, Control *control, Statistics *stats);
 void rpmsg_deinit(Rpmsg *rpmsg);
 
+/// Report timing of probe group to IOC every `TIMING_REPORT_PERIOD_MS`. Control and send task timing is added on init.
+void rpmsg_add_timing(Rpmsg *rpmsg, ProbeGroup *group);
+
+/// Set handler that applies sample rate change to sync generator. Control task buffers are updated by RPMSG itself.
+void rpmsg_set_rate_handler(Rpmsg *rpmsg, RpmsgRateHandler handler, void *user_data);
+
+/// Allow app to read and write calibration table of sync generator.
+void rpmsg_set_calib(Rpmsg *rpmsg, Calib *calib);
+
+/// Allow app to read and write regulator gains of sync generator.
+void rpmsg_set_regulator(Rpmsg *rpmsg, Regulator *regulator);
+
+/// Allow app to stream regulator telemetry of sync generator.
+void rpmsg_set_telemetry(Rpmsg *rpmsg, Telemetry *telemetry);
+
+/// Allow app to set DAC upsampling and reference interpolation of sync generator.
+void rpmsg_set_reference(Rpmsg *rpmsg, Reference *reference);
+
+/// Report the first fault of each episode latched by sync generator and allow app to read and write fault limits.
+void rpmsg_set_fault(Rpmsg *rpmsg, FaultMonitor *fault);
+
+/// Upload post-mortem buffer of sync generator each time it is frozen on fault.
+void rpmsg_set_postmortem(Rpmsg *rpmsg, Postmortem *postmortem);
+
 /// Start rpmsg tasks.
 void rpmsg_run(Rpmsg *rpmsg);
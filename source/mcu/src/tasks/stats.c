@@ -1,5 +1,7 @@
 #include "stats.h"
 
+#include <string.h>
+
 #include <FreeRTOS.h>
 #include <task.h>
 
@@ -33,15 +35,22 @@ void value_stats_print(ValueStats *self, const char *prefix) {
     }
 }
 
-void stats_reset(Statistics *self) {
-    self->clock_count = 0;
+void stats_init(Statistics *self) {
+    self->seq = 0;
+    self->reset_requested = false;
+    self->clock_reset_requested = false;
+    self->din = 0;
+    stats_reset(self);
+}
+
+/// Reset counters updated by control task.
+static void stats_reset_control(Statistics *self) {
     self->sample_count = 0;
     self->max_intrs_per_sample = 0;
 
     self->crc_error_count = 0;
 
     self->dac.lost_empty = 0;
-    self->dac.lost_full = 0;
 
     self->adc.lost_full = 0;
     for (size_t i = 0; i < ADC_COUNT; ++i) {
@@ -49,6 +58,21 @@ void stats_reset(Statistics *self) {
     }
 }
 
+/// Reset counters updated by RPMSG receive task when DAC messages are written.
+static void stats_reset_rpmsg(Statistics *self) {
+    self->dac.lost_full = 0;
+    self->dac.req_exceed = 0;
+
+    self->link.dac_msg_lost = 0;
+    self->link.dac_msg_dup = 0;
+}
+
+void stats_reset(Statistics *self) {
+    self->clock_count = 0;
+    stats_reset_control(self);
+    stats_reset_rpmsg(self);
+}
+
 void stats_print(Statistics *self) {
     hal_log_info("");
 
@@ -78,14 +102,72 @@ void stats_print(Statistics *self) {
         hal_log_info("    channel %d:", i);
         value_stats_print(&self->adc.values[i], "        ");
     }
+
+    hal_log_info("link:");
+    // Number of DAC messages lost in transport.
+    hal_log_info("    dac_msg_lost: %ld", self->link.dac_msg_lost);
+    // Number of duplicated or reordered DAC messages.
+    hal_log_info("    dac_msg_dup: %ld", self->link.dac_msg_dup);
     hal_log_info("Din value: %02x",self->din);
 }
 
+void stats_write_begin(Statistics *self) {
+    uint32_t seq = __atomic_load_n(&self->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (self->reset_requested) {
+        stats_reset_control(self);
+        self->reset_requested = false;
+    }
+}
+
+void stats_write_end(Statistics *self) {
+    uint32_t seq = __atomic_load_n(&self->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+void stats_clock_tick(Statistics *self) {
+    if (self->clock_reset_requested) {
+        self->clock_count = 0;
+        self->clock_reset_requested = false;
+    }
+    self->clock_count += 1;
+}
+
+void stats_request_reset(Statistics *self) {
+    // Counters of receive task are reset here, as it is the only one that increments them.
+    stats_reset_rpmsg(self);
+    self->reset_requested = true;
+    self->clock_reset_requested = true;
+}
+
+void stats_snapshot(Statistics *self, Statistics *out) {
+    uint32_t begin = 0, end = 0;
+    do {
+        begin = __atomic_load_n(&self->seq, __ATOMIC_ACQUIRE);
+        memcpy((void *)out, (const void *)self, sizeof(Statistics));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&self->seq, __ATOMIC_RELAXED);
+    } while (begin % 2 != 0 || begin != end);
+
+    // Clock count is 64-bit and updated by sync generator task outside of seqlock,
+    // so it is read until two consecutive values match.
+    uint64_t clock_count = 0;
+    do {
+        clock_count = self->clock_count;
+    } while (clock_count != self->clock_count);
+    out->clock_count = clock_count;
+}
+
 static void stats_task(void *param) {
     Statistics *stats = (Statistics *)param;
+    // Snapshot is too large for the task stack.
+    static Statistics snapshot;
 
     for (;;) {
-        stats_print(stats);
+        stats_snapshot(stats, &snapshot);
+        stats_print(&snapshot);
         vTaskDelay(STATS_REPORT_PERIOD_MS);
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
 
@@ -28,7 +29,28 @@ typedef struct {
     uint32_t lost_full;
 } AdcStats;
 
+typedef struct {
+    /// Number of DAC messages lost between app and MCU (detected by sequence number gaps).
+    uint32_t dac_msg_lost;
+    /// Number of duplicated or reordered DAC messages.
+    uint32_t dac_msg_dup;
+} LinkStats;
+
+// Most of statistics is updated by control task at sample rate. These updates are wrapped into
+// `stats_write_begin`/`stats_write_end` seqlock, so other tasks can take a consistent snapshot
+// without blocking the control task. Counters updated by other tasks are 32-bit, except `clock_count`.
+// Each counter is reset by the task that updates it, so a reset never interleaves with a non-atomic increment:
+// DAC write (`dac.lost_full`, `dac.req_exceed`) and link counters belong to RPMSG receive task, `clock_count` to
+// sync generator, the rest to control task.
+
 typedef volatile struct {
+    /// Seqlock sequence number, odd while control task is updating statistics.
+    uint32_t seq;
+    /// Reset of control task counters requested by RPMSG receive task, it is done by control task on the next update.
+    bool reset_requested;
+    /// Reset of `clock_count` requested by RPMSG receive task, it is done by sync generator on the next tick.
+    bool clock_reset_requested;
+
     uint64_t clock_count;
     uint64_t sample_count;
     uint32_t max_intrs_per_sample;
@@ -36,6 +58,7 @@ typedef volatile struct {
     uint32_t crc_error_count;
     DacStats dac;
     AdcStats adc;
+    LinkStats link;
     uint8_t  din;
 } Statistics;
 
@@ -43,7 +66,22 @@ void value_stats_reset(ValueStats *self);
 void value_stats_update(ValueStats *self, point_t value);
 void value_stats_print(ValueStats *self, const char *prefix);
 
+void stats_init(Statistics *self);
 void stats_reset(Statistics *self);
 void stats_print(Statistics *self);
 
+/// Begin update of statistics. Must be called by control task only.
+void stats_write_begin(Statistics *self);
+void stats_write_end(Statistics *self);
+
+/// Count sync signal. Must be called by sync generator only.
+void stats_clock_tick(Statistics *self);
+
+/// Reset statistics from RPMSG receive task. Its own counters are reset at once, the rest by control task and
+/// sync generator on their next update.
+void stats_request_reset(Statistics *self);
+
+/// Copy consistent snapshot of statistics into `out`. Must not be called by control task.
+void stats_snapshot(Statistics *self, Statistics *out);
+
 void stats_report_run(Statistics *self);
@@ -22,7 +22,7 @@
 
 #define GPT_CHANNEL 1
 
-#define SET_FAULT(X) { self->MPS->Fault_Clear_Count=1000 * self->MPS->ms_tick; self->MPS->Faults.X = 1; }
+#define SET_FAULT(X, CODE) { self->MPS->Fault_Clear_Count=1000 * self->MPS->ms_tick; self->MPS->Faults.X = 1; fault_trip(&self->fault, CODE); }
 
 #define LED_FAULT_MUX IOMUXC_SAI2_TXC_GPIO4_IO25
 #define LED_FAULT_PIN 4, 25
@@ -46,8 +46,21 @@ static void update_pins(SyncGenerator *self, LEDMask mask) {
     
 }
 
-void sync_generator_init(SyncGenerator *self, uint32_t period_us, Statistics *stats, PS_Control *MPS) {
+static void apply_period(SyncGenerator *self, uint32_t period_us) {
     self->period_us = period_us;
+    self->ticks_per_second = 2 * 1000000 / period_us;
+    self->MPS->ms_tick = 1000 / period_us;
+}
+
+void sync_generator_init(
+    SyncGenerator *self,
+    uint32_t period_us,
+    Statistics *stats,
+    PS_Control *MPS,
+    const CalibTable *calib,
+    const RegulatorGains *gains,
+    const FaultLimits *fault_limits //
+) {
 
     IOMUXC_SetPinMux(SYNC_10K_MUX, 0u);
     IOMUXC_SetPinMux(SYNC_1_MUX, 0u);
@@ -65,13 +78,26 @@ void sync_generator_init(SyncGenerator *self, uint32_t period_us, Statistics *st
     hal_gpio_pin_init(&self->pins[5], &self->group, LED_FAULT_PIN, HAL_GPIO_OUTPUT, HAL_GPIO_INTR_DISABLED);
  
  
+    self->task = NULL;
+#ifdef CONTROL_SYNC_SEMAPHORE
     self->sem = xSemaphoreCreateBinary();
     hal_assert(self->sem != NULL);
+#endif
+    self->notify_cycles = 0;
 
     self->stats = stats;
     self->MPS = MPS;
+    calib_init(&self->calib, calib);
+    regulator_init(&self->regulator, gains);
+    reference_init(&self->reference);
+    fault_init(&self->fault, fault_limits);
+    telemetry_init(&self->telemetry);
+    postmortem_init(&self->postmortem);
+    apply_period(self, period_us);
+    self->requested_period_us = period_us;
 
     self->counter = 0;
+    probe_group_init(&self->timing, TIMING_SYNC_WAIT, TIMING_SYNC_TICK - TIMING_SYNC_WAIT + 1);
     LEDMask mask={0};
     update_pins(self,mask);
 }
@@ -84,7 +110,12 @@ static void handle_gpt(void *data) {
     self->counter += 1;
  
     // Notify target task
+    self->notify_cycles = cycles_now();
+#ifdef CONTROL_SYNC_SEMAPHORE
     xSemaphoreGiveFromISR(self->sem, &hptw);
+#else
+    vTaskNotifyGiveFromISR(self->task, &hptw);
+#endif
 
     // Yield to higher priority task
     portYIELD_FROM_ISR(hptw);
@@ -92,6 +123,8 @@ static void handle_gpt(void *data) {
 
 void sync_generator_task(void *param) {
     SyncGenerator *self = (SyncGenerator *)param;
+    // Must be set before the timer is started.
+    self->task = xTaskGetCurrentTaskHandle();
 
     HalGpt gpt;
     hal_assert(hal_gpt_init(&gpt, 1) == HAL_SUCCESS);
@@ -99,60 +132,106 @@ void sync_generator_task(void *param) {
 
     hal_assert(hal_gpt_start(&gpt, GPT_CHANNEL, self->period_us / 2, handle_gpt, (void *)self) == HAL_SUCCESS);
     for (size_t i = 0;; ++i) {
+        uint32_t wait_start = cycles_now();
+#ifdef CONTROL_SYNC_SEMAPHORE
         if (xSemaphoreTake(self->sem, 10000) != pdTRUE) {
-            hal_log_info("GPT semaphore timeout %x", i);
+#else
+        if (ulTaskNotifyTake(pdTRUE, 10000) == 0) {
+#endif
+            hal_log_info("GPT notification timeout %x", i);
             self->MPS->Ready=0;
-            SET_FAULT(Board);
+            SET_FAULT(Board, FAULT_BOARD);
             continue;
         }
-        int64_t Iout_val = SCALE(Iout,Ain[0]);
-        FILTER(mIout,Iout_val,t250ms);
-        self->MPS->Iout = Iout_val;
-        int64_t Vout_val = SCALE(Vout,Ain[1]);
-        FILTER(mVout,Vout_val,t250ms);
-        self->MPS->Vout = Vout_val;
-        int64_t Vreg_val = SCALE(Vreg,Ain[2]);
-        self->MPS->Vreg = Vreg_val;
-        int64_t tHS1_val = SCALE(tHS1,Ain[3]);
-        FILTER(mtHS1,tHS1_val,t250ms);
-        int64_t tHS2_val = SCALE(tHS2,Ain[4]);
-        FILTER(mtHS2,tHS2_val,t250ms);
-        int64_t tHS3_val = SCALE(tHS3,Ain[5]);
-        FILTER(mtHS3,tHS3_val,t250ms);
-        self->MPS->tHeatsink = (self->MPS->mtHS1.val>self->MPS->mtHS2.val)? self->MPS->mtHS1.val:self->MPS->mtHS2.val;
-        self->MPS->tHeatsink = (self->MPS->mtHS3.val>self->MPS->tHeatsink)? self->MPS->mtHS3.val:self->MPS->tHeatsink;
+        uint32_t tick_start = probe_lap(probe_group_get(&self->timing, TIMING_SYNC_WAIT), wait_start);
+        probe_record(probe_group_get(&self->timing, TIMING_SYNC_WAKEUP), tick_start - self->notify_cycles);
+        // New calibration, gains and fault limits are taken only here, so the whole tick uses the same set.
+        calib_commit(&self->calib);
+        regulator_commit(&self->regulator);
+        fault_commit(&self->fault);
+        reference_commit(&self->reference);
+        calib_process(&self->calib, self->MPS->Ain);
+        const Calib *calib = &self->calib;
+        self->MPS->Iout = calib->values[CALIB_IOUT];
+        self->MPS->mIout = calib->filtered[CALIB_IOUT];
+        self->MPS->Vout = calib->values[CALIB_VOUT];
+        self->MPS->mVout = calib->filtered[CALIB_VOUT];
+        self->MPS->Vreg = calib->values[CALIB_VREG];
+        self->MPS->mtHS1 = calib->filtered[CALIB_THS1];
+        self->MPS->mtHS2 = calib->filtered[CALIB_THS2];
+        self->MPS->mtHS3 = calib->filtered[CALIB_THS3];
+        self->MPS->tHeatsink = (self->MPS->mtHS1>self->MPS->mtHS2)? self->MPS->mtHS1:self->MPS->mtHS2;
+        self->MPS->tHeatsink = (self->MPS->mtHS3>self->MPS->tHeatsink)? self->MPS->mtHS3:self->MPS->tHeatsink;
         //Calculate Feedcack Signal
-        int32_t FB_Calc = 0, delta = 0;
+        int64_t FB_Calc = 0;
+        int32_t delta = 0;
+        int32_t VRef = reference_update(&self->reference, REFERENCE_VOLTAGE, self->MPS->VRef_Set);
+        // Previous reference and measurement are tracked in any mode, so switching to current mode does not kick.
+        int32_t feed_forward = regulator_feed_forward(&self->regulator, self->MPS->Ref);
+        int32_t derivative = regulator_derivative(&self->regulator, self->MPS->Iout);
         if(self->MPS->Flag.fCCMode){
             delta = (self->MPS->Ref - self->MPS->Iout);
-            self->MPS->Feedback.Sum +=delta;
-            int64_t smax = 0;
-            if(self->MPS->Feedback.KI) smax = (160000LL*150000LL)/self->MPS->Feedback.KI;
-            if(self->MPS->Feedback.Sum > smax) self->MPS->Feedback.Sum = smax;
-            if(self->MPS->Feedback.Sum < -smax) self->MPS->Feedback.Sum = -smax;
-            FB_Calc = ((int64_t)delta*(int64_t)self->MPS->Feedback.KP)/100LL + \
-            (self->MPS->Feedback.Sum*(int64_t)self->MPS->Feedback.KI)/80000LL;
+            self->MPS->FeedForward = feed_forward;
+            self->MPS->Feedback.dVal = derivative;
+            FB_Calc = (int64_t)regulator_pi(&self->regulator, delta, &self->MPS->Feedback.Sum) +
+                self->MPS->FeedForward + self->MPS->Feedback.dVal;
             if(self->MPS->Ref==0) {self->MPS->Feedback.Sum=0;FB_Calc=0;}
         }
         else{
-            FB_Calc = self->MPS->VRef_Set;
+            FB_Calc = VRef;
         }
         if(FB_Calc>240000L) FB_Calc=240000L;
         if(FB_Calc<0L) FB_Calc=0L; 
-        if((self->MPS->Flag.PS_ON)&&((self->MPS->Ready+self->MPS->Operate)==2)) self->MPS->Feedback.FB_Val = FB_Calc;
+        if((self->MPS->Flag.PS_ON)&&((self->MPS->Ready+self->MPS->Operate)==2)) self->MPS->Feedback.FB_Val = (int32_t)FB_Calc;
         else {            
             self->MPS->Ref = 0;
             self->MPS->Feedback.Sum= 0;
             self->MPS->Feedback.Sum_Add = 0;
             self->MPS->Feedback.FB_Val = 0;
         }
+        {
+            TelemetryPoint point;
+            point.values[TELEMETRY_REF] = self->MPS->Ref;
+            point.values[TELEMETRY_IOUT] = self->MPS->Iout;
+            point.values[TELEMETRY_VOUT] = self->MPS->Vout;
+            point.values[TELEMETRY_FB] = self->MPS->Feedback.FB_Val;
+            point.values[TELEMETRY_SUM] = telemetry_saturate(self->MPS->Feedback.Sum);
+            telemetry_push(&self->telemetry, &point);
+        }
+        {
+            // Thresholds are checked on values of this tick, so trip latency does not depend on any polling.
+            bool regulating = self->MPS->Flag.fCCMode && self->MPS->Feedback.FB_Val != 0;
+            int32_t values[FAULT_CHECK_COUNT] = {
+                [FAULT_CHECK_IOUT] = self->MPS->Iout,
+                [FAULT_CHECK_VOUT] = self->MPS->Vout,
+                [FAULT_CHECK_HEATSINK] = self->MPS->tHeatsink,
+                [FAULT_CHECK_FB_ERROR] = regulating ? self->MPS->Ref - self->MPS->Iout : 0,
+            };
+            uint32_t tripped = fault_check(&self->fault, values);
+            if (tripped & (1u << FAULT_CHECK_IOUT)) SET_FAULT(Overcurrent, FAULT_OVERCURRENT);
+            if (tripped & (1u << FAULT_CHECK_VOUT)) SET_FAULT(Overvoltage, FAULT_OVERVOLTAGE);
+            if (tripped & (1u << FAULT_CHECK_HEATSINK)) SET_FAULT(Overheat, FAULT_OVERHEAT);
+            if (tripped & (1u << FAULT_CHECK_FB_ERROR)) SET_FAULT(FBLost, FAULT_FB_LOST);
+        }
+        uint32_t stage_start = probe_lap(probe_group_get(&self->timing, TIMING_SYNC_REGULATOR), tick_start);
         //moved to MPS_Check_Faults(SkifioDin ReadDin)
         SkifioDin ReadDin = skifio_din_read();
-        if((ReadDin&0x08)!=0) SET_FAULT(DCCT);      //DCCT Fault
-        //if((ReadDin&0x10)!=0) SET_FAULT(GndMon);    // IGND Fault
-        //if((ReadDin&0x20)!=0) SET_FAULT(Line);      // LINE Fault
-        if((ReadDin&0x40)!=0) SET_FAULT(ExtLock1);  // EXT_Lock 1
-        if((ReadDin&0x80)!=0) SET_FAULT(ExtLock2);  // EXT_Lock 2
+        if((ReadDin&0x08)!=0) SET_FAULT(DCCT, FAULT_DCCT);      //DCCT Fault
+        //if((ReadDin&0x10)!=0) SET_FAULT(GndMon, FAULT_GND_MON);    // IGND Fault
+        //if((ReadDin&0x20)!=0) SET_FAULT(Line, FAULT_LINE);      // LINE Fault
+        if((ReadDin&0x40)!=0) SET_FAULT(ExtLock1, FAULT_EXT_LOCK1);  // EXT_Lock 1
+        if((ReadDin&0x80)!=0) SET_FAULT(ExtLock2, FAULT_EXT_LOCK2);  // EXT_Lock 2
+        {
+            // Stored after all fault checks, so the tick a fault latched at is the last one in frozen buffer.
+            PostmortemPoint point;
+            for (size_t i = 0; i < ADC_COUNT; ++i) {
+                point.values[POSTMORTEM_AIN0 + i] = self->MPS->Ain[i];
+            }
+            point.values[POSTMORTEM_REF] = self->MPS->Ref;
+            point.values[POSTMORTEM_FB] = self->MPS->Feedback.FB_Val;
+            point.values[POSTMORTEM_DIN] = (int32_t)ReadDin;
+            postmortem_push(&self->postmortem, &point, self->fault.count);
+        }
 
         if(self->MPS->Fault_Clear_Count) { 
             self->MPS->Fault_Clear_Count--; self->MPS->Ready=0; self->MPS->Ready=0;
@@ -160,31 +239,45 @@ void sync_generator_task(void *param) {
             self->MPS->Feedback.Sum= 0;
             self->MPS->Feedback.Sum_Add = 0;
             self->MPS->Feedback.FB_Val = 0;
+            reference_reset(&self->reference, REFERENCE_CURRENT, 0);
         }
         else {
             self->MPS->Ready=1;
-            self->MPS->Ref = self->MPS->Ref_Set;
+            self->MPS->Ref = reference_update(&self->reference, REFERENCE_CURRENT, self->MPS->Ref_Set);
             memset(&self->MPS->Faults,0,sizeof(self->MPS->Faults));
+            fault_release(&self->fault);
         }
         LEDMask mask = {0};
-        if(++self->timer_1Hz > 20000)   { self->timer_1Hz=0; processing_1Hz(self);} 
-        if(++self->timer_5Hz > 4000)    { self->timer_5Hz=0; processing_5Hz(self);}
-        size_t Pulse_2Hz = (self->timer_1Hz > 10000)? 1: 0;
+        if(++self->timer_1Hz > self->ticks_per_second)   { self->timer_1Hz=0; processing_1Hz(self);} 
+        if(++self->timer_5Hz > self->ticks_per_second/5)    { self->timer_5Hz=0; processing_5Hz(self);}
+        size_t Pulse_2Hz = (self->timer_1Hz > self->ticks_per_second/2)? 1: 0;
         mask.LED_Flt = self->MPS->Ready*self->counter%2;
         mask.LED_10kHz =  skifio_readFlag(EXTSYNC)|Pulse_2Hz;
         mask.LED_1Hz =  skifio_readFlag(EXTSTART);
         update_pins(self,mask);
         skifio_dout_write(8*((self->counter/5)%2)+7*(self->MPS->Ready*self->MPS->Flag.PS_ON));
+        probe_lap(probe_group_get(&self->timing, TIMING_SYNC_DIO), stage_start);
 
         if (self->counter % 2 == 0) {
-            self->stats->clock_count += 1;
+            stats_clock_tick(self->stats);
             //hal_gpio_pin_write(&self->pins[6],skifio_force_data_ready()!=0);
         }
         else { 
             skifio_sync_tick();
             //hal_gpio_pin_write(&self->pins[6],false);
         }
-        
+
+        probe_lap(probe_group_get(&self->timing, TIMING_SYNC_TICK), tick_start);
+        probe_group_commit(&self->timing);
+
+        // Change period only after the whole sample, so that the sync signal stays consistent.
+        uint32_t requested_period_us = self->requested_period_us;
+        if (requested_period_us != self->period_us && self->counter % 2 != 0) {
+            hal_assert(hal_gpt_stop(&gpt) == HAL_SUCCESS);
+            apply_period(self, requested_period_us);
+            hal_assert(hal_gpt_start(&gpt, GPT_CHANNEL, self->period_us / 2, handle_gpt, (void *)self) == HAL_SUCCESS);
+            hal_log_info("Sync period set to %ld us", self->period_us);
+        }
     }
     hal_panic();
 
@@ -196,6 +289,10 @@ void sync_generator_run(SyncGenerator *self) {
     hal_assert(xTaskCreate(sync_generator_task, "sync", TASK_STACK_SIZE, (void *)self, SYNC_TASK_PRIORITY, NULL) == pdPASS);
 }
 
+void sync_generator_set_period(SyncGenerator *self, uint32_t period_us) {
+    self->requested_period_us = period_us;
+}
+
 void processing_1Hz(SyncGenerator *self) {
     self->MPS->Flag.f1Hz=1;
 }
@@ -8,15 +8,33 @@
 
 #include <hal/gpio.h>
 #include <drivers/skifio.h>
+#include <utils/probe.h>
 
+#include <tasks/calib.h>
+#include <tasks/fault.h>
+#include <tasks/postmortem.h>
+#include <tasks/reference.h>
+#include <tasks/regulator.h>
 #include <tasks/stats.h>
+#include <tasks/telemetry.h>
 #include <device/MPS.h>
 
 typedef struct {
     uint32_t period_us;
+    /// Period to switch to at the next tick, set from other task.
+    volatile uint32_t requested_period_us;
+    /// Number of timer ticks per second, timer ticks twice per period.
+    uint32_t ticks_per_second;
     HalGpioGroup group;
     HalGpioPin pins[8];
+    /// Sync generator task notified by timer interrupt.
+    TaskHandle_t task;
+#ifdef CONTROL_SYNC_SEMAPHORE
+    /// Former wake-up path kept to compare latency, see `ControlSync`.
     SemaphoreHandle_t sem;
+#endif
+    /// Cycle counter at the last timer interrupt.
+    volatile uint32_t notify_cycles;
     volatile uint32_t counter;
     volatile uint32_t timer_1Hz;
     volatile uint32_t timer_5Hz;    
@@ -24,6 +42,21 @@ typedef struct {
     Statistics *stats;
     PS_Control *MPS;
 
+    /// Calibration of measurement channels, updated by RPMSG task.
+    Calib calib;
+    /// Gains of current regulator, updated by RPMSG task.
+    Regulator regulator;
+    /// Interpolation of reference between DAC points, mode is set by RPMSG task.
+    Reference reference;
+    /// Threshold faults and the first fault latch, reported by RPMSG task, limits are updated by it.
+    FaultMonitor fault;
+    /// Regulator values streamed to app.
+    Telemetry telemetry;
+    /// The last ticks before fault, uploaded by RPMSG task.
+    Postmortem postmortem;
+
+    /// Durations of `TIMING_SYNC_*` stages.
+    ProbeGroup timing;
 } SyncGenerator;
 typedef struct {
     unsigned LED_1Hz:1;
@@ -32,10 +65,21 @@ typedef struct {
     unsigned LED_Mode:1;
 } LEDMask;
 
-void sync_generator_init(SyncGenerator *self, uint32_t period_us, Statistics *stats, PS_Control *MPS);
+void sync_generator_init(
+    SyncGenerator *self,
+    uint32_t period_us,
+    Statistics *stats,
+    PS_Control *MPS,
+    const CalibTable *calib,
+    const RegulatorGains *gains,
+    const FaultLimits *fault_limits //
+);
 
 void sync_generator_run(SyncGenerator *self);
 
+/// Request period change. Timer is restarted with new period at the tick boundary by sync generator task.
+void sync_generator_set_period(SyncGenerator *self, uint32_t period_us);
+
 void processing_1Hz(SyncGenerator *self);
 
 void processing_4Hz(SyncGenerator *self);
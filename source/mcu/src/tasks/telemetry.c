@@ -0,0 +1,49 @@
+#include "telemetry.h"
+
+#include <hal/assert.h>
+
+#define RB_STRUCT TelemetryRingBuffer
+#define RB_PREFIX telemetry_rb
+#define RB_ITEM TelemetryPoint
+#define RB_CAPACITY TELEMETRY_BUFFER_SIZE
+#include <utils/ringbuf.inl>
+#undef RB_STRUCT
+#undef RB_PREFIX
+#undef RB_ITEM
+#undef RB_CAPACITY
+
+void telemetry_init(Telemetry *self) {
+    hal_assert_retcode(telemetry_rb_init(&self->buffer));
+    self->ratio = 0;
+    self->requested_ratio = 0;
+    self->count = 0;
+    overrun_log_init(&self->overrun);
+}
+
+void telemetry_set_ratio(Telemetry *self, uint32_t ratio) {
+    hal_assert(ratio <= TELEMETRY_RATIO_MAX);
+    self->requested_ratio = ratio;
+}
+
+void telemetry_push(Telemetry *self, const TelemetryPoint *point) {
+    uint32_t requested_ratio = self->requested_ratio;
+    if (requested_ratio != self->ratio) {
+        // The first point after switch is stored at once.
+        self->ratio = requested_ratio;
+        self->count = requested_ratio;
+    }
+    if (self->ratio == 0) {
+        return;
+    }
+    self->count += 1;
+    if (self->count < self->ratio) {
+        return;
+    }
+    self->count = 0;
+    if (telemetry_rb_vacant(&self->buffer) >= 1 &&
+        overrun_log_write(&self->overrun, telemetry_rb_write_position(&self->buffer))) {
+        hal_assert(telemetry_rb_write(&self->buffer, point, 1) == 1);
+    } else {
+        overrun_log_drop(&self->overrun);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <common/config.h>
+#include <utils/overrun.h>
+
+// Regulator telemetry stream.
+//
+// Sync generator pushes a point with regulator values each tick, every `ratio`-th of them is stored in the ring buffer
+// and sent to app by RPMSG task. Zero ratio stops the stream, so nothing is stored between tuning sessions.
+
+typedef struct {
+    int32_t values[TELEMETRY_COUNT];
+} TelemetryPoint;
+
+// Size of ring buffer, must be a power of two.
+#define TELEMETRY_BUFFER_SIZE 512
+
+#define RB_STRUCT TelemetryRingBuffer
+#define RB_PREFIX telemetry_rb
+#define RB_ITEM TelemetryPoint
+#define RB_CAPACITY TELEMETRY_BUFFER_SIZE
+#include <utils/ringbuf.h>
+#undef RB_STRUCT
+#undef RB_PREFIX
+#undef RB_ITEM
+#undef RB_CAPACITY
+
+typedef struct {
+    TelemetryRingBuffer buffer;
+    uint32_t ratio;
+    /// Ratio to switch to at the next tick, set by other task.
+    volatile uint32_t requested_ratio;
+    /// Number of ticks since the last stored point.
+    uint32_t count;
+    /// Points lost because the buffer was full, accounted by reader at their place in the stream.
+    OverrunLog overrun;
+} Telemetry;
+
+void telemetry_init(Telemetry *self);
+
+/// Set decimation ratio in range from 0 (stream stopped) to `TELEMETRY_RATIO_MAX`, called by RPMSG task.
+void telemetry_set_ratio(Telemetry *self, uint32_t ratio);
+
+/// Called by sync generator each tick.
+void telemetry_push(Telemetry *self, const TelemetryPoint *point);
+
+static inline int32_t telemetry_saturate(int64_t value) {
+    if (value > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (value < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)value;
+}
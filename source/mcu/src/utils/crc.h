@@ -3,4 +3,17 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+/// Number of bytes handled per round of table lookups by `calculate_crc16`: 1, 4 or 8.
+/// Each step above 1 costs 256 * 2 bytes of tables per extra byte.
+#ifndef CRC16_SLICE
+#define CRC16_SLICE 4
+#endif
+
+#if CRC16_SLICE != 1 && CRC16_SLICE != 4 && CRC16_SLICE != 8
+#error "CRC16_SLICE must be 1, 4 or 8"
+#endif
+
 uint16_t calculate_crc16(const uint8_t *data, size_t len);
+
+/// Reference implementation processing one byte at a time.
+uint16_t calculate_crc16_bytewise(const uint8_t *data, size_t len);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <fsl_common.h>
+
+// CPU cycle counter of Cortex-M7 DWT unit.
+// Host builds shadow this header with a stub backed by monotonic clock.
+
+#define CYCLES_PER_US (SystemCoreClock / 1000000u)
+
+/// Enable and reset cycle counter. Must be called once before any measurement.
+static inline void cycles_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    // Unlock DWT registers, they are write-protected on Cortex-M7.
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/// Current value of free-running cycle counter. Differences are correct across wrap-around.
+static inline uint32_t cycles_now(void) {
+    return DWT->CYCCNT;
+}
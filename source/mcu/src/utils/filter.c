@@ -0,0 +1,10 @@
+#include "filter.h"
+
+#include <hal/assert.h>
+
+void filter_coef_init(FilterCoef *self, uint32_t ticks) {
+    hal_assert(ticks <= FILTER_TIME_CONSTANT_MAX);
+    // Initialization is not time critical, so plain division is used here.
+    uint32_t divisor = ticks + 1;
+    self->coef = (int32_t)((((uint32_t)1 << FILTER_COEF_BITS) + divisor / 2) / divisor);
+}
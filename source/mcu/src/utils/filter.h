@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+// First-order low-pass (exponential moving average) filter in fixed point.
+//
+// Each update moves the state towards the input by `1 / (T + 1)` of the difference, so `T` ticks of history are
+// weighted against the new value, which is the same response as of the former `FILTER` macro. The coefficient is
+// a reciprocal precomputed once per time constant, so the update takes a multiplication and shifts instead of 64-bit
+// division and remainder. For `T + 1` being a power of two the coefficient is exact. State keeps `FILTER_FRAC_BITS`
+// fractional bits, so output settles exactly to constant input for time constants up to 8191 ticks and within 2 units
+// up to `FILTER_TIME_CONSTANT_MAX`.
+
+/// Fractional bits of filter state.
+#define FILTER_FRAC_BITS 14
+/// Fractional bits of coefficient.
+#define FILTER_COEF_BITS 16
+
+/// Maximum time constant in ticks, the coefficient is still non-zero for it.
+#define FILTER_TIME_CONSTANT_MAX 65535
+
+typedef struct {
+    /// `2^FILTER_COEF_BITS / (T + 1)` rounded to nearest.
+    int32_t coef;
+} FilterCoef;
+
+typedef struct {
+    /// Output value with `FILTER_FRAC_BITS` fractional bits.
+    int64_t acc;
+} Filter;
+
+/// Precompute coefficient of time constant `ticks`, zero passes input through unchanged.
+void filter_coef_init(FilterCoef *self, uint32_t ticks);
+
+/// Set filter output to `value` at once.
+static inline void filter_reset(Filter *self, int32_t value) {
+    self->acc = (int64_t)value << FILTER_FRAC_BITS;
+}
+
+/// Output rounded to nearest.
+static inline int32_t filter_value(const Filter *self) {
+    return (int32_t)((self->acc + ((int64_t)1 << (FILTER_FRAC_BITS - 1))) >> FILTER_FRAC_BITS);
+}
+
+/// Take the next input and return new output. Product never overflows: difference is below `2^46`
+/// and coefficient is at most `2^16`.
+static inline int32_t filter_update(Filter *self, const FilterCoef *coef, int32_t value) {
+    int64_t error = ((int64_t)value << FILTER_FRAC_BITS) - self->acc;
+    self->acc += (error * coef->coef + ((int64_t)1 << (FILTER_COEF_BITS - 1))) >> FILTER_COEF_BITS;
+    return filter_value(self);
+}
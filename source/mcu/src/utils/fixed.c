@@ -0,0 +1,31 @@
+#include "fixed.h"
+
+#include <hal/assert.h>
+
+void fixed_div_init(FixedDiv *self, uint64_t divisor) {
+    hal_assert(divisor >= 1 && divisor <= (uint64_t)INT64_MAX);
+
+    // Smallest `l` such that `2^l >= divisor`.
+    uint8_t l = 0;
+    while (((uint64_t)1 << l) < divisor) {
+        l += 1;
+    }
+
+    // Reciprocal is `2^64 * (2^l - divisor) / divisor + 1` plus implicit `2^64`.
+    // Quotient is computed by long division, remainder is always less than divisor so it never overflows.
+    uint64_t rem = ((uint64_t)1 << l) - divisor;
+    uint64_t quot = 0;
+    for (size_t i = 0; i < 64; ++i) {
+        rem <<= 1;
+        quot <<= 1;
+        if (rem >= divisor) {
+            rem -= divisor;
+            quot |= 1;
+        }
+    }
+
+    self->divisor = divisor;
+    self->magic = quot + 1;
+    self->shift1 = l < 1 ? l : 1;
+    self->shift2 = l > 1 ? l - 1 : 0;
+}
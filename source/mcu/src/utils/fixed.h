@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Division of 64-bit integers by invariant divisor using precomputed reciprocal.
+//
+// Cortex-M7 has no 64-bit hardware division, so `/` and `%` on `int64_t` are library calls taking a hundred cycles
+// or more. Division by the same divisor is replaced by multiplication by 65-bit reciprocal and shift
+// (Granlund and Montgomery, "Division by invariant integers using multiplication"). Result is exactly the same as of
+// C operators for any dividend, so it can be used as drop-in replacement.
+
+typedef struct {
+    uint64_t divisor;
+    /// Lower 64 bits of reciprocal, the upper bit is always 1.
+    uint64_t magic;
+    uint8_t shift1;
+    uint8_t shift2;
+} FixedDiv;
+
+/// Precompute reciprocal of `divisor`, it must be in `[1, INT64_MAX]`.
+void fixed_div_init(FixedDiv *self, uint64_t divisor);
+
+/// Upper 64 bits of 128-bit product, computed with 32-bit multiplications.
+static inline uint64_t fixed_mul_high_u64(uint64_t a, uint64_t b) {
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+    return hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (cross >> 32);
+}
+
+/// Same as `n / divisor`.
+static inline uint64_t fixed_div_u64(const FixedDiv *self, uint64_t n) {
+    uint64_t t = fixed_mul_high_u64(self->magic, n);
+    return (t + ((n - t) >> self->shift1)) >> self->shift2;
+}
+
+/// Same as `n / divisor`, rounds towards zero.
+static inline int64_t fixed_div_s64(const FixedDiv *self, int64_t n) {
+    // Magnitude of `INT64_MIN` fits `uint64_t`.
+    bool negative = n < 0;
+    uint64_t q = fixed_div_u64(self, negative ? 0 - (uint64_t)n : (uint64_t)n);
+    return (int64_t)(negative ? 0 - q : q);
+}
+
+/// Same as `n % divisor`, has the sign of `n`.
+static inline int64_t fixed_mod_s64(const FixedDiv *self, int64_t n) {
+    return n - fixed_div_s64(self, n) * (int64_t)self->divisor;
+}
@@ -0,0 +1,65 @@
+#include "overrun.h"
+
+#include <hal/assert.h>
+
+#define RB_STRUCT OverrunGapRingBuffer
+#define RB_PREFIX overrun_gap_rb
+#define RB_ITEM OverrunGap
+#define RB_CAPACITY OVERRUN_GAPS_SIZE
+#include <utils/ringbuf.inl>
+#undef RB_STRUCT
+#undef RB_PREFIX
+#undef RB_ITEM
+#undef RB_CAPACITY
+
+void overrun_log_init(OverrunLog *self) {
+    hal_assert_retcode(overrun_gap_rb_init(&self->gaps));
+    self->pending = 0;
+    self->total = 0;
+}
+
+void overrun_log_drop(OverrunLog *self) {
+    self->pending += 1;
+    self->total += 1;
+}
+
+bool overrun_log_write(OverrunLog *self, size_t position) {
+    if (self->pending == 0) {
+        return true;
+    }
+    // Gap is published before the point, so reader always sees it when it reaches the point.
+    const OverrunGap gap = {position, self->pending};
+    if (overrun_gap_rb_write(&self->gaps, &gap, 1) != 1) {
+        return false;
+    }
+    self->pending = 0;
+    return true;
+}
+
+uint32_t overrun_log_read(OverrunLog *self, size_t position, size_t *len) {
+    uint32_t lost = 0;
+    const OverrunGap *gap = NULL;
+    while (overrun_gap_rb_read_peek_contiguous(&self->gaps, &gap) >= 1) {
+        // Reader never passes recorded gaps, so the offset does not wrap.
+        size_t offset = gap->position - position;
+        if (offset != 0) {
+            if (offset < *len) {
+                *len = offset;
+            }
+            break;
+        }
+        lost += gap->count;
+        overrun_gap_rb_read_commit(&self->gaps, 1);
+    }
+    return lost;
+}
+
+uint32_t overrun_log_skip(OverrunLog *self, size_t position, size_t len) {
+    uint32_t lost = 0;
+    const OverrunGap *gap = NULL;
+    while (overrun_gap_rb_read_peek_contiguous(&self->gaps, &gap) >= 1 && gap->position - position < len) {
+        lost += gap->count;
+        overrun_gap_rb_read_commit(&self->gaps, 1);
+    }
+    return lost;
+}
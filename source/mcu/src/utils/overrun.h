@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Accounting of points lost on ring buffer overrun.
+//
+// Writer keeps the oldest points when the buffer is full, so the lost points fall between the buffered ones and
+// the next written point. Each gap is recorded together with ring buffer position of that point, and reader
+// accounts lost points only when it reaches the position, so that the index of each read point stays exact.
+// Writer and reader sides may run in different tasks the same way as ones of the ring buffer.
+
+/// Number of gaps that can be recorded at once. Points are lost until there is a free record.
+#define OVERRUN_GAPS_SIZE 8
+
+typedef struct {
+    /// Ring buffer position of the first point written after the gap.
+    size_t position;
+    /// Number of points lost.
+    uint32_t count;
+} OverrunGap;
+
+#define RB_STRUCT OverrunGapRingBuffer
+#define RB_PREFIX overrun_gap_rb
+#define RB_ITEM OverrunGap
+#define RB_CAPACITY OVERRUN_GAPS_SIZE
+#include <utils/ringbuf.h>
+#undef RB_STRUCT
+#undef RB_PREFIX
+#undef RB_ITEM
+#undef RB_CAPACITY
+
+typedef struct {
+    OverrunGapRingBuffer gaps;
+    /// Points lost since the last written one, not recorded yet. Modified by writer only.
+    uint32_t pending;
+    /// Total number of points lost. Unlike statistics, it is never reset.
+    volatile uint32_t total;
+} OverrunLog;
+
+void overrun_log_init(OverrunLog *self);
+
+/// Count point lost by writer.
+void overrun_log_drop(OverrunLog *self);
+
+/// Called by writer before a point is written at `position`.
+/// @return `false` if pending gap cannot be recorded, the point must be dropped with `overrun_log_drop` then.
+bool overrun_log_write(OverrunLog *self, size_t position);
+
+/// Called by reader before reading points from `position`. `len` is limited so that no gap falls inside of them.
+/// @return Number of points lost right before `position`.
+uint32_t overrun_log_read(OverrunLog *self, size_t position, size_t *len);
+
+/// Called by reader before skipping `len` points from `position`.
+/// @return Number of points lost before and between them.
+uint32_t overrun_log_skip(OverrunLog *self, size_t position, size_t len);
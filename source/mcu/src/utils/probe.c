@@ -0,0 +1,73 @@
+#include "probe.h"
+
+#include <string.h>
+
+#include <hal/assert.h>
+
+// Snapshot handshake states. Reader only moves state from `IDLE` or `READY` to `REQUESTED`
+// and writer only moves it from `REQUESTED` to `READY`, so the snapshot is accessed by one side at a time.
+#define PROBE_STATE_IDLE 0
+#define PROBE_STATE_REQUESTED 1
+#define PROBE_STATE_READY 2
+
+void probe_reset(Probe *self) {
+    memset(self, 0, sizeof(Probe));
+    self->min = UINT32_MAX;
+}
+
+size_t probe_hist_bin(uint32_t cycles) {
+    uint32_t ratio = cycles / TIMING_HIST_BASE_CYCLES;
+    if (ratio == 0) {
+        return 0;
+    }
+    size_t bin = 32 - (size_t)__builtin_clz(ratio);
+    return bin < TIMING_HIST_BINS ? bin : TIMING_HIST_BINS - 1;
+}
+
+void probe_record(Probe *self, uint32_t cycles) {
+    self->count += 1;
+    self->sum += cycles;
+    if (cycles < self->min) {
+        self->min = cycles;
+    }
+    if (cycles > self->max) {
+        self->max = cycles;
+    }
+    self->hist[probe_hist_bin(cycles)] += 1;
+}
+
+void probe_group_init(ProbeGroup *self, uint8_t first, size_t size) {
+    hal_assert(size <= PROBE_GROUP_MAX_SIZE);
+    hal_assert(first + size <= TIMING_STAGE_COUNT);
+    self->first = first;
+    self->size = size;
+    for (size_t i = 0; i < size; ++i) {
+        probe_reset(&self->active[i]);
+        probe_reset(&self->snapshot[i]);
+    }
+    __atomic_store_n(&self->state, PROBE_STATE_IDLE, __ATOMIC_RELAXED);
+}
+
+void probe_group_commit(ProbeGroup *self) {
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != PROBE_STATE_REQUESTED) {
+        return;
+    }
+    memcpy(self->snapshot, self->active, self->size * sizeof(Probe));
+    for (size_t i = 0; i < self->size; ++i) {
+        probe_reset(&self->active[i]);
+    }
+    __atomic_store_n(&self->state, PROBE_STATE_READY, __ATOMIC_RELEASE);
+}
+
+bool probe_group_take(ProbeGroup *self, Probe *out) {
+    uint32_t state = __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+    if (state == PROBE_STATE_REQUESTED) {
+        // Writer has not committed yet, the request is still pending.
+        return false;
+    }
+    if (state == PROBE_STATE_READY) {
+        memcpy(out, self->snapshot, self->size * sizeof(Probe));
+    }
+    __atomic_store_n(&self->state, PROBE_STATE_REQUESTED, __ATOMIC_RELEASE);
+    return state == PROBE_STATE_READY;
+}
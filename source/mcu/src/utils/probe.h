@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <common/config.h>
+
+#include <utils/cycles.h>
+
+// Timing probes measuring durations of task stages in CPU cycles.
+//
+// Probes are updated by the measured task only. Other task gets their values through `ProbeGroup` snapshot
+// handshake, so no locks or critical sections are needed in the hot loop.
+
+#define PROBE_GROUP_MAX_SIZE 8
+
+/// Accumulated durations of single stage.
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    /// Logarithmic histogram, see `TIMING_HIST_BINS`.
+    uint32_t hist[TIMING_HIST_BINS];
+} Probe;
+
+void probe_reset(Probe *self);
+
+/// Index of histogram bin for given duration.
+size_t probe_hist_bin(uint32_t cycles);
+
+void probe_record(Probe *self, uint32_t cycles);
+
+/// Record duration since `start` and return current time to be used as start of the next stage.
+static inline uint32_t probe_lap(Probe *self, uint32_t start) {
+    uint32_t now = cycles_now();
+    probe_record(self, now - start);
+    return now;
+}
+
+/// Probes of consecutive `TIMING_*` stages measured by single task.
+typedef struct {
+    /// Probes updated by measured task.
+    Probe active[PROBE_GROUP_MAX_SIZE];
+    /// Copy of `active` probes made on reader request.
+    Probe snapshot[PROBE_GROUP_MAX_SIZE];
+    /// Stage of the first probe.
+    uint8_t first;
+    size_t size;
+    /// Snapshot handshake state, see `probe.c`.
+    uint32_t state;
+} ProbeGroup;
+
+void probe_group_init(ProbeGroup *self, uint8_t first, size_t size);
+
+/// Probe of given `TIMING_*` stage.
+static inline Probe *probe_group_get(ProbeGroup *self, uint8_t stage) {
+    return &self->active[stage - self->first];
+}
+
+/// Called by measured task at the end of each iteration.
+/// If snapshot was requested then copy active probes into it and reset them.
+void probe_group_commit(ProbeGroup *self);
+
+/// Called by reader task. If the requested snapshot is ready then copy it into `out` (of `size` items)
+/// and request the next one. The first call only makes a request.
+/// @return Whether `out` was written.
+bool probe_group_take(ProbeGroup *self, Probe *out);
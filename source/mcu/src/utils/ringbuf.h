@@ -15,20 +15,24 @@
 
 #include "macros.h"
 
-#include <FreeRTOS.h>
-#include <stream_buffer.h>
-
 #include <hal/defs.h>
 
 #include <common/config.h>
 
-#define _RB_STATIC_DATA_SIZE(len) (sizeof(RB_ITEM) * (len) + 1)
+// Lock-free single-producer single-consumer ring buffer.
+//
+// Positions are free-running counters, item index is obtained by masking, so capacity must be a power of two.
+// Writer only modifies `head` and reader only modifies `tail`, acquire/release ordering makes items visible
+// to the other side before the position is updated. No critical sections are needed as long as there is
+// at most one reader and one writer at a time.
 
 /// Ring buffer structure.
 typedef struct {
-    StaticStreamBuffer_t info;
-    StreamBufferHandle_t handle;
-    uint8_t data[_RB_STATIC_DATA_SIZE(RB_CAPACITY)];
+    /// Number of items written since initialization (wrapping). Modified by writer only.
+    size_t head;
+    /// Number of items read since initialization (wrapping). Modified by reader only.
+    size_t tail;
+    RB_ITEM data[RB_CAPACITY];
 } RB_STRUCT;
 
 
@@ -48,6 +52,30 @@ size_t concat(RB_PREFIX, _occupied)(const RB_STRUCT *self);
 /// Number of additionaly points that could be stored in free space of the ring buffer.
 size_t concat(RB_PREFIX, _vacant)(const RB_STRUCT *self);
 
+/// Position of the oldest stored point, i.e. number of points read since initialization (wrapping). Called by reader.
+size_t concat(RB_PREFIX, _read_position)(const RB_STRUCT *self);
+
+/// Position of the next written point, i.e. number of points written since initialization (wrapping). Called by writer.
+size_t concat(RB_PREFIX, _write_position)(const RB_STRUCT *self);
+
+
+/// Get contiguous slice of stored points starting from the oldest one without removing them.
+/// Points are removed only by subsequent `_read_commit`.
+/// NOTE: Stored points may wrap around the end of the buffer, so the slice may be shorter than `_occupied`.
+/// @return Length of the slice.
+size_t concat(RB_PREFIX, _read_peek_contiguous)(RB_STRUCT *self, const RB_ITEM **data);
+
+/// Remove `len` oldest points previously obtained by `_read_peek_contiguous`.
+void concat(RB_PREFIX, _read_commit)(RB_STRUCT *self, size_t len);
+
+/// Get contiguous slice of free space to write points into.
+/// Points become visible to the reader only after subsequent `_write_commit`.
+/// @return Length of the slice.
+size_t concat(RB_PREFIX, _write_peek_contiguous)(RB_STRUCT *self, RB_ITEM **data);
+
+/// Publish `len` points previously written into slice obtained by `_write_peek_contiguous`.
+void concat(RB_PREFIX, _write_commit)(RB_STRUCT *self, size_t len);
+
 
 /// Read at most `max_len` points from the ring buffer into `data`.
 /// @return Number of actually read points.
@@ -11,12 +11,18 @@
 #error "RB_CAPACITY number must be defined"
 #endif // RB_CAPACITY
 
+#include <string.h>
+
 #include <hal/assert.h>
 #include <hal/math.h>
 
+_Static_assert((RB_CAPACITY & (RB_CAPACITY - 1)) == 0 && RB_CAPACITY > 0, "RB_CAPACITY must be a power of two");
+
+#define _RB_MASK (RB_CAPACITY - 1)
+
 hal_retcode concat(RB_PREFIX, _init)(RB_STRUCT *self) {
-    self->handle = xStreamBufferCreateStatic(_RB_STATIC_DATA_SIZE(RB_CAPACITY), 0, self->data, &self->info);
-    hal_assert(self->handle != NULL);
+    self->head = 0;
+    self->tail = 0;
     return HAL_SUCCESS;
 }
 
@@ -30,61 +36,110 @@ size_t concat(RB_PREFIX, _capacity)(const RB_STRUCT *self) {
 }
 
 size_t concat(RB_PREFIX, _occupied)(const RB_STRUCT *self) {
-    size_t len = xStreamBufferBytesAvailable(self->handle);
-    hal_assert((len % sizeof(RB_ITEM)) == 0);
-    return len / sizeof(RB_ITEM);
+    // Tail is loaded first, so that the difference is never negative even if called from third context.
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    return head - tail;
 }
 
 size_t concat(RB_PREFIX, _vacant)(const RB_STRUCT *self) {
-    size_t len = xStreamBufferSpacesAvailable(self->handle);
-    hal_assert((len % sizeof(RB_ITEM)) == 0);
-    return len / sizeof(RB_ITEM);
+    return RB_CAPACITY - concat(RB_PREFIX, _occupied)(self);
+}
+
+size_t concat(RB_PREFIX, _read_position)(const RB_STRUCT *self) {
+    return __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+}
+
+size_t concat(RB_PREFIX, _write_position)(const RB_STRUCT *self) {
+    return __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+}
+
+
+size_t concat(RB_PREFIX, _read_peek_contiguous)(RB_STRUCT *self, const RB_ITEM **data) {
+    // Only reader modifies `tail`, so relaxed load is enough.
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+    // Acquire to see items written before `head` was published.
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    size_t offset = tail & _RB_MASK;
+    *data = &self->data[offset];
+    return hal_min(head - tail, RB_CAPACITY - offset);
+}
+
+void concat(RB_PREFIX, _read_commit)(RB_STRUCT *self, size_t len) {
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+    hal_assert(len <= __atomic_load_n(&self->head, __ATOMIC_ACQUIRE) - tail);
+    // Release to finish reading of items before writer is able to reuse their space.
+    __atomic_store_n(&self->tail, tail + len, __ATOMIC_RELEASE);
+}
+
+size_t concat(RB_PREFIX, _write_peek_contiguous)(RB_STRUCT *self, RB_ITEM **data) {
+    // Only writer modifies `head`, so relaxed load is enough.
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+    // Acquire to not overwrite items before reader has finished with them.
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+    size_t offset = head & _RB_MASK;
+    *data = &self->data[offset];
+    return hal_min(RB_CAPACITY - (head - tail), RB_CAPACITY - offset);
 }
 
+void concat(RB_PREFIX, _write_commit)(RB_STRUCT *self, size_t len) {
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+    hal_assert(len <= RB_CAPACITY - (head - __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE)));
+    // Release to publish written items along with new `head`.
+    __atomic_store_n(&self->head, head + len, __ATOMIC_RELEASE);
+}
+
+
 size_t concat(RB_PREFIX, _read)(RB_STRUCT *self, RB_ITEM *data, size_t max_len) {
-    size_t len = xStreamBufferReceive(self->handle, data, max_len * sizeof(RB_ITEM), 0);
-    hal_assert((len % sizeof(RB_ITEM)) == 0);
-    return len / sizeof(RB_ITEM);
+    size_t len = 0;
+    // Stored points are split into at most two contiguous slices.
+    for (size_t i = 0; i < 2 && len < max_len; ++i) {
+        const RB_ITEM *slice = NULL;
+        size_t slice_len = hal_min(concat(RB_PREFIX, _read_peek_contiguous)(self, &slice), max_len - len);
+        if (slice_len == 0) {
+            break;
+        }
+        memcpy(data + len, slice, slice_len * sizeof(RB_ITEM));
+        concat(RB_PREFIX, _read_commit)(self, slice_len);
+        len += slice_len;
+    }
+    return len;
 }
 
 size_t concat(RB_PREFIX, _write)(RB_STRUCT *self, const RB_ITEM *data, size_t max_len) {
-    size_t len = xStreamBufferSend(self->handle, data, max_len * sizeof(RB_ITEM), 0);
-    hal_assert((len % sizeof(RB_ITEM)) == 0);
-    return len / sizeof(RB_ITEM);
+    size_t len = 0;
+    // Free space is split into at most two contiguous slices.
+    for (size_t i = 0; i < 2 && len < max_len; ++i) {
+        RB_ITEM *slice = NULL;
+        size_t slice_len = hal_min(concat(RB_PREFIX, _write_peek_contiguous)(self, &slice), max_len - len);
+        if (slice_len == 0) {
+            break;
+        }
+        memcpy(slice, data + len, slice_len * sizeof(RB_ITEM));
+        concat(RB_PREFIX, _write_commit)(self, slice_len);
+        len += slice_len;
+    }
+    return len;
 }
 
-#define TMP_BUF_LEN 16
-
 size_t concat(RB_PREFIX, _overwrite)(RB_STRUCT *self, const RB_ITEM *data, size_t len) {
     hal_assert(len <= concat(RB_PREFIX, _capacity)(self));
     size_t vacant = concat(RB_PREFIX, _vacant)(self);
     size_t extra = 0;
     if (vacant < len) {
         extra = len - vacant;
-        RB_ITEM tmp_buf[TMP_BUF_LEN];
-        for (size_t i = 0; i < extra / TMP_BUF_LEN; ++i) {
-            hal_assert(concat(RB_PREFIX, _read)(self, tmp_buf, TMP_BUF_LEN) == TMP_BUF_LEN);
-        }
-        size_t extra_rem = extra % TMP_BUF_LEN;
-        hal_assert(concat(RB_PREFIX, _read)(self, tmp_buf, extra_rem) == extra_rem);
+        hal_assert(concat(RB_PREFIX, _skip)(self, extra) == extra);
     }
     hal_assert(concat(RB_PREFIX, _write)(self, data, len) == len);
     return extra;
 }
 
-/// Read and discard at most `max_len` points from the ring buffer.
-/// @return Number of actually skipped points.
 size_t concat(RB_PREFIX, _skip)(RB_STRUCT *self, size_t max_len) {
-    size_t len = hal_min(max_len, concat(RB_PREFIX, _occupied)(self));
-
-    RB_ITEM tmp_buf[TMP_BUF_LEN];
-    for (size_t i = 0; i < len / TMP_BUF_LEN; ++i) {
-        hal_assert(concat(RB_PREFIX, _read)(self, tmp_buf, TMP_BUF_LEN) == TMP_BUF_LEN);
-    }
-    size_t rem = len % TMP_BUF_LEN;
-    hal_assert(concat(RB_PREFIX, _read)(self, tmp_buf, rem) == rem);
-
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    size_t len = hal_min(max_len, head - tail);
+    __atomic_store_n(&self->tail, tail + len, __ATOMIC_RELEASE);
     return len;
 }
 
-#undef TMP_BUF_LEN
+#undef _RB_MASK
@@ -24,6 +24,9 @@ class Config(pydantic.BaseModel):
     keep_alive_period_ms: int
     keep_alive_max_delay_ms: int
 
+    ipp_protocol_version: int
+    ipp_feature_sequence_numbers: int
+
 
 def read_common_config(source_dir: Path) -> Config:
     defs = read_defs(source_dir / "common" / "include" / "common" / "config.h")
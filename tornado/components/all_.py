@@ -8,9 +8,9 @@ from ferrite.components.epics.epics_base import EpicsBaseCross, EpicsBaseHost
 from ferrite.remote.tasks import RebootTask
 
 from tornado.components.ipp import Ipp
-from tornado.components.app import AppReal, AppFake
+from tornado.components.app import AppReal, AppFake, AppTest
 from tornado.components.epics.app_ioc import AppIocHost, AppIocCross
-from tornado.components.mcu import Mcu
+from tornado.components.mcu import Mcu, McuHost
 
 
 @dataclass
@@ -19,6 +19,8 @@ class AllHost(Component):
     epics_base: EpicsBaseHost
     ipp: Ipp
     app: AppFake
+    app_test: AppTest
+    mcu_host: McuHost
     ioc: AppIocHost
 
     def __post_init__(self) -> None:
@@ -33,6 +35,8 @@ class AllHost(Component):
         self.test_task = TaskWrapper(
             deps=[
                 self.ipp.test_task,
+                self.app_test.test_task,
+                self.mcu_host.test_task,
                 self.ioc.test_task,
             ],
         )
@@ -1,8 +1,10 @@
 from __future__ import annotations
 from typing import Any, Dict, List
 
+import subprocess
 from pathlib import Path
 
+from ferrite.components.base import Task, Context
 from ferrite.components.app import AppBase, AppBaseHost, AppBaseCross
 from ferrite.components.toolchain import Toolchain, HostToolchain, CrossToolchain
 
@@ -72,3 +74,45 @@ class AppFake(AppCommon, AppBaseHost):
             toolchain,
             ipp,
         )
+
+
+class AppTest(AppBaseHost):
+    """Host-side unit tests and benchmarks for application code that doesn't need IOC."""
+
+    class RunTask(Task):
+
+        def __init__(self, owner: AppBaseHost, binary: str) -> None:
+            super().__init__()
+            self.owner = owner
+            self.binary = binary
+
+        def run(self, ctx: Context) -> None:
+            subprocess.run([str(self.owner.build_dir / self.binary)], check=True)
+
+        def dependencies(self) -> List[Task]:
+            return [self.owner.build_task]
+
+    def __init__(
+        self,
+        source_dir: Path,
+        ferrite_source_dir: Path,
+        target_dir: Path,
+        toolchain: HostToolchain,
+    ):
+        super().__init__(
+            source_dir / "app" / "test",
+            target_dir / "app_test",
+            toolchain,
+            target="all",
+            opts=[f"-DFERRITE={ferrite_source_dir}"],
+        )
+        self.test_task = self.RunTask(self, "app_test")
+        self.bench_task = self.RunTask(self, "app_bench")
+
+    def tasks(self) -> Dict[str, Task]:
+        tasks = super().tasks()
+        tasks.update({
+            "test": self.test_task,
+            "bench": self.bench_task,
+        })
+        return tasks
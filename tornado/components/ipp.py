@@ -1,7 +1,12 @@
 from __future__ import annotations
+from typing import Any, Dict, List
 
+import json
+import subprocess
 from pathlib import Path
 
+from ferrite.components.base import Task, Context
+from ferrite.components.app import AppBaseHost
 from ferrite.components.toolchain import HostToolchain
 from ferrite.components.codegen import CodegenWithTest
 
@@ -25,3 +30,62 @@ class Ipp(CodegenWithTest):
             "ipp",
             generate,
         )
+
+
+class IppBench(AppBaseHost):
+    """Encode/decode benchmarks of generated C, C++ and Python IPP codecs."""
+
+    class RunTask(Task):
+
+        def __init__(self, owner: IppBench) -> None:
+            super().__init__()
+            self.owner = owner
+
+        def run(self, ctx: Context) -> None:
+            from tornado.ipp.bench import run
+            from tornado.common.config import read_common_config
+
+            output = subprocess.run([str(self.owner.build_dir / "ipp_bench")], check=True, capture_output=True).stdout
+            native: Dict[str, Any] = json.loads(output)
+            python = run(read_common_config(self.owner.source_root_dir))
+            report = {
+                "iterations": {"native": native["iterations"], "python": python["iterations"]},
+                "results": native["results"] + python["results"],
+            }
+
+            text = json.dumps(report, indent=2)
+            # Saved to compare results of codegen changes run over run.
+            (self.owner.build_dir / "ipp_bench.json").write_text(text)
+            print(text)
+
+        def dependencies(self) -> List[Task]:
+            return [self.owner.build_task]
+
+    def __init__(
+        self,
+        source_dir: Path,
+        ferrite_source_dir: Path,
+        target_dir: Path,
+        toolchain: HostToolchain,
+        ipp: Ipp,
+    ):
+        super().__init__(
+            source_dir / "ipp" / "bench",
+            target_dir / "ipp_bench",
+            toolchain,
+            target="ipp_bench",
+            opts=[
+                f"-DFERRITE={ferrite_source_dir}",
+                f"-DIPP={ipp.gen_dir}",
+            ],
+            deps=[ipp.generate_task],
+        )
+        self.source_root_dir = source_dir
+        self.run_task = self.RunTask(self)
+
+    def tasks(self) -> Dict[str, Task]:
+        tasks = super().tasks()
+        tasks.update({
+            "run": self.run_task,
+        })
+        return tasks
@@ -1,12 +1,16 @@
 from __future__ import annotations
+from typing import Dict
 
 from pathlib import Path
 
-from ferrite.components.toolchain import CrossToolchain
+from ferrite.components.base import Task
+from ferrite.components.app import AppBaseHost
+from ferrite.components.toolchain import CrossToolchain, HostToolchain
 from ferrite.components.freertos import Freertos
 from ferrite.components.mcu import McuBase, McuDeployer
 
 from tornado.components.ipp import Ipp
+from tornado.components.app import AppTest
 
 
 class Mcu(McuBase):
@@ -34,3 +38,34 @@ class Mcu(McuBase):
         )
         self.ferrite_source_dir = ferrite_source_dir
         self.ipp = ipp
+
+
+class McuHost(AppBaseHost):
+    """MCU tasks built for host with stubbed FreeRTOS and HAL, used for unit tests and benchmarks."""
+
+    def __init__(
+        self,
+        source_dir: Path,
+        ferrite_source_dir: Path,
+        target_dir: Path,
+        toolchain: HostToolchain,
+        ipp: Ipp,
+    ):
+        super().__init__(
+            source_dir / "mcu" / "host",
+            target_dir / "mcu_host",
+            toolchain,
+            target="all",
+            opts=[f"-DFERRITE={ferrite_source_dir}", f"-DIPP={ipp.gen_dir}"],
+            deps=[ipp.generate_task],
+        )
+        self.test_task = AppTest.RunTask(self, "mcu_test")
+        self.bench_task = AppTest.RunTask(self, "mcu_bench")
+
+    def tasks(self) -> Dict[str, Task]:
+        tasks = super().tasks()
+        tasks.update({
+            "test": self.test_task,
+            "bench": self.bench_task,
+        })
+        return tasks
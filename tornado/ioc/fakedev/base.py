@@ -1,7 +1,10 @@
 from __future__ import annotations
 from typing import List, Generator
 
+import os
+import socket
 import asyncio
+from enum import Enum
 from dataclasses import dataclass
 from contextlib import contextmanager
 
@@ -14,6 +17,7 @@ import zmq.asyncio as azmq
 from ferrite.utils.epics.ioc import Ioc
 
 from tornado.ipp import AppMsg, McuMsg
+from tornado.ipp.fast import FastCodec
 from tornado.common.config import Config
 
 import logging
@@ -21,12 +25,36 @@ import logging
 logger = logging.getLogger(__name__)
 
 
+# NOTE: Must be kept in sync with `source/app/fake/external.cpp`.
+TRANSPORT_ENV = "TORNADO_FAKEDEV_TRANSPORT"
+SOCKET_PATH_ENV = "TORNADO_FAKEDEV_SOCKET_PATH"
+SOCKET_PATH_DEFAULT = "/tmp/tornado_fakedev.sock"
+SEQPACKET_MAX_MSG_LEN = 32768
+
+
+class Transport(Enum):
+    # Pair of ZMQ sockets over TCP loopback.
+    ZMQ = "zmq"
+    # Single Unix-domain `SOCK_SEQPACKET` socket.
+    SEQPACKET = "seqpacket"
+
+    @staticmethod
+    def from_env() -> Transport:
+        return Transport(os.environ.get(TRANSPORT_ENV, Transport.ZMQ.value))
+
+
 class FakeDev:
     REQUEST_SIZE: int = 1024
 
     @dataclass
     class Handler:
         config: Config
+        # Current sample frequency, set by app on connection.
+        sample_freq_hz: float = 0.0
+
+        def __post_init__(self) -> None:
+            if self.sample_freq_hz == 0.0:
+                self.sample_freq_hz = self.config.sample_freq_hz
 
         def dac_codes_to_volts(self, codes: NDArray[np.int32]) -> NDArray[np.float64]:
             array: NDArray[np.float64] = codes.astype(np.float64)
@@ -43,33 +71,115 @@ class FakeDev:
             adcs = await self.transfer(self.dac_codes_to_volts(dac_codes))
             return self.adc_volts_to_codes(adcs)
 
-    def __init__(self, ioc: Ioc, config: Config, handler: FakeDev.Handler) -> None:
+    def __init__(self, ioc: Ioc, config: Config, handler: FakeDev.Handler, transport: Transport | None = None) -> None:
         self.ioc = ioc
 
-        self.context = azmq.Context()
-        self.recv_socket = self.context.socket(zmq.PAIR)
-        self.send_socket = self.context.socket(zmq.PAIR)
+        self.transport = transport if transport is not None else Transport.from_env()
+        if self.transport == Transport.ZMQ:
+            self.context = azmq.Context()
+            self.recv_socket = self.context.socket(zmq.PAIR)
+            self.send_socket = self.context.socket(zmq.PAIR)
+        elif self.transport == Transport.SEQPACKET:
+            self.socket_path = os.environ.get(SOCKET_PATH_ENV, SOCKET_PATH_DEFAULT)
+            self.listener = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+            self.listener.setblocking(False)
+            self.conn: socket.socket | None = None
 
         self.config = config
         self.handler = handler
+        self.codec = FastCodec(config.adc_count)
+
+        self.adc_seq = 0
+        self.sample_index = 0
+        self.dac_seq = 0
+
+        # Negotiated on connection.
+        self.adc_msg_max_points = 0
+        self.features = 0
+
+    # Features implemented by fake device.
+    def _supported_features(self) -> int:
+        return self.config.ipp_feature_sequence_numbers
+
+    async def _negotiate(self, msg: AppMsg.Connect) -> None:
+        # Message type, sequence number, sample index, vector length and points.
+        self.adc_msg_max_points = min(
+            (msg.max_msg_len - 1 - 4 - 8 - 2) // (self.config.adc_count * 4),
+            (1 << 16) - 1,
+        )
+        self.features = msg.features & self._supported_features()
+        # Any requested frequency is accepted, zero keeps the current one.
+        if msg.sample_freq_hz != 0:
+            self.handler.sample_freq_hz = float(msg.sample_freq_hz)
+        # Message type, sequence number, vector length and points.
+        dac_msg_max_points = (SEQPACKET_MAX_MSG_LEN - 1 - 4 - 2) // 4
+        await self._send_msg(
+            McuMsg.Capabilities(
+                version=self.config.ipp_protocol_version,
+                max_msg_len=SEQPACKET_MAX_MSG_LEN,
+                dac_buffer_size=FakeDev.REQUEST_SIZE,
+                adc_buffer_size=FakeDev.REQUEST_SIZE,
+                dac_msg_max_points=dac_msg_max_points,
+                adc_msg_max_points=self.adc_msg_max_points,
+                sample_freq_hz=int(self.handler.sample_freq_hz),
+                features=self.features,
+            )
+        )
+        if msg.version != self.config.ipp_protocol_version:
+            raise RuntimeError(f"IPP protocol version mismatch: app {msg.version}, fakedev {self.config.ipp_protocol_version}")
+        if self.adc_msg_max_points <= 0:
+            raise RuntimeError(f"App max message length ({msg.max_msg_len}) is too small")
+        logger.info(
+            f"Negotiated features: {self.features:#x}, ADC points per message: {self.adc_msg_max_points}, "
+            f"sample frequency: {self.handler.sample_freq_hz} Hz"
+        )
 
     async def _send_msg(self, msg: McuMsg.Variant) -> None:
-        await self.send_socket.send(McuMsg(msg).store())
+        await self._send_data(McuMsg(msg).store())
 
-    async def _recv_msg(self) -> AppMsg:
-        data = await self.recv_socket.recv()
+    async def _send_data(self, data: bytes | memoryview) -> None:
+        if self.transport == Transport.ZMQ:
+            await self.send_socket.send(data)
+        else:
+            assert self.conn is not None
+            await asyncio.get_running_loop().sock_sendall(self.conn, data)
+
+    async def _recv_msg(self) -> AppMsg.Variant:
+        if self.transport == Transport.ZMQ:
+            data = await self.recv_socket.recv()
+        else:
+            assert self.conn is not None
+            data = await asyncio.get_running_loop().sock_recv(self.conn, SEQPACKET_MAX_MSG_LEN)
+            if len(data) == 0:
+                raise ConnectionResetError("IOC closed connection")
         assert isinstance(data, bytes)
-        return AppMsg.load(data)
+        return self.codec.load_app_msg(data)
+
+    async def _accept(self) -> None:
+        if self.transport == Transport.SEQPACKET:
+            self.conn, _ = await asyncio.get_running_loop().sock_accept(self.listener)
+            self.conn.setblocking(False)
+
+    def _check_dac_seq(self, seq: int) -> None:
+        if (self.features & self.config.ipp_feature_sequence_numbers) == 0:
+            return
+        if seq != self.dac_seq:
+            logger.warning(f"DAC message sequence gap: expected {self.dac_seq}, got {seq}")
+        self.dac_seq = (seq + 1) % (1 << 32)
 
     async def _sample_chunk(self, dac: NDArray[np.int32]) -> None:
         adcs = await self.handler.transfer_codes(dac)
-        await self._send_msg(McuMsg.AdcData(adcs))
-        await self._send_msg(McuMsg.DacRequest(len(dac)))
+        messages = self.codec.store_adc_data_batch(self.adc_seq, self.sample_index, adcs, self.adc_msg_max_points)
+        for data in messages:
+            await self._send_data(data)
+        self.adc_seq = (self.adc_seq + len(messages)) % (1 << 32)
+        self.sample_index += len(adcs)
+        await self._send_data(self.codec.store_dac_request(len(dac)))
 
     async def _recv_and_handle_msg(self) -> None:
-        base_msg = await self._recv_msg()
-        msg = base_msg.variant
+        msg = await self._recv_msg()
         if isinstance(msg, AppMsg.DacData):
+            self._check_dac_seq(msg.seq)
             await self._sample_chunk(msg.points)
         elif isinstance(msg, AppMsg.DacMode):
             if msg.enable:
@@ -82,8 +192,11 @@ class FakeDev:
             raise RuntimeError(f"Unexpected message type")
 
     async def loop(self) -> None:
-        assert isinstance((await self._recv_msg()).variant, AppMsg.Connect)
+        await self._accept()
+        connect = await self._recv_msg()
+        assert isinstance(connect, AppMsg.Connect)
         logger.info("IOC connected signal")
+        await self._negotiate(connect)
         await self._send_msg(McuMsg.Debug("Hello from MCU!"))
 
         await self._send_msg(McuMsg.DacRequest(FakeDev.REQUEST_SIZE))
@@ -96,10 +209,26 @@ class FakeDev:
 
     @contextmanager
     def _bind_sockets(self) -> Generator[None, None, None]:
-        recv = self.recv_socket.bind("tcp://127.0.0.1:8321")
-        send = self.send_socket.bind("tcp://127.0.0.1:8322")
-        with recv, send:
-            yield None
+        # IOC inherits our environment, so it picks the same transport.
+        os.environ[TRANSPORT_ENV] = self.transport.value
+        if self.transport == Transport.ZMQ:
+            recv = self.recv_socket.bind("tcp://127.0.0.1:8321")
+            send = self.send_socket.bind("tcp://127.0.0.1:8322")
+            with recv, send:
+                yield None
+        else:
+            os.environ[SOCKET_PATH_ENV] = self.socket_path
+            if os.path.exists(self.socket_path):
+                os.unlink(self.socket_path)
+            self.listener.bind(self.socket_path)
+            self.listener.listen(1)
+            try:
+                yield None
+            finally:
+                if self.conn is not None:
+                    self.conn.close()
+                self.listener.close()
+                os.unlink(self.socket_path)
 
     async def run(self) -> None:
         with self._bind_sockets(), self.ioc:
@@ -21,14 +21,17 @@ class Handler(FakeDev.Handler):
 
     async def transfer(self, dac: NDArray[np.float64]) -> NDArray[np.float64]:
         adc_mag = dac / self.config.dac_max_abs_v * self.config.adc_max_abs_v
-        time = self.time + np.arange(len(dac), dtype=np.float64) / self.config.sample_freq_hz
+        time = self.time + np.arange(len(dac), dtype=np.float64) / self.sample_freq_hz
         value = 0.5 * adc_mag * np.cos(np.e * time) + 0.5 * self.config.adc_max_abs_v * np.cos(np.pi * time)
 
-        delay = len(dac) / self.config.sample_freq_hz
+        delay = len(dac) / self.sample_freq_hz
         await asyncio.sleep(delay)
         self.time += delay
 
-        return np.stack([dac] + [value] * (self.config.adc_count - 1)).transpose()
+        adcs = np.empty((len(dac), self.config.adc_count), dtype=np.float64)
+        adcs[:, 0] = dac
+        adcs[:, 1:] = value[:, np.newaxis]
+        return adcs
 
 
 def run(source_dir: Path, epics_base_dir: Path, ioc_dir: Path, arch: str) -> None:
@@ -9,7 +9,16 @@ from ferrite.codegen.generate import make_variant, generate_and_write
 AppMsg = make_variant(
     Name(["app", "msg"]),
     [
-        (Name(["connect"]), []),
+        (Name(["connect"]), [
+            # Protocol version, must be equal to `IPP_PROTOCOL_VERSION` of MCU.
+            Field("version", Int(16, signed=False)),
+            # Maximum length of message app is able to receive.
+            Field("max_msg_len", Int(16, signed=False)),
+            # Features supported by app, see `IPP_FEATURE_*`.
+            Field("features", Int(32, signed=False)),
+            # Requested sample frequency, zero to keep the current one. Actual frequency is reported in capabilities.
+            Field("sample_freq_hz", Int(32, signed=False)),
+        ]),
         (Name(["keep", "alive"]), []),
         (Name(["dout", "update"]), [
             Field("value", Int(8, signed=False)),
@@ -18,15 +27,79 @@ AppMsg = make_variant(
             Field("enable", Int(8, signed=False)),
         ]),
         (Name(["dac", "data"]), [
+            # Sequence number of DAC message since connection, used to detect lost and duplicated messages.
+            Field("seq", Int(32, signed=False)),
             Field("points", Vector(Int(32, signed=True))),
         ]),
         (Name(["stats", "reset"]), []),
+        # Average ADC points over `ratio` samples on MCU, requires `IPP_FEATURE_ADC_DECIMATION`.
+        # Sample indices of ADC messages count decimated points.
+        (Name(["adc", "decimation"]), [
+            Field("ratio", Int(16, signed=False)),
+        ]),
+        # Request `McuMsgCalib` with current calibration table, requires `IPP_FEATURE_CALIB`.
+        (Name(["calib", "read"]), []),
+        # Replace the whole calibration table, requires `IPP_FEATURE_CALIB`.
+        # MCU applies it at sync tick boundary and replies with `McuMsgCalib`.
+        (Name(["calib", "write"]), [
+            Field("gain", Array(Int(32, signed=True), 6)),
+            Field("offset", Array(Int(32, signed=True), 6)),
+            Field("filter", Array(Int(16, signed=False), 6)),
+        ]),
+        # Request `McuMsgRegulator` with current regulator gains, requires `IPP_FEATURE_REGULATOR`.
+        (Name(["regulator", "read"]), []),
+        # Replace all regulator gains at once, requires `IPP_FEATURE_REGULATOR`.
+        # MCU applies them at sync tick boundary and replies with `McuMsgRegulator`.
+        (Name(["regulator", "write"]), [
+            Field("kp", Int(32, signed=True)),
+            Field("ki", Int(32, signed=True)),
+            Field("kd", Int(32, signed=True)),
+            Field("kp2", Int(32, signed=True)),
+            Field("ki2", Int(32, signed=True)),
+            Field("kd2", Int(32, signed=True)),
+            Field("ff_r", Int(32, signed=True)),
+            Field("ff_l", Int(32, signed=True)),
+        ]),
+        # Stream regulator telemetry with every `ratio`-th sync tick, zero stops the stream.
+        # Requires `IPP_FEATURE_TELEMETRY`, stream is stopped on each connection.
+        (Name(["telemetry"]), [
+            Field("ratio", Int(16, signed=False)),
+        ]),
+        # Hold each DAC point for `ratio` samples on MCU and optionally interpolate regulator reference between them.
+        # Requires `IPP_FEATURE_DAC_UPSAMPLING`, reset to ratio 1 without interpolation on each connection.
+        (Name(["dac", "upsampling"]), [
+            Field("ratio", Int(16, signed=False)),
+            Field("interpolate", Int(8, signed=False)),
+        ]),
+        # Request `McuMsgFaultLimits` with current fault thresholds, requires `IPP_FEATURE_FAULT_LIMITS`.
+        (Name(["fault", "limits", "read"]), []),
+        # Replace all fault thresholds at once, requires `IPP_FEATURE_FAULT_LIMITS`.
+        # MCU applies them at sync tick boundary and replies with `McuMsgFaultLimits`.
+        (Name(["fault", "limits", "write"]), [
+            Field("limit", Array(Int(32, signed=True), 4)),
+            Field("persistence", Array(Int(32, signed=False), 4)),
+        ]),
     ],
 )
 
 McuMsg = make_variant(
     Name(["mcu", "msg"]),
     [
+        # Response to `AppMsgConnect`. Sent before any other message.
+        (Name(["capabilities"]), [
+            Field("version", Int(16, signed=False)),
+            # Maximum length of message MCU is able to receive.
+            Field("max_msg_len", Int(16, signed=False)),
+            Field("dac_buffer_size", Int(32, signed=False)),
+            Field("adc_buffer_size", Int(32, signed=False)),
+            # Maximum number of points in single DAC message MCU is able to receive.
+            Field("dac_msg_max_points", Int(16, signed=False)),
+            # Number of points MCU will send in single ADC message.
+            Field("adc_msg_max_points", Int(16, signed=False)),
+            Field("sample_freq_hz", Int(32, signed=False)),
+            # Features enabled for this connection (supported by both sides).
+            Field("features", Int(32, signed=False)),
+        ]),
         (Name(["din", "update"]), [
             Field("value", Int(8, signed=False)),
         ]),
@@ -34,6 +107,10 @@ McuMsg = make_variant(
             Field("count", Int(32, signed=False)),
         ]),
         (Name(["adc", "data"]), [
+            # Sequence number of ADC message since connection, used to detect lost and duplicated messages.
+            Field("seq", Int(32, signed=False)),
+            # Index of the first point in the stream of all samples taken by MCU, including ones lost on buffer overrun.
+            Field("sample_index", Int(64, signed=False)),
             Field("points_arrays", Vector(Array(Int(32, signed=True), 6))),
         ]),
         (Name(["error"]), [
@@ -43,6 +120,108 @@ McuMsg = make_variant(
         (Name(["debug"]), [
             Field("message", String()),
         ]),
+        # Timing statistics of MCU task stage since the previous report, sent every `TIMING_REPORT_PERIOD_MS`.
+        (Name(["timing"]), [
+            # One of `TIMING_*` stages.
+            Field("stage", Int(8, signed=False)),
+            # Durations are measured in CPU cycles.
+            Field("cycles_per_us", Int(32, signed=False)),
+            Field("count", Int(32, signed=False)),
+            Field("min", Int(32, signed=False)),
+            Field("max", Int(32, signed=False)),
+            Field("sum", Int(64, signed=False)),
+            # Logarithmic histogram of `TIMING_HIST_BINS` bins.
+            Field("hist", Array(Int(32, signed=False), 12)),
+        ]),
+        # Snapshot of MCU statistics since the last `AppMsgStatsReset`, sent every `STATS_MSG_PERIOD_MS`.
+        (Name(["stats"]), [
+            # Number of 10 kHz sync signals generated.
+            Field("clock_count", Int(64, signed=False)),
+            # Number of SkifIO samples handled.
+            Field("sample_count", Int(64, signed=False)),
+            # Maximum number of SkifIO ready signals per sample, greater than 1 means that signals are lost.
+            Field("max_intrs_per_sample", Int(32, signed=False)),
+            # CRC mismatches in SkifIO communication.
+            Field("crc_error_count", Int(32, signed=False)),
+            # DAC points lost because the buffer was empty or full.
+            Field("dac_lost_empty", Int(32, signed=False)),
+            Field("dac_lost_full", Int(32, signed=False)),
+            # DAC points sent by app in excess of requested ones.
+            Field("dac_req_exceed", Int(32, signed=False)),
+            # ADC points lost because the buffer was full.
+            Field("adc_lost_full", Int(32, signed=False)),
+            # DAC messages lost in transport and duplicated or reordered ones.
+            Field("dac_msg_lost", Int(32, signed=False)),
+            Field("dac_msg_dup", Int(32, signed=False)),
+            # Per-channel statistics of ADC codes.
+            Field("adc_count", Array(Int(32, signed=False), 6)),
+            Field("adc_sum", Array(Int(64, signed=True), 6)),
+            Field("adc_last", Array(Int(32, signed=True), 6)),
+            Field("adc_min", Array(Int(32, signed=True), 6)),
+            Field("adc_max", Array(Int(32, signed=True), 6)),
+        ]),
+        # Calibration table of measurement channels, one element per ADC channel.
+        # Value is `(code - offset) * gain / 1000000` filtered with time constant of `filter` sync ticks.
+        (Name(["calib"]), [
+            Field("gain", Array(Int(32, signed=True), 6)),
+            Field("offset", Array(Int(32, signed=True), 6)),
+            Field("filter", Array(Int(16, signed=False), 6)),
+        ]),
+        # Gains of current regulator. Proportional gain is in 1/100 units, integral gain is in 1/80000 units per tick,
+        # derivative gain on measurement is in 1/100 units, feed-forward gains of load resistance and inductance
+        # are in 1/1000 units.
+        (Name(["regulator"]), [
+            Field("kp", Int(32, signed=True)),
+            Field("ki", Int(32, signed=True)),
+            Field("kd", Int(32, signed=True)),
+            Field("kp2", Int(32, signed=True)),
+            Field("ki2", Int(32, signed=True)),
+            Field("kd2", Int(32, signed=True)),
+            Field("ff_r", Int(32, signed=True)),
+            Field("ff_l", Int(32, signed=True)),
+        ]),
+        # Regulator telemetry points, values are indexed by `TELEMETRY_*`.
+        # Index counts streamed points since connection, gaps mean points lost on MCU buffer overrun.
+        (Name(["telemetry"]), [
+            Field("point_index", Int(64, signed=False)),
+            Field("points", Vector(Array(Int(32, signed=True), 5))),
+        ]),
+        # The first fault of fault episode latched by MCU, requires `IPP_FEATURE_FAULT`. Sent once per episode,
+        # a fault latched without connection is sent after connecting. Code is one of `FAULT_*`.
+        (Name(["fault"]), [
+            Field("code", Int(8, signed=False)),
+            # Sync tick of trip since MCU start.
+            Field("tick", Int(64, signed=False)),
+            # Sample index of ADC point that contains the trip, as `sample_index` of `McuMsgAdcData`.
+            Field("sample_index", Int(64, signed=False)),
+            # Value exceeded threshold, zero for discrete faults.
+            Field("value", Int(32, signed=True)),
+            # Ticks from threshold exceeded to trip.
+            Field("latency", Int(32, signed=False)),
+            # Faults latched since MCU start and ones not reported because previous report was not sent yet.
+            Field("count", Int(32, signed=False)),
+            Field("lost_count", Int(32, signed=False)),
+        ]),
+        # Chunk of post-mortem buffer frozen by MCU on fault latch, requires `IPP_FEATURE_POSTMORTEM`.
+        # Values are indexed by `POSTMORTEM_*`, one point per sync tick. Points are ordered from the oldest one,
+        # `offset` is the index of the first point of chunk and `size` is the number of points in the whole buffer.
+        # Upload is restarted from zero offset after reconnection.
+        (Name(["postmortem"]), [
+            # Fault count of `McuMsgFault` the buffer was frozen at.
+            Field("fault_count", Int(32, signed=False)),
+            # Faults latched while the buffer was frozen, their ticks are not captured.
+            Field("lost_count", Int(32, signed=False)),
+            Field("size", Int(16, signed=False)),
+            Field("offset", Int(16, signed=False)),
+            Field("points", Vector(Array(Int(32, signed=True), 9))),
+        ]),
+        # Fault thresholds indexed by `FAULT_CHECK_*`, requires `IPP_FEATURE_FAULT_LIMITS`. Check fails when absolute
+        # value is greater than `limit` and trips after `persistence` consecutive failed sync ticks, zero disables it.
+        # Limits are in 100 uA units for currents, 100 uV units for voltage and 0.1 C units for temperature.
+        (Name(["fault", "limits"]), [
+            Field("limit", Array(Int(32, signed=True), 4)),
+            Field("persistence", Array(Int(32, signed=False), 4)),
+        ]),
     ],
 )
 
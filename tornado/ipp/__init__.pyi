@@ -15,6 +15,11 @@ from numpy.typing import NDArray
 @dataclass
 class AppMsgConnect:
 
+    version: int
+    max_msg_len: int
+    features: int
+    sample_freq_hz: int
+
     @staticmethod
     def load(data: bytes) -> AppMsgConnect:
         ...
@@ -63,6 +68,7 @@ class AppMsgDacMode:
 @dataclass
 class AppMsgDacData:
 
+    seq: int
     points: NDArray[np.int32]
 
     @staticmethod
@@ -84,6 +90,127 @@ class AppMsgStatsReset:
         ...
 
 
+@dataclass
+class AppMsgAdcDecimation:
+    ratio: int
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgAdcDecimation:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgCalibRead:
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgCalibRead:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgCalibWrite:
+
+    gain: NDArray[np.int32]
+    offset: NDArray[np.int32]
+    filter: NDArray[np.uint16]
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgCalibWrite:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgRegulatorRead:
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgRegulatorRead:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgRegulatorWrite:
+
+    kp: int
+    ki: int
+    kd: int
+    kp2: int
+    ki2: int
+    kd2: int
+    ff_r: int
+    ff_l: int
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgRegulatorWrite:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgTelemetry:
+
+    ratio: int
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgTelemetry:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgDacUpsampling:
+
+    ratio: int
+    interpolate: int
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgDacUpsampling:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgFaultLimitsRead:
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgFaultLimitsRead:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class AppMsgFaultLimitsWrite:
+
+    limit: NDArray[np.int32]
+    persistence: NDArray[np.uint32]
+
+    @staticmethod
+    def load(data: bytes) -> AppMsgFaultLimitsWrite:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
 @dataclass
 class AppMsg:
 
@@ -93,8 +220,17 @@ class AppMsg:
     DacMode = AppMsgDacMode
     DacData = AppMsgDacData
     StatsReset = AppMsgStatsReset
-
-    Variant = AppMsgConnect | AppMsgKeepAlive | AppMsgDoutUpdate | AppMsgDacMode | AppMsgDacData | AppMsgStatsReset
+    AdcDecimation = AppMsgAdcDecimation
+    CalibRead = AppMsgCalibRead
+    CalibWrite = AppMsgCalibWrite
+    RegulatorRead = AppMsgRegulatorRead
+    RegulatorWrite = AppMsgRegulatorWrite
+    Telemetry = AppMsgTelemetry
+    DacUpsampling = AppMsgDacUpsampling
+    FaultLimitsRead = AppMsgFaultLimitsRead
+    FaultLimitsWrite = AppMsgFaultLimitsWrite
+
+    Variant = AppMsgConnect | AppMsgKeepAlive | AppMsgDoutUpdate | AppMsgDacMode | AppMsgDacData | AppMsgStatsReset | AppMsgAdcDecimation | AppMsgCalibRead | AppMsgCalibWrite | AppMsgRegulatorRead | AppMsgRegulatorWrite | AppMsgTelemetry | AppMsgDacUpsampling | AppMsgFaultLimitsRead | AppMsgFaultLimitsWrite
 
     variant: Variant
 
@@ -106,6 +242,26 @@ class AppMsg:
         ...
 
 
+@dataclass
+class McuMsgCapabilities:
+
+    version: int
+    max_msg_len: int
+    dac_buffer_size: int
+    adc_buffer_size: int
+    dac_msg_max_points: int
+    adc_msg_max_points: int
+    sample_freq_hz: int
+    features: int
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgCapabilities:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
 @dataclass
 class McuMsgDinUpdate:
 
@@ -135,6 +291,8 @@ class McuMsgDacRequest:
 @dataclass
 class McuMsgAdcData:
 
+    seq: int
+    sample_index: int
     points_arrays: NDArray[np.int32]
 
     @staticmethod
@@ -172,16 +330,170 @@ class McuMsgDebug:
         ...
 
 
+@dataclass
+class McuMsgTiming:
+
+    stage: int
+    cycles_per_us: int
+    count: int
+    min: int
+    max: int
+    sum: int
+    hist: NDArray[np.uint32]
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgTiming:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class McuMsgStats:
+
+    clock_count: int
+    sample_count: int
+    max_intrs_per_sample: int
+    crc_error_count: int
+    dac_lost_empty: int
+    dac_lost_full: int
+    dac_req_exceed: int
+    adc_lost_full: int
+    dac_msg_lost: int
+    dac_msg_dup: int
+    adc_count: NDArray[np.uint32]
+    adc_sum: NDArray[np.int64]
+    adc_last: NDArray[np.int32]
+    adc_min: NDArray[np.int32]
+    adc_max: NDArray[np.int32]
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgStats:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class McuMsgCalib:
+
+    gain: NDArray[np.int32]
+    offset: NDArray[np.int32]
+    filter: NDArray[np.uint16]
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgCalib:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class McuMsgRegulator:
+
+    kp: int
+    ki: int
+    kd: int
+    kp2: int
+    ki2: int
+    kd2: int
+    ff_r: int
+    ff_l: int
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgRegulator:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class McuMsgTelemetry:
+
+    point_index: int
+    points: NDArray[np.int32]
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgTelemetry:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class McuMsgFault:
+
+    code: int
+    tick: int
+    sample_index: int
+    value: int
+    latency: int
+    count: int
+    lost_count: int
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgFault:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class McuMsgPostmortem:
+
+    fault_count: int
+    lost_count: int
+    size: int
+    offset: int
+    points: NDArray[np.int32]
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgPostmortem:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
+@dataclass
+class McuMsgFaultLimits:
+
+    limit: NDArray[np.int32]
+    persistence: NDArray[np.uint32]
+
+    @staticmethod
+    def load(data: bytes) -> McuMsgFaultLimits:
+        ...
+
+    def store(self) -> bytes:
+        ...
+
+
 @dataclass
 class McuMsg:
 
+    Capabilities = McuMsgCapabilities
     DinUpdate = McuMsgDinUpdate
     DacRequest = McuMsgDacRequest
     AdcData = McuMsgAdcData
     Error = McuMsgError
     Debug = McuMsgDebug
-
-    Variant = McuMsgDinUpdate | McuMsgDacRequest | McuMsgAdcData | McuMsgError | McuMsgDebug
+    Timing = McuMsgTiming
+    Stats = McuMsgStats
+    Calib = McuMsgCalib
+    Regulator = McuMsgRegulator
+    Telemetry = McuMsgTelemetry
+    Fault = McuMsgFault
+    Postmortem = McuMsgPostmortem
+    FaultLimits = McuMsgFaultLimits
+
+    Variant = McuMsgCapabilities | McuMsgDinUpdate | McuMsgDacRequest | McuMsgAdcData | McuMsgError | McuMsgDebug | McuMsgTiming | McuMsgStats | McuMsgCalib | McuMsgRegulator | McuMsgTelemetry | McuMsgFault | McuMsgPostmortem | McuMsgFaultLimits
 
     variant: Variant
 
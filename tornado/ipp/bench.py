@@ -0,0 +1,111 @@
+from __future__ import annotations
+from typing import Any, Callable, Dict, List
+
+import sys
+import json
+import time
+import tracemalloc
+from pathlib import Path
+
+import numpy as np
+
+from tornado.ipp import AppMsg, McuMsg
+from tornado.ipp.fast import FastCodec
+from tornado.common.config import Config, read_common_config
+
+# Measures encode/decode throughput and memory allocated by Python IPP codecs.
+# Output format is the same as of `source/ipp/bench/ipp_bench.cpp`.
+
+ITERATIONS = 10000
+WARMUP = 100
+
+
+def dac_msg_max_points(config: Config) -> int:
+    # Message type, sequence number, vector length and points.
+    return (config.rpmsg_max_app_msg_len - 1 - 4 - 2) // 4
+
+
+def adc_msg_max_points(config: Config) -> int:
+    # Message type, sequence number, sample index, vector length and points.
+    return (config.rpmsg_max_mcu_msg_len - 1 - 4 - 8 - 2) // (config.adc_count * 4)
+
+
+def _measure(op: Callable[[], Any], iterations: int) -> Dict[str, float]:
+    for _ in range(WARMUP):
+        op()
+
+    start = time.perf_counter_ns()
+    for _ in range(iterations):
+        op()
+    elapsed = time.perf_counter_ns() - start
+
+    # Allocations are measured separately because tracing slows down execution a lot.
+    tracemalloc.start()
+    op()
+    _, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+
+    return {
+        "ns_per_msg": elapsed / iterations,
+        "alloc_bytes_per_msg": float(peak),
+    }
+
+
+def _case(
+    codec: str,
+    name: str,
+    points: int,
+    encode: Callable[[], bytes],
+    decode: Callable[[bytes], Any],
+    iterations: int,
+) -> Dict[str, Any]:
+    data = encode()
+    result: Dict[str, Any] = {
+        "codec": codec,
+        "message": name,
+        "points": points,
+        "size": len(data),
+        "encode": _measure(encode, iterations),
+        "decode": _measure(lambda: decode(data), iterations),
+    }
+    for key in ["encode", "decode"]:
+        ns = result[key]["ns_per_msg"]
+        result[key]["mb_per_s"] = len(data) / ns * 1e3 if ns > 0 else 0.0
+    return result
+
+
+def run(config: Config, iterations: int = ITERATIONS) -> Dict[str, Any]:
+    dac_points = dac_msg_max_points(config)
+    adc_points = adc_msg_max_points(config)
+    dac = (np.arange(dac_points, dtype=np.int32) * 997).astype(np.int32)
+    adc = (np.arange(adc_points * config.adc_count, dtype=np.int32) * 131).reshape(adc_points, config.adc_count)
+
+    keep_alive = AppMsg(AppMsg.KeepAlive())
+    dac_data = AppMsg(AppMsg.DacData(0, dac))
+    dac_request = McuMsg(McuMsg.DacRequest(dac_points))
+    adc_data = McuMsg(McuMsg.AdcData(0, 0, adc))
+    fast = FastCodec(config.adc_count)
+
+    results: List[Dict[str, Any]] = [
+        _case("py", "app_msg_keep_alive", 0, keep_alive.store, AppMsg.load, iterations),
+        _case("py", "app_msg_dac_data", dac_points, dac_data.store, AppMsg.load, iterations),
+        _case("py", "mcu_msg_dac_request", 0, dac_request.store, McuMsg.load, iterations),
+        _case("py", "mcu_msg_adc_data", adc_points, adc_data.store, McuMsg.load, iterations),
+        # Fast codecs implement only the direction used by fake device.
+        _case("py_fast", "app_msg_dac_data", dac_points, dac_data.store, fast.load_app_msg, iterations),
+        _case("py_fast", "mcu_msg_dac_request", 0, lambda: fast.store_dac_request(dac_points), McuMsg.load, iterations),
+        _case("py_fast", "mcu_msg_adc_data", adc_points, lambda: fast.store_adc_data(0, 0, adc), McuMsg.load, iterations),
+    ]
+    return {
+        "iterations": iterations,
+        "results": results,
+    }
+
+
+def main() -> None:
+    source_dir = Path(sys.argv[1]) if len(sys.argv) > 1 else Path.cwd() / "source"
+    print(json.dumps(run(read_common_config(source_dir)), indent=2))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+from __future__ import annotations
+from typing import Dict, List
+
+import struct
+import numpy as np
+from numpy.typing import NDArray
+
+from tornado.ipp import AppMsg, McuMsg
+
+# Numpy-based codecs for the hot messages of data stream.
+#
+# Generic `load`/`store` convert vector fields element by element, which is too slow for the fake device at full
+# sample rate. These codecs describe packed wire layout with structured dtypes instead, so vectors are decoded as
+# `np.frombuffer` views without copying and encoded with a single array assignment.
+#
+# Wire layout is verified against generic codecs on creation, so any change of the messages that is not reflected
+# here is caught immediately.
+
+
+class FastCodec:
+
+    def __init__(self, adc_count: int) -> None:
+        self.adc_count = adc_count
+
+        # Variant indices are taken from generic codec to not duplicate message order.
+        self._app_dac_data_type = AppMsg(AppMsg.DacData(0, np.zeros(0, dtype=np.int32))).store()[0]
+        self._mcu_adc_data_type = McuMsg(McuMsg.AdcData(0, 0, np.zeros((0, adc_count), dtype=np.int32))).store()[0]
+        self._mcu_dac_request_type = McuMsg(McuMsg.DacRequest(0)).store()[0]
+
+        # Structured dtypes are packed (not aligned) by default, like IPP messages.
+        self.dac_data_header = np.dtype([
+            ("type", "u1"),
+            ("seq", "<u4"),
+            ("len", "<u2"),
+        ])
+        self.adc_data_header = np.dtype([
+            ("type", "u1"),
+            ("seq", "<u4"),
+            ("sample_index", "<u8"),
+            ("len", "<u2"),
+        ])
+        self._adc_point = np.dtype(("<i4", (adc_count,)))
+        # Whole ADC message dtype by number of points.
+        self._adc_records: Dict[int, np.dtype[np.void]] = {}
+
+        self._self_check()
+
+    def load_app_msg(self, data: bytes) -> AppMsg.Variant:
+        """Decode app message. DAC points are read-only view into `data`."""
+
+        if len(data) > 0 and data[0] == self._app_dac_data_type:
+            header = np.frombuffer(data, dtype=self.dac_data_header, count=1)[0]
+            count = int(header["len"])
+            offset = self.dac_data_header.itemsize
+            if len(data) != offset + count * 4:
+                raise ValueError(f"DacData message size mismatch: {len(data)} bytes for {count} points")
+            points: NDArray[np.int32] = np.frombuffer(data, dtype="<i4", count=count, offset=offset)
+            return AppMsg.DacData(int(header["seq"]), points)
+        else:
+            return AppMsg.load(data).variant
+
+    def store_dac_request(self, count: int) -> bytes:
+        return struct.pack("<BI", self._mcu_dac_request_type, count)
+
+    def _adc_record(self, points: int) -> np.dtype[np.void]:
+        record = self._adc_records.get(points)
+        if record is None:
+            record = np.dtype([("header", self.adc_data_header), ("points", self._adc_point, (points,))])
+            self._adc_records[points] = record
+        return record
+
+    def store_adc_data(self, seq: int, sample_index: int, points: NDArray[np.int32]) -> bytes:
+        return bytes(self.store_adc_data_batch(seq, sample_index, points, max(len(points), 1))[0])
+
+    def store_adc_data_batch(
+        self,
+        seq: int,
+        sample_index: int,
+        points: NDArray[np.int32],
+        max_points: int,
+    ) -> List[memoryview]:
+        """
+        Encode ADC points of shape `(n, adc_count)` into `ceil(n / max_points)` messages at once.
+        Messages have consecutive sequence numbers and sample indices starting from given ones.
+        Returned messages are views into single buffer.
+        """
+
+        assert points.shape[1:] == (self.adc_count,)
+        total = len(points)
+        full, tail = divmod(total, max_points)
+
+        record = self._adc_record(max_points)
+        # Empty input is encoded as single empty message.
+        has_tail = tail > 0 or total == 0
+        tail_size = self.adc_data_header.itemsize + tail * self._adc_point.itemsize if has_tail else 0
+        buffer = bytearray(full * record.itemsize + tail_size)
+
+        records = np.ndarray(full, dtype=record, buffer=buffer)
+        indices = np.arange(full, dtype=np.uint64)
+        records["header"]["type"] = self._mcu_adc_data_type
+        records["header"]["seq"] = (seq + indices) % (1 << 32)
+        records["header"]["sample_index"] = sample_index + indices * max_points
+        records["header"]["len"] = max_points
+        records["points"] = points[:full * max_points].reshape(full, max_points, self.adc_count)
+
+        view = memoryview(buffer)
+        messages = [view[i * record.itemsize:(i + 1) * record.itemsize] for i in range(full)]
+
+        if has_tail:
+            offset = full * record.itemsize
+            header = np.ndarray(1, dtype=self.adc_data_header, buffer=buffer, offset=offset)
+            header["type"] = self._mcu_adc_data_type
+            header["seq"] = (seq + full) % (1 << 32)
+            header["sample_index"] = sample_index + full * max_points
+            header["len"] = tail
+            tail_points = np.ndarray(
+                (tail, self.adc_count),
+                dtype="<i4",
+                buffer=buffer,
+                offset=offset + self.adc_data_header.itemsize,
+            )
+            tail_points[:] = points[full * max_points:]
+            messages.append(view[offset:])
+
+        return messages
+
+    def _self_check(self) -> None:
+        points = np.arange(7 * self.adc_count, dtype=np.int32).reshape(7, self.adc_count) - 3
+        seq, sample_index = 0xfffffffe, 0x123456789
+
+        generic = [
+            McuMsg(McuMsg.AdcData(seq, sample_index, points[:3])).store(),
+            McuMsg(McuMsg.AdcData(0xffffffff, sample_index + 3, points[3:6])).store(),
+            McuMsg(McuMsg.AdcData(0, sample_index + 6, points[6:])).store(),
+        ]
+        fast = [bytes(m) for m in self.store_adc_data_batch(seq, sample_index, points, 3)]
+        if fast != generic:
+            raise RuntimeError("Fast AdcData encoding differs from generic one")
+
+        if self.store_dac_request(12345) != McuMsg(McuMsg.DacRequest(12345)).store():
+            raise RuntimeError("Fast DacRequest encoding differs from generic one")
+
+        dac = AppMsg.DacData(0x89abcdef, np.array([0, -1, 0x7fffffff, -0x80000000], dtype=np.int32))
+        decoded = self.load_app_msg(AppMsg(dac).store())
+        if not (
+            isinstance(decoded, AppMsg.DacData) and decoded.seq == dac.seq and np.array_equal(decoded.points, dac.points)
+        ):
+            raise RuntimeError("Fast DacData decoding differs from generic one")
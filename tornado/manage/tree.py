@@ -10,10 +10,10 @@ from ferrite.components.epics.epics_base import EpicsBaseHost, EpicsBaseCross
 from ferrite.components.platforms.base import Platform
 from ferrite.components.platforms.imx8mn import Imx8mnPlatform
 
-from tornado.components.ipp import Ipp
-from tornado.components.app import AppReal, AppFake
+from tornado.components.ipp import Ipp, IppBench
+from tornado.components.app import AppReal, AppFake, AppTest
 from tornado.components.epics.app_ioc import AppIocHost, AppIocCross
-from tornado.components.mcu import Mcu
+from tornado.components.mcu import Mcu, McuHost
 from tornado.components.all_ import AllHost, AllCross
 
 
@@ -29,7 +29,10 @@ class _HostComponents(ComponentGroup):
         self.toolchain = toolchain
         self.epics_base = EpicsBaseHost(target_dir, toolchain)
         self.ipp = Ipp(source_dir, ferrite_source_dir, target_dir, toolchain)
+        self.ipp_bench = IppBench(source_dir, ferrite_source_dir, target_dir, toolchain, self.ipp)
         self.app = AppFake(source_dir, ferrite_source_dir, target_dir, toolchain, self.ipp)
+        self.app_test = AppTest(source_dir, ferrite_source_dir, target_dir, toolchain)
+        self.mcu_host = McuHost(source_dir, ferrite_source_dir, target_dir, toolchain, self.ipp)
         self.ioc_fakedev = AppIocHost(
             source_dir,
             ferrite_source_dir,
@@ -37,7 +40,7 @@ class _HostComponents(ComponentGroup):
             self.epics_base,
             self.app,
         )
-        self.all = AllHost(self.epics_base, self.ipp, self.app, self.ioc_fakedev)
+        self.all = AllHost(self.epics_base, self.ipp, self.app, self.app_test, self.mcu_host, self.ioc_fakedev)
 
     def components(self) -> Dict[str, Component | ComponentGroup]:
         return self.__dict__